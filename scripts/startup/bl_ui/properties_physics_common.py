@@ -191,6 +191,7 @@ def point_cache_ui(self, cache, enabled, cachetype):
             subcol.use_property_split = False
             subcol.active = cache.use_disk_cache
             subcol.prop(cache, "use_library_path", text="Use Library Path")
+            subcol.prop(cache, "use_disk_cache_pack", text="Pack Disk Cache")
 
             if cache.id_data.library and not cache.use_disk_cache:
                 can_bake = False
@@ -974,6 +974,12 @@ class USERPREF_PT_system_memory(SystemPanel, CenterAlignMixIn, Panel):
         col = layout.column()
         col.prop(system, "nodes_stack_limit")
 
+        layout.separator()
+
+        col = layout.column(align=True)
+        col.prop(system, "memory_cache_limit_volume_grids")
+        col.prop(system, "memory_cache_limit_file_loads")
+
 
 class USERPREF_PT_system_video_sequencer(SystemPanel, CenterAlignMixIn, Panel):
     bl_label = "Video Sequencer"
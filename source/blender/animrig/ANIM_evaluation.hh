@@ -9,6 +9,9 @@
  */
 #pragma once
 
+#include <string>
+
+#include "BLI_array.hh"
 #include "BLI_map.hh"
 #include "BLI_string_ref.hh"
 
@@ -118,6 +121,53 @@ class EvaluationResult {
   }
 };
 
+/**
+ * Evaluation plan for the F-Curves of one Channelbag, for one animated data-block.
+ *
+ * The RNA paths of the F-Curves are resolved when the plan is built instead of on every
+ * evaluation, and every F-Curve gets a cursor to quickly find its keyframes for the next frame.
+ * The resolved pointers point into the animated data-block, so plans are only stored for
+ * evaluated copies (see #AnimDataEvalCache). The depsgraph frees those and copies them again when
+ * their data changes.
+ */
+class ChannelbagEvalPlan {
+ public:
+  struct Channel {
+    /** The F-Curve, with its RNA path and array index at the time the plan was built. */
+    const FCurve *fcurve = nullptr;
+    std::string rna_path;
+    int array_index = 0;
+
+    /** Whether the RNA path could be resolved. When false, the F-Curve is skipped. */
+    bool is_resolved = false;
+    /** Result of #RNA_path_resolve_property, the rest is validated on every evaluation. */
+    PathResolvedRNA prop_rna = {};
+
+    /** Index of the keyframes used by the previous evaluation, see #evaluate_fcurve. */
+    int keyframe_cursor = 0;
+  };
+
+  Array<Channel> channels;
+
+  /**
+   * Whether the plan was built for exactly these F-Curves with the same RNA paths. Comparing the
+   * paths makes this independent of memory addresses that may be reused after the evaluated
+   * Action has been freed.
+   */
+  bool is_valid_for(Span<FCurve *> fcurves) const;
+};
+
+/**
+ * Cached evaluation plans of all Channelbags that animate a data-block, stored in the #AnimData
+ * of its evaluated copy.
+ *
+ * \note This is not thread-safe. A data-block is only animated by one thread at a time.
+ */
+class AnimDataEvalCache {
+ public:
+  Map<const Channelbag *, ChannelbagEvalPlan> plans;
+};
+
 /**
  * Evaluate the given action for the given slot and animated ID.
  *
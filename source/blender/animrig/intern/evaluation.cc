@@ -4,6 +4,7 @@
 
 #include "ANIM_evaluation.hh"
 
+#include "BKE_anim_data.hh"
 #include "BKE_animsys.hh"
 #include "BKE_fcurve.hh"
 
@@ -13,6 +14,10 @@
 
 #include "CLG_log.h"
 
+#include "DEG_depsgraph_query.hh"
+
+#include "RNA_path.hh"
+
 #include "evaluation_internal.hh"
 
 namespace blender {
@@ -144,6 +149,126 @@ static void animsys_write_orig_anim_rna(PointerRNA *ptr,
   }
 }
 
+/**
+ * Maximum number of cached evaluation plans per animated data-block. Plans are keyed by the
+ * Channelbag, and the evaluated Action (including its Channelbags) is copied again when it is
+ * edited. This limit avoids keeping the plans of freed Channelbags forever.
+ */
+static constexpr int64_t EVAL_PLANS_MAX = 16;
+
+bool ChannelbagEvalPlan::is_valid_for(const Span<FCurve *> fcurves) const
+{
+  if (this->channels.size() != fcurves.size()) {
+    return false;
+  }
+  for (const int64_t i : fcurves.index_range()) {
+    const Channel &channel = this->channels[i];
+    const FCurve *fcu = fcurves[i];
+    if (channel.fcurve != fcu || channel.array_index != fcu->array_index ||
+        channel.rna_path != fcu->rna_path())
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * Get the cache for evaluation plans of the animated data-block. Only evaluated copies have one,
+ * because the RNA pointers in the plans would not be safe to keep for original data, which can
+ * be changed at any time.
+ */
+static AnimDataEvalCache *eval_cache_ensure(PointerRNA &animated_id_ptr)
+{
+  ID *animated_id = animated_id_ptr.owner_id;
+  if (animated_id == nullptr || animated_id_ptr.data != animated_id ||
+      !DEG_is_evaluated(animated_id))
+  {
+    return nullptr;
+  }
+  AnimData *adt = BKE_animdata_from_id(animated_id);
+  if (adt == nullptr) {
+    return nullptr;
+  }
+  if (adt->eval_cache == nullptr) {
+    adt->eval_cache = MEM_new<AnimDataEvalCache>(__func__);
+  }
+  return adt->eval_cache;
+}
+
+static void eval_plan_build(PointerRNA &animated_id_ptr,
+                            const Span<FCurve *> fcurves,
+                            ChannelbagEvalPlan &plan)
+{
+  plan.channels.reinitialize(fcurves.size());
+  threading::parallel_for(fcurves.index_range(), 512, [&](const IndexRange range) {
+    for (const int i : range) {
+      const FCurve *fcu = fcurves[i];
+      ChannelbagEvalPlan::Channel &channel = plan.channels[i];
+      channel.fcurve = fcu;
+      channel.rna_path = fcu->rna_path();
+      channel.array_index = fcu->array_index;
+      channel.keyframe_cursor = 0;
+      channel.is_resolved = !fcu->rna_path().is_empty() &&
+                            RNA_path_resolve_property(&animated_id_ptr,
+                                                      fcu->rna_path_parsed(),
+                                                      &channel.prop_rna.ptr,
+                                                      &channel.prop_rna.prop);
+    }
+  });
+}
+
+/**
+ * Evaluate the F-Curves with a cached plan, see #ChannelbagEvalPlan. This gives the same results
+ * as #evaluate_keyframe_data, without resolving the RNA paths and searching the keyframes from
+ * scratch on every evaluation.
+ */
+static EvaluationResult evaluate_keyframe_data_with_plan(
+    PointerRNA &animated_id_ptr,
+    const Span<FCurve *> fcurves,
+    ChannelbagEvalPlan &plan,
+    const AnimationEvalContext &offset_eval_context)
+{
+  Array<bool> valid(fcurves.size(), false);
+  Array<float> results(fcurves.size());
+  Array<PathResolvedRNA> resolved_rna(fcurves.size());
+
+  threading::parallel_for(fcurves.index_range(), 512, [&](const IndexRange range) {
+    for (const int i : range) {
+      FCurve *fcu = fcurves[i];
+      ChannelbagEvalPlan::Channel &channel = plan.channels[i];
+      if (!channel.is_resolved || !is_fcurve_evaluatable(fcu)) {
+        continue;
+      }
+      PathResolvedRNA &anim_rna = resolved_rna[i];
+      anim_rna = channel.prop_rna;
+      if (!BKE_animsys_rna_path_resolve_validate(
+              &animated_id_ptr, fcu->rna_path_parsed(), fcu->array_index, &anim_rna))
+      {
+        continue;
+      }
+      BLI_assert(fcu->driver == nullptr);
+      results[i] = evaluate_fcurve(fcu, offset_eval_context.eval_time, channel.keyframe_cursor);
+      valid[i] = true;
+    }
+  });
+
+  EvaluationResult evaluation_result;
+  evaluation_result.reserve(fcurves.size());
+  for (const int i : fcurves.index_range()) {
+    if (!valid[i]) {
+      continue;
+    }
+    /* This part is not threadsafe. */
+    evaluation_result.store(fcurves[i]->rna_path_parsed(),
+                            fcurves[i]->array_index,
+                            results[i],
+                            std::move(resolved_rna[i]));
+  }
+
+  return evaluation_result;
+}
+
 static EvaluationResult evaluate_keyframe_data(PointerRNA &animated_id_ptr,
                                                StripKeyframeData &strip_data,
                                                const slot_handle_t slot_handle,
@@ -155,6 +280,21 @@ static EvaluationResult evaluate_keyframe_data(PointerRNA &animated_id_ptr,
   }
 
   Span<FCurve *> fcurves = channelbag_for_slot->fcurves();
+
+  if (AnimDataEvalCache *eval_cache = eval_cache_ensure(animated_id_ptr)) {
+    if (!eval_cache->plans.contains(channelbag_for_slot) &&
+        eval_cache->plans.size() >= EVAL_PLANS_MAX)
+    {
+      eval_cache->plans.clear();
+    }
+    ChannelbagEvalPlan &plan = eval_cache->plans.lookup_or_add_default(channelbag_for_slot);
+    if (!plan.is_valid_for(fcurves)) {
+      /* The Action was edited or another one was assigned. */
+      eval_plan_build(animated_id_ptr, fcurves, plan);
+    }
+    return evaluate_keyframe_data_with_plan(
+        animated_id_ptr, fcurves, plan, offset_eval_context);
+  }
   /* Stores true for FCurves that have been evaluated. Not using BitVector because writing to it
    * from threads will introduce race conditions.*/
   Array<bool> valid(fcurves.size(), false);
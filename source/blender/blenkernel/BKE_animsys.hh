@@ -314,6 +314,15 @@ bool BKE_animsys_rna_path_resolve(PointerRNA *ptr,
                                   ParsedRNAPathRef rna_path,
                                   int array_index,
                                   PathResolvedRNA *r_result);
+/**
+ * Second half of #BKE_animsys_rna_path_resolve, for callers that cache the pointer and property
+ * that the path resolved to. Checks whether the property in \a r_result can be animated with the
+ * given array index, and sets #PathResolvedRNA::prop_index.
+ */
+bool BKE_animsys_rna_path_resolve_validate(const PointerRNA *ptr,
+                                           ParsedRNAPathRef rna_path,
+                                           int array_index,
+                                           PathResolvedRNA *r_result);
 bool BKE_animsys_read_from_rna_path(PathResolvedRNA *anim_rna, float *r_value);
 /**
  * Write the given value to a setting using RNA, and return success.
@@ -369,6 +378,14 @@ void animsys_evaluate_action_group(PointerRNA *ptr,
 void BKE_animsys_eval_animdata(Depsgraph *depsgraph, ID *id);
 void BKE_animsys_eval_driver_unshare(Depsgraph *depsgraph, ID *id);
 void BKE_animsys_eval_driver(Depsgraph *depsgraph, ID *id, int driver_index, FCurve *fcu_orig);
+/**
+ * Evaluate a batch of drivers of the given ID, sharing the evaluation context between them.
+ * Used by the dependency graph to evaluate drivers which do not need Python as one operation.
+ */
+void BKE_animsys_eval_drivers(Depsgraph *depsgraph,
+                              ID *id,
+                              Span<int> driver_indices,
+                              Span<FCurve *> fcurves_orig);
 
 void BKE_animsys_update_driver_array(ID *id);
 
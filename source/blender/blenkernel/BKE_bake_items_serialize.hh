@@ -49,6 +49,14 @@ class BlobReader {
    */
   [[nodiscard]] virtual bool read_as_stream(const BlobSlice &slice,
                                             FunctionRef<bool(std::istream &)> fn) const;
+
+  /**
+   * Provides the data of the given slice without copying it, if the reader supports that. The
+   * data is owned by the returned sharing info. It is not necessarily aligned.
+   * \return The shared data, or none if the data has to be copied with #read instead.
+   */
+  [[nodiscard]] virtual std::optional<ImplicitSharingInfoAndData> read_without_copy(
+      const BlobSlice &slice) const;
 };
 
 /**
@@ -57,6 +65,8 @@ class BlobReader {
 class BlobWriter {
  protected:
   int64_t total_written_size_ = 0;
+  /** Compress large arrays that are written with #write_array. */
+  bool use_compression_ = false;
 
  public:
   virtual ~BlobWriter() = default;
@@ -76,6 +86,18 @@ class BlobWriter {
   virtual BlobSlice write_as_stream(StringRef file_extension,
                                     FunctionRef<void(std::ostream &)> fn);
 
+  /**
+   * Write an array of binary data. If compression is enabled and the array is large enough, it is
+   * compressed in independent chunks, so that it can be decompressed in parallel.
+   * \return Identifier of the written data, i.e. the #BlobSlice and how it is encoded.
+   */
+  std::shared_ptr<io::serialize::DictionaryValue> write_array(const void *data, int64_t size);
+
+  void set_use_compression(const bool use_compression)
+  {
+    use_compression_ = use_compression;
+  }
+
   int64_t written_size() const
   {
     return total_written_size_;
@@ -111,7 +133,7 @@ class BlobWriteSharing : NonCopyable, NonMovable {
    * Remembers where data was stored based on the hash of the data. This allows us to skip writing
    * the same array again if it has the same hash.
    */
-  Map<uint64_t, BlobSlice> slice_by_content_hash_;
+  Map<uint64_t, std::shared_ptr<io::serialize::DictionaryValue>> io_data_by_content_hash_;
 
  public:
   ~BlobWriteSharing();
@@ -162,6 +184,8 @@ class BlobReadSharing : NonCopyable, NonMovable {
       FunctionRef<std::optional<ImplicitSharingInfoAndData>()> read_fn) const;
 };
 
+class MappedBlobFile;
+
 /**
  * A specific #BlobReader that reads from disk.
  */
@@ -170,10 +194,14 @@ class DiskBlobReader : public BlobReader {
   const std::string blobs_dir_;
   mutable Mutex mutex_;
   mutable Map<std::string, std::unique_ptr<fstream>> open_input_streams_;
+  /** Blob files that are memory mapped to read arrays without copying them. */
+  mutable Map<std::string, std::shared_ptr<const MappedBlobFile>> mapped_files_;
 
  public:
   DiskBlobReader(std::string blobs_dir);
   [[nodiscard]] bool read(const BlobSlice &slice, void *r_data) const override;
+  [[nodiscard]] std::optional<ImplicitSharingInfoAndData> read_without_copy(
+      const BlobSlice &slice) const override;
 };
 
 /**
@@ -8,6 +8,7 @@
 #include "BLI_function_ref.hh"
 #include "BLI_index_mask_fwd.hh"
 #include "BLI_math_vector_types.hh"
+#include "BLI_mutex.hh"
 
 #include <limits>
 #include <optional>
@@ -86,6 +87,16 @@ class Tree {
   /** Used when Embree is not available. */
   std::unique_ptr<FallbackTree> fallback_tree_;
 
+  /**
+   * The topology of the mesh the tree was built from with #from_single_mesh, used to check whether
+   * the tree can be refit for new positions. The hash covers the face offsets and corner vertices.
+   */
+  uint64_t topology_hash_ = 0;
+  int topology_verts_num_ = -1;
+  int topology_tris_num_ = 0;
+  /** True when the tree was built in a way that allows cheap refitting. */
+  bool is_refittable_ = false;
+
  public:
   Tree();
   Tree(const Tree &) = delete;
@@ -104,9 +115,33 @@ class Tree {
   /** Create a BVH tree from the entire mesh. */
   static Tree from_single_mesh(const Mesh &mesh);
 
+  /**
+   * Update the bounding volumes of a tree created with #from_single_mesh for the positions of a
+   * mesh with the same topology, which is much cheaper than building a new tree. The first refit
+   * builds the tree again in a mode that supports refitting, so that meshes which are never
+   * deformed don't pay the (small) cost in query performance.
+   * \return False if the mesh topology is different, in which case a new tree must be built.
+   */
+  bool refit(const Mesh &mesh);
+
+  /** Whether the tree stores the topology of its mesh and can potentially be refit. */
+  bool has_mesh_topology() const
+  {
+    return topology_verts_num_ != -1;
+  }
+
   /** Intersect a single ray against the tree. */
   std::optional<RayHit> ray_intersect(const Ray &ray) const;
 
+  /**
+   * Intersect many rays against the tree. The rays are reordered for more coherent traversal and
+   * traced in packets, which is much faster than calling #ray_intersect for every ray.
+   * \param mask: Indices of the rays to trace, used for both \a rays and \a r_hits.
+   */
+  void ray_intersect(const IndexMask &mask,
+                     Span<Ray> rays,
+                     MutableSpan<std::optional<RayHit>> r_hits) const;
+
   /** Call a callback for every ray intersection. */
   void ray_intersect_all(const Ray &ray, FunctionRef<void(const RayHit &)> fn) const;
 
@@ -114,8 +149,43 @@ class Tree {
   std::optional<ClosestPointResult> closest_point(
       const float3 &point, float radius = std::numeric_limits<float>::max()) const;
 
+  /**
+   * Find the closest surface points to many positions. The queries are reordered so that nearby
+   * positions are processed together, which improves memory locality of the traversal.
+   * \param mask: Indices of the positions to query, used for both \a points and \a r_results.
+   */
+  void closest_point(const IndexMask &mask,
+                     Span<float3> points,
+                     MutableSpan<std::optional<ClosestPointResult>> r_results,
+                     float radius = std::numeric_limits<float>::max()) const;
+
   /** Call a callback for every element within a given radius. */
   void range_query(const float3 &point, const float radius, FunctionRef<bool(int)> fn) const;
+
+ private:
+  static Tree from_single_mesh_impl(const Mesh &mesh, bool refittable);
+
+  friend class ReusableTree;
+};
+
+/**
+ * Storage for trees of meshes which were freed, so that they can be refit for the next meshes with
+ * the same topology instead of building new trees. This is shared between copies of a mesh,
+ * because deformed meshes are typically created from the same original mesh on every evaluation.
+ * A few trees are kept so that e.g. simulation sub-steps which use a mesh per step benefit too.
+ * The memory of a tree is mostly proportional to its number of triangles, so the total number of
+ * triangles of the stored trees is limited too.
+ */
+class ReusableTree {
+  static constexpr int max_trees = 8;
+  static constexpr int64_t max_tris_num = 4 * 1024 * 1024;
+  Mutex mutex_;
+  Vector<Tree> trees_;
+  int64_t tris_num_ = 0;
+
+ public:
+  void store(Tree &&tree);
+  std::optional<Tree> take();
 };
 
 }  // namespace bke::bvh
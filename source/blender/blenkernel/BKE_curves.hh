@@ -9,6 +9,7 @@
  * \brief Low-level operations for curves.
  */
 
+#include "BLI_array.hh"
 #include "BLI_array_utils.hh"
 #include "BLI_bounds_types.hh"
 #include "BLI_implicit_sharing_ptr.hh"
@@ -67,6 +68,27 @@ struct BasisCache {
   bool invalid = false;
 };
 
+/**
+ * Basis caches for all curves. The basis only depends on a few parameters of a curve, so curves
+ * which use the same parameters and generated knots (typically most NURBS curves of hair) share a
+ * single cache. This avoids recomputing and storing identical weights, and keeps them hot in CPU
+ * caches while evaluating many curves.
+ */
+struct BasisCaches {
+  /**
+   * Unique basis caches. The first one is an empty cache used by curves of other types, so that
+   * every curve index can be looked up.
+   */
+  Vector<BasisCache> caches;
+  /** For each curve, the index of its cache in #caches. Empty when there are no NURBS curves. */
+  Array<int> cache_indices;
+
+  const BasisCache &operator[](const int curve_index) const
+  {
+    return this->caches[this->cache_indices[curve_index]];
+  }
+};
+
 }  // namespace curves::nurbs
 
 /**
@@ -98,7 +120,7 @@ class CurvesGeometryRuntime {
 
   mutable SharedCache<bool> has_cyclic_curve_cache;
 
-  mutable SharedCache<Vector<curves::nurbs::BasisCache>> nurbs_basis_cache;
+  mutable SharedCache<curves::nurbs::BasisCaches> nurbs_basis_cache;
 
   /**
    * Cache of evaluated positions for all curves. The positions span will
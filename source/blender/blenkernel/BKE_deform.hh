@@ -7,6 +7,7 @@
 #include "DNA_listBase.h"
 #include "DNA_meshdata_types.h"
 
+#include "BLI_array.hh"
 #include "BLI_math_vector_types.hh"
 #include "BLI_offset_indices.hh"
 #include "BLI_span.hh"
@@ -359,6 +360,13 @@ struct WeightIndexGetter {
 };
 using MDeformWeightSet = CustomIDVectorSet<MDeformWeight, WeightIndexGetter, 64>;
 
+/** The vertex group weights of all vertices in a single array, see #Mesh::deform_weights(). */
+struct DeformWeightsCache {
+  /** Offsets into #weights for every vertex. */
+  Array<int> offsets;
+  Array<MDeformWeight> weights;
+};
+
 MDeformVert mix_deform_verts(const Span<MDeformVert> src,
                              const Span<int> indices,
                              const Span<float> weights,
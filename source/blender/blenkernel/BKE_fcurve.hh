@@ -616,6 +616,15 @@ void BKE_fcurve_correct_bezpart(const float v1[2], float v2[2], float v3[2], con
  * Evaluate a non-driver F-Curve.
  */
 float evaluate_fcurve(const FCurve *fcu, float evaltime);
+/**
+ * Evaluate a non-driver F-Curve, like #evaluate_fcurve.
+ *
+ * \param keyframe_cursor: Index of the keyframes that were used by the previous evaluation of
+ * the curve, which is updated for the next evaluation. When the evaluation time is close to the
+ * previous one (e.g. during playback), the keyframes don't have to be searched for. Should be
+ * initialized to zero, the result does not depend on its value.
+ */
+float evaluate_fcurve(const FCurve *fcu, float evaltime, int &keyframe_cursor);
 /**
  * Evaluate the F-Curve; if this is a driver, that aspect is ignored and only its F-Curve is
  * evaluated.
@@ -38,6 +38,7 @@ class ShrinkwrapBoundaryData;
 struct SubdivCCG;
 struct SubsurfRuntimeData;
 namespace bke {
+struct DeformWeightsCache;
 struct EditMeshData;
 }  // namespace bke
 namespace bke::bake {
@@ -197,6 +198,12 @@ struct MeshRuntime {
   SharedCache<std::unique_ptr<BVHTree, BVHTreeDeleter>> bvh_cache_loose_edges_no_hidden;
 
   SharedCache<bke::bvh::Tree> bvh_embree_cache;
+  /**
+   * A tree of a freed mesh with the same topology, shared between copies of the mesh, so that the
+   * tree of deformed meshes can be refit instead of being built from scratch.
+   */
+  std::shared_ptr<bke::bvh::ReusableTree> bvh_embree_reusable_tree =
+      std::make_shared<bke::bvh::ReusableTree>();
 
   SharedCache<std::optional<int>> max_material_index;
   SharedCache<VectorSet<int>> used_material_indices;
@@ -270,6 +277,9 @@ struct MeshRuntime {
   /** Cache of non-manifold boundary data for shrinkwrap target Project. */
   SharedCache<ShrinkwrapBoundaryData> shrinkwrap_boundary_cache;
 
+  /** Cache of contiguously stored vertex group weights. See #Mesh::deform_weights(). */
+  SharedCache<DeformWeightsCache> deform_weights_cache;
+
   /**
    * A bit vector the size of the number of vertices, set to true for the center vertices of
    * subdivided faces. The values are set by the subdivision surface modifier and used by
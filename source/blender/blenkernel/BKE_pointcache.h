@@ -15,6 +15,7 @@
 #include "DNA_particle_types.h"   /* for KDTree3d */
 #include "DNA_pointcache_types.h" /* for #BPHYS_TOT_DATA */
 
+#include <memory>
 #include <stdio.h> /* for #FILE */
 
 namespace blender {
@@ -34,6 +35,8 @@ namespace blender {
 
 /* Add the blend-file name after `blendcache_`. */
 #define PTCACHE_EXT ".bphys"
+/* Single file containing all frames of a packed disk cache, see #BKE_ptcache_disk_pack. */
+#define PTCACHE_PACK_EXT ".bpack"
 #define PTCACHE_PATH "blendcache_"
 
 /* File open options, for BKE_ptcache_file_open */
@@ -93,8 +96,17 @@ struct PTCacheData {
   struct BoidData boids;
 };
 
+struct PTCachePack;
+
 struct PTCacheFile {
   FILE *fp;
+  /**
+   * Frames of a packed disk cache are read from the memory mapped pack file instead of #fp.
+   * The frame data starts at #mem, #pack keeps the mapping alive while the frame is read.
+   */
+  std::shared_ptr<const PTCachePack> pack;
+  const unsigned char *mem;
+  size_t mem_size, mem_pos;
 
   int frame, old_format;
   unsigned int totpoint, type;
@@ -395,6 +407,16 @@ void BKE_ptcache_disk_to_mem(struct PTCacheID *pid);
  * Convert memory cache to disk cache.
  */
 void BKE_ptcache_mem_to_disk(struct PTCacheID *pid);
+/**
+ * Move all frames of a baked disk cache into a single file with a frame offset table, which is
+ * memory mapped for reading. Returns false if the cache could not be packed, in which case the
+ * per-frame files are kept.
+ */
+bool BKE_ptcache_disk_pack(struct PTCacheID *pid);
+/**
+ * Write the frames of a packed disk cache back to one file per frame and remove the pack file.
+ */
+void BKE_ptcache_disk_unpack(struct PTCacheID *pid);
 /**
  * Convert disk cache to memory cache and vice versa. Clears the cache that was converted.
  */
@@ -53,6 +53,7 @@
 
 #include "ANIM_action_iterators.hh"
 #include "ANIM_action_legacy.hh"
+#include "ANIM_evaluation.hh"
 #include "ANIM_versioning.hh"
 
 #include "CLG_log.h"
@@ -215,6 +216,9 @@ void BKE_animdata_free(ID *id, const bool do_id_user)
   /* free driver array cache */
   MEM_SAFE_DELETE(adt->driver_array);
 
+  /* free evaluation cache */
+  MEM_SAFE_DELETE(adt->eval_cache);
+
   /* free overrides */
   /* TODO... */
 
@@ -321,6 +325,7 @@ AnimData *BKE_animdata_copy_in_lib(Main *bmain,
   /* duplicate drivers (F-Curves) */
   BKE_fcurves_copy(&dadt->drivers, &adt->drivers);
   dadt->driver_array = nullptr;
+  dadt->eval_cache = nullptr;
 
   /* don't copy overrides */
   dadt->overrides.clear_no_delete();
@@ -1319,6 +1324,7 @@ void BKE_animdata_blend_read_data(BlendDataReader *reader, ID *id)
   BLO_read_struct_list(reader, FCurve, &adt->drivers);
   BKE_fcurve_blend_read_data_listbase(reader, &adt->drivers);
   adt->driver_array = nullptr;
+  adt->eval_cache = nullptr;
 
   /* link overrides */
   /* TODO... */
@@ -14,6 +14,7 @@
 
 #include "MEM_guardedalloc.h"
 
+#include "BLI_array.hh"
 #include "BLI_bit_vector.hh"
 #include "BLI_listbase.hh"
 #include "BLI_listbase_wrapper.hh"
@@ -25,6 +26,7 @@
 #include "BLI_string.hh"
 #include "BLI_string_utf8.hh"
 #include "BLI_string_utils.hh"
+#include "BLI_task.hh"
 #include "BLI_utildefines.hh"
 
 #include "BLT_translation.hh"
@@ -373,6 +375,14 @@ bool BKE_animsys_rna_path_resolve(
     return false;
   }
 
+  return BKE_animsys_rna_path_resolve_validate(ptr, rna_path, array_index, r_result);
+}
+
+bool BKE_animsys_rna_path_resolve_validate(const PointerRNA *ptr,
+                                           const ParsedRNAPathRef rna_path,
+                                           const int array_index,
+                                           PathResolvedRNA *r_result)
+{
   if (ptr->owner_id != nullptr && !RNA_property_animateable(&r_result->ptr, r_result->prop)) {
     return false;
   }
@@ -566,7 +576,7 @@ static bool animsys_construct_orig_pointer_rna(const PointerRNA *ptr, PointerRNA
 }
 
 static void animsys_write_orig_anim_rna(PointerRNA *ptr,
-                                        const char *rna_path,
+                                        const ParsedRNAPathRef rna_path,
                                         int array_index,
                                         float value)
 {
@@ -581,6 +591,21 @@ static void animsys_write_orig_anim_rna(PointerRNA *ptr,
   }
 }
 
+static void animsys_write_orig_anim_rna(PointerRNA *ptr,
+                                        const char *rna_path,
+                                        int array_index,
+                                        float value)
+{
+  if (rna_path == nullptr) {
+    return;
+  }
+  const std::optional<ParsedRNAPath<>> path = ParsedRNAPath<>::from_string(rna_path);
+  if (!path) {
+    return;
+  }
+  animsys_write_orig_anim_rna(ptr, *path, array_index, value);
+}
+
 /**
  * Evaluate all the F-Curves in the given list
  * This performs a set of standard checks. If extra checks are required,
@@ -591,22 +616,40 @@ static void animsys_evaluate_fcurves(PointerRNA *ptr,
                                      const AnimationEvalContext *anim_eval_context,
                                      bool flush_to_original)
 {
-  /* Calculate then execute each curve. */
-  for (FCurve *fcu : fcurves) {
+  /* Resolve the paths (parsed when they were assigned to the F-Curves) and calculate the values
+   * in parallel. Stores true for F-Curves that have been evaluated. */
+  Array<bool> valid(fcurves.size(), false);
+  Array<float> values(fcurves.size());
+  Array<PathResolvedRNA> resolved_rna(fcurves.size());
 
-    if (!is_fcurve_evaluatable(fcu)) {
-      continue;
+  threading::parallel_for(fcurves.index_range(), 512, [&](const IndexRange range) {
+    for (const int i : range) {
+      FCurve *fcu = fcurves[i];
+      if (!is_fcurve_evaluatable(fcu)) {
+        continue;
+      }
+      const ParsedRNAPathRef rna_path = fcu->rna_path_parsed();
+      if (rna_path.is_empty()) {
+        continue;
+      }
+      if (!BKE_animsys_rna_path_resolve(ptr, rna_path, fcu->array_index, &resolved_rna[i])) {
+        continue;
+      }
+      values[i] = calculate_fcurve(&resolved_rna[i], fcu, anim_eval_context);
+      valid[i] = true;
     }
+  });
 
-    const StringRefNull rna_path = fcu->rna_path();
-
-    PathResolvedRNA anim_rna;
-    if (BKE_animsys_rna_path_resolve(ptr, rna_path.c_str(), fcu->array_index, &anim_rna)) {
-      const float curval = calculate_fcurve(&anim_rna, fcu, anim_eval_context);
-      BKE_animsys_write_to_rna_path(&anim_rna, curval);
-      if (flush_to_original) {
-        animsys_write_orig_anim_rna(ptr, rna_path.c_str(), fcu->array_index, curval);
-      }
+  /* Writing the values is not threadsafe. It happens in the order of the F-Curves, so that the
+   * last F-Curve of a property still determines its value. */
+  for (const int i : fcurves.index_range()) {
+    if (!valid[i]) {
+      continue;
+    }
+    BKE_animsys_write_to_rna_path(&resolved_rna[i], values[i]);
+    if (flush_to_original) {
+      animsys_write_orig_anim_rna(
+          ptr, fcurves[i]->rna_path_parsed(), fcurves[i]->array_index, values[i]);
     }
   }
 }
@@ -3849,7 +3892,14 @@ void BKE_animsys_eval_driver_unshare(Depsgraph *depsgraph, ID *id_eval)
   }
 }
 
-void BKE_animsys_eval_driver(Depsgraph *depsgraph, ID *id, int driver_index, FCurve *fcu_orig)
+static void animsys_eval_driver(Depsgraph *depsgraph,
+                                ID *id,
+                                const AnimData *adt,
+                                PointerRNA *id_ptr,
+                                const AnimationEvalContext *anim_eval_context,
+                                const bool is_active_depsgraph,
+                                int driver_index,
+                                FCurve *fcu_orig)
 {
   BLI_assert(fcu_orig != nullptr);
 
@@ -3857,7 +3907,6 @@ void BKE_animsys_eval_driver(Depsgraph *depsgraph, ID *id, int driver_index, FCu
   bool ok = false;
 
   /* Lookup driver, accelerated with driver array map. */
-  const AnimData *adt = BKE_animdata_from_id(id);
   FCurve *fcu;
 
   if (adt->driver_array) {
@@ -3877,8 +3926,6 @@ void BKE_animsys_eval_driver(Depsgraph *depsgraph, ID *id, int driver_index, FCu
   DEG_debug_print_eval_subdata_index(
       depsgraph, __func__, id->name, id, "fcu", fcu->rna_path().c_str(), fcu, fcu->array_index);
 
-  PointerRNA id_ptr = RNA_id_pointer_create(id);
-
   /* check if this driver's curve should be skipped */
   if ((fcu->flag & (FCURVE_MUTED | FCURVE_DISABLED)) == 0) {
     /* check if driver itself is tagged for recalculation */
@@ -3892,17 +3939,14 @@ void BKE_animsys_eval_driver(Depsgraph *depsgraph, ID *id, int driver_index, FCu
 
       PathResolvedRNA anim_rna;
       const StringRefNull rna_path = fcu->rna_path();
-      if (BKE_animsys_rna_path_resolve(&id_ptr, rna_path.c_str(), fcu->array_index, &anim_rna)) {
+      if (BKE_animsys_rna_path_resolve(id_ptr, rna_path.c_str(), fcu->array_index, &anim_rna)) {
         /* Evaluate driver, and write results to copy-on-eval-domain destination */
-        const float ctime = DEG_get_ctime(depsgraph);
-        const AnimationEvalContext anim_eval_context = BKE_animsys_eval_context_construct(
-            depsgraph, ctime);
-        const float curval = calculate_fcurve(&anim_rna, fcu, &anim_eval_context);
+        const float curval = calculate_fcurve(&anim_rna, fcu, anim_eval_context);
         ok = BKE_animsys_write_to_rna_path(&anim_rna, curval);
 
         /* Flush results & status codes to original data for UI (#59984) */
-        if (ok && DEG_is_active(depsgraph)) {
-          animsys_write_orig_anim_rna(&id_ptr, rna_path.c_str(), fcu->array_index, curval);
+        if (ok && is_active_depsgraph) {
+          animsys_write_orig_anim_rna(id_ptr, rna_path.c_str(), fcu->array_index, curval);
 
           /* curval is displayed in the UI, and flag contains error-status codes */
           fcu_orig->runtime->curval = fcu->runtime->curval;
@@ -3938,6 +3982,47 @@ void BKE_animsys_eval_driver(Depsgraph *depsgraph, ID *id, int driver_index, FCu
   }
 }
 
+void BKE_animsys_eval_driver(Depsgraph *depsgraph, ID *id, int driver_index, FCurve *fcu_orig)
+{
+  const AnimData *adt = BKE_animdata_from_id(id);
+  PointerRNA id_ptr = RNA_id_pointer_create(id);
+  const AnimationEvalContext anim_eval_context = BKE_animsys_eval_context_construct(
+      depsgraph, DEG_get_ctime(depsgraph));
+  animsys_eval_driver(depsgraph,
+                      id,
+                      adt,
+                      &id_ptr,
+                      &anim_eval_context,
+                      DEG_is_active(depsgraph),
+                      driver_index,
+                      fcu_orig);
+}
+
+void BKE_animsys_eval_drivers(Depsgraph *depsgraph,
+                              ID *id,
+                              const Span<int> driver_indices,
+                              const Span<FCurve *> fcurves_orig)
+{
+  BLI_assert(driver_indices.size() == fcurves_orig.size());
+
+  /* Evaluation context and the ID pointer are shared by all drivers of the batch. */
+  const AnimData *adt = BKE_animdata_from_id(id);
+  PointerRNA id_ptr = RNA_id_pointer_create(id);
+  const AnimationEvalContext anim_eval_context = BKE_animsys_eval_context_construct(
+      depsgraph, DEG_get_ctime(depsgraph));
+  const bool is_active_depsgraph = DEG_is_active(depsgraph);
+  for (const int i : driver_indices.index_range()) {
+    animsys_eval_driver(depsgraph,
+                        id,
+                        adt,
+                        &id_ptr,
+                        &anim_eval_context,
+                        is_active_depsgraph,
+                        driver_indices[i],
+                        fcurves_orig[i]);
+  }
+}
+
 void BKE_time_markers_blend_write(BlendWriter *writer, ListBaseT<TimeMarker> &markers)
 {
   for (TimeMarker &marker : markers) {
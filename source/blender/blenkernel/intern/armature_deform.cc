@@ -366,11 +366,27 @@ static ArmatureDeformParams get_armature_deform_params(
   return deform_params;
 }
 
-/* Accumulate bone deformations using the mixer implementation. */
+/* Same as #BKE_defvert_find_weight, for weights that aren't stored in a #MDeformVert. */
+static float deform_weights_find_weight(const Span<MDeformWeight> dweights, const int defgroup)
+{
+  for (const MDeformWeight &dw : dweights) {
+    if (dw.def_nr == defgroup) {
+      return dw.weight;
+    }
+  }
+  return 0.0f;
+}
+
+/**
+ * Accumulate bone deformations using the mixer implementation.
+ *
+ * \param dweights: The vertex group weights of the vertex, or none if the geometry has no vertex
+ * group data.
+ */
 template<typename MixerT>
 static void armature_vert_task_with_mixer(const ArmatureDeformParams &params,
                                           const int i,
-                                          const MDeformVert *dvert,
+                                          const std::optional<Span<MDeformWeight>> dweights,
                                           MixerT &mixer)
 {
   const bool full_deform = params.vert_deform_mats.has_value();
@@ -378,8 +394,8 @@ static void armature_vert_task_with_mixer(const ArmatureDeformParams &params,
   /* Overall influence, can change by masking with a vertex group. */
   float armature_weight = 1.0f;
   float prevco_weight = 0.0f; /* weight for optional cached vertexcos */
-  if (params.armature_def_nr != -1 && dvert) {
-    const float mask_weight = BKE_defvert_find_weight(dvert, params.armature_def_nr);
+  if (params.armature_def_nr != -1 && dweights) {
+    const float mask_weight = deform_weights_find_weight(*dweights, params.armature_def_nr);
     /* On multi-modifier the mask is used to blend with previous coordinates. */
     if (params.vert_coords_prev) {
       prevco_weight = params.invert_vgroup ? mask_weight : 1.0f - mask_weight;
@@ -403,11 +419,10 @@ static void armature_vert_task_with_mixer(const ArmatureDeformParams &params,
   float contrib = 0.0f;
   bool deformed = false;
   /* Apply vertex group deformation if enabled. */
-  if (params.use_dverts && dvert) {
+  if (params.use_dverts && dweights) {
     /* Range of valid def_nr in MDeformWeight. */
     const IndexRange def_nr_range = params.pose_channel_by_vertex_group.index_range();
-    const Span<MDeformWeight> dweights(dvert->dw, dvert->totweight);
-    for (const auto &dw : dweights) {
+    for (const auto &dw : *dweights) {
       const PChanBone pchanbone = def_nr_range.contains(dw.def_nr) ?
                                       params.pose_channel_by_vertex_group[dw.def_nr] :
                                       PChanBone(nullptr, nullptr);
@@ -474,28 +489,28 @@ static void armature_vert_task_with_mixer(const ArmatureDeformParams &params,
 /* Accumulate bone deformations for a vertex. */
 static void armature_vert_task_with_dvert(const ArmatureDeformParams &deform_params,
                                           const int i,
-                                          const MDeformVert *dvert,
+                                          const std::optional<Span<MDeformWeight>> dweights,
                                           const bool use_quaternion)
 {
   const bool full_deform = deform_params.vert_deform_mats.has_value();
   if (use_quaternion) {
     if (full_deform) {
       bke::BoneDeformDualQuaternionMixer<true> mixer;
-      armature_vert_task_with_mixer(deform_params, i, dvert, mixer);
+      armature_vert_task_with_mixer(deform_params, i, dweights, mixer);
     }
     else {
       bke::BoneDeformDualQuaternionMixer<false> mixer;
-      armature_vert_task_with_mixer(deform_params, i, dvert, mixer);
+      armature_vert_task_with_mixer(deform_params, i, dweights, mixer);
     }
   }
   else {
     if (full_deform) {
       bke::BoneDeformLinearMixer<true> mixer;
-      armature_vert_task_with_mixer(deform_params, i, dvert, mixer);
+      armature_vert_task_with_mixer(deform_params, i, dweights, mixer);
     }
     else {
       bke::BoneDeformLinearMixer<false> mixer;
-      armature_vert_task_with_mixer(deform_params, i, dvert, mixer);
+      armature_vert_task_with_mixer(deform_params, i, dweights, mixer);
     }
   }
 }
@@ -522,23 +537,39 @@ static void armature_deform_coords(const Object &ob_arm,
                                                                   dverts.has_value());
 
   const bool use_quaternion = bool(deformflag & ARM_DEF_QUATERNION);
+  const bool use_weights = deform_params.use_dverts || deform_params.armature_def_nr >= 0;
+
+  /* The weights of the mesh are cached in a single array, which is much faster to traverse than
+   * the separate allocations of every #MDeformVert, and is only rebuilt when weights change. */
+  GroupedSpan<MDeformWeight> mesh_weights;
+  if (use_weights && me_target && dverts && !dverts->is_empty() &&
+      dverts->data() == me_target->deform_verts().data())
+  {
+    mesh_weights = me_target->deform_weights();
+  }
+
   constexpr int grain_size = 32;
   threading::parallel_for(vert_coords.index_range(), grain_size, [&](const IndexRange range) {
     for (const int i : range) {
-      const MDeformVert *dvert = nullptr;
-      if (deform_params.use_dverts || deform_params.armature_def_nr >= 0) {
-        if (me_target) {
+      std::optional<Span<MDeformWeight>> dweights;
+      if (use_weights) {
+        if (!mesh_weights.is_empty()) {
+          dweights = mesh_weights[i];
+        }
+        else if (me_target) {
           BLI_assert(i < me_target->verts_num);
           if (dverts) {
-            dvert = &(*dverts)[i];
+            const MDeformVert &dvert = (*dverts)[i];
+            dweights = Span<MDeformWeight>(dvert.dw, dvert.totweight);
           }
         }
         else if (dverts && i < dverts->size()) {
-          dvert = &(*dverts)[i];
+          const MDeformVert &dvert = (*dverts)[i];
+          dweights = Span<MDeformWeight>(dvert.dw, dvert.totweight);
         }
       }
 
-      armature_vert_task_with_dvert(deform_params, i, dvert, use_quaternion);
+      armature_vert_task_with_dvert(deform_params, i, dweights, use_quaternion);
     }
   });
 }
@@ -557,11 +588,14 @@ static void armature_vert_task_editmesh(void *__restrict userdata,
 {
   const ArmatureEditMeshUserdata &data = *static_cast<const ArmatureEditMeshUserdata *>(userdata);
   BMVert *v = reinterpret_cast<BMVert *>(iter);
-  const MDeformVert *dvert = use_dvert ? static_cast<const MDeformVert *>(
-                                             BM_ELEM_CD_GET_VOID_P(v, data.cd_dvert_offset)) :
-                                         nullptr;
+  std::optional<Span<MDeformWeight>> dweights;
+  if (use_dvert) {
+    const MDeformVert *dvert = static_cast<const MDeformVert *>(
+        BM_ELEM_CD_GET_VOID_P(v, data.cd_dvert_offset));
+    dweights = Span<MDeformWeight>(dvert->dw, dvert->totweight);
+  }
   armature_vert_task_with_dvert(
-      data.deform_params, BM_elem_index_get(v), dvert, data.use_quaternion);
+      data.deform_params, BM_elem_index_get(v), dweights, data.use_quaternion);
 }
 
 static void armature_deform_editmesh(const Object &ob_arm,
@@ -810,6 +810,33 @@ TEST_F(ArmatureDeformTest, MeshDeform)
   }
 }
 
+TEST_F(ArmatureDeformTest, MeshDeformWeightsCache)
+{
+  Mesh *mesh = create_test_mesh();
+
+  GroupedSpan<MDeformWeight> weights = mesh->deform_weights();
+  ASSERT_EQ(weights.size(), mesh->verts_num);
+  for (const int i : weights.index_range()) {
+    const MDeformVert &dvert = mesh->deform_verts()[i];
+    ASSERT_EQ(weights[i].size(), dvert.totweight);
+    for (const int j : weights[i].index_range()) {
+      EXPECT_EQ(weights[i][j].def_nr, dvert.dw[j].def_nr);
+      EXPECT_EQ(weights[i][j].weight, dvert.dw[j].weight);
+    }
+  }
+
+  /* Writing to the vertex groups has to invalidate the cached weights. */
+  MutableSpan<MDeformVert> dverts = mesh->deform_verts_for_write();
+  BKE_defvert_add_index_notest(&dverts[0], 1, 0.25f);
+  weights = mesh->deform_weights();
+  ASSERT_EQ(weights[0].size(), 2);
+  EXPECT_EQ(weights[0][1].def_nr, 1u);
+  EXPECT_EQ(weights[0][1].weight, 0.25f);
+  EXPECT_EQ(weights[1].size(), 1);
+
+  BKE_id_free(nullptr, mesh);
+}
+
 TEST_F(ArmatureDeformTest, EditMeshDeform)
 {
   for (InterpolationTest ipol : {InterpolationTest::Linear, InterpolationTest::DualQuaternion}) {
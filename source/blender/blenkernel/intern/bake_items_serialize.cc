@@ -16,11 +16,14 @@
 #include "BKE_pointcloud.hh"
 #include "BKE_volume.hh"
 
+#include "BLI_array.hh"
 #include "BLI_listbase.hh"
 #include "BLI_math_matrix_types.hh"
+#include "BLI_mmap.hh"
 #include "BLI_path_utils.hh"
 #include "BLI_string.hh"
 #include "BLI_string_utf8.hh"
+#include "BLI_task.hh"
 
 #include "DNA_object_types.h"
 #include "DNA_volume_types.h"
@@ -33,9 +36,18 @@
 #include "NOD_geometry_nodes_bundle.hh"
 #include "NOD_geometry_nodes_list.hh"
 
+#include <atomic>
+#include <fcntl.h>
 #include <fmt/format.h>
 #include <sstream>
 #include <xxhash.h>
+#include <zstd.h>
+
+#ifndef WIN32
+#  include <unistd.h>
+#else
+#  include <io.h>
+#endif
 
 #ifdef WITH_OPENVDB
 #  include <openvdb/io/Stream.h>
@@ -49,6 +61,19 @@ namespace blender::bke::bake {
 using namespace io::serialize;
 using DictionaryValuePtr = std::shared_ptr<DictionaryValue>;
 
+/**
+ * Offsets of arrays in blob files are aligned, so that they can be used directly from the mapped
+ * file. This is more than the alignment of all attribute types, and avoids sharing cache lines.
+ */
+static constexpr int64_t blob_alignment = 64;
+/** Smaller arrays are copied when reading, mapping them has more overhead than it saves. */
+static constexpr int64_t blob_read_without_copy_min_size = 16 * 1024;
+/** Smaller arrays are not compressed because it is not worth the overhead. */
+static constexpr int64_t blob_compression_min_size = 16 * 1024;
+/** Compressed arrays are split into chunks of this size that are (de)compressed in parallel. */
+static constexpr int64_t blob_compression_chunk_size = 256 * 1024;
+static constexpr int blob_compression_level = 3;
+
 static std::optional<SocketValueVariant> deserialize_bake_item(
     const DictionaryValue &io_item,
     const BlobReader &blob_reader,
@@ -97,6 +122,65 @@ BlobSlice BlobWriter::write_as_stream(const StringRef /*file_extension*/,
   return this->write(data.data(), data.size());
 }
 
+DictionaryValuePtr BlobWriter::write_array(const void *data, const int64_t size)
+{
+  if (!use_compression_ || size < blob_compression_min_size) {
+    return this->write(data, size).serialize();
+  }
+
+  const int64_t chunks_num = (size + blob_compression_chunk_size - 1) /
+                             blob_compression_chunk_size;
+  Array<Vector<std::byte>> compressed_chunks(chunks_num);
+  std::atomic<bool> success = true;
+  threading::parallel_for(IndexRange(chunks_num), 1, [&](const IndexRange range) {
+    for (const int64_t chunk_i : range) {
+      const IndexRange src_range = IndexRange(size).slice(
+          chunk_i * blob_compression_chunk_size,
+          std::min(blob_compression_chunk_size, size - chunk_i * blob_compression_chunk_size));
+      Vector<std::byte> &chunk = compressed_chunks[chunk_i];
+      chunk.resize(ZSTD_compressBound(src_range.size()));
+      const size_t compressed_size = ZSTD_compress(chunk.data(),
+                                                   chunk.size(),
+                                                   static_cast<const std::byte *>(data) +
+                                                       src_range.start(),
+                                                   src_range.size(),
+                                                   blob_compression_level);
+      if (ZSTD_isError(compressed_size)) {
+        success = false;
+        return;
+      }
+      chunk.resize(compressed_size);
+    }
+  });
+
+  Vector<std::byte> compressed;
+  if (success) {
+    for (const Vector<std::byte> &chunk : compressed_chunks) {
+      compressed.extend(chunk);
+    }
+  }
+  if (!success || compressed.size() >= size) {
+    /* Store incompressible data as is. */
+    return this->write(data, size).serialize();
+  }
+
+  DictionaryValuePtr io_data = this->write(compressed.data(), compressed.size()).serialize();
+  io_data->append_str("compression", "zstd");
+  io_data->append_int("uncompressed_size", size);
+  io_data->append_int("chunk_size", blob_compression_chunk_size);
+  std::shared_ptr<ArrayValue> io_chunks = io_data->append_array("chunks");
+  for (const Vector<std::byte> &chunk : compressed_chunks) {
+    io_chunks->append_int(int(chunk.size()));
+  }
+  return io_data;
+}
+
+std::optional<ImplicitSharingInfoAndData> BlobReader::read_without_copy(
+    const BlobSlice & /*slice*/) const
+{
+  return std::nullopt;
+}
+
 bool BlobReader::read_as_stream(const BlobSlice &slice, FunctionRef<bool(std::istream &)> fn) const
 {
   const int64_t size = slice.range.size();
@@ -112,8 +196,97 @@ bool BlobReader::read_as_stream(const BlobSlice &slice, FunctionRef<bool(std::is
   return true;
 }
 
+/**
+ * A blob file that is memory mapped, so that its arrays can be used without copying them. The
+ * mapping is copy-on-write, because geometry that uses the data may modify it in place once it is
+ * the only user.
+ */
+class MappedBlobFile : NonCopyable, NonMovable {
+ private:
+  BLI_mmap_file *mmap_file_;
+
+ public:
+  MappedBlobFile(BLI_mmap_file *mmap_file) : mmap_file_(mmap_file) {}
+
+  ~MappedBlobFile()
+  {
+    BLI_mmap_free(mmap_file_);
+  }
+
+  static std::shared_ptr<const MappedBlobFile> open(const char *path)
+  {
+    const int file = BLI_open(path, O_BINARY | O_RDONLY, 0);
+    if (file == -1) {
+      return nullptr;
+    }
+    BLI_mmap_file *mmap_file = BLI_mmap_open_copy_on_write(file);
+    close(file);
+    if (mmap_file == nullptr) {
+      return nullptr;
+    }
+    return std::make_shared<const MappedBlobFile>(mmap_file);
+  }
+
+  Span<std::byte> data() const
+  {
+    return {static_cast<const std::byte *>(BLI_mmap_get_pointer(mmap_file_)),
+            int64_t(BLI_mmap_get_length(mmap_file_))};
+  }
+};
+
+/** Keeps the mapped file alive while an array that is stored in it is used. */
+class MappedBlobSharingInfo : public ImplicitSharingInfo {
+ private:
+  std::shared_ptr<const MappedBlobFile> file_;
+
+ public:
+  MappedBlobSharingInfo(std::shared_ptr<const MappedBlobFile> file) : file_(std::move(file)) {}
+
+ private:
+  void delete_self_with_data() override
+  {
+    MEM_delete(this);
+  }
+
+  void delete_data_only() override
+  {
+    file_.reset();
+  }
+};
+
 DiskBlobReader::DiskBlobReader(std::string blobs_dir) : blobs_dir_(std::move(blobs_dir)) {}
 
+std::optional<ImplicitSharingInfoAndData> DiskBlobReader::read_without_copy(
+    const BlobSlice &slice) const
+{
+#ifdef WIN32
+  /* A mapped file can't be replaced or deleted on Windows, so keeping the mapping alive while the
+   * baked data is used would prevent re-baking or freeing the bake. */
+  UNUSED_VARS(slice);
+  return std::nullopt;
+#else
+  if (slice.range.is_empty()) {
+    return std::nullopt;
+  }
+
+  char blob_path[FILE_MAX];
+  BLI_path_join(blob_path, sizeof(blob_path), blobs_dir_.c_str(), slice.name.c_str());
+
+  std::shared_ptr<const MappedBlobFile> file;
+  {
+    std::lock_guard lock{mutex_};
+    file = mapped_files_.lookup_or_add_cb_as(blob_path,
+                                             [&]() { return MappedBlobFile::open(blob_path); });
+  }
+  if (!file || !file->data().index_range().contains(slice.range)) {
+    return std::nullopt;
+  }
+  const void *data = file->data().slice(slice.range).data();
+  return ImplicitSharingInfoAndData{MEM_new<MappedBlobSharingInfo>(__func__, std::move(file)),
+                                    data};
+#endif
+}
+
 [[nodiscard]] bool DiskBlobReader::read(const BlobSlice &slice, void *r_data) const
 {
   if (slice.range.is_empty()) {
@@ -150,6 +323,14 @@ BlobSlice DiskBlobWriter::write(const void *data, const int64_t size)
     blob_stream_.open(blob_path, std::ios::out | std::ios::binary);
   }
 
+  /* Align the start of the data, so that arrays can be used directly from the mapped file. */
+  const int64_t padding = (blob_alignment - current_offset_ % blob_alignment) % blob_alignment;
+  if (padding > 0) {
+    const std::array<char, blob_alignment> zeros{};
+    blob_stream_.write(zeros.data(), padding);
+    current_offset_ += padding;
+  }
+
   const int64_t old_offset = current_offset_;
   blob_stream_.write(static_cast<const char *>(data), size);
   current_offset_ += size;
@@ -280,9 +461,8 @@ std::shared_ptr<io::serialize::DictionaryValue> BlobWriteSharing::write_deduplic
     BlobWriter &writer, const void *data, const int64_t size_in_bytes)
 {
   const uint64_t content_hash = XXH3_64bits(data, size_in_bytes);
-  const BlobSlice slice = slice_by_content_hash_.lookup_or_add_cb(
-      content_hash, [&]() { return writer.write(data, size_in_bytes); });
-  return slice.serialize();
+  return io_data_by_content_hash_.lookup_or_add_cb(
+      content_hash, [&]() { return writer.write_array(data, size_in_bytes); });
 }
 
 std::optional<ImplicitSharingInfoAndData> BlobReadSharing::read_shared(
@@ -378,10 +558,114 @@ static std::shared_ptr<DictionaryValue> write_blob_raw_bytes(BlobWriter &blob_wr
   if (!slice) {
     return false;
   }
-  if (slice->range.size() != bytes_num) {
+  const std::optional<StringRefNull> compression = io_data.lookup_str("compression");
+  if (!compression) {
+    if (slice->range.size() != bytes_num) {
+      return false;
+    }
+    return blob_reader.read(*slice, r_data);
+  }
+  if (*compression != "zstd") {
+    return false;
+  }
+  const std::optional<int64_t> uncompressed_size = io_data.lookup_int("uncompressed_size");
+  const std::optional<int64_t> chunk_size = io_data.lookup_int("chunk_size");
+  const ArrayValue *io_chunks = io_data.lookup_array("chunks");
+  if (!uncompressed_size || !chunk_size || !io_chunks) {
+    return false;
+  }
+  if (*uncompressed_size != bytes_num || *chunk_size <= 0) {
     return false;
   }
-  return blob_reader.read(*slice, r_data);
+  const int64_t chunks_num = io_chunks->elements().size();
+  if (chunks_num != (bytes_num + *chunk_size - 1) / *chunk_size) {
+    return false;
+  }
+  /* Offsets of the compressed chunks within the slice. */
+  Array<int64_t> chunk_offsets(chunks_num + 1);
+  chunk_offsets[0] = 0;
+  for (const int64_t chunk_i : IndexRange(chunks_num)) {
+    const IntValue *io_chunk_size = io_chunks->elements()[chunk_i]->as_int_value();
+    if (!io_chunk_size || io_chunk_size->value() <= 0) {
+      return false;
+    }
+    chunk_offsets[chunk_i + 1] = chunk_offsets[chunk_i] + io_chunk_size->value();
+  }
+  if (chunk_offsets.last() != slice->range.size()) {
+    return false;
+  }
+
+  /* Avoid reading the compressed data into a temporary buffer when the file can be mapped. */
+  std::optional<ImplicitSharingInfoAndData> mapped_data = blob_reader.read_without_copy(*slice);
+  Array<std::byte> compressed_buffer;
+  const std::byte *compressed_data;
+  if (mapped_data) {
+    compressed_data = static_cast<const std::byte *>(mapped_data->data);
+  }
+  else {
+    compressed_buffer.reinitialize(slice->range.size());
+    if (!blob_reader.read(*slice, compressed_buffer.data())) {
+      return false;
+    }
+    compressed_data = compressed_buffer.data();
+  }
+
+  std::atomic<bool> success = true;
+  threading::parallel_for(IndexRange(chunks_num), 1, [&](const IndexRange range) {
+    for (const int64_t chunk_i : range) {
+      const IndexRange dst_range = IndexRange(bytes_num).slice(
+          chunk_i * *chunk_size, std::min(*chunk_size, bytes_num - chunk_i * *chunk_size));
+      const size_t decompressed_size = ZSTD_decompress(
+          static_cast<std::byte *>(r_data) + dst_range.start(),
+          dst_range.size(),
+          compressed_data + chunk_offsets[chunk_i],
+          chunk_offsets[chunk_i + 1] - chunk_offsets[chunk_i]);
+      if (ZSTD_isError(decompressed_size) || decompressed_size != dst_range.size()) {
+        success = false;
+        return;
+      }
+    }
+  });
+  if (mapped_data) {
+    mapped_data->sharing_info->remove_user_and_delete_if_last();
+  }
+  return success;
+}
+
+/**
+ * Use the array directly from the blob file if possible, instead of copying it. This is only
+ * done for uncompressed, large and suitably aligned arrays.
+ */
+static std::optional<ImplicitSharingInfoAndData> read_blob_shared_simple_gspan_without_copy(
+    const DictionaryValue &io_data,
+    const BlobReader &blob_reader,
+    const CPPType &cpp_type,
+    const int size)
+{
+  if (!cpp_type.is_trivial) {
+    return std::nullopt;
+  }
+  const int64_t size_in_bytes = int64_t(size) * cpp_type.size;
+  if (size_in_bytes < blob_read_without_copy_min_size) {
+    return std::nullopt;
+  }
+  if (io_data.lookup("compression")) {
+    return std::nullopt;
+  }
+  const std::optional<BlobSlice> slice = BlobSlice::deserialize(io_data);
+  if (!slice || slice->range.size() != size_in_bytes) {
+    return std::nullopt;
+  }
+  std::optional<ImplicitSharingInfoAndData> data = blob_reader.read_without_copy(*slice);
+  if (!data) {
+    return std::nullopt;
+  }
+  if (uintptr_t(data->data) % cpp_type.alignment != 0) {
+    /* Blobs written by older versions are not aligned. */
+    data->sharing_info->remove_user_and_delete_if_last();
+    return std::nullopt;
+  }
+  return data;
 }
 
 static std::shared_ptr<DictionaryValue> write_blob_simple_gspan(BlobWriter &blob_writer,
@@ -419,6 +703,11 @@ static std::shared_ptr<DictionaryValue> write_blob_shared_simple_gspan(
   const char *func = __func__;
   const std::optional<ImplicitSharingInfoAndData> sharing_info_and_data = blob_sharing.read_shared(
       io_data, [&]() -> std::optional<ImplicitSharingInfoAndData> {
+        if (std::optional<ImplicitSharingInfoAndData> data =
+                read_blob_shared_simple_gspan_without_copy(io_data, blob_reader, cpp_type, size))
+        {
+          return data;
+        }
         void *data_mem = MEM_new_uninitialized_aligned(
             size * cpp_type.size, cpp_type.alignment, func);
         if (!read_blob_simple_gspan(blob_reader, io_data, {cpp_type, data_mem, size})) {
@@ -4,14 +4,22 @@
 
 #include "testing/testing.h"
 
+#include "BLI_fileops.hh"
+#include "BLI_path_utils.hh"
+
+#include "DNA_pointcloud_types.h"
+
+#include "BKE_appdir.hh"
 #include "BKE_bake_items_serialize.hh"
 #include "BKE_geometry_set.hh"
 #include "BKE_gtest_base.hh"
 #include "BKE_node.hh"
+#include "BKE_pointcloud.hh"
 
 #include "NOD_geometry_nodes_bundle.hh"
 #include "NOD_geometry_nodes_list.hh"
 
+#include <fstream>
 #include <sstream>
 #include <string>
 
@@ -106,4 +114,184 @@ TEST_F(BakeItemsSerializeTest, nested_bundle_with_geometry_and_bundle_lists)
   EXPECT_EQ((*restored_bundles)->size(), 2);
 }
 
+/**
+ * Writes arrays like blob writers of older versions did, without aligning them. Every array is
+ * preceded by a single byte, so that it is never aligned.
+ */
+class UnalignedBlobWriter : public MemoryBlobWriter {
+ public:
+  using MemoryBlobWriter::MemoryBlobWriter;
+
+  BlobSlice write(const void *data, const int64_t size) override
+  {
+    const char padding = 0;
+    MemoryBlobWriter::write(&padding, 1);
+    return MemoryBlobWriter::write(data, size);
+  }
+};
+
+class BakeItemsSerializeBlobTest : public BakeItemsSerializeTest {
+ protected:
+  /** Large enough so that the arrays are compressed and read without copying. */
+  static constexpr int points_num = 5001;
+  std::string blobs_dir_;
+
+  void SetUp() override
+  {
+    BKE_tempdir_init(nullptr);
+    blobs_dir_ = std::string(BKE_tempdir_session()) + SEP_STR + "bake_blobs" + SEP_STR;
+    BLI_dir_create_recursive(blobs_dir_.c_str());
+  }
+
+  void TearDown() override
+  {
+    BKE_tempdir_session_purge();
+  }
+
+  static BakeValues create_point_cloud_bake_values()
+  {
+    PointCloud *pointcloud = BKE_pointcloud_new_nomain(points_num);
+    MutableSpan<float3> positions = pointcloud->positions_for_write();
+    MutableSpan<float> radii = pointcloud->radius_for_write();
+    for (const int i : IndexRange(points_num)) {
+      positions[i] = float3(i % 17, i / 17, 1.0f);
+      radii[i] = float(i % 5) * 0.25f;
+    }
+    Map<int, BakeValues::Item> items;
+    items.add_new(0,
+                  BakeValues::Item{SocketValueVariant::From(
+                      GeometrySet::from_pointcloud(pointcloud))});
+    return BakeValues(std::move(items));
+  }
+
+  static const PointCloud *expect_point_cloud(const std::optional<BakeValues> &bake_values)
+  {
+    EXPECT_TRUE(bake_values);
+    if (!bake_values) {
+      return nullptr;
+    }
+    const BakeValues::Item *item = bake_values->values_by_id().lookup_ptr(0);
+    EXPECT_NE(item, nullptr);
+    if (!item) {
+      return nullptr;
+    }
+    const PointCloud *pointcloud = item->value.get<GeometrySet>().get_pointcloud();
+    EXPECT_NE(pointcloud, nullptr);
+    if (!pointcloud) {
+      return nullptr;
+    }
+    EXPECT_EQ(pointcloud->totpoint, points_num);
+    const Span<float3> positions = pointcloud->positions();
+    const VArraySpan<float> radii = pointcloud->radius();
+    for (const int i : IndexRange(points_num)) {
+      EXPECT_EQ(positions[i], float3(i % 17, i / 17, 1.0f));
+      EXPECT_EQ(radii[i], float(i % 5) * 0.25f);
+    }
+    return pointcloud;
+  }
+
+  /** Write the blobs of a #MemoryBlobWriter to files, as the disk writer would have. */
+  void write_blob_files(const MemoryBlobWriter &blob_writer)
+  {
+    for (const auto &item : blob_writer.get_stream_by_name().items()) {
+      std::ofstream file(blobs_dir_ + item.key, std::ios::binary);
+      const std::string blob = item.value.stream->str();
+      file.write(blob.data(), blob.size());
+    }
+  }
+
+  std::optional<BakeValues> read_from_disk(const std::string &meta) const
+  {
+    DiskBlobReader blob_reader{blobs_dir_};
+    BlobReadSharing blob_read_sharing;
+    std::istringstream read_stream{meta};
+    return deserialize_bake(read_stream, blob_reader, blob_read_sharing);
+  }
+};
+
+TEST_F(BakeItemsSerializeBlobTest, compressed_roundtrip)
+{
+  MemoryBlobWriter blob_writer{"test"};
+  blob_writer.set_use_compression(true);
+  BlobWriteSharing blob_write_sharing;
+  std::ostringstream stream;
+  serialize_bake(create_point_cloud_bake_values(), blob_writer, blob_write_sharing, stream);
+  EXPECT_NE(stream.str().find("zstd"), std::string::npos);
+  EXPECT_LT(blob_writer.written_size(), points_num * (sizeof(float3) + sizeof(float)));
+
+  /* Read compressed arrays from memory and from the mapped file. */
+  Map<std::string, std::string> blobs;
+  MemoryBlobReader blob_reader;
+  for (const auto &item : blob_writer.get_stream_by_name().items()) {
+    std::string &blob = blobs.lookup_or_add(item.key, item.value.stream->str());
+    blob_reader.add(item.key,
+                    Span<std::byte>(reinterpret_cast<std::byte *>(blob.data()), blob.size()));
+  }
+  BlobReadSharing blob_read_sharing;
+  std::istringstream read_stream{stream.str()};
+  expect_point_cloud(deserialize_bake(read_stream, blob_reader, blob_read_sharing));
+
+  this->write_blob_files(blob_writer);
+  expect_point_cloud(this->read_from_disk(stream.str()));
+}
+
+TEST_F(BakeItemsSerializeBlobTest, mapped_aligned_roundtrip)
+{
+  std::ostringstream stream;
+  {
+    DiskBlobWriter blob_writer{blobs_dir_, "test"};
+    BlobWriteSharing blob_write_sharing;
+    serialize_bake(create_point_cloud_bake_values(), blob_writer, blob_write_sharing, stream);
+  }
+#ifdef WIN32
+  expect_point_cloud(this->read_from_disk(stream.str()));
+#else
+  /* The reader maps every blob file only once, so the whole file is mapped at the same address
+   * as the arrays which are read without copying them. */
+  const int64_t blob_size = BLI_file_size((blobs_dir_ + "test.blob").c_str());
+  DiskBlobReader blob_reader{blobs_dir_};
+  const std::optional<ImplicitSharingInfoAndData> mapped_file = blob_reader.read_without_copy(
+      {"test.blob", IndexRange(blob_size)});
+  ASSERT_TRUE(mapped_file);
+  const Span<std::byte> mapped_data(static_cast<const std::byte *>(mapped_file->data),
+                                    blob_size);
+  const auto is_in_mapped_file = [&](const void *data, const int64_t size) {
+    const std::byte *begin = static_cast<const std::byte *>(data);
+    return begin >= mapped_data.begin() && begin + size <= mapped_data.end();
+  };
+
+  {
+    BlobReadSharing blob_read_sharing;
+    std::istringstream read_stream{stream.str()};
+    const std::optional<BakeValues> bake_values = deserialize_bake(
+        read_stream, blob_reader, blob_read_sharing);
+    const PointCloud *pointcloud = expect_point_cloud(bake_values);
+    ASSERT_NE(pointcloud, nullptr);
+    const Span<float3> positions = pointcloud->positions();
+    const Span<float> radii = pointcloud->radius().get_internal_span();
+    EXPECT_TRUE(is_in_mapped_file(positions.data(), positions.size_in_bytes()));
+    EXPECT_TRUE(is_in_mapped_file(radii.data(), radii.size_in_bytes()));
+    /* The arrays are stored at aligned offsets in the file. */
+    EXPECT_EQ(uintptr_t(positions.data()) % 64, 0);
+    EXPECT_EQ(uintptr_t(radii.data()) % 64, 0);
+  }
+  mapped_file->sharing_info->remove_user_and_delete_if_last();
+#endif
+}
+
+TEST_F(BakeItemsSerializeBlobTest, legacy_unaligned_roundtrip)
+{
+  UnalignedBlobWriter blob_writer{"test"};
+  BlobWriteSharing blob_write_sharing;
+  std::ostringstream stream;
+  serialize_bake(create_point_cloud_bake_values(), blob_writer, blob_write_sharing, stream);
+
+  /* Unaligned arrays can't be used from the mapped file and have to be copied. */
+  this->write_blob_files(blob_writer);
+  const std::optional<BakeValues> bake_values = this->read_from_disk(stream.str());
+  const PointCloud *pointcloud = expect_point_cloud(bake_values);
+  ASSERT_NE(pointcloud, nullptr);
+  EXPECT_EQ(uintptr_t(pointcloud->positions().data()) % alignof(float3), 0);
+}
+
 }  // namespace blender::bke::bake::tests
@@ -3,10 +3,12 @@
  * SPDX-License-Identifier: GPL-2.0-or-later */
 
 #include "BLI_array_utils.hh"
+#include "BLI_bounds.hh"
 #include "BLI_index_mask.hh"
 #include "BLI_kdopbvh.hh"
 #include "BLI_math_geom_c.hh"
 #include "BLI_math_vector.hh"
+#include "BLI_task.hh"
 
 #include "DNA_mesh_types.h"
 
@@ -16,6 +18,10 @@
 #include "BKE_mesh_runtime.hh"
 #include "BKE_mesh_sample.hh"
 
+#include <algorithm>
+
+#include <xxhash.h>
+
 #ifdef WITH_EMBREE
 
 #  include <embree4/rtcore.h>
@@ -40,6 +46,10 @@ Tree::Tree(Tree &&other)
 #else /* WITH_EMBREE */
   fallback_tree_ = std::move(other.fallback_tree_);
 #endif
+  topology_hash_ = std::exchange(other.topology_hash_, 0);
+  topology_verts_num_ = std::exchange(other.topology_verts_num_, -1);
+  topology_tris_num_ = std::exchange(other.topology_tris_num_, 0);
+  is_refittable_ = std::exchange(other.is_refittable_, false);
 }
 
 Tree &Tree::operator=(Tree &&other)
@@ -88,6 +98,28 @@ static float3 bary_coord_embree_to_blender(const float u, const float v)
   return float3(1.0f - u - v, u, v);
 }
 
+static std::optional<RayHit> ray_hit_from_embree(const Span<Array<int, 0>> index_map_by_geom,
+                                                 const float3 &normal,
+                                                 const float u,
+                                                 const float v,
+                                                 const uint32_t geom_id,
+                                                 const uint32_t prim_id,
+                                                 const float distance)
+{
+  if (geom_id == RTC_INVALID_GEOMETRY_ID || prim_id == RTC_INVALID_GEOMETRY_ID) {
+    return std::nullopt;
+  }
+  RayHit hit;
+  hit.normal = normal;
+  hit.bary_coord = bary_coord_embree_to_blender(u, v);
+  hit.index = prim_id;
+  if (!index_map_by_geom[geom_id].is_empty()) {
+    hit.index = index_map_by_geom[geom_id][hit.index];
+  }
+  hit.distance = distance;
+  return hit;
+}
+
 #endif /* WITH_EMBREE */
 
 #ifdef WITH_EMBREE
@@ -279,7 +311,22 @@ Tree Tree::from_tris(const Mesh &mesh, const IndexMask &face_mask, const bool ma
   return tree;
 }
 
+static uint64_t mesh_topology_hash(const Mesh &mesh)
+{
+  const Span<int> face_offsets = mesh.face_offsets();
+  const Span<int> corner_verts = mesh.corner_verts();
+  const uint64_t face_offsets_hash = XXH3_64bits(face_offsets.data(),
+                                                 face_offsets.size_in_bytes());
+  return XXH3_64bits_withSeed(
+      corner_verts.data(), corner_verts.size_in_bytes(), face_offsets_hash);
+}
+
 Tree Tree::from_single_mesh(const Mesh &mesh)
+{
+  return from_single_mesh_impl(mesh, false);
+}
+
+Tree Tree::from_single_mesh_impl(const Mesh &mesh, const bool refittable)
 {
   Tree tree;
 #ifdef WITH_EMBREE
@@ -295,17 +342,113 @@ Tree Tree::from_single_mesh(const Mesh &mesh)
   RTCBuildQuality build_quality = RTC_BUILD_QUALITY_MEDIUM;
   rtcSetSceneBuildQuality(tree.rtc_scene_, build_quality);
 
-  BvhBuildContext ctx{tree.rtc_device_, tree.rtc_scene_, build_quality};
+  BvhBuildContext ctx{tree.rtc_device_,
+                      tree.rtc_scene_,
+                      refittable ? RTC_BUILD_QUALITY_REFIT : build_quality};
 
   add_mesh_faces(ctx, 0, mesh);
   tree.index_map_by_geom_.append({});
 
   rtcSetSceneProgressMonitorFunction(tree.rtc_scene_, rtc_progress_func, nullptr);
   rtcCommitScene(tree.rtc_scene_);
+  tree.is_refittable_ = refittable;
 #else  /* WITH_EMBREE */
+  UNUSED_VARS(refittable);
   tree.fallback_tree_ = std::make_unique<MeshFallbackTree>(mesh, IndexMask(mesh.faces_num), true);
+  /* KDOP trees can always be refit. */
+  tree.is_refittable_ = true;
+#endif /* WITH_EMBREE */
+
+  tree.topology_hash_ = mesh_topology_hash(mesh);
+  tree.topology_verts_num_ = mesh.verts_num;
+  tree.topology_tris_num_ = poly_to_tri_count(mesh.faces_num, mesh.corners_num);
+
+  return tree;
+}
+
+bool Tree::refit(const Mesh &mesh)
+{
+  if (!this->has_mesh_topology() || topology_verts_num_ != mesh.verts_num ||
+      topology_tris_num_ != poly_to_tri_count(mesh.faces_num, mesh.corners_num) ||
+      topology_hash_ != mesh_topology_hash(mesh))
+  {
+    return false;
+  }
+  if (!is_refittable_) {
+    *this = from_single_mesh_impl(mesh, true);
+    return true;
+  }
+  const Span<float3> positions = mesh.vert_positions();
+#ifdef WITH_EMBREE
+  RTCGeometry geom = rtcGetGeometry(rtc_scene_, 0);
+  float3 *positions_ptr = static_cast<float3 *>(
+      rtcGetGeometryBufferData(geom, RTC_BUFFER_TYPE_VERTEX, 0));
+  array_utils::copy(positions, MutableSpan(positions_ptr, positions.size()));
+  rtcUpdateGeometryBuffer(geom, RTC_BUFFER_TYPE_VERTEX, 0);
+  if (all_faces_are_triangles(mesh)) {
+    /* The index buffer is shared with the corner vertices of the mesh the tree was built from,
+     * which may have been freed since. */
+    const Span<int> corner_verts = mesh.corner_verts();
+    rtcSetSharedGeometryBuffer(geom,
+                               RTC_BUFFER_TYPE_INDEX,
+                               0,
+                               RTC_FORMAT_UINT3,
+                               corner_verts.data(),
+                               0,
+                               sizeof(int3),
+                               corner_verts.cast<int3>().size());
+  }
+  else {
+    /* The triangulation of faces with more than three corners depends on the positions. */
+    const Span<int3> corner_tris = mesh.corner_tris();
+    uint3 *rtc_indices = static_cast<uint3 *>(
+        rtcGetGeometryBufferData(geom, RTC_BUFFER_TYPE_INDEX, 0));
+    mesh::vert_tris_from_corner_tris(mesh.corner_verts(),
+                                     corner_tris,
+                                     MutableSpan(rtc_indices, corner_tris.size()).cast<int3>());
+    rtcUpdateGeometryBuffer(geom, RTC_BUFFER_TYPE_INDEX, 0);
+  }
+  rtcCommitGeometry(geom);
+  rtcCommitScene(rtc_scene_);
+#else  /* WITH_EMBREE */
+  BVHTreeFromMesh &data = static_cast<MeshFallbackTree &>(*fallback_tree_).bvh_from_mesh;
+  data.vert_positions = positions;
+  data.corner_verts = mesh.corner_verts();
+  data.corner_tris = mesh.corner_tris();
+  if (BVHTree *tree = data.owned_tree.get()) {
+    for (const int tri : data.corner_tris.index_range()) {
+      float co[3][3];
+      copy_v3_v3(co[0], positions[data.corner_verts[data.corner_tris[tri][0]]]);
+      copy_v3_v3(co[1], positions[data.corner_verts[data.corner_tris[tri][1]]]);
+      copy_v3_v3(co[2], positions[data.corner_verts[data.corner_tris[tri][2]]]);
+      BLI_bvhtree_update_node(tree, tri, co[0], nullptr, 3);
+    }
+    BLI_bvhtree_update_tree(tree);
+  }
 #endif /* WITH_EMBREE */
+  return true;
+}
+
+void ReusableTree::store(Tree &&tree)
+{
+  if (!tree.has_mesh_topology()) {
+    return;
+  }
+  std::lock_guard lock{mutex_};
+  if (trees_.size() < max_trees && tris_num_ + tree.topology_tris_num_ <= max_tris_num) {
+    tris_num_ += tree.topology_tris_num_;
+    trees_.append(std::move(tree));
+  }
+}
 
+std::optional<Tree> ReusableTree::take()
+{
+  std::lock_guard lock{mutex_};
+  if (trees_.is_empty()) {
+    return std::nullopt;
+  }
+  Tree tree = trees_.pop_last();
+  tris_num_ -= tree.topology_tris_num_;
   return tree;
 }
 
@@ -327,21 +470,13 @@ std::optional<RayHit> Tree::ray_intersect(const Ray &ray) const
   rtc_hit.hit.geomID = RTC_INVALID_GEOMETRY_ID;
   rtc_hit.hit.instID[0] = RTC_INVALID_GEOMETRY_ID;
   rtcIntersect1(rtc_scene_, &rtc_hit);
-  if (rtc_hit.hit.geomID == RTC_INVALID_GEOMETRY_ID ||
-      rtc_hit.hit.primID == RTC_INVALID_GEOMETRY_ID)
-  {
-    return std::nullopt;
-  }
-
-  RayHit hit;
-  hit.normal = float3(rtc_hit.hit.Ng_x, rtc_hit.hit.Ng_y, rtc_hit.hit.Ng_z);
-  hit.bary_coord = bary_coord_embree_to_blender(rtc_hit.hit.u, rtc_hit.hit.v);
-  hit.index = rtc_hit.hit.primID;
-  if (!index_map_by_geom_[rtc_hit.hit.geomID].is_empty()) {
-    hit.index = index_map_by_geom_[rtc_hit.hit.geomID][hit.index];
-  }
-  hit.distance = rtc_hit.ray.tfar;
-  return hit;
+  return ray_hit_from_embree(index_map_by_geom_,
+                             float3(rtc_hit.hit.Ng_x, rtc_hit.hit.Ng_y, rtc_hit.hit.Ng_z),
+                             rtc_hit.hit.u,
+                             rtc_hit.hit.v,
+                             rtc_hit.hit.geomID,
+                             rtc_hit.hit.primID,
+                             rtc_hit.ray.tfar);
 #else /* WITH_EMBREE */
   BVHTreeFromMesh *data = fallback_mesh_data(*this->fallback_tree_);
   if (!data->tree) {
@@ -370,6 +505,129 @@ std::optional<RayHit> Tree::ray_intersect(const Ray &ray) const
 #endif
 }
 
+/** Number of queries which are sorted together for coherent traversal. */
+static constexpr int64_t coherent_batch_size = 256;
+
+/** Spread the lower 10 bits of the value so that there are two zero bits between each bit. */
+static uint32_t morton_expand_bits(uint32_t v)
+{
+  v = (v * 0x00010001u) & 0xFF0000FFu;
+  v = (v * 0x00000101u) & 0x0F00F00Fu;
+  v = (v * 0x00000011u) & 0xC30C30C3u;
+  v = (v * 0x00000005u) & 0x49249249u;
+  return v;
+}
+
+/**
+ * Call the function for batches of the mask, with the indices of each batch sorted by the octant
+ * of the direction (if any) and the Morton code of the position. Queries which are next to each
+ * other then tend to visit the same BVH nodes, so they are faster to process together.
+ */
+static void foreach_coherent_batch(const IndexMask &mask,
+                                   const FunctionRef<float3(int)> get_position,
+                                   const FunctionRef<float3(int)> get_direction,
+                                   const FunctionRef<void(Span<int>)> fn)
+{
+  const int64_t grain_size = 4 * coherent_batch_size;
+  threading::parallel_for(mask.index_range(), grain_size, [&](const IndexRange range) {
+    Vector<std::pair<uint64_t, int>, coherent_batch_size> sorted;
+    Vector<int, coherent_batch_size> indices;
+    for (int64_t start = range.start(); start < range.one_after_last();
+         start += coherent_batch_size)
+    {
+      const IndexMask batch = mask.slice(
+          start, std::min(coherent_batch_size, range.one_after_last() - start));
+      Bounds<float3> bounds(get_position(batch.first()));
+      batch.foreach_index([&](const int i) {
+        math::min_max(get_position(i), bounds.min, bounds.max);
+      });
+      const float3 scale = math::safe_divide(float3(1023.0f), bounds.max - bounds.min);
+
+      sorted.clear();
+      batch.foreach_index([&](const int i) {
+        const float3 direction = get_direction ? get_direction(i) : float3(0.0f);
+        const uint64_t octant = (direction.x < 0.0f ? 1u : 0u) | (direction.y < 0.0f ? 2u : 0u) |
+                                (direction.z < 0.0f ? 4u : 0u);
+        const uint3 cell = uint3(
+            math::clamp((get_position(i) - bounds.min) * scale, float3(0.0f), float3(1023.0f)));
+        const uint32_t morton = morton_expand_bits(cell.x) | (morton_expand_bits(cell.y) << 1) |
+                                (morton_expand_bits(cell.z) << 2);
+        /* The Morton code uses 30 bits, the octant is stored above it. */
+        sorted.append({(octant << 32) | morton, i});
+      });
+      std::sort(sorted.begin(), sorted.end(), [](const auto &a, const auto &b) {
+        return a.first < b.first;
+      });
+
+      indices.clear();
+      for (const std::pair<uint64_t, int> &item : sorted) {
+        indices.append(item.second);
+      }
+      fn(indices);
+    }
+  });
+}
+
+void Tree::ray_intersect(const IndexMask &mask,
+                         const Span<Ray> rays,
+                         MutableSpan<std::optional<RayHit>> r_hits) const
+{
+  if (mask.is_empty()) {
+    return;
+  }
+  foreach_coherent_batch(
+      mask,
+      [&](const int i) { return rays[i].origin; },
+      [&](const int i) { return rays[i].direction; },
+      [&](const Span<int> indices) {
+#ifdef WITH_EMBREE
+        constexpr int packet_size = 8;
+        for (int64_t packet_start = 0; packet_start < indices.size(); packet_start += packet_size)
+        {
+          const Span<int> packet = indices.slice(
+              packet_start, std::min<int64_t>(packet_size, indices.size() - packet_start));
+          alignas(32) int valid[packet_size];
+          RTCRayHit8 rtc_hit;
+          for (int lane = 0; lane < packet_size; lane++) {
+            if (lane >= packet.size()) {
+              valid[lane] = 0;
+              continue;
+            }
+            valid[lane] = -1;
+            const Ray &ray = rays[packet[lane]];
+            rtc_hit.ray.org_x[lane] = ray.origin.x;
+            rtc_hit.ray.org_y[lane] = ray.origin.y;
+            rtc_hit.ray.org_z[lane] = ray.origin.z;
+            rtc_hit.ray.dir_x[lane] = ray.direction.x;
+            rtc_hit.ray.dir_y[lane] = ray.direction.y;
+            rtc_hit.ray.dir_z[lane] = ray.direction.z;
+            rtc_hit.ray.tnear[lane] = 0.0f;
+            rtc_hit.ray.tfar[lane] = ray.dist_max;
+            rtc_hit.ray.time[lane] = 0.0f;
+            rtc_hit.ray.mask[lane] = 0xffffffff;
+            rtc_hit.hit.geomID[lane] = RTC_INVALID_GEOMETRY_ID;
+            rtc_hit.hit.instID[0][lane] = RTC_INVALID_GEOMETRY_ID;
+          }
+          rtcIntersect8(valid, rtc_scene_, &rtc_hit);
+          for (const int lane : packet.index_range()) {
+            r_hits[packet[lane]] = ray_hit_from_embree(
+                index_map_by_geom_,
+                float3(rtc_hit.hit.Ng_x[lane], rtc_hit.hit.Ng_y[lane], rtc_hit.hit.Ng_z[lane]),
+                rtc_hit.hit.u[lane],
+                rtc_hit.hit.v[lane],
+                rtc_hit.hit.geomID[lane],
+                rtc_hit.hit.primID[lane],
+                rtc_hit.ray.tfar[lane]);
+          }
+        }
+#else /* WITH_EMBREE */
+        for (const int i : indices) {
+          r_hits[i] = this->ray_intersect(rays[i]);
+        }
+#endif
+      });
+}
+
 void Tree::ray_intersect_all(const Ray &ray, FunctionRef<void(const RayHit &)> fn) const
 {
 #ifdef WITH_EMBREE
@@ -579,6 +837,24 @@ std::optional<ClosestPointResult> Tree::closest_point(const float3 &point,
 #endif
 }
 
+void Tree::closest_point(const IndexMask &mask,
+                         const Span<float3> points,
+                         MutableSpan<std::optional<ClosestPointResult>> r_results,
+                         const float radius) const
+{
+  if (mask.is_empty()) {
+    return;
+  }
+  /* Embree's point query packets are processed one query at a time internally, so only the
+   * ordering of the queries matters here. */
+  foreach_coherent_batch(
+      mask, [&](const int i) { return points[i]; }, nullptr, [&](const Span<int> indices) {
+        for (const int i : indices) {
+          r_results[i] = this->closest_point(points[i], radius);
+        }
+      });
+}
+
 void Tree::range_query(const float3 &point, const float radius, FunctionRef<bool(int)> fn) const
 {
 #ifdef WITH_EMBREE
@@ -0,0 +1,210 @@
+/* SPDX-FileCopyrightText: 2026 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+
+#include "testing/testing.h"
+
+#include "BLI_index_mask.hh"
+#include "BLI_index_range.hh"
+#include "BLI_math_vector.hh"
+#include "BLI_rand.hh"
+
+#include "DNA_mesh_types.h"
+
+#include "BKE_bvh.hh"
+#include "BKE_gtest_base.hh"
+#include "BKE_lib_id.hh"
+#include "BKE_mesh.hh"
+
+#include <cmath>
+
+namespace blender::bke::bvh::tests {
+
+class BVHTreeTest : public BlenderGTestBase {};
+
+/** Grid of `size` by `size` cells in the XY plane, using quads or two triangles per cell. */
+static Mesh *create_grid_mesh(const int size, const bool triangulate)
+{
+  const int verts_per_side = size + 1;
+  const int cells_num = size * size;
+  const int faces_num = triangulate ? cells_num * 2 : cells_num;
+  const int corners_num = cells_num * 4 + (triangulate ? cells_num * 2 : 0);
+  Mesh *mesh = BKE_mesh_new_nomain(verts_per_side * verts_per_side, 0, faces_num, corners_num);
+
+  MutableSpan<float3> positions = mesh->vert_positions_for_write();
+  for (const int y : IndexRange(verts_per_side)) {
+    for (const int x : IndexRange(verts_per_side)) {
+      positions[y * verts_per_side + x] = float3(x, y, 0.0f);
+    }
+  }
+
+  MutableSpan<int> face_offsets = mesh->face_offsets_for_write();
+  MutableSpan<int> corner_verts = mesh->corner_verts_for_write();
+  int face = 0;
+  int corner = 0;
+  auto add_face = [&](const Span<int> verts) {
+    face_offsets[face++] = corner;
+    for (const int vert : verts) {
+      corner_verts[corner++] = vert;
+    }
+  };
+  for (const int y : IndexRange(size)) {
+    for (const int x : IndexRange(size)) {
+      const int v0 = y * verts_per_side + x;
+      const int v1 = v0 + 1;
+      const int v2 = v1 + verts_per_side;
+      const int v3 = v0 + verts_per_side;
+      if (triangulate) {
+        add_face({v0, v1, v2});
+        add_face({v0, v2, v3});
+      }
+      else {
+        add_face({v0, v1, v2, v3});
+      }
+    }
+  }
+  face_offsets.last() = corner;
+  return mesh;
+}
+
+static void deform_grid_mesh(Mesh &mesh, const float phase)
+{
+  for (float3 &position : mesh.vert_positions_for_write()) {
+    position.z = 0.3f * std::sin(position.x * 0.7f + phase) * std::cos(position.y * 0.5f);
+  }
+  mesh.tag_positions_changed();
+}
+
+static void expect_same_queries(const Tree &tree, const Tree &expected, const int size)
+{
+  for (const int y : IndexRange(size)) {
+    for (const int x : IndexRange(size)) {
+      /* Avoid shooting rays at triangle edges, where the hit triangle is ambiguous. */
+      const Ray ray(float3(x + 0.3f, y + 0.6f, 5.0f), float3(0.0f, 0.0f, -1.0f));
+      const std::optional<RayHit> hit = tree.ray_intersect(ray);
+      const std::optional<RayHit> expected_hit = expected.ray_intersect(ray);
+      ASSERT_EQ(hit.has_value(), expected_hit.has_value());
+      if (hit) {
+        EXPECT_EQ(hit->index, expected_hit->index);
+        EXPECT_NEAR(hit->distance, expected_hit->distance, 1e-5f);
+      }
+
+      const float3 point(x + 0.7f, y + 0.2f, (x % 3) - 1.0f);
+      const std::optional<ClosestPointResult> closest = tree.closest_point(point);
+      const std::optional<ClosestPointResult> expected_closest = expected.closest_point(point);
+      ASSERT_EQ(closest.has_value(), expected_closest.has_value());
+      if (closest) {
+        EXPECT_NEAR(math::distance(point, closest->position),
+                    math::distance(point, expected_closest->position),
+                    1e-5f);
+      }
+    }
+  }
+}
+
+TEST_F(BVHTreeTest, refit_matches_build)
+{
+  constexpr int size = 12;
+  for (const bool triangulate : {false, true}) {
+    Mesh *mesh = create_grid_mesh(size, triangulate);
+    Tree tree = Tree::from_single_mesh(*mesh);
+
+    /* The first refit builds a refittable tree, the following ones only update the bounds. */
+    for (const int step : IndexRange(3)) {
+      deform_grid_mesh(*mesh, float(step));
+      EXPECT_TRUE(tree.refit(*mesh));
+      const Tree expected = Tree::from_single_mesh(*mesh);
+      expect_same_queries(tree, expected, size);
+    }
+
+    /* The tree can be refit for another mesh with the same topology, even after the mesh it was
+     * built from is freed. */
+    Mesh *mesh_copy = create_grid_mesh(size, triangulate);
+    BKE_id_free(nullptr, mesh);
+    deform_grid_mesh(*mesh_copy, 5.0f);
+    EXPECT_TRUE(tree.refit(*mesh_copy));
+    expect_same_queries(tree, Tree::from_single_mesh(*mesh_copy), size);
+    BKE_id_free(nullptr, mesh_copy);
+  }
+}
+
+TEST_F(BVHTreeTest, refit_topology_changed)
+{
+  Mesh *mesh = create_grid_mesh(4, false);
+  Mesh *mesh_triangulated = create_grid_mesh(4, true);
+  Mesh *mesh_larger = create_grid_mesh(5, false);
+  Tree tree = Tree::from_single_mesh(*mesh);
+  EXPECT_FALSE(tree.refit(*mesh_triangulated));
+  EXPECT_FALSE(tree.refit(*mesh_larger));
+
+  /* Same sizes, but different corner vertices. */
+  Mesh *mesh_flipped = create_grid_mesh(4, false);
+  MutableSpan<int> corner_verts = mesh_flipped->corner_verts_for_write();
+  std::swap(corner_verts[1], corner_verts[3]);
+  mesh_flipped->tag_topology_changed();
+  EXPECT_FALSE(tree.refit(*mesh_flipped));
+  EXPECT_TRUE(tree.refit(*mesh));
+
+  BKE_id_free(nullptr, mesh);
+  BKE_id_free(nullptr, mesh_triangulated);
+  BKE_id_free(nullptr, mesh_larger);
+  BKE_id_free(nullptr, mesh_flipped);
+}
+
+TEST_F(BVHTreeTest, batched_queries_match_single)
+{
+  constexpr int size = 10;
+  Mesh *mesh = create_grid_mesh(size, false);
+  deform_grid_mesh(*mesh, 1.0f);
+  const Tree tree = Tree::from_single_mesh(*mesh);
+
+  /* Rays and points in all octants, including ones which miss the mesh. Batches are sorted by
+   * direction octant and position, which must not change the results. */
+  constexpr int queries_num = 2000;
+  RandomNumberGenerator rng(42);
+  Array<Ray> rays(queries_num);
+  Array<float3> points(queries_num);
+  for (const int i : IndexRange(queries_num)) {
+    const float3 origin(rng.get_float() * (size + 4) - 2.0f,
+                        rng.get_float() * (size + 4) - 2.0f,
+                        rng.get_float() * 4.0f - 2.0f);
+    rays[i] = Ray(origin, math::normalize(rng.get_unit_float3()));
+    points[i] = origin;
+  }
+  /* Only query a subset, to make sure indices are mapped correctly. */
+  IndexMaskMemory memory;
+  const IndexMask mask = IndexMask::from_predicate(
+      IndexRange(queries_num), memory, [](const int i) { return i % 3 != 0; });
+
+  Array<std::optional<RayHit>> hits(queries_num);
+  tree.ray_intersect(mask, rays, hits);
+  Array<std::optional<ClosestPointResult>> results(queries_num);
+  tree.closest_point(mask, points, results);
+
+  int hits_num = 0;
+  mask.foreach_index([&](const int i) {
+    const std::optional<RayHit> expected_hit = tree.ray_intersect(rays[i]);
+    ASSERT_EQ(hits[i].has_value(), expected_hit.has_value());
+    if (expected_hit) {
+      hits_num++;
+      EXPECT_EQ(hits[i]->index, expected_hit->index);
+      EXPECT_NEAR(hits[i]->distance, expected_hit->distance, 1e-5f);
+    }
+    const std::optional<ClosestPointResult> expected_result = tree.closest_point(points[i]);
+    ASSERT_EQ(results[i].has_value(), expected_result.has_value());
+    if (expected_result) {
+      EXPECT_NEAR(math::distance(points[i], results[i]->position),
+                  math::distance(points[i], expected_result->position),
+                  1e-5f);
+    }
+  });
+  EXPECT_GT(hits_num, 0);
+  mask.complement(IndexRange(queries_num), memory).foreach_index([&](const int i) {
+    EXPECT_FALSE(hits[i].has_value());
+    EXPECT_FALSE(results[i].has_value());
+  });
+
+  BKE_id_free(nullptr, mesh);
+}
+
+}  // namespace blender::bke::bvh::tests
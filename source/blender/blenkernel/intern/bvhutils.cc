@@ -776,8 +776,20 @@ bke::BVHTreeFromMesh Mesh::bvh_corner_tris() const
 const bke::bvh::Tree &Mesh::bvh_tris() const
 {
   using namespace blender::bke::bvh;
-  this->runtime->bvh_embree_cache.ensure(
-      [&](bke::bvh::Tree &data) { data = bke::bvh::Tree::from_single_mesh(*this); });
+  this->runtime->bvh_embree_cache.ensure([&](bke::bvh::Tree &data) {
+    /* When only positions changed, the previous tree of this mesh or of a freed mesh with the same
+     * topology can be refit, which is much faster than building a new tree. */
+    if (data.refit(*this)) {
+      return;
+    }
+    if (std::optional<Tree> tree = this->runtime->bvh_embree_reusable_tree->take()) {
+      if (tree->refit(*this)) {
+        data = std::move(*tree);
+        return;
+      }
+    }
+    data = bke::bvh::Tree::from_single_mesh(*this);
+  });
   return this->runtime->bvh_embree_cache.data();
 }
 
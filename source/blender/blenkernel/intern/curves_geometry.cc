@@ -15,6 +15,7 @@
 #include "BLI_index_mask.hh"
 #include "BLI_length_parameterize.hh"
 #include "BLI_listbase.hh"
+#include "BLI_map.hh"
 #include "BLI_math_matrix.hh"
 #include "BLI_math_rotation_legacy.hh"
 #include "BLI_memory_counter.hh"
@@ -761,20 +762,39 @@ Array<int> CurvesGeometry::point_to_curve_map() const
   return map;
 }
 
+namespace {
+
+/** The parameters a NURBS basis depends on, when the knots are not customized. */
+struct NurbsBasisKey {
+  int points_num;
+  int resolution;
+  int8_t order;
+  bool cyclic;
+  KnotsMode mode;
+
+  uint64_t hash() const
+  {
+    return get_default_hash(points_num, resolution, order, cyclic, int(mode));
+  }
+
+  friend bool operator==(const NurbsBasisKey &a, const NurbsBasisKey &b) = default;
+};
+
+}  // namespace
+
 void CurvesGeometry::ensure_nurbs_basis_cache() const
 {
   const CurvesGeometryRuntime &runtime = *this->runtime;
-  runtime.nurbs_basis_cache.ensure([&](Vector<curves::nurbs::BasisCache> &r_data) {
+  runtime.nurbs_basis_cache.ensure([&](curves::nurbs::BasisCaches &r_data) {
     PRF_scope_with_name("CurvesGeometry::ensure_nurbs_basis_cache", ProfileCategory::Default);
     IndexMaskMemory memory;
     const IndexMask nurbs_mask = this->indices_for_curve_type(CURVE_TYPE_NURBS, memory);
     if (nurbs_mask.is_empty()) {
-      r_data.clear_and_shrink();
+      r_data.caches.clear_and_shrink();
+      r_data.cache_indices = {};
       return;
     }
 
-    r_data.resize(this->curves_num());
-
     const OffsetIndices<int> points_by_curve = this->points_by_curve();
     const OffsetIndices<int> evaluated_points_by_curve = this->evaluated_points_by_curve();
     const OffsetIndices<int> custom_knots_by_curve = this->nurbs_custom_knots_by_curve();
@@ -784,45 +804,77 @@ void CurvesGeometry::ensure_nurbs_basis_cache() const
     const VArray<int8_t> knots_modes = this->nurbs_knots_modes();
     const Span<float> custom_knots = this->nurbs_custom_knots();
 
-    nurbs_mask.foreach_segment(
-        [&](const IndexMaskSegment segment) {
-          Vector<float, 32> knots;
-          for (const int curve_index : segment) {
-            const IndexRange points = points_by_curve[curve_index];
-            const IndexRange evaluated_points = evaluated_points_by_curve[curve_index];
+    /* Assign a cache to every curve first. The curve used to compute each cache is stored, or -1
+     * for caches which stay empty. Curves with custom knots can't share their basis. */
+    r_data.caches.clear();
+    r_data.cache_indices.reinitialize(this->curves_num());
+    r_data.cache_indices.fill(0);
+    Vector<int> curve_by_cache = {-1};
+    int invalid_cache_index = -1;
+    Map<NurbsBasisKey, int> cache_by_key;
+    nurbs_mask.foreach_index([&](const int curve_index) {
+      const NurbsBasisKey key{int(points_by_curve[curve_index].size()),
+                              resolutions[curve_index],
+                              orders[curve_index],
+                              cyclic[curve_index],
+                              KnotsMode(knots_modes[curve_index])};
+      if (!curves::nurbs::check_valid_eval_params(
+              key.points_num, key.order, key.cyclic, key.mode, key.resolution))
+      {
+        if (invalid_cache_index == -1) {
+          invalid_cache_index = curve_by_cache.append_and_get_index(-1);
+        }
+        r_data.cache_indices[curve_index] = invalid_cache_index;
+        return;
+      }
+      if (key.mode == NURBS_KNOT_MODE_CUSTOM) {
+        r_data.cache_indices[curve_index] = curve_by_cache.append_and_get_index(curve_index);
+        return;
+      }
+      r_data.cache_indices[curve_index] = cache_by_key.lookup_or_add_cb(
+          key, [&]() { return curve_by_cache.append_and_get_index(curve_index); });
+    });
 
-            const int8_t order = orders[curve_index];
-            const int resolution = resolutions[curve_index];
-            const bool is_cyclic = cyclic[curve_index];
-            const KnotsMode mode = KnotsMode(knots_modes[curve_index]);
+    r_data.caches.resize(curve_by_cache.size());
+    if (invalid_cache_index != -1) {
+      r_data.caches[invalid_cache_index].invalid = true;
+    }
 
-            if (!curves::nurbs::check_valid_eval_params(
-                    points.size(), order, is_cyclic, mode, resolution))
-            {
-              r_data[curve_index].invalid = true;
-              continue;
-            }
-            const int knots_num = curves::nurbs::knots_num(points.size(), order, is_cyclic);
-            knots.reinitialize(knots_num);
-            curves::nurbs::load_curve_knots(mode,
-                                            points.size(),
-                                            order,
-                                            is_cyclic,
-                                            custom_knots_by_curve[curve_index],
-                                            custom_knots,
-                                            knots);
-
-            curves::nurbs::calculate_basis_cache(points.size(),
-                                                 evaluated_points.size(),
-                                                 order,
-                                                 resolution,
-                                                 is_cyclic,
-                                                 mode,
-                                                 knots,
-                                                 r_data[curve_index]);
-          }
-        },
-        exec_mode::grain_size(64));
+    threading::parallel_for(curve_by_cache.index_range(), 64, [&](const IndexRange range) {
+      Vector<float, 32> knots;
+      for (const int cache_index : range) {
+        const int curve_index = curve_by_cache[cache_index];
+        if (curve_index == -1) {
+          continue;
+        }
+        const IndexRange points = points_by_curve[curve_index];
+        const IndexRange evaluated_points = evaluated_points_by_curve[curve_index];
+
+        const int8_t order = orders[curve_index];
+        const int resolution = resolutions[curve_index];
+        const bool is_cyclic = cyclic[curve_index];
+        const KnotsMode mode = KnotsMode(knots_modes[curve_index]);
+
+        const int knots_num = curves::nurbs::knots_num(points.size(), order, is_cyclic);
+        knots.reinitialize(knots_num);
+        curves::nurbs::load_curve_knots(mode,
+                                        points.size(),
+                                        order,
+                                        is_cyclic,
+                                        custom_knots_by_curve[curve_index],
+                                        custom_knots,
+                                        knots);
+
+        curves::nurbs::calculate_basis_cache(points.size(),
+                                             evaluated_points.size(),
+                                             order,
+                                             resolution,
+                                             is_cyclic,
+                                             mode,
+                                             knots,
+                                             r_data.caches[cache_index]);
+      }
+    });
   });
 }
 
@@ -890,7 +942,7 @@ Span<float3> CurvesGeometry::evaluated_positions() const
       this->ensure_nurbs_basis_cache();
       const VArray<int8_t> nurbs_orders = this->nurbs_orders();
       const std::optional<Span<float>> nurbs_weights = this->nurbs_weights();
-      const Span<curves::nurbs::BasisCache> nurbs_basis_cache = runtime.nurbs_basis_cache.data();
+      const curves::nurbs::BasisCaches &nurbs_basis_cache = runtime.nurbs_basis_cache.data();
       selection.foreach_index(
           [&](const int curve_index) {
             const IndexRange points = points_by_curve[curve_index];
@@ -1002,7 +1054,7 @@ struct EvalData {
   const VArray<bool> &cyclic;
   const VArray<int> &resolution;
   const Span<int> all_bezier_evaluated_offsets;
-  const Span<curves::nurbs::BasisCache> nurbs_basis_cache;
+  const curves::nurbs::BasisCaches &nurbs_basis_cache;
   const VArray<int8_t> &nurbs_orders;
   const std::optional<Span<float>> nurbs_weights;
 };
@@ -2055,9 +2055,47 @@ static float fcurve_eval_keyframes_extrapolate(const FCurve *fcu,
   return endpoint_bezt->vec[1][1] - (fac * dx);
 }
 
+/**
+ * Check whether the keyframe index found by a previous evaluation of the curve is also the result
+ * of #BKE_fcurve_bezt_binarysearch_index_ex for \a evaltime. This is only the case when
+ * \a evaltime lies between the same keyframes (or on the same keyframe) as before, which is very
+ * common during playback. The keyframes around the index have to be further than \a threshold
+ * away, otherwise the binary search might have found them instead.
+ */
+static bool fcurve_keyframe_cursor_is_valid(const FCurve *fcu,
+                                            const BezTriple *bezts,
+                                            const float evaltime,
+                                            const float threshold,
+                                            const int index,
+                                            bool *r_exact)
+{
+  /* The first and last keyframes are handled by the extrapolation. */
+  if (index < 1 || index >= fcu->totvert) {
+    return false;
+  }
+  const float prev_frame = bezts[index - 1].vec[1][0];
+  if (IS_EQT(evaltime, prev_frame, threshold) || evaltime < prev_frame) {
+    return false;
+  }
+  const float frame = bezts[index].vec[1][0];
+  if (!IS_EQT(evaltime, frame, threshold)) {
+    *r_exact = false;
+    return evaltime < frame;
+  }
+  if (index + 1 < fcu->totvert) {
+    const float next_frame = bezts[index + 1].vec[1][0];
+    if (IS_EQT(evaltime, next_frame, threshold) || evaltime > next_frame) {
+      return false;
+    }
+  }
+  *r_exact = true;
+  return true;
+}
+
 static float fcurve_eval_keyframes_interpolate(const FCurve *fcu,
                                                const BezTriple *bezts,
-                                               float evaltime)
+                                               float evaltime,
+                                               int *keyframe_cursor)
 {
   const float eps = 1.e-8f;
   uint a;
@@ -2075,7 +2113,27 @@ static float fcurve_eval_keyframes_interpolate(const FCurve *fcu,
    *   Weird errors, like selecting the wrong keyframe range (see #39207), occur.
    *   This lower bound was established in b888a32eee8147b028464336ad2404d8155c64dd.
    */
-  a = BKE_fcurve_bezt_binarysearch_index_ex(bezts, evaltime, fcu->totvert, 0.0001, &exact);
+  const float threshold = 0.0001f;
+  if (keyframe_cursor == nullptr) {
+    a = BKE_fcurve_bezt_binarysearch_index_ex(bezts, evaltime, fcu->totvert, threshold, &exact);
+  }
+  else {
+    /* During playback the evaluation time mostly stays between the same keyframes, or moves on
+     * to the next ones. Only search the whole curve when that is not the case. */
+    const int cursor = *keyframe_cursor;
+    if (fcurve_keyframe_cursor_is_valid(fcu, bezts, evaltime, threshold, cursor, &exact)) {
+      a = cursor;
+    }
+    else if (fcurve_keyframe_cursor_is_valid(fcu, bezts, evaltime, threshold, cursor + 1, &exact))
+    {
+      a = cursor + 1;
+    }
+    else {
+      a = BKE_fcurve_bezt_binarysearch_index_ex(
+          bezts, evaltime, fcu->totvert, threshold, &exact);
+    }
+    *keyframe_cursor = int(a);
+  }
   const BezTriple *bezt = bezts + a;
 
   if (exact) {
@@ -2318,8 +2376,16 @@ static float fcurve_eval_keyframes_interpolate(const FCurve *fcu,
   return 0.0f;
 }
 
-/* Calculate F-Curve value for 'evaltime' using #BezTriple keyframes. */
-static float fcurve_eval_keyframes(const FCurve *fcu, const BezTriple *bezts, float evaltime)
+/**
+ * Calculate F-Curve value for 'evaltime' using #BezTriple keyframes.
+ *
+ * \param keyframe_cursor: Optional index of the keyframes used by the previous evaluation, which
+ * is updated for the next one. See #evaluate_fcurve.
+ */
+static float fcurve_eval_keyframes(const FCurve *fcu,
+                                   const BezTriple *bezts,
+                                   float evaltime,
+                                   int *keyframe_cursor = nullptr)
 {
   if (evaltime <= bezts->vec[1][0]) {
     return fcurve_eval_keyframes_extrapolate(fcu, bezts, evaltime, 0, +1);
@@ -2330,7 +2396,7 @@ static float fcurve_eval_keyframes(const FCurve *fcu, const BezTriple *bezts, fl
     return fcurve_eval_keyframes_extrapolate(fcu, bezts, evaltime, fcu->totvert - 1, -1);
   }
 
-  return fcurve_eval_keyframes_interpolate(fcu, bezts, evaltime);
+  return fcurve_eval_keyframes_interpolate(fcu, bezts, evaltime, keyframe_cursor);
 }
 
 /* Calculate F-Curve value for 'evaltime' using #FPoint samples. */
@@ -2378,7 +2444,10 @@ static float fcurve_eval_samples(const FCurve *fcu, const FPoint *fpts, float ev
 /* Evaluate and return the value of the given F-Curve at the specified frame ("evaltime")
  * NOTE: this is also used for drivers.
  */
-static float evaluate_fcurve_ex(const FCurve *fcu, float evaltime, float cvalue)
+static float evaluate_fcurve_ex(const FCurve *fcu,
+                                float evaltime,
+                                float cvalue,
+                                int *keyframe_cursor = nullptr)
 {
   /* Evaluate modifiers which modify time to evaluate the base curve at. */
   FModifiersStackStorage storage;
@@ -2394,7 +2463,7 @@ static float evaluate_fcurve_ex(const FCurve *fcu, float evaltime, float cvalue)
    *   F-Curve modifier on the stack requested the curve to be evaluated at.
    */
   if (fcu->bezt) {
-    cvalue = fcurve_eval_keyframes(fcu, fcu->bezt, devaltime);
+    cvalue = fcurve_eval_keyframes(fcu, fcu->bezt, devaltime, keyframe_cursor);
   }
   else if (fcu->fpt) {
     cvalue = fcurve_eval_samples(fcu, fcu->fpt, devaltime);
@@ -2420,6 +2489,13 @@ float evaluate_fcurve(const FCurve *fcu, float evaltime)
   return evaluate_fcurve_ex(fcu, evaltime, 0.0);
 }
 
+float evaluate_fcurve(const FCurve *fcu, float evaltime, int &keyframe_cursor)
+{
+  BLI_assert(fcu->driver == nullptr);
+
+  return evaluate_fcurve_ex(fcu, evaltime, 0.0, &keyframe_cursor);
+}
+
 float evaluate_fcurve_only_curve(const FCurve *fcu, float evaltime)
 {
   /* Can be used to evaluate the (key-framed) f-curve only.
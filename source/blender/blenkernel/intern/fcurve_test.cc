@@ -53,6 +53,32 @@ TEST_F(EvaluateFCurveTest, OnKeys)
   BKE_fcurve_free(fcu);
 }
 
+TEST_F(EvaluateFCurveTest, KeyframeCursor)
+{
+  FCurve *fcu = BKE_fcurve_create();
+
+  const KeyframeSettings settings = get_keyframe_settings(false);
+  for (int i = 0; i < 10; i++) {
+    insert_vert_fcurve(fcu, {float(i * 2), float(i * i)}, settings, INSERTKEY_NOFLAGS);
+  }
+
+  /* Evaluation with a cursor should give the same result as without, regardless of the order of
+   * evaluation times and whether they are on a keyframe. */
+  int cursor = 0;
+  for (float frame = -2.0f; frame <= 20.0f; frame += 0.25f) {
+    EXPECT_EQ(evaluate_fcurve(fcu, frame, cursor), evaluate_fcurve(fcu, frame));
+  }
+  for (float frame = 20.0f; frame >= -2.0f; frame -= 0.5f) {
+    EXPECT_EQ(evaluate_fcurve(fcu, frame, cursor), evaluate_fcurve(fcu, frame));
+  }
+  const float frames[] = {3.0f, 17.5f, 4.0f, 4.00005f, 5.99995f, 0.00005f, 11.0f, 1.0f};
+  for (const float frame : frames) {
+    EXPECT_EQ(evaluate_fcurve(fcu, frame, cursor), evaluate_fcurve(fcu, frame));
+  }
+
+  BKE_fcurve_free(fcu);
+}
+
 TEST_F(EvaluateFCurveTest, InterpolationConstant)
 {
   FCurve *fcu = BKE_fcurve_create();
@@ -14,14 +14,17 @@
 
 #include "MEM_guardedalloc.h"
 
+#include "BLI_cache_mutex.hh"
 #include "BLI_listbase.hh"
 #include "BLI_math_matrix_c.hh"
 #include "BLI_math_vector_c.hh"
+#include "BLI_offset_indices.hh"
 #include "BLI_string.hh"
 #include "BLI_string_utf8.hh"
 #include "BLI_string_utils.hh"
 #include "BLI_task.hh"
 #include "BLI_utildefines.hh"
+#include "BLI_vector.hh"
 
 #include "BLT_translation.hh"
 
@@ -61,11 +64,50 @@
 
 namespace blender {
 
+/** Number of elements evaluated together when blending relative shape keys. */
+static constexpr int KEY_EVAL_CHUNK_SIZE = 1024;
+/**
+ * Key blocks moving more than this fraction of their elements are evaluated densely, the sparse
+ * representation takes more memory per element and is slower to gather then.
+ */
+static constexpr int KEY_SPARSE_DENSITY_DIVISOR = 4;
+
+namespace bke {
+
+/**
+ * Offsets of a relative #KeyBlock from its reference key, only storing the elements that are
+ * actually moved. Corrective shapes typically only touch a small part of the geometry, so this
+ * avoids streaming the full dense arrays on every evaluation.
+ */
+struct KeyBlockSparseDeltas {
+  CacheMutex mutex;
+  /** The arrays the deltas were computed from, used to detect changed key blocks. */
+  const void *data = nullptr;
+  const void *reference_data = nullptr;
+  /** False when the key block moves too many elements for sparse evaluation to pay off. */
+  bool is_sparse = false;
+  /** Sorted indices of the elements with a non-zero offset, and their offset. */
+  Array<int> indices;
+  Array<float3> deltas;
+  /** Range in #indices for every chunk of #KEY_EVAL_CHUNK_SIZE elements. */
+  Array<int> chunk_offsets;
+};
+
+/** Runtime data of evaluated shape keys. */
+struct KeyRuntime {
+  /** Lazily computed sparse deltas, in the same order as #Key::block. */
+  Array<KeyBlockSparseDeltas, 0> sparse_deltas;
+
+  KeyRuntime(const int keyblocks_num) : sparse_deltas(keyblocks_num) {}
+};
+
+}  // namespace bke
+
 static void shapekey_copy_data(Main * /*bmain*/,
                                std::optional<Library *> /*owner_library*/,
                                ID *id_dst,
                                const ID *id_src,
-                               const int /*flag*/)
+                               const int flag)
 {
   Key *key_dst = id_cast<Key *>(id_dst);
   const Key *key_src = id_cast<const Key *>(id_src);
@@ -84,11 +126,19 @@ static void shapekey_copy_data(Main * /*bmain*/,
       key_dst->refkey = kb_dst;
     }
   }
+
+  /* Sparse evaluation data is only cached for evaluated copies, whose key block data does not
+   * change until the next copy-on-evaluation update frees the whole runtime. */
+  key_dst->runtime = nullptr;
+  if (flag & LIB_ID_COPY_SET_COPIED_ON_WRITE) {
+    key_dst->runtime = MEM_new<bke::KeyRuntime>(__func__, key_dst->block.count());
+  }
 }
 
 static void shapekey_free_data(ID *id)
 {
   Key *key = id_cast<Key *>(id);
+  MEM_SAFE_DELETE(key->runtime);
   while (KeyBlock *kb = static_cast<KeyBlock *>(BLI_pophead(&key->block))) {
     if (kb->data) {
       MEM_delete_void(kb->data);
@@ -150,6 +200,7 @@ static void shapekey_blend_read_data(BlendDataReader *reader, ID *id)
   BLO_read_struct_list(reader, KeyBlock, &(key->block));
 
   BLO_read_struct(reader, KeyBlock, &key->refkey);
+  key->runtime = nullptr;
 
   for (KeyBlock &kb : key->block) {
     BLO_read_array_and_validate_size(
@@ -215,6 +266,7 @@ struct WeightsArrayCache {
 
 void BKE_key_free_nolib(Key *key)
 {
+  MEM_SAFE_DELETE(key->runtime);
   while (KeyBlock *kb = static_cast<KeyBlock *>(BLI_pophead(&key->block))) {
     if (kb->data) {
       MEM_delete_void(kb->data);
@@ -669,12 +721,102 @@ static void copy_key_float3_weighted(const int vertex_count,
   }
 }
 
+/**
+ * Compute the non-zero offsets of `kb` from `reference_kb`, see #bke::KeyBlockSparseDeltas.
+ */
+static void key_block_sparse_deltas_compute(const KeyBlock &kb,
+                                            const KeyBlock &reference_kb,
+                                            bke::KeyBlockSparseDeltas &r_sparse)
+{
+  r_sparse.data = kb.data;
+  r_sparse.reference_data = reference_kb.data;
+  r_sparse.is_sparse = false;
+  if (kb.data == nullptr || reference_kb.data == nullptr || reference_kb.totelem != kb.totelem) {
+    return;
+  }
+
+  const Span<float3> from(static_cast<const float3 *>(kb.data), kb.totelem);
+  const Span<float3> reffrom(static_cast<const float3 *>(reference_kb.data), kb.totelem);
+  const int chunks_num = divide_ceil_u(kb.totelem, KEY_EVAL_CHUNK_SIZE);
+
+  Array<int> chunk_offsets(chunks_num + 1, 0);
+  threading::parallel_for(IndexRange(chunks_num), 16, [&](const IndexRange chunks) {
+    for (const int chunk : chunks) {
+      const IndexRange range = IndexRange(chunk * KEY_EVAL_CHUNK_SIZE, KEY_EVAL_CHUNK_SIZE)
+                                   .intersect(from.index_range());
+      int count = 0;
+      for (const int i : range) {
+        count += int(from[i] != reffrom[i]);
+      }
+      chunk_offsets[chunk] = count;
+    }
+  });
+  const OffsetIndices<int> offsets = offset_indices::accumulate_counts_to_offsets(chunk_offsets);
+  if (offsets.total_size() > kb.totelem / KEY_SPARSE_DENSITY_DIVISOR) {
+    return;
+  }
+
+  r_sparse.indices.reinitialize(offsets.total_size());
+  r_sparse.deltas.reinitialize(offsets.total_size());
+  threading::parallel_for(IndexRange(chunks_num), 16, [&](const IndexRange chunks) {
+    for (const int chunk : chunks) {
+      const IndexRange range = IndexRange(chunk * KEY_EVAL_CHUNK_SIZE, KEY_EVAL_CHUNK_SIZE)
+                                   .intersect(from.index_range());
+      int dst = offsets[chunk].start();
+      for (const int i : range) {
+        if (from[i] != reffrom[i]) {
+          r_sparse.indices[dst] = i;
+          r_sparse.deltas[dst] = from[i] - reffrom[i];
+          dst++;
+        }
+      }
+    }
+  });
+  r_sparse.chunk_offsets = std::move(chunk_offsets);
+  r_sparse.is_sparse = true;
+}
+
+/**
+ * Get the cached sparse offsets of `kb`, computing them on first use.
+ * Returns null if the key block has to be evaluated densely.
+ */
+static const bke::KeyBlockSparseDeltas *key_block_sparse_deltas_ensure(
+    Key *key, const int keyblock_index, const KeyBlock &kb, const KeyBlock &reference_kb)
+{
+  if (key->runtime == nullptr || keyblock_index >= key->runtime->sparse_deltas.size()) {
+    return nullptr;
+  }
+  bke::KeyBlockSparseDeltas &sparse = key->runtime->sparse_deltas[keyblock_index];
+  sparse.mutex.ensure([&]() { key_block_sparse_deltas_compute(kb, reference_kb, sparse); });
+  if (!sparse.is_sparse || sparse.data != kb.data || sparse.reference_data != reference_kb.data)
+  {
+    return nullptr;
+  }
+  return &sparse;
+}
+
+/** A relative key block that contributes to the result of #key_evaluate_relative_float3. */
+struct RelativeKeyBlockEval {
+  float influence;
+  /** Optional per element weights. */
+  const float *weights;
+  /** Used when the key block is evaluated densely. */
+  const float *from;
+  const float *reffrom;
+  /** Used instead of the dense arrays when available. */
+  const bke::KeyBlockSparseDeltas *sparse;
+};
+
 /**
  * Shapekey evaluation for data of 3 floats (Vector3).
  *
+ * All contributing key blocks are gathered per chunk of elements in a single pass, so the result
+ * stays in cache while it is accumulated. On evaluated shape keys, key blocks that only move a
+ * few elements are blended from their cached sparse offsets.
+ *
  * \param per_keyblock_weights: is a 2d array which gives a per KeyBlock per Vertex weight. Can be
- * \param target_data: is the float array into which the result of the evaluation is written.
  * a nullptr.
+ * \param target_data: is the float array into which the result of the evaluation is written.
  */
 static void key_evaluate_relative_float3(Key *key,
                                          KeyBlock *active_keyblock,
@@ -683,8 +825,20 @@ static void key_evaluate_relative_float3(Key *key,
                                          float **per_keyblock_weights,
                                          float *target_data)
 {
-  /* Creates the basis values of the reference key in target_data. */
-  copy_key_float3(vertex_count, key, active_keyblock, key->refkey, target_data);
+  /* Creates the basis values of the reference key in target_data. Key blocks with a different
+   * number of elements are only supported for backwards compatibility, copy those upfront. */
+  char *free_basis = nullptr;
+  const float *basis = nullptr;
+  if (key->refkey->totelem == vertex_count) {
+    basis = reinterpret_cast<float *>(
+        key_block_get_data(key, active_keyblock, key->refkey, &free_basis));
+  }
+  else {
+    copy_key_float3(vertex_count, key, active_keyblock, key->refkey, target_data);
+  }
+
+  Vector<RelativeKeyBlockEval> keyblocks;
+  Vector<char *> free_data;
 
   /* Cannot use auto [keyblock_index, kb] here because that would throw a warning at the
    * parallel_for. */
@@ -710,27 +864,66 @@ static void key_evaluate_relative_float3(Key *key,
       continue;
     }
 
-    const float *weights = per_keyblock_weights ? per_keyblock_weights[enumerator.first] : nullptr;
+    RelativeKeyBlockEval eval{};
+    eval.influence = kb_influence;
+    eval.weights = per_keyblock_weights ? per_keyblock_weights[enumerator.first] : nullptr;
 
     char *freefrom = nullptr;
-    const float *from = reinterpret_cast<float *>(
+    eval.from = reinterpret_cast<float *>(
         key_block_get_data(key, active_keyblock, &kb, &freefrom));
+    if (freefrom) {
+      free_data.append(freefrom);
+    }
+    else {
+      /* The sparse offsets are computed from the stored data, so they can't be used when the
+       * active key block is replaced by the edit-mode coordinates. */
+      eval.sparse = key_block_sparse_deltas_ensure(key, enumerator.first, kb, *reference_kb);
+    }
 
     /* For meshes, use the original values instead of the bmesh values to
      * maintain a constant offset. */
-    const float *reffrom = static_cast<float *>(reference_kb->data);
-    threading::parallel_for(IndexRange(vertex_count), 1024, [&](const IndexRange range) {
-      for (const int i : range) {
-        const float weight = weights ? (weights[i] * kb.curval) : kb.curval;
-        /* Each vertex has 3 floats. */
-        const int vector_index = i * 3;
-        add_weighted_vector(vector_index, weight, reffrom, from, target_data);
+    eval.reffrom = static_cast<float *>(reference_kb->data);
+    keyblocks.append(eval);
+  }
+
+  const int chunks_num = divide_ceil_u(vertex_count, KEY_EVAL_CHUNK_SIZE);
+  threading::parallel_for(IndexRange(chunks_num), 1, [&](const IndexRange chunks) {
+    for (const int chunk : chunks) {
+      const IndexRange range = IndexRange(chunk * KEY_EVAL_CHUNK_SIZE, KEY_EVAL_CHUNK_SIZE)
+                                   .intersect(IndexRange(vertex_count));
+      if (basis) {
+        memcpy(&target_data[range.start() * 3],
+               &basis[range.start() * 3],
+               range.size() * 3 * sizeof(float));
+      }
+      for (const RelativeKeyBlockEval &eval : keyblocks) {
+        if (eval.sparse) {
+          const Span<int> chunk_offsets = eval.sparse->chunk_offsets;
+          const IndexRange entries = IndexRange::from_begin_end(chunk_offsets[chunk],
+                                                                chunk_offsets[chunk + 1]);
+          for (const int entry : entries) {
+            const int i = eval.sparse->indices[entry];
+            const float weight = eval.weights ? (eval.weights[i] * eval.influence) :
+                                                eval.influence;
+            madd_v3_v3fl(&target_data[i * 3], eval.sparse->deltas[entry], weight);
+          }
+          continue;
+        }
+        for (const int i : range) {
+          const float weight = eval.weights ? (eval.weights[i] * eval.influence) : eval.influence;
+          /* Each vertex has 3 floats. */
+          const int vector_index = i * 3;
+          add_weighted_vector(vector_index, weight, eval.reffrom, eval.from, target_data);
+        }
       }
-    });
-
-    if (freefrom) {
-      MEM_delete(freefrom);
     }
+  });
+
+  for (char *data : free_data) {
+    MEM_delete(data);
+  }
+  if (free_basis) {
+    MEM_delete(free_basis);
   }
 }
 
@@ -5,6 +5,7 @@
 #include "BKE_gtest_base.hh"
 #include "BKE_idtype.hh"
 #include "BKE_key.hh"
+#include "BKE_lib_id.hh"
 #include "BKE_main.hh"
 #include "BKE_mesh.h"
 #include "BKE_mesh.hh"
@@ -147,6 +148,69 @@ TEST_F(ShapekeyTest, mesh_key_evaluation_relative)
   MEM_delete(ob_eval);
 }
 
+/* Evaluated copies blend key blocks from their cached sparse offsets, which has to give the same
+ * result as the dense evaluation of the original. */
+TEST_F(ShapekeyTest, mesh_key_evaluation_relative_sparse)
+{
+  const int verts_num = 3000;
+  mesh = BKE_mesh_add(bmain, "Large Mesh");
+  ob->data = &mesh->id;
+  mesh->verts_num = verts_num;
+  bke::mesh_ensure_required_data_layers(*mesh);
+  MutableSpan<float3> positions = mesh->vert_positions_for_write();
+  for (const int i : positions.index_range()) {
+    positions[i] = float3(float(i), float(i % 7), 0.5f);
+  }
+
+  Key *key = BKE_key_add(bmain, &mesh->id);
+  mesh->key = key;
+  key->type = KEY_RELATIVE;
+  KeyBlock *base = BKE_keyblock_add(key, "base");
+  BKE_keyblock_convert_from_mesh(mesh, key, base);
+
+  /* Only moves a few vertices, in different evaluation chunks. */
+  KeyBlock *key1 = BKE_keyblock_add(key, "sparse");
+  BKE_keyblock_convert_from_mesh(mesh, key, key1);
+  float3 *key1_data = reinterpret_cast<float3 *>(key1->data);
+  key1_data[0] += float3(1, 2, 3);
+  key1_data[1500] += float3(-0.25f, 0, 0);
+  key1_data[verts_num - 1] += float3(0, 0, 4);
+  key1->curval = 0.75f;
+
+  /* Moves all vertices. */
+  KeyBlock *key2 = BKE_keyblock_add(key, "dense");
+  BKE_keyblock_convert_from_mesh(mesh, key, key2);
+  float3 *key2_data = reinterpret_cast<float3 *>(key2->data);
+  for (const int i : IndexRange(verts_num)) {
+    key2_data[i] *= 1.5f;
+  }
+  key2->curval = 0.5f;
+
+  int totelem = 0;
+  float3 *expected = reinterpret_cast<float3 *>(BKE_key_evaluate_object(ob, &totelem));
+  ASSERT_EQ(totelem, verts_num);
+  EXPECT_EQ(expected[0], float3(0.75f, 1.5f, 2.875f));
+
+  Key *key_eval = id_cast<Key *>(BKE_id_copy_in_lib(bmain,
+                                                    std::nullopt,
+                                                    &key->id,
+                                                    std::nullopt,
+                                                    nullptr,
+                                                    LIB_ID_COPY_DEFAULT |
+                                                        LIB_ID_COPY_SET_COPIED_ON_WRITE));
+  ASSERT_NE(key_eval->runtime, nullptr);
+  mesh->key = key_eval;
+  /* The first evaluation computes the sparse offsets, the second one uses the cached ones. */
+  for ([[maybe_unused]] const int iteration : IndexRange(2)) {
+    float3 *ob_eval = reinterpret_cast<float3 *>(BKE_key_evaluate_object(ob, &totelem));
+    ASSERT_EQ(totelem, verts_num);
+    EXPECT_EQ_ARRAY(expected, ob_eval, verts_num);
+    MEM_delete(ob_eval);
+  }
+  mesh->key = key;
+  MEM_delete(expected);
+}
+
 TEST_F(ShapekeyTest, mesh_key_evaluation_absolute)
 {
   Key *key = BKE_key_add(bmain, &mesh->id);
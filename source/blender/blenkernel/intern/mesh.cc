@@ -159,6 +159,7 @@ static void mesh_copy_data(Main *bmain,
   mesh_dst->runtime->vert_to_face_map_cache = mesh_src->runtime->vert_to_face_map_cache;
   mesh_dst->runtime->vert_to_corner_map_cache = mesh_src->runtime->vert_to_corner_map_cache;
   mesh_dst->runtime->corner_to_face_map_cache = mesh_src->runtime->corner_to_face_map_cache;
+  mesh_dst->runtime->deform_weights_cache = mesh_src->runtime->deform_weights_cache;
   mesh_dst->runtime->bvh_cache_verts = mesh_src->runtime->bvh_cache_verts;
   mesh_dst->runtime->bvh_cache_edges = mesh_src->runtime->bvh_cache_edges;
   mesh_dst->runtime->bvh_cache_faces = mesh_src->runtime->bvh_cache_faces;
@@ -172,6 +173,7 @@ static void mesh_copy_data(Main *bmain,
   mesh_dst->runtime->bvh_cache_loose_edges_no_hidden =
       mesh_src->runtime->bvh_cache_loose_edges_no_hidden;
   mesh_dst->runtime->bvh_embree_cache = mesh_src->runtime->bvh_embree_cache;
+  mesh_dst->runtime->bvh_embree_reusable_tree = mesh_src->runtime->bvh_embree_reusable_tree;
   mesh_dst->runtime->max_material_index = mesh_src->runtime->max_material_index;
   if (mesh_src->runtime->bake_materials) {
     mesh_dst->runtime->bake_materials = std::make_unique<bke::bake::BakeMaterialsList>(
@@ -1272,6 +1274,7 @@ Span<MDeformVert> Mesh::deform_verts() const
 }
 MutableSpan<MDeformVert> Mesh::deform_verts_for_write()
 {
+  this->runtime->deform_weights_cache.tag_dirty();
   MDeformVert *dvert = static_cast<MDeformVert *>(
       CustomData_get_layer_for_write(&this->vert_data, CD_MDEFORMVERT, this->verts_num));
   if (dvert) {
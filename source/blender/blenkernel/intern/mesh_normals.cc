@@ -191,6 +191,46 @@ void normals_calc_faces(const Span<float3> positions,
   });
 }
 
+void normals_calc_faces(const Span<float3> positions,
+                        const OffsetIndices<int> faces,
+                        const Span<int> corner_verts,
+                        const IndexMask &face_mask,
+                        MutableSpan<float3> face_normals)
+{
+  PRF_scope(ProfileCategory::Default);
+  BLI_assert(faces.size() == face_normals.size());
+  face_mask.foreach_index(
+      [&](const int i) {
+        face_normals[i] = normal_calc_ngon(positions, corner_verts.slice(faces[i]));
+      },
+      exec_mode::grain_size(1024));
+}
+
+static float3 vert_normal_calc(const Span<float3> positions,
+                               const OffsetIndices<int> faces,
+                               const Span<int> corner_verts,
+                               const GroupedSpan<int> vert_to_face_map,
+                               const Span<float3> face_normals,
+                               const int vert)
+{
+  const Span<int> vert_faces = vert_to_face_map[vert];
+  if (vert_faces.is_empty()) {
+    return math::normalize(positions[vert]);
+  }
+
+  float3 vert_normal(0);
+  for (const int face : vert_faces) {
+    const int2 adjacent_verts = face_find_adjacent_verts(faces[face], corner_verts, vert);
+    const float3 dir_prev = math::normalize(positions[adjacent_verts[0]] - positions[vert]);
+    const float3 dir_next = math::normalize(positions[adjacent_verts[1]] - positions[vert]);
+    const float factor = math::safe_acos_approx(math::dot(dir_prev, dir_next));
+
+    vert_normal += face_normals[face] * factor;
+  }
+
+  return math::normalize(vert_normal);
+}
+
 void normals_calc_verts(const Span<float3> vert_positions,
                         const OffsetIndices<int> faces,
                         const Span<int> corner_verts,
@@ -202,27 +242,29 @@ void normals_calc_verts(const Span<float3> vert_positions,
   const Span<float3> positions = vert_positions;
   threading::parallel_for(positions.index_range(), 1024, [&](const IndexRange range) {
     for (const int vert : range) {
-      const Span<int> vert_faces = vert_to_face_map[vert];
-      if (vert_faces.is_empty()) {
-        vert_normals[vert] = math::normalize(positions[vert]);
-        continue;
-      }
-
-      float3 vert_normal(0);
-      for (const int face : vert_faces) {
-        const int2 adjacent_verts = face_find_adjacent_verts(faces[face], corner_verts, vert);
-        const float3 dir_prev = math::normalize(positions[adjacent_verts[0]] - positions[vert]);
-        const float3 dir_next = math::normalize(positions[adjacent_verts[1]] - positions[vert]);
-        const float factor = math::safe_acos_approx(math::dot(dir_prev, dir_next));
-
-        vert_normal += face_normals[face] * factor;
-      }
-
-      vert_normals[vert] = math::normalize(vert_normal);
+      vert_normals[vert] = vert_normal_calc(
+          positions, faces, corner_verts, vert_to_face_map, face_normals, vert);
     }
   });
 }
 
+void normals_calc_verts(const Span<float3> vert_positions,
+                        const OffsetIndices<int> faces,
+                        const Span<int> corner_verts,
+                        const GroupedSpan<int> vert_to_face_map,
+                        const Span<float3> face_normals,
+                        const IndexMask &vert_mask,
+                        MutableSpan<float3> vert_normals)
+{
+  PRF_scope(ProfileCategory::Default);
+  vert_mask.foreach_index(
+      [&](const int vert) {
+        vert_normals[vert] = vert_normal_calc(
+            vert_positions, faces, corner_verts, vert_to_face_map, face_normals, vert);
+      },
+      exec_mode::grain_size(1024));
+}
+
 /** \} */
 
 static void mix_normals_corner_to_vert(const Span<float3> vert_positions,
@@ -0,0 +1,108 @@
+/* SPDX-FileCopyrightText: 2026 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+
+#include "testing/testing.h"
+
+#include "BLI_array.hh"
+#include "BLI_index_mask.hh"
+#include "BLI_math_vector_types.hh"
+
+#include "DNA_mesh_types.h"
+
+#include "BKE_gtest_base.hh"
+#include "BKE_lib_id.hh"
+#include "BKE_mesh.hh"
+
+#include <cmath>
+
+namespace blender::bke::tests {
+
+class MeshNormalsTest : public BlenderGTestBase {};
+
+/** Grid of quads in the XY plane with a wave along the Z axis, so that normals differ. */
+static Mesh *create_wavy_grid_mesh(const int size)
+{
+  const int verts_per_side = size + 1;
+  Mesh *mesh = BKE_mesh_new_nomain(
+      verts_per_side * verts_per_side, 0, size * size, size * size * 4);
+
+  MutableSpan<float3> positions = mesh->vert_positions_for_write();
+  for (const int y : IndexRange(verts_per_side)) {
+    for (const int x : IndexRange(verts_per_side)) {
+      positions[y * verts_per_side + x] = float3(x, y, 0.3f * std::sin(x * 0.7f + y * 0.4f));
+    }
+  }
+
+  MutableSpan<int> face_offsets = mesh->face_offsets_for_write();
+  MutableSpan<int> corner_verts = mesh->corner_verts_for_write();
+  for (const int y : IndexRange(size)) {
+    for (const int x : IndexRange(size)) {
+      const int face = y * size + x;
+      const int v0 = y * verts_per_side + x;
+      face_offsets[face] = face * 4;
+      corner_verts[face * 4 + 0] = v0;
+      corner_verts[face * 4 + 1] = v0 + 1;
+      corner_verts[face * 4 + 2] = v0 + 1 + verts_per_side;
+      corner_verts[face * 4 + 3] = v0 + verts_per_side;
+    }
+  }
+  face_offsets.last() = size * size * 4;
+  return mesh;
+}
+
+static void expect_normals_match_full_recalculation(const Mesh &mesh)
+{
+  Mesh *expected = BKE_mesh_copy_for_eval(mesh);
+  expected->tag_positions_changed();
+  EXPECT_EQ(mesh.face_normals_true(), expected->face_normals_true());
+  EXPECT_EQ(mesh.vert_normals_true(), expected->vert_normals_true());
+  EXPECT_EQ(mesh.vert_normals(), expected->vert_normals());
+  BKE_id_free(nullptr, expected);
+}
+
+TEST_F(MeshNormalsTest, partial_positions_update)
+{
+  Mesh *mesh = create_wavy_grid_mesh(30);
+  /* Calculate the normals for the initial positions. */
+  mesh->face_normals_true();
+  mesh->vert_normals_true();
+
+  /* Another mesh sharing the normals must not be affected by the partial update. */
+  Mesh *mesh_copy = BKE_mesh_copy_for_eval(*mesh);
+  const Array<float3> old_vert_normals(mesh_copy->vert_normals_true());
+
+  /* Move a corner, a boundary and two neighboring inner vertices. */
+  const Array<int> changed_indices = {0, 5, 100, 101};
+  MutableSpan<float3> positions = mesh->vert_positions_for_write();
+  for (const int vert : changed_indices) {
+    positions[vert].z += 0.5f;
+    positions[vert].x -= 0.2f;
+  }
+  IndexMaskMemory memory;
+  mesh->tag_positions_changed(IndexMask::from_indices(changed_indices.as_span(), memory));
+
+  expect_normals_match_full_recalculation(*mesh);
+  EXPECT_EQ(mesh_copy->vert_normals_true(), old_vert_normals.as_span());
+
+  BKE_id_free(nullptr, mesh);
+  BKE_id_free(nullptr, mesh_copy);
+}
+
+TEST_F(MeshNormalsTest, partial_positions_update_many)
+{
+  Mesh *mesh = create_wavy_grid_mesh(10);
+  mesh->vert_normals_true();
+
+  /* Moving most of the vertices falls back to recalculating all normals. */
+  MutableSpan<float3> positions = mesh->vert_positions_for_write();
+  for (float3 &position : positions.drop_front(10)) {
+    position.z = -position.z;
+  }
+  mesh->tag_positions_changed(IndexRange(10, positions.size() - 10));
+  expect_normals_match_full_recalculation(*mesh);
+
+  BKE_id_free(nullptr, mesh);
+}
+
+}  // namespace blender::bke::tests
@@ -12,6 +12,7 @@
 #include "BKE_bake_data_block_id.hh"
 #include "BKE_bvhutils.hh"
 #include "BKE_customdata.hh"
+#include "BKE_deform.hh"
 #include "BKE_editmesh_cache.hh"
 #include "BKE_lib_id.hh"
 #include "BKE_mesh.hh"
@@ -64,6 +65,12 @@ MeshRuntime::~MeshRuntime()
 {
   free_mesh_eval(*this);
   free_batch_cache(*this);
+  if (this->bvh_embree_reusable_tree.use_count() > 1) {
+    /* Other meshes with the same topology may refit the tree instead of building a new one. */
+    if (bke::bvh::Tree *tree = this->bvh_embree_cache.data_if_unshared()) {
+      this->bvh_embree_reusable_tree->store(std::move(*tree));
+    }
+  }
 }
 
 static void set_bools(MutableSpan<bool> bools, const Span<int> indices_to_set)
@@ -136,6 +143,28 @@ GroupedSpan<int> Mesh::vert_to_face_map() const
   return {offsets, this->runtime->vert_to_face_map_cache.data()};
 }
 
+GroupedSpan<MDeformWeight> Mesh::deform_weights() const
+{
+  this->runtime->deform_weights_cache.ensure([&](bke::DeformWeightsCache &r_data) {
+    const Span<MDeformVert> dverts = this->deform_verts();
+    r_data.offsets.reinitialize(dverts.size() + 1);
+    for (const int i : dverts.index_range()) {
+      r_data.offsets[i] = dverts[i].totweight;
+    }
+    const OffsetIndices offsets = offset_indices::accumulate_counts_to_offsets(r_data.offsets);
+    r_data.weights.reinitialize(offsets.total_size());
+    threading::parallel_for(dverts.index_range(), 2048, [&](const IndexRange range) {
+      for (const int i : range) {
+        r_data.weights.as_mutable_span()
+            .slice(offsets[i])
+            .copy_from({dverts[i].dw, dverts[i].totweight});
+      }
+    });
+  });
+  const bke::DeformWeightsCache &cache = this->runtime->deform_weights_cache.data();
+  return {OffsetIndices<int>(cache.offsets), cache.weights};
+}
+
 GroupedSpan<int> Mesh::vert_to_corner_map() const
 {
   const OffsetIndices offsets = this->vert_to_face_map_offsets();
@@ -320,10 +349,13 @@ void BKE_mesh_runtime_clear_geometry(Mesh *mesh)
   mesh->runtime->corner_tris_cache.data.tag_dirty();
   mesh->runtime->corner_tri_faces_cache.tag_dirty();
   mesh->runtime->shrinkwrap_boundary_cache.tag_dirty();
+  mesh->runtime->deform_weights_cache.tag_dirty();
   mesh->runtime->max_material_index.tag_dirty();
   mesh->runtime->subsurf_face_dot_tags.clear_and_shrink();
   mesh->runtime->subsurf_optimal_display_edges.clear_and_shrink();
   mesh->runtime->spatial_groups.reset();
+  /* Stop sharing the reusable tree with meshes which may have a different topology now. */
+  mesh->runtime->bvh_embree_reusable_tree = std::make_shared<bke::bvh::ReusableTree>();
   mesh->flag &= ~(ME_NO_OVERLAPPING_TOPOLOGY | ME_FLAG_UV_SELECT_SYNC_VALID);
 }
 
@@ -393,6 +425,71 @@ void Mesh::tag_positions_changed()
   this->tag_positions_changed_no_normals();
 }
 
+void Mesh::tag_positions_changed(const IndexMask &changed_verts)
+{
+  using namespace blender::bke;
+  if (changed_verts.is_empty()) {
+    return;
+  }
+  SharedCache<Vector<float3>> &face_normals_cache = this->runtime->face_normals_true_cache;
+  SharedCache<Vector<float3>> &vert_normals_cache = this->runtime->vert_normals_true_cache;
+  /* Updating the normals in place requires normals that were calculated for the previous
+   * positions, and only pays off for local changes: gathering the affected elements is single
+   * threaded and costs a few hash table insertions per corner of every affected face, while the
+   * full recalculation is multi-threaded. */
+  if (changed_verts.size() > this->verts_num / 64 ||
+      (face_normals_cache.is_dirty() && vert_normals_cache.is_dirty()))
+  {
+    this->tag_positions_changed();
+    return;
+  }
+
+  const Span<float3> positions = this->vert_positions();
+  const OffsetIndices faces = this->faces();
+  const Span<int> corner_verts = this->corner_verts();
+  const GroupedSpan<int> vert_to_face_map = this->vert_to_face_map();
+
+  /* Moving a vertex changes the normals of the faces using it. Vertex normals also depend on the
+   * positions of the neighboring vertices, so all vertices of those faces need to be updated. */
+  VectorSet<int> affected_faces;
+  changed_verts.foreach_index(
+      [&](const int vert) { affected_faces.add_multiple(vert_to_face_map[vert]); });
+  VectorSet<int> affected_verts;
+  changed_verts.foreach_index([&](const int vert) { affected_verts.add(vert); });
+  for (const int face : affected_faces) {
+    affected_verts.add_multiple(corner_verts.slice(faces[face]));
+  }
+
+  IndexMaskMemory memory;
+  Array<int> indices(affected_faces.as_span());
+  std::sort(indices.begin(), indices.end());
+  const IndexMask face_mask = IndexMask::from_indices<int>(indices, memory);
+  indices = Array<int>(affected_verts.as_span());
+  std::sort(indices.begin(), indices.end());
+  const IndexMask vert_mask = IndexMask::from_indices<int>(indices, memory);
+
+  if (!face_normals_cache.is_dirty()) {
+    face_normals_cache.update([&](Vector<float3> &r_data) {
+      mesh::normals_calc_faces(positions, faces, corner_verts, face_mask, r_data);
+    });
+  }
+  if (!vert_normals_cache.is_dirty()) {
+    const Span<float3> face_normals = this->face_normals_true();
+    vert_normals_cache.update([&](Vector<float3> &r_data) {
+      mesh::normals_calc_verts(
+          positions, faces, corner_verts, vert_to_face_map, face_normals, vert_mask, r_data);
+    });
+  }
+
+  /* These only reference the true normals unless there are custom normals, in which case they
+   * are recalculated entirely. */
+  this->runtime->vert_normals_cache.tag_dirty();
+  this->runtime->face_normals_cache.tag_dirty();
+  this->runtime->corner_normals_cache.tag_dirty();
+  this->runtime->shrinkwrap_boundary_cache.tag_dirty();
+  this->tag_positions_changed_no_normals();
+}
+
 void Mesh::tag_positions_changed_no_normals()
 {
   free_bvh_caches(*this->runtime);
@@ -985,7 +985,11 @@ void BKE_packedfile_blend_read(BlendDataReader *reader, PackedFile **pf_p, Strin
   }
   /* NOTE: this is endianness-sensitive. */
   /* NOTE: there is no way to handle endianness switch here. */
-  pf->sharing_info = BLO_read_shared(reader, &pf->data, [&]() {
+  pf->sharing_info = BLO_read_shared(reader, &pf->data, [&]() -> const ImplicitSharingInfo * {
+    /* Packed data of linked data-blocks is only loaded from disk when it is used. */
+    if (const ImplicitSharingInfo *sharing_info = BLO_read_mapped(reader, &pf->data, pf->size)) {
+      return sharing_info;
+    }
     BLO_read_array_and_validate_size(
         reader, reinterpret_cast<std::byte **>(const_cast<void **>(&pf->data)), &pf->size);
     /* Do not create an implicit sharing if read data pointer is `nullptr`. */
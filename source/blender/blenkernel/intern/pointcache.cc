@@ -8,17 +8,21 @@
  */
 
 #include <algorithm>
+#include <atomic>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
+#include <fcntl.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 
 /* needed for directory lookup */
 #ifndef WIN32
 #  include <dirent.h>
+#  include <unistd.h>
 #else
 #  include "BLI_winstuff.hh"
+#  include <io.h>
 #endif
 
 #include "CLG_log.h"
@@ -37,16 +41,23 @@
 #include "DNA_scene_types.h"
 #include "DNA_space_types.h"
 
+#include "BLI_array.hh"
 #include "BLI_compression.hh"
 #include "BLI_fileops.hh"
+#include "BLI_hash.hh"
 #include "BLI_listbase.hh"
 #include "BLI_math_rotation_c.hh"
 #include "BLI_math_vector_c.hh"
+#include "BLI_memory_cache.hh"
+#include "BLI_memory_counter.hh"
+#include "BLI_mmap.hh"
 #include "BLI_path_utils.hh"
 #include "BLI_string.hh"
 #include "BLI_string_utf8.hh"
+#include "BLI_task.hh"
 #include "BLI_time.hh"
 #include "BLI_utildefines.hh"
+#include "BLI_vector.hh"
 
 #include "BLT_translation.hh"
 
@@ -135,11 +146,11 @@ static int ptcache_basic_header_read(PTCacheFile *pf)
   int error = 0;
 
   /* Custom functions should read these basic elements too! */
-  if (!error && !fread(&pf->totpoint, sizeof(uint), 1, pf->fp)) {
+  if (!error && !ptcache_file_read(pf, &pf->totpoint, 1, sizeof(uint))) {
     error = 1;
   }
 
-  if (!error && !fread(&pf->data_types, sizeof(uint), 1, pf->fp)) {
+  if (!error && !ptcache_file_read(pf, &pf->data_types, 1, sizeof(uint))) {
     error = 1;
   }
 
@@ -1452,6 +1463,278 @@ static int ptcache_filepath(PTCacheID *pid,
   return len; /* make sure the above string is always 16 chars */
 }
 
+/* Packed disk cache.
+ *
+ * All frames of a baked disk cache can be stored in a single `.bpack` file, so that scrubbing
+ * through a long cache does not have to open one file per frame (which is slow on network
+ * storage). The file starts with a #PTCachePackHeader, followed by a #PTCachePackFrame table that
+ * is sorted by frame number and finally the unmodified contents of the per-frame files. The pack
+ * file is memory mapped once and kept in the memory cache, frames are read from the mapping. */
+
+#define PTCACHE_PACK_ID "BPHYSPAK"
+#define PTCACHE_PACK_VERSION 1
+
+struct PTCachePackHeader {
+  char id[8];
+  uint version;
+  uint frames_num;
+};
+
+struct PTCachePackFrame {
+  int frame;
+  uint size;
+  uint64_t offset;
+};
+
+struct PTCachePack : public memory_cache::CachedValue {
+  BLI_mmap_file *mmap_file = nullptr;
+  /** Copied out of the mapping, so that lookups can't run into IO errors. */
+  Array<PTCachePackFrame> frames;
+
+  ~PTCachePack() override
+  {
+    if (mmap_file) {
+      BLI_mmap_free(mmap_file);
+    }
+  }
+
+  void count_memory(MemoryCounter &memory) const override
+  {
+    memory.add(frames.as_span().size_in_bytes());
+  }
+
+  /** Index in #frames of the given frame number or -1 if it isn't cached. */
+  int64_t frame_index(const int frame) const
+  {
+    const PTCachePackFrame *found = std::lower_bound(
+        frames.begin(), frames.end(), frame, [](const PTCachePackFrame &a, const int b) {
+          return a.frame < b;
+        });
+    if (found == frames.end() || found->frame != frame) {
+      return -1;
+    }
+    return found - frames.begin();
+  }
+
+  const uchar *data() const
+  {
+    return static_cast<const uchar *>(BLI_mmap_get_pointer(mmap_file));
+  }
+};
+
+/**
+ * Identifies a pack file in the memory cache. The modification time and size make sure that a
+ * pack file that was changed outside of this session is not read from a stale mapping.
+ */
+class PTCachePackKey : public GenericKey {
+ public:
+  std::string filepath;
+  int64_t mtime;
+  int64_t size;
+
+  PTCachePackKey(std::string filepath, const int64_t mtime, const int64_t size)
+      : filepath(std::move(filepath)), mtime(mtime), size(size)
+  {
+  }
+
+  uint64_t hash() const override
+  {
+    return get_default_hash(filepath, mtime, size);
+  }
+
+  bool equal_to(const GenericKey &other) const override
+  {
+    if (const auto *other_typed = dynamic_cast<const PTCachePackKey *>(&other)) {
+      return filepath == other_typed->filepath && mtime == other_typed->mtime &&
+             size == other_typed->size;
+    }
+    return false;
+  }
+
+  std::unique_ptr<GenericKey> to_storable() const override
+  {
+    return std::make_unique<PTCachePackKey>(*this);
+  }
+};
+
+static bool ptcache_pack_io_error(const PTCachePack &pack)
+{
+  return BLI_mmap_any_io_error(pack.mmap_file);
+}
+
+static int ptcache_pack_filepath(PTCacheID *pid, char filepath[MAX_PTCACHE_FILE])
+{
+  const int len = ptcache_filepath(pid, filepath, 0, true, false);
+  if (len == 0) {
+    return 0;
+  }
+  ptcache_filepath_ext_append(pid, filepath, size_t(len), false, 0);
+  BLI_path_extension_replace(filepath, MAX_PTCACHE_FILE, PTCACHE_PACK_EXT);
+  return len;
+}
+
+/** Whether frames should be looked up in a pack file before falling back to per-frame files. */
+static bool ptcache_pack_in_use(const PTCacheID *pid)
+{
+  return (pid->cache->flag & (PTCACHE_DISK_PACK | PTCACHE_BAKED)) ==
+         (PTCACHE_DISK_PACK | PTCACHE_BAKED);
+}
+
+static std::unique_ptr<PTCachePack> ptcache_pack_load(const char *filepath)
+{
+  auto pack = std::make_unique<PTCachePack>();
+
+  const int file = BLI_open(filepath, O_BINARY | O_RDONLY, 0);
+  if (file == -1) {
+    return pack;
+  }
+  pack->mmap_file = BLI_mmap_open(file);
+  close(file);
+  if (pack->mmap_file == nullptr) {
+    CLOG_WARN(&LOG, "Cannot map point cache pack file '%s'", filepath);
+    return pack;
+  }
+
+  const size_t length = BLI_mmap_get_length(pack->mmap_file);
+  PTCachePackHeader header;
+  if (!BLI_mmap_read(pack->mmap_file, &header, 0, sizeof(header)) ||
+      !STREQLEN(header.id, PTCACHE_PACK_ID, 8) || header.version != PTCACHE_PACK_VERSION)
+  {
+    CLOG_WARN(&LOG, "Invalid point cache pack file '%s'", filepath);
+    return pack;
+  }
+
+  Array<PTCachePackFrame> frames(header.frames_num);
+  if (!BLI_mmap_read(
+          pack->mmap_file, frames.data(), sizeof(header), frames.as_span().size_in_bytes()))
+  {
+    CLOG_WARN(&LOG, "Cannot read frame table of point cache pack file '%s'", filepath);
+    return pack;
+  }
+  for (const PTCachePackFrame &frame : frames) {
+    if (frame.offset > length || frame.size > length - frame.offset) {
+      CLOG_WARN(&LOG,
+                "Frame %d is out of bounds in point cache pack file '%s'",
+                frame.frame,
+                filepath);
+      return pack;
+    }
+  }
+
+  pack->frames = std::move(frames);
+  return pack;
+}
+
+/**
+ * Get the mapped pack file of the cache, or null if the cache isn't packed.
+ */
+static std::shared_ptr<const PTCachePack> ptcache_pack_get(PTCacheID *pid)
+{
+  char filepath[MAX_PTCACHE_FILE];
+  if (ptcache_pack_filepath(pid, filepath) == 0) {
+    return nullptr;
+  }
+  BLI_stat_t stat;
+  if (BLI_stat(filepath, &stat) == -1) {
+    return nullptr;
+  }
+
+  const PTCachePackKey key{filepath, int64_t(stat.st_mtime), int64_t(stat.st_size)};
+  std::shared_ptr<const PTCachePack> pack = memory_cache::get<PTCachePack>(
+      key, [&]() { return ptcache_pack_load(filepath); });
+  if (pack->frames.is_empty()) {
+    return nullptr;
+  }
+  return pack;
+}
+
+/**
+ * Unmap a pack file before it is replaced or deleted, mapped files can't be removed on all
+ * platforms.
+ */
+static void ptcache_pack_release(const char *filepath)
+{
+  memory_cache::remove_if([&](const GenericKey &key) {
+    if (const auto *pack_key = dynamic_cast<const PTCachePackKey *>(&key)) {
+      return pack_key->filepath == filepath;
+    }
+    return false;
+  });
+}
+
+/** Sorted frame numbers of all per-frame files of a disk cache. */
+static Vector<int> ptcache_disk_frames_list(PTCacheID *pid)
+{
+  Vector<int> frames;
+  char path[MAX_PTCACHE_PATH];
+  char filepath[MAX_PTCACHE_FILE];
+  char ext[MAX_PTCACHE_FILE];
+
+  BKE_ptcache_path(pid, path);
+  uint len = ptcache_filepath(pid, filepath, 0, false, false); /* no path */
+  /* append underscore terminator to ensure we don't match similar names
+   * from objects whose names start with the same prefix
+   */
+  if (len < sizeof(filepath) - 2) {
+    BLI_strncpy(filepath + len, "_", sizeof(filepath) - 2 - len);
+    len += 1;
+  }
+  ptcache_filepath_ext_append(pid, ext, 0, false, 0);
+
+  DIR *dir = opendir(path);
+  if (dir == nullptr) {
+    return frames;
+  }
+  dirent *de;
+  while ((de = readdir(dir)) != nullptr) {
+    if (strstr(de->d_name, ext) && STREQLEN(filepath, de->d_name, len)) {
+      const int frame = ptcache_frame_from_filename(de->d_name, ext);
+      if (frame != -1) {
+        frames.append(frame);
+      }
+    }
+  }
+  closedir(dir);
+
+  std::sort(frames.begin(), frames.end());
+  return frames;
+}
+
+static void ptcache_pack_delete(PTCacheID *pid)
+{
+  char pack_filepath[MAX_PTCACHE_FILE];
+  if (ptcache_pack_filepath(pid, pack_filepath) && BLI_exists(pack_filepath)) {
+    ptcache_pack_release(pack_filepath);
+    BLI_delete(pack_filepath, false, false);
+  }
+}
+
+static PTCacheFile *ptcache_pack_file_open(std::shared_ptr<const PTCachePack> pack, int cfra)
+{
+  const int64_t frame_index = pack->frame_index(cfra);
+  if (frame_index == -1) {
+    return nullptr;
+  }
+  const PTCachePackFrame &frame = pack->frames[frame_index];
+
+  /* Playback usually continues with the next frame, let the OS read it in the meantime. */
+  if (frame_index + 1 < pack->frames.size()) {
+    const PTCachePackFrame &next_frame = pack->frames[frame_index + 1];
+    BLI_mmap_prefetch(pack->mmap_file, next_frame.offset, next_frame.size);
+  }
+
+  PTCacheFile *pf = MEM_new<PTCacheFile>("PTCacheFile");
+  pf->fp = nullptr;
+  pf->mem = pack->data() + frame.offset;
+  pf->mem_size = frame.size;
+  pf->mem_pos = 0;
+  pf->pack = std::move(pack);
+  pf->old_format = 0;
+  pf->frame = cfra;
+
+  return pf;
+}
+
 /**
  * Caller must close after!
  */
@@ -1474,6 +1757,13 @@ static PTCacheFile *ptcache_file_open(PTCacheID *pid, int mode, int cfra)
     }
   }
 
+  if (mode == PTCACHE_FILE_READ && ptcache_pack_in_use(pid)) {
+    /* A pack file replaces all per-frame files. */
+    if (std::shared_ptr<const PTCachePack> pack = ptcache_pack_get(pid)) {
+      return ptcache_pack_file_open(std::move(pack), cfra);
+    }
+  }
+
   ptcache_filepath(pid, filepath, cfra, true, true);
 
   if (mode == PTCACHE_FILE_READ) {
@@ -1502,16 +1792,120 @@ static PTCacheFile *ptcache_file_open(PTCacheID *pid, int mode, int cfra)
 static void ptcache_file_close(PTCacheFile *pf)
 {
   if (pf) {
-    fclose(pf->fp);
+    if (pf->fp) {
+      fclose(pf->fp);
+    }
     MEM_delete(pf);
   }
 }
 
+static int ptcache_compressed_decode(const PointCacheCompression compressed,
+                                     const uchar *in,
+                                     const size_t in_len,
+                                     uchar *result,
+                                     uint items_num,
+                                     uint item_size)
+{
+  int r = 0;
+  if (in_len == 0) {
+    /* do nothing */
+    return r;
+  }
+
+  uchar *decomp_result = result;
+  if (compressed == PTCACHE_COMPRESS_ZSTD_FILTERED) {
+    decomp_result = MEM_new_array_uninitialized<uchar>(items_num * item_size,
+                                                       "pointcache_unfilter_buffer");
+  }
+  if (ELEM(compressed,
+           PTCACHE_COMPRESS_ZSTD_FILTERED,
+           PTCACHE_COMPRESS_ZSTD_FAST_DEPRECATED,
+           PTCACHE_COMPRESS_ZSTD_SLOW_DEPRECATED))
+  {
+    const size_t err = ZSTD_decompress(decomp_result, items_num * item_size, in, in_len);
+    r = ZSTD_isError(err);
+  }
+  else {
+    /* We are trying to read an unsupported compression format. */
+    r = 1;
+  }
+
+  /* Un-filter the decompressed data, if needed. */
+  if (compressed == PTCACHE_COMPRESS_ZSTD_FILTERED) {
+    unfilter_transpose_delta(decomp_result, result, items_num, item_size);
+    MEM_delete(decomp_result);
+  }
+
+  return r;
+}
+
+/** A possibly compressed array of a frame that is read from a packed cache. */
+struct PTCacheMemChunk {
+  PointCacheCompression compression;
+  const uchar *in;
+  size_t in_len;
+};
+
+/**
+ * Parse the header of a compressed array in a packed cache frame and skip its data, without
+ * decompressing it yet.
+ */
+static bool ptcache_file_mem_chunk_read(PTCacheFile *pf,
+                                        uint items_num,
+                                        uint item_size,
+                                        PTCacheMemChunk &r_chunk)
+{
+  uchar compressed_val = 0;
+  if (!ptcache_file_read(pf, &compressed_val, 1, sizeof(uchar))) {
+    return false;
+  }
+  r_chunk.compression = PointCacheCompression(compressed_val);
+  if (r_chunk.compression == PTCACHE_COMPRESS_NO) {
+    r_chunk.in_len = size_t(items_num) * item_size;
+  }
+  else {
+    uint size;
+    if (!ptcache_file_read(pf, &size, 1, sizeof(uint))) {
+      return false;
+    }
+    r_chunk.in_len = size_t(size);
+  }
+  if (r_chunk.in_len > pf->mem_size - pf->mem_pos) {
+    return false;
+  }
+  r_chunk.in = pf->mem + pf->mem_pos;
+  pf->mem_pos += r_chunk.in_len;
+  return true;
+}
+
+static int ptcache_mem_chunk_decode(const PTCacheMemChunk &chunk,
+                                    uchar *result,
+                                    uint items_num,
+                                    uint item_size)
+{
+  if (chunk.compression == PTCACHE_COMPRESS_NO) {
+    memcpy(result, chunk.in, chunk.in_len);
+    return 0;
+  }
+  return ptcache_compressed_decode(
+      chunk.compression, chunk.in, chunk.in_len, result, items_num, item_size);
+}
+
 static int ptcache_file_compressed_read(PTCacheFile *pf,
                                         uchar *result,
                                         uint items_num,
                                         uint item_size)
 {
+  if (pf->mem) {
+    /* Decompress straight from the mapped pack file, no need for a temporary buffer. */
+    PTCacheMemChunk chunk;
+    if (!ptcache_file_mem_chunk_read(pf, items_num, item_size, chunk)) {
+      return 1;
+    }
+    const int r = ptcache_mem_chunk_decode(chunk, result, items_num, item_size);
+    return r || ptcache_pack_io_error(*pf->pack);
+  }
+
   int r = 0;
   size_t in_len;
 
@@ -1528,31 +1922,8 @@ static int ptcache_file_compressed_read(PTCacheFile *pf,
     else {
       uchar *in = MEM_new_array_zeroed<uchar>(in_len, "pointcache_compressed_buffer");
       ptcache_file_read(pf, in, in_len, sizeof(uchar));
-
-      uchar *decomp_result = result;
-      if (compressed == PTCACHE_COMPRESS_ZSTD_FILTERED) {
-        decomp_result = MEM_new_array_uninitialized<uchar>(items_num * item_size,
-                                                           "pointcache_unfilter_buffer");
-      }
-      if (ELEM(compressed,
-               PTCACHE_COMPRESS_ZSTD_FILTERED,
-               PTCACHE_COMPRESS_ZSTD_FAST_DEPRECATED,
-               PTCACHE_COMPRESS_ZSTD_SLOW_DEPRECATED))
-      {
-        const size_t err = ZSTD_decompress(decomp_result, items_num * item_size, in, in_len);
-        r = ZSTD_isError(err);
-      }
-      else {
-        /* We are trying to read an unsupported compression format. */
-        r = 1;
-      }
+      r = ptcache_compressed_decode(compressed, in, in_len, result, items_num, item_size);
       MEM_delete(in);
-
-      /* Un-filter the decompressed data, if needed. */
-      if (compressed == PTCACHE_COMPRESS_ZSTD_FILTERED) {
-        unfilter_transpose_delta(decomp_result, result, items_num, item_size);
-        MEM_delete(decomp_result);
-      }
     }
   }
   else {
@@ -1562,6 +1933,37 @@ static int ptcache_file_compressed_read(PTCacheFile *pf,
   return r;
 }
 
+/**
+ * Read all data arrays of a compressed frame from a packed cache. All array headers are parsed
+ * first, so that the arrays can be decompressed in parallel.
+ */
+static int ptcache_file_mem_compressed_data_read(PTCacheFile *pf, PTCacheMem *pm)
+{
+  PTCacheMemChunk chunks[BPHYS_TOT_DATA];
+  Vector<int, BPHYS_TOT_DATA> data_types;
+  for (int i = 0; i < BPHYS_TOT_DATA; i++) {
+    if (pf->data_types & (1 << i)) {
+      if (!ptcache_file_mem_chunk_read(pf, pm->totpoint, ptcache_data_size[i], chunks[i])) {
+        return 1;
+      }
+      data_types.append(i);
+    }
+  }
+
+  std::atomic<bool> error = false;
+  threading::parallel_for(data_types.index_range(), 1, [&](const IndexRange range) {
+    for (const int i : data_types.as_span().slice(range)) {
+      if (ptcache_mem_chunk_decode(
+              chunks[i], static_cast<uchar *>(pm->data[i]), pm->totpoint, ptcache_data_size[i]))
+      {
+        error = true;
+      }
+    }
+  });
+
+  return error || ptcache_pack_io_error(*pf->pack);
+}
+
 static void ptcache_file_compressed_write(PTCacheFile *pf,
                                           const void *data,
                                           uint items_num,
@@ -1593,6 +1995,15 @@ static void ptcache_file_compressed_write(PTCacheFile *pf,
 
 static bool ptcache_file_read(PTCacheFile *pf, void *f, uint items_num, uint item_size)
 {
+  if (pf->mem) {
+    const size_t size = size_t(items_num) * item_size;
+    if (size > pf->mem_size - pf->mem_pos) {
+      return false;
+    }
+    memcpy(f, pf->mem + pf->mem_pos, size);
+    pf->mem_pos += size;
+    return !ptcache_pack_io_error(*pf->pack);
+  }
   return (fread(f, item_size, items_num, pf->fp) == items_num);
 }
 static int ptcache_file_write(PTCacheFile *pf, const void *data, uint items_num, uint item_size)
@@ -1620,7 +2031,7 @@ static int ptcache_file_header_begin_read(PTCacheFile *pf)
 
   pf->data_types = 0;
 
-  if (fread(bphysics, sizeof(char), 8, pf->fp) != 8) {
+  if (!ptcache_file_read(pf, bphysics, 8, sizeof(char))) {
     error = 1;
   }
 
@@ -1628,7 +2039,7 @@ static int ptcache_file_header_begin_read(PTCacheFile *pf)
     error = 1;
   }
 
-  if (!error && !fread(&typeflag, sizeof(uint), 1, pf->fp)) {
+  if (!error && !ptcache_file_read(pf, &typeflag, 1, sizeof(uint))) {
     error = 1;
   }
 
@@ -1637,7 +2048,12 @@ static int ptcache_file_header_begin_read(PTCacheFile *pf)
 
   /* if there was an error set file as it was */
   if (error) {
-    BLI_fseek(pf->fp, 0, SEEK_SET);
+    if (pf->mem) {
+      pf->mem_pos = 0;
+    }
+    else {
+      BLI_fseek(pf->fp, 0, SEEK_SET);
+    }
   }
 
   return !error;
@@ -1914,7 +2330,10 @@ static PTCacheMem *ptcache_disk_frame_to_mem(PTCacheID *pid, int cfra)
 
     ptcache_data_alloc(pm);
 
-    if (pf->flag & PTCACHE_TYPEFLAG_COMPRESS) {
+    if ((pf->flag & PTCACHE_TYPEFLAG_COMPRESS) && pf->mem) {
+      error = ptcache_file_mem_compressed_data_read(pf, pm);
+    }
+    else if (pf->flag & PTCACHE_TYPEFLAG_COMPRESS) {
       for (i = 0; !error && i < BPHYS_TOT_DATA; i++) {
         if (pf->data_types & (1 << i)) {
           error = ptcache_file_compressed_read(
@@ -2549,6 +2968,18 @@ void BKE_ptcache_id_clear(PTCacheID *pid, int mode, uint cfra)
   }
 #endif
 
+  if ((pid->cache->flag & (PTCACHE_DISK_CACHE | PTCACHE_DISK_PACK)) ==
+      (PTCACHE_DISK_CACHE | PTCACHE_DISK_PACK))
+  {
+    /* Frames are only removed from per-frame files. */
+    if (mode == PTCACHE_CLEAR_ALL) {
+      ptcache_pack_delete(pid);
+    }
+    else if (ptcache_pack_in_use(pid)) {
+      BKE_ptcache_disk_unpack(pid);
+    }
+  }
+
   /* Clear all files in the temp dir with the prefix of the ID and the `.bphys` suffix. */
   switch (mode) {
     case PTCACHE_CLEAR_ALL:
@@ -2685,6 +3116,12 @@ bool BKE_ptcache_id_exist(PTCacheID *pid, int cfra)
   }
 
   if (pid->cache->flag & PTCACHE_DISK_CACHE) {
+    if (ptcache_pack_in_use(pid)) {
+      if (std::shared_ptr<const PTCachePack> pack = ptcache_pack_get(pid)) {
+        return pack->frame_index(cfra) != -1;
+      }
+    }
+
     char filepath[MAX_PTCACHE_FILE];
 
     ptcache_filepath(pid, filepath, cfra, true, true);
@@ -2785,6 +3222,16 @@ void BKE_ptcache_id_time(
         }
       }
       closedir(dir);
+
+      if (ptcache_pack_in_use(pid)) {
+        if (std::shared_ptr<const PTCachePack> pack = ptcache_pack_get(pid)) {
+          for (const PTCachePackFrame &frame : pack->frames) {
+            if (frame.frame >= int(sta) && frame.frame <= int(end)) {
+              cache->cached_frames[frame.frame - sta] = 1;
+            }
+          }
+        }
+      }
     }
     else {
       PTCacheMem *pm = static_cast<PTCacheMem *>(pid->cache->mem_cache.first);
@@ -3295,6 +3742,9 @@ void BKE_ptcache_bake(PTCacheBaker *baker)
         else {
           BKE_ptcache_write(pid, 0);
         }
+        if (cache->flag & PTCACHE_DISK_PACK) {
+          BKE_ptcache_disk_pack(pid);
+        }
       }
     }
   }
@@ -3338,6 +3788,9 @@ void BKE_ptcache_bake(PTCacheBaker *baker)
             else {
               BKE_ptcache_write(&pid, 0);
             }
+            if (cache->flag & PTCACHE_DISK_PACK) {
+              BKE_ptcache_disk_pack(&pid);
+            }
           }
         }
       }
@@ -3406,8 +3859,136 @@ void BKE_ptcache_mem_to_disk(PTCacheID *pid)
   /* write info file */
   if (cache->flag & PTCACHE_BAKED) {
     BKE_ptcache_write(pid, 0);
+    if (cache->flag & PTCACHE_DISK_PACK) {
+      BKE_ptcache_disk_pack(pid);
+    }
+  }
+}
+
+bool BKE_ptcache_disk_pack(PTCacheID *pid)
+{
+  PointCache *cache = pid->cache;
+
+  /* External caches are only read, never modified. */
+  if ((cache->flag & PTCACHE_DISK_CACHE) == 0 || (cache->flag & PTCACHE_EXTERNAL)) {
+    return false;
+  }
+#ifndef DURIAN_POINTCACHE_LIB_OK
+  /* don't allow writing for linked objects */
+  if (pid->owner_id->lib) {
+    return false;
+  }
+#endif
+
+  char pack_filepath[MAX_PTCACHE_FILE];
+  if (ptcache_pack_filepath(pid, pack_filepath) == 0) {
+    return false;
+  }
+
+  const Vector<int> frames = ptcache_disk_frames_list(pid);
+  if (frames.is_empty()) {
+    return false;
+  }
+
+  /* Build the frame table up front, the frame data follows it in the same order. */
+  Array<PTCachePackFrame> table(frames.size());
+  Array<std::string> frame_filepaths(frames.size());
+  uint64_t offset = sizeof(PTCachePackHeader) + table.as_span().size_in_bytes();
+  for (const int i : frames.index_range()) {
+    char filepath[MAX_PTCACHE_FILE];
+    ptcache_filepath(pid, filepath, frames[i], true, true);
+    const size_t size = BLI_file_size(filepath);
+    if (size == size_t(-1) || size > UINT_MAX) {
+      return false;
+    }
+    table[i].frame = frames[i];
+    table[i].size = uint(size);
+    table[i].offset = offset;
+    frame_filepaths[i] = filepath;
+    offset += size;
+  }
+
+  /* Write to a temporary file first, a failure must not leave a broken pack behind. */
+  char tmp_filepath[MAX_PTCACHE_FILE];
+  SNPRINTF(tmp_filepath, "%s.tmp", pack_filepath);
+  FILE *fp = BLI_fopen(tmp_filepath, "wb");
+  if (fp == nullptr) {
+    return false;
+  }
+
+  PTCachePackHeader header;
+  memcpy(header.id, PTCACHE_PACK_ID, sizeof(header.id));
+  header.version = PTCACHE_PACK_VERSION;
+  header.frames_num = uint(table.size());
+  bool ok = fwrite(&header, sizeof(header), 1, fp) == 1 &&
+            fwrite(table.data(), sizeof(PTCachePackFrame), table.size(), fp) == table.size();
+
+  Vector<uchar> buffer;
+  for (const int i : table.index_range()) {
+    if (!ok) {
+      break;
+    }
+    buffer.resize(table[i].size);
+    FILE *frame_fp = BLI_fopen(frame_filepaths[i].c_str(), "rb");
+    ok = frame_fp && fread(buffer.data(), 1, buffer.size(), frame_fp) == buffer.size();
+    if (frame_fp) {
+      fclose(frame_fp);
+    }
+    ok = ok && fwrite(buffer.data(), 1, buffer.size(), fp) == buffer.size();
+  }
+  ok = (fclose(fp) == 0) && ok;
+
+  ptcache_pack_release(pack_filepath);
+  if (!ok || BLI_rename_overwrite(tmp_filepath, pack_filepath) != 0) {
+    CLOG_WARN(&LOG, "Failed to write point cache pack file '%s'", pack_filepath);
+    BLI_delete(tmp_filepath, false, false);
+    return false;
+  }
+
+  for (const std::string &filepath : frame_filepaths) {
+    BLI_delete(filepath.c_str(), false, false);
+  }
+
+  cache->flag |= PTCACHE_FLAG_INFO_DIRTY;
+  return true;
+}
+
+void BKE_ptcache_disk_unpack(PTCacheID *pid)
+{
+#ifndef DURIAN_POINTCACHE_LIB_OK
+  /* don't allow writing for linked objects */
+  if (pid->owner_id->lib) {
+    return;
+  }
+#endif
+
+  char pack_filepath[MAX_PTCACHE_FILE];
+  if (ptcache_pack_filepath(pid, pack_filepath) == 0 || !BLI_exists(pack_filepath)) {
+    return;
+  }
+
+  if (std::shared_ptr<const PTCachePack> pack = ptcache_pack_get(pid)) {
+    for (const PTCachePackFrame &frame : pack->frames) {
+      char filepath[MAX_PTCACHE_FILE];
+      ptcache_filepath(pid, filepath, frame.frame, true, true);
+      FILE *fp = BLI_fopen(filepath, "wb");
+      bool ok = fp && fwrite(pack->data() + frame.offset, 1, frame.size, fp) == frame.size;
+      if (fp) {
+        ok = (fclose(fp) == 0) && ok;
+      }
+      if (!ok || ptcache_pack_io_error(*pack)) {
+        /* Keep the pack file, so that no frames are lost. */
+        CLOG_ERROR(&LOG, "Failed to unpack point cache pack file '%s'", pack_filepath);
+        return;
+      }
+    }
   }
+
+  ptcache_pack_release(pack_filepath);
+  BLI_delete(pack_filepath, false, false);
+  pid->cache->flag |= PTCACHE_FLAG_INFO_DIRTY;
 }
+
 void BKE_ptcache_toggle_disk_cache(PTCacheID *pid)
 {
   PointCache *cache = pid->cache;
@@ -3507,6 +4088,18 @@ void BKE_ptcache_disk_cache_rename(PTCacheID *pid, const char *name_src, const c
   }
   closedir(dir);
 
+  /* A packed cache stores all frames in one file. */
+  char old_pack_filepath[MAX_PTCACHE_FILE];
+  char new_pack_filepath[MAX_PTCACHE_FILE];
+  ptcache_pack_filepath(pid, new_pack_filepath);
+  STRNCPY(pid->cache->name, name_src);
+  ptcache_pack_filepath(pid, old_pack_filepath);
+  if (BLI_exists(old_pack_filepath)) {
+    ptcache_pack_release(old_pack_filepath);
+    ptcache_pack_release(new_pack_filepath);
+    BLI_rename_overwrite(old_pack_filepath, new_pack_filepath);
+  }
+
   STRNCPY(pid->cache->name, old_name);
 }
 
@@ -3568,12 +4161,32 @@ void BKE_ptcache_load_external(PTCacheID *pid)
   }
   closedir(dir);
 
+  /* A packed cache stores all frames in one file. */
+  if (std::shared_ptr<const PTCachePack> pack = ptcache_pack_get(pid)) {
+    for (const PTCachePackFrame &frame : pack->frames) {
+      if (frame.frame) {
+        start = std::min(start, frame.frame);
+        end = std::max(end, frame.frame);
+      }
+      else {
+        info = 1;
+      }
+    }
+    cache->flag |= PTCACHE_DISK_PACK;
+  }
+  else {
+    cache->flag &= ~PTCACHE_DISK_PACK;
+  }
+
   if (start != MAXFRAME) {
     PTCacheFile *pf;
 
     cache->startframe = start;
     cache->endframe = end;
     cache->totpoint = 0;
+    /* Set before reading the first frame, packed frames are only looked up for baked caches. */
+    cache->flag |= (PTCACHE_BAKED | PTCACHE_DISK_CACHE | PTCACHE_SIMULATION_VALID);
+    cache->flag &= ~(PTCACHE_OUTDATED | PTCACHE_FRAMES_SKIPPED);
 
     if (pid->type == PTCACHE_TYPE_SMOKE_DOMAIN) {
       /* necessary info in every file */
@@ -3609,8 +4222,6 @@ void BKE_ptcache_load_external(PTCacheID *pid)
         ptcache_file_close(pf);
       }
     }
-    cache->flag |= (PTCACHE_BAKED | PTCACHE_DISK_CACHE | PTCACHE_SIMULATION_VALID);
-    cache->flag &= ~(PTCACHE_OUTDATED | PTCACHE_FRAMES_SKIPPED);
   }
 
   /* make sure all new frames are loaded */
@@ -0,0 +1,159 @@
+/* SPDX-FileCopyrightText: 2026 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_fileops.hh"
+#include "BLI_path_utils.hh"
+#include "BLI_string.hh"
+
+#include "DNA_object_force_types.h"
+#include "DNA_object_types.h"
+
+#include "BKE_appdir.hh"
+#include "BKE_global.hh"
+#include "BKE_gtest_base.hh"
+#include "BKE_lib_id.hh"
+#include "BKE_main.hh"
+#include "BKE_pointcache.h"
+#include "BKE_softbody.h"
+
+namespace blender::bke::tests {
+
+class PointCacheDiskPackTest : public BlenderGTestBase {
+ protected:
+  static constexpr int points_num = 4;
+  static constexpr int frames_num = 3;
+
+  Main *bmain_ = nullptr;
+  Object *ob_ = nullptr;
+  PTCacheID pid_;
+  char cache_dir_[FILE_MAX];
+
+  void SetUp() override
+  {
+    BKE_tempdir_init(nullptr);
+    bmain_ = BKE_main_new();
+    BLI_path_join(
+        bmain_->filepath, sizeof(bmain_->filepath), BKE_tempdir_session(), "pointcache.blend");
+    G_MAIN = bmain_;
+
+    ob_ = static_cast<Object *>(BKE_id_new(bmain_, ID_OB, "Soft"));
+    ob_->soft = sbNew();
+    SoftBody *sb = ob_->soft;
+    sb->totpoint = points_num;
+    sb->bpoint = MEM_new_array_zeroed<BodyPoint>(points_num, __func__);
+
+    BKE_ptcache_id_from_softbody(&pid_, ob_, sb);
+    pid_.cache->flag |= PTCACHE_DISK_CACHE;
+    BKE_ptcache_path(&pid_, cache_dir_);
+
+    for (int frame = 1; frame <= frames_num; frame++) {
+      this->set_points(frame);
+      EXPECT_EQ(BKE_ptcache_write(&pid_, uint(frame)), 0);
+    }
+  }
+
+  void TearDown() override
+  {
+    BKE_ptcache_id_clear(&pid_, PTCACHE_CLEAR_ALL, 0);
+    BKE_main_free(bmain_);
+    G_MAIN = nullptr;
+    BKE_tempdir_session_purge();
+  }
+
+  void set_points(const int frame)
+  {
+    for (const int i : IndexRange(points_num)) {
+      BodyPoint &bp = ob_->soft->bpoint[i];
+      bp.pos[0] = float(frame);
+      bp.pos[1] = float(i);
+      bp.pos[2] = float(frame * 10 + i);
+      bp.vec[0] = float(-frame);
+      bp.vec[1] = 0.0f;
+      bp.vec[2] = float(i);
+    }
+  }
+
+  void expect_frame(const int frame)
+  {
+    this->set_points(0);
+    EXPECT_EQ(BKE_ptcache_read(&pid_, float(frame), false), PTCACHE_READ_EXACT);
+    for (const int i : IndexRange(points_num)) {
+      const BodyPoint &bp = ob_->soft->bpoint[i];
+      EXPECT_EQ(bp.pos[0], float(frame));
+      EXPECT_EQ(bp.pos[1], float(i));
+      EXPECT_EQ(bp.pos[2], float(frame * 10 + i));
+      EXPECT_EQ(bp.vec[0], float(-frame));
+      EXPECT_EQ(bp.vec[2], float(i));
+    }
+  }
+
+  /** Number of per-frame files in the cache directory, ignoring the pack file. */
+  int frame_files_num() const
+  {
+    direntry *entries;
+    const uint entries_num = BLI_filelist_dir_contents(cache_dir_, &entries);
+    int files_num = 0;
+    for (const uint i : IndexRange(entries_num)) {
+      if (BLI_path_extension_check(entries[i].relname, PTCACHE_EXT)) {
+        files_num++;
+      }
+    }
+    BLI_filelist_free(entries, entries_num);
+    return files_num;
+  }
+
+  void bake_and_pack()
+  {
+    pid_.cache->flag |= PTCACHE_BAKED | PTCACHE_DISK_PACK;
+    EXPECT_TRUE(BKE_ptcache_disk_pack(&pid_));
+  }
+};
+
+TEST_F(PointCacheDiskPackTest, pack_unpack)
+{
+  EXPECT_EQ(this->frame_files_num(), frames_num);
+
+  this->bake_and_pack();
+  EXPECT_EQ(this->frame_files_num(), 0);
+  for (int frame = 1; frame <= frames_num; frame++) {
+    EXPECT_TRUE(BKE_ptcache_id_exist(&pid_, frame));
+    this->expect_frame(frame);
+  }
+
+  BKE_ptcache_disk_unpack(&pid_);
+  pid_.cache->flag &= ~(PTCACHE_BAKED | PTCACHE_DISK_PACK);
+  EXPECT_EQ(this->frame_files_num(), frames_num);
+  for (int frame = 1; frame <= frames_num; frame++) {
+    EXPECT_TRUE(BKE_ptcache_id_exist(&pid_, frame));
+    this->expect_frame(frame);
+  }
+}
+
+TEST_F(PointCacheDiskPackTest, clear_frame_unpacks)
+{
+  this->bake_and_pack();
+
+  /* Removing a single frame has to restore the others as per-frame files. */
+  BKE_ptcache_id_clear(&pid_, PTCACHE_CLEAR_FRAME, 2);
+  EXPECT_EQ(this->frame_files_num(), frames_num - 1);
+  EXPECT_TRUE(BKE_ptcache_id_exist(&pid_, 1));
+  EXPECT_FALSE(BKE_ptcache_id_exist(&pid_, 2));
+  EXPECT_TRUE(BKE_ptcache_id_exist(&pid_, 3));
+  this->expect_frame(3);
+}
+
+TEST_F(PointCacheDiskPackTest, clear_frame_not_baked)
+{
+  this->bake_and_pack();
+  pid_.cache->flag &= ~PTCACHE_BAKED;
+
+  /* The pack file is not in use without a bake, clearing a frame must leave it alone. */
+  BKE_ptcache_id_clear(&pid_, PTCACHE_CLEAR_FRAME, 2);
+  EXPECT_EQ(this->frame_files_num(), 0);
+}
+
+}  // namespace blender::bke::tests
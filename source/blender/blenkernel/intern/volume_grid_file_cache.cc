@@ -208,7 +208,7 @@ static LazyLoadedGrid load_single_grid_from_disk_cached(const StringRef file_pat
   key.grid_name = grid_name;
   key.simplify_level = simplify_level;
 
-  std::shared_ptr<const GridReadValue> value = memory_cache::get<GridReadValue>(key, [&key]() {
+  const auto load_fn = [&key]() {
     openvdb::GridBase::Ptr grid;
     if (key.simplify_level == 0) {
       grid = load_single_grid_from_disk(key.file_path, key.grid_name);
@@ -226,7 +226,9 @@ static LazyLoadedGrid load_single_grid_from_disk_cached(const StringRef file_pat
     value->grid = std::move(grid);
     value->tree_sharing_info = OpenvdbTreeSharingInfo::make(value->grid->baseTreePtr());
     return value;
-  });
+  };
+  std::shared_ptr<const GridReadValue> value = memory_cache::get<GridReadValue>(
+      key, load_fn, memory_cache::Category::VolumeGrids);
   if (!value) {
     return {};
   }
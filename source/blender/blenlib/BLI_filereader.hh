@@ -55,8 +55,15 @@ FileReader *BLI_filereader_new_mmap(int filedes) ATTR_WARN_UNUSED_RESULT;
 /** Create #FileReader from a region of memory. */
 FileReader *BLI_filereader_new_memory(const void *data, size_t len) ATTR_WARN_UNUSED_RESULT
     ATTR_NONNULL();
-/** Create #FileReader from applying `Zstd` decompression on an underlying file. */
-FileReader *BLI_filereader_new_zstd(FileReader *base) ATTR_WARN_UNUSED_RESULT ATTR_NONNULL();
+/**
+ * Create #FileReader from applying `Zstd` decompression on an underlying file.
+ *
+ * \param use_read_ahead: For seekable files (as written by Blender), decompress the frames that
+ * follow the current read position on worker threads while the data is read sequentially.
+ * Only a limited number of frames are kept in flight.
+ */
+FileReader *BLI_filereader_new_zstd(FileReader *base, bool use_read_ahead = false)
+    ATTR_WARN_UNUSED_RESULT ATTR_NONNULL();
 /** Create #FileReader from applying `Gzip` decompression on an underlying file. */
 FileReader *BLI_filereader_new_gzip(FileReader *base) ATTR_WARN_UNUSED_RESULT ATTR_NONNULL();
 
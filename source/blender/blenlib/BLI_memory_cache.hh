@@ -11,9 +11,24 @@
 #include "BLI_function_ref.hh"
 #include "BLI_generic_key.hh"
 #include "BLI_memory_counter_fwd.hh"
+#include "BLI_string_ref.hh"
 
 namespace blender::memory_cache {
 
+/**
+ * Every cached value belongs to a category. Categories have separate statistics and can have their
+ * own memory budget in addition to the limit of the entire cache.
+ */
+enum class Category : int8_t {
+  Generic,
+  VolumeGrids,
+  FileLoads,
+};
+constexpr int CATEGORIES_NUM = 3;
+
+/** Identifier of the category, e.g. for use in the Python API. */
+StringRefNull category_name(Category category);
+
 /**
  * A value that is stored in the cache. It may be freed automatically when the cache is full. This
  * is expected to be subclassed by users of the memory cache.
@@ -36,13 +51,16 @@ class CachedValue {
  * If the cache is full, older values may be freed.
  */
 template<typename T>
-std::shared_ptr<const T> get(const GenericKey &key, FunctionRef<std::unique_ptr<T>()> compute_fn);
+std::shared_ptr<const T> get(const GenericKey &key,
+                             FunctionRef<std::unique_ptr<T>()> compute_fn,
+                             Category category = Category::Generic);
 
 /**
  * A non-templated version of the main entry point above.
  */
 std::shared_ptr<CachedValue> get_base(const GenericKey &key,
-                                      FunctionRef<std::unique_ptr<CachedValue>()> compute_fn);
+                                      FunctionRef<std::unique_ptr<CachedValue>()> compute_fn,
+                                      Category category = Category::Generic);
 
 /**
  * Set how much memory the cache is allowed to use. This is only an approximation because counting
@@ -50,6 +68,35 @@ std::shared_ptr<CachedValue> get_base(const GenericKey &key,
  */
 void set_approximate_size_limit(int64_t limit_in_bytes);
 
+/**
+ * Set how much memory values of the given category are allowed to use. Zero means that the
+ * category is only limited by the size limit of the entire cache.
+ */
+void set_approximate_size_limit(Category category, int64_t limit_in_bytes);
+
+struct CategoryStatistics {
+  /** Number of times a value was found in the cache. */
+  int64_t hits = 0;
+  /** Number of times a value had to be computed. */
+  int64_t misses = 0;
+  /** Number of values that were freed because a size limit was exceeded. */
+  int64_t evictions = 0;
+  /** Number of values currently in the cache. */
+  int64_t values_num = 0;
+  /** Approximate memory used by the values currently in the cache. */
+  int64_t size_in_bytes = 0;
+  /** Size limit of the category, zero if there is none. */
+  int64_t size_limit = 0;
+  /** Total time in seconds spent computing values on cache misses. */
+  double compute_time = 0.0;
+};
+
+/**
+ * Get statistics about the usage of the cache for one category. The counters are gathered without
+ * locking, so they may be slightly out of date when the cache is used concurrently.
+ */
+CategoryStatistics get_statistics(Category category);
+
 /**
  * Remove all elements from the cache. Note that this does not guarantee that no elements are in
  * the cache after the function returned. This is because another thread may have added a new
@@ -70,9 +117,10 @@ void remove_if(FunctionRef<bool(const GenericKey &)> predicate);
 
 template<typename T>
 inline std::shared_ptr<const T> get(const GenericKey &key,
-                                    FunctionRef<std::unique_ptr<T>()> compute_fn)
+                                    FunctionRef<std::unique_ptr<T>()> compute_fn,
+                                    const Category category)
 {
-  return std::dynamic_pointer_cast<const T>(get_base(key, compute_fn));
+  return std::dynamic_pointer_cast<const T>(get_base(key, compute_fn, category));
 }
 
 /** \} */
@@ -10,6 +10,7 @@
 
 #include "BLI_function_ref.hh"
 #include "BLI_implicit_sharing_ptr.hh"
+#include "BLI_map.hh"
 #include "BLI_memory_counter_fwd.hh"
 #include "BLI_set.hh"
 
@@ -27,6 +28,14 @@ class MemoryCount {
   int64_t total_bytes = 0;
 
   Set<WeakImplicitSharingPtr> handled_shared_data;
+  /**
+   * Bytes counted for each data in #handled_shared_data, not including the shared data that is
+   * nested in it. This allows users to count the same shared data only once across multiple
+   * counts, e.g. when data is shared between different values in a cache.
+   */
+  Map<const ImplicitSharingInfo *, int64_t> shared_data_bytes;
+  /** Sum of all #shared_data_bytes, the remaining #total_bytes are uniquely owned. */
+  int64_t shared_bytes = 0;
 
   void reset();
 };
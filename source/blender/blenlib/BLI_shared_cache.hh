@@ -85,6 +85,19 @@ template<typename T> class SharedCache {
     cache_->mutex.ensure([&]() { compute_cache(this->cache_->data); });
   }
 
+  /**
+   * Access the data to move it elsewhere, e.g. to reuse it for another cache once this one is
+   * freed. This is only possible when there are no other users, otherwise null is returned. The
+   * data may be outdated if the cache is dirty.
+   */
+  T *data_if_unshared()
+  {
+    if (cache_.use_count() == 1) {
+      return &cache_->data;
+    }
+    return nullptr;
+  }
+
   /** Retrieve the cached data. */
   const T &data() const
   {
@@ -7,16 +7,66 @@
  */
 
 #include <algorithm>
+#include <atomic>
+#include <condition_variable>
 #include <cstring>
 #include <zstd.h>
 
+#include "BLI_array.hh"
 #include "BLI_fileops.hh"
 #include "BLI_filereader.hh"
+#include "BLI_task_c.hh"
+#include "BLI_threads.hh"
 
 #include "MEM_guardedalloc.h"
 
 namespace blender {
 
+/** Upper bound for the number of frames decompressed ahead of the consumer. */
+#define ZSTD_READ_AHEAD_FRAMES_MAX 16
+
+/**
+ * A frame that is decompressed on a worker thread ahead of the consumer.
+ *
+ * Slots are owned by the reader and reused in a ring (frame `i` always uses slot
+ * `i % slots.size()`), so that the memory held by in-flight frames stays bounded.
+ * Whichever thread manages to switch the state from #PENDING to #RUNNING decompresses the frame,
+ * this may also be the consumer itself if no worker got to it yet.
+ */
+struct ZstdReadAheadSlot {
+  enum State {
+    /** Slot is unused, or its frame has been cancelled. */
+    IDLE = 0,
+    /** A task has been pushed for this slot, but no thread has started decompressing it yet. */
+    PENDING,
+    /** A thread is decompressing the frame. */
+    RUNNING,
+    /** The frame has been decompressed (or failed to, in which case `data` is null). */
+    DONE,
+  };
+  std::atomic<int> state = IDLE;
+
+  int frame = -1;
+  char *data = nullptr;
+
+  /** Only used by the thread that owns the #RUNNING state. */
+  ZSTD_DCtx *ctx = nullptr;
+};
+
+/** State for decompressing frames of seekable files on worker threads. */
+struct ZstdReadAhead {
+  TaskPool *pool = nullptr;
+  Array<ZstdReadAheadSlot> slots;
+
+  /** Protects access to the base reader, which is shared between the consumer and the workers. */
+  std::mutex base_mutex;
+  /** Signaled whenever a slot reaches the #ZstdReadAheadSlot::DONE state. */
+  std::mutex done_mutex;
+  std::condition_variable done_cond;
+
+  ZstdReadAhead(const int slots_num) : slots(slots_num) {}
+};
+
 struct ZstdReader {
   FileReader reader;
 
@@ -34,6 +84,9 @@ struct ZstdReader {
     char *cached_content;
     int cached_frame;
   } seek;
+
+  /** Only set for seekable files when read-ahead is enabled, see #BLI_filereader_new_zstd. */
+  ZstdReadAhead *read_ahead;
 };
 
 static bool zstd_read_u32(FileReader *base, uint32_t *val)
@@ -155,38 +208,179 @@ static int zstd_frame_from_pos(ZstdReader *zstd, size_t pos)
   return low;
 }
 
-/* Ensure that the currently loaded frame is the correct one. */
-static const char *zstd_ensure_cache(ZstdReader *zstd, int frame)
+/**
+ * Read and decompress the given frame into a newly allocated buffer.
+ * \return null on failure.
+ */
+static char *zstd_decompress_frame(ZstdReader *zstd, ZSTD_DCtx *ctx, int frame)
 {
-  if (zstd->seek.cached_frame == frame) {
-    /* Cached frame matches, so just return it. */
-    return zstd->seek.cached_content;
-  }
-
-  /* Cached frame doesn't match, so discard it and cache the wanted one instead. */
-  MEM_SAFE_DELETE(zstd->seek.cached_content);
-
   size_t compressed_size = zstd->seek.compressed_ofs[frame + 1] - zstd->seek.compressed_ofs[frame];
   size_t uncompressed_size = zstd->seek.uncompressed_ofs[frame + 1] -
                              zstd->seek.uncompressed_ofs[frame];
 
   char *uncompressed_data = MEM_new_array_uninitialized<char>(uncompressed_size, __func__);
   char *compressed_data = MEM_new_array_uninitialized<char>(compressed_size, __func__);
-  if (zstd->base->seek(zstd->base, zstd->seek.compressed_ofs[frame], SEEK_SET) < 0 ||
-      zstd->base->read(zstd->base, compressed_data, compressed_size) < compressed_size)
+  bool read_ok;
   {
+    std::unique_lock<std::mutex> lock;
+    if (zstd->read_ahead) {
+      lock = std::unique_lock(zstd->read_ahead->base_mutex);
+    }
+    read_ok = zstd->base->seek(zstd->base, zstd->seek.compressed_ofs[frame], SEEK_SET) >= 0 &&
+              zstd->base->read(zstd->base, compressed_data, compressed_size) >= compressed_size;
+  }
+  if (!read_ok) {
     MEM_delete(compressed_data);
     MEM_delete(uncompressed_data);
     return nullptr;
   }
 
   size_t res = ZSTD_decompressDCtx(
-      zstd->ctx, uncompressed_data, uncompressed_size, compressed_data, compressed_size);
+      ctx, uncompressed_data, uncompressed_size, compressed_data, compressed_size);
   MEM_delete(compressed_data);
   if (ZSTD_isError(res) || res < uncompressed_size) {
     MEM_delete(uncompressed_data);
     return nullptr;
   }
+  return uncompressed_data;
+}
+
+/** Decompress the frame of a slot, the caller must have switched it to the running state. */
+static void zstd_read_ahead_slot_run(ZstdReader *zstd, ZstdReadAheadSlot *slot)
+{
+  if (slot->ctx == nullptr) {
+    slot->ctx = ZSTD_createDCtx();
+  }
+  slot->data = zstd_decompress_frame(zstd, slot->ctx, slot->frame);
+  {
+    std::lock_guard lock(zstd->read_ahead->done_mutex);
+    slot->state = ZstdReadAheadSlot::DONE;
+  }
+  zstd->read_ahead->done_cond.notify_all();
+}
+
+static void zstd_read_ahead_task_run(TaskPool *pool, void *taskdata)
+{
+  ZstdReader *zstd = static_cast<ZstdReader *>(BLI_task_pool_user_data(pool));
+  ZstdReadAheadSlot *slot = static_cast<ZstdReadAheadSlot *>(taskdata);
+
+  int expected = ZstdReadAheadSlot::PENDING;
+  if (!slot->state.compare_exchange_strong(expected, ZstdReadAheadSlot::RUNNING)) {
+    /* The frame was cancelled, or the consumer already took care of it. Note that the slot may
+     * have been reused for another frame in the meantime, in which case running it here is still
+     * correct: its own task will find it already running or done and skip it. */
+    return;
+  }
+  zstd_read_ahead_slot_run(zstd, slot);
+}
+
+/**
+ * Wait until the slot is not used by any thread anymore.
+ * \return True if the slot holds the result of its frame (which may still be null on failure).
+ */
+static bool zstd_read_ahead_slot_finish(ZstdReader *zstd, ZstdReadAheadSlot *slot, bool cancel)
+{
+  int expected = ZstdReadAheadSlot::PENDING;
+  if (slot->state.compare_exchange_strong(expected,
+                                          cancel ? ZstdReadAheadSlot::IDLE :
+                                                   ZstdReadAheadSlot::RUNNING))
+  {
+    if (cancel) {
+      return false;
+    }
+    /* No worker got to this frame yet, decompress it on the calling thread instead of waiting. */
+    zstd_read_ahead_slot_run(zstd, slot);
+    return true;
+  }
+  if (expected == ZstdReadAheadSlot::IDLE) {
+    return false;
+  }
+  if (expected == ZstdReadAheadSlot::RUNNING) {
+    std::unique_lock lock(zstd->read_ahead->done_mutex);
+    zstd->read_ahead->done_cond.wait(
+        lock, [&]() { return slot->state.load() == ZstdReadAheadSlot::DONE; });
+  }
+  return true;
+}
+
+/** Free the slot's data, waiting for or cancelling its frame first. */
+static void zstd_read_ahead_slot_release(ZstdReader *zstd, ZstdReadAheadSlot *slot)
+{
+  if (zstd_read_ahead_slot_finish(zstd, slot, true)) {
+    MEM_SAFE_DELETE(slot->data);
+  }
+  slot->state = ZstdReadAheadSlot::IDLE;
+}
+
+/**
+ * Queue decompression of the frames following the given one, reusing the slots of frames that
+ * are not needed anymore.
+ */
+static void zstd_read_ahead_schedule(ZstdReader *zstd, int frame)
+{
+  MutableSpan<ZstdReadAheadSlot> slots = zstd->read_ahead->slots;
+  const int slots_num = int(slots.size());
+  const int last_frame = std::min(frame + slots_num - 1, zstd->seek.frames_num - 1);
+  for (int i = frame + 1; i <= last_frame; i++) {
+    ZstdReadAheadSlot *slot = &slots[i % slots_num];
+    if (slot->frame == i && slot->state != ZstdReadAheadSlot::IDLE) {
+      /* Already queued or decompressed. */
+      continue;
+    }
+    zstd_read_ahead_slot_release(zstd, slot);
+    slot->frame = i;
+    slot->state = ZstdReadAheadSlot::PENDING;
+    BLI_task_pool_push(zstd->read_ahead->pool, zstd_read_ahead_task_run, slot, false, nullptr);
+  }
+}
+
+/**
+ * Get the decompressed data of the frame from its read-ahead slot, if it was queued.
+ * Ownership of the data is transferred to the caller.
+ */
+static bool zstd_read_ahead_take(ZstdReader *zstd, int frame, char **r_data)
+{
+  MutableSpan<ZstdReadAheadSlot> slots = zstd->read_ahead->slots;
+  ZstdReadAheadSlot *slot = &slots[frame % slots.size()];
+  if (slot->frame != frame || !zstd_read_ahead_slot_finish(zstd, slot, false)) {
+    return false;
+  }
+  *r_data = slot->data;
+  slot->data = nullptr;
+  slot->state = ZstdReadAheadSlot::IDLE;
+  return true;
+}
+
+/* Ensure that the currently loaded frame is the correct one. */
+static const char *zstd_ensure_cache(ZstdReader *zstd, int frame)
+{
+  if (zstd->seek.cached_frame == frame) {
+    /* Cached frame matches, so just return it. */
+    return zstd->seek.cached_content;
+  }
+
+  /* Cached frame doesn't match, so discard it and cache the wanted one instead. */
+  MEM_SAFE_DELETE(zstd->seek.cached_content);
+
+  char *uncompressed_data = nullptr;
+  if (zstd->read_ahead) {
+    /* Only read ahead when the file is read sequentially, random access would mostly waste the
+     * decompressed frames. */
+    const bool is_sequential = ELEM(zstd->seek.cached_frame, -1, frame - 1);
+    if (!zstd_read_ahead_take(zstd, frame, &uncompressed_data)) {
+      uncompressed_data = zstd_decompress_frame(zstd, zstd->ctx, frame);
+    }
+    if (is_sequential) {
+      zstd_read_ahead_schedule(zstd, frame);
+    }
+  }
+  else {
+    uncompressed_data = zstd_decompress_frame(zstd, zstd->ctx, frame);
+  }
+  if (uncompressed_data == nullptr) {
+    zstd->seek.cached_frame = -1;
+    return nullptr;
+  }
 
   zstd->seek.cached_frame = frame;
   zstd->seek.cached_content = uncompressed_data;
@@ -279,6 +473,21 @@ static void zstd_close(FileReader *reader)
 {
   ZstdReader *zstd = reinterpret_cast<ZstdReader *>(reader);
 
+  if (zstd->read_ahead) {
+    for (ZstdReadAheadSlot &slot : zstd->read_ahead->slots) {
+      zstd_read_ahead_slot_release(zstd, &slot);
+    }
+    /* All slots are idle now, so remaining tasks return immediately. */
+    BLI_task_pool_work_and_wait(zstd->read_ahead->pool);
+    BLI_task_pool_free(zstd->read_ahead->pool);
+    for (ZstdReadAheadSlot &slot : zstd->read_ahead->slots) {
+      if (slot.ctx) {
+        ZSTD_freeDCtx(slot.ctx);
+      }
+    }
+    MEM_delete(zstd->read_ahead);
+  }
+
   ZSTD_freeDCtx(zstd->ctx);
   if (zstd->reader.seek) {
     MEM_delete(zstd->seek.uncompressed_ofs);
@@ -296,7 +505,7 @@ static void zstd_close(FileReader *reader)
   MEM_delete(zstd);
 }
 
-FileReader *BLI_filereader_new_zstd(FileReader *base)
+FileReader *BLI_filereader_new_zstd(FileReader *base, const bool use_read_ahead)
 {
   ZstdReader *zstd = MEM_new_zeroed<ZstdReader>(__func__);
 
@@ -306,6 +515,14 @@ FileReader *BLI_filereader_new_zstd(FileReader *base)
   if (zstd_read_seek_table(zstd)) {
     zstd->reader.read = zstd_read_seekable;
     zstd->reader.seek = zstd_seek;
+
+    /* Keep roughly one frame in flight per worker thread. The consumer holds one more frame in
+     * `seek.cached_content`, so a single thread gains nothing from reading ahead. */
+    const int slots_num = std::min(BLI_system_thread_count() + 1, ZSTD_READ_AHEAD_FRAMES_MAX);
+    if (use_read_ahead && slots_num > 2 && zstd->seek.frames_num > 1) {
+      zstd->read_ahead = MEM_new<ZstdReadAhead>(__func__, slots_num);
+      zstd->read_ahead->pool = BLI_task_pool_create_background(zstd, TASK_PRIORITY_HIGH);
+    }
   }
   else {
     zstd->reader.read = zstd_read;
@@ -4,15 +4,36 @@
 
 /** \file
  * \ingroup bli
+ *
+ * The cache is split into shards based on the hash of the key. Every shard has its own map, mutex
+ * and counters, so that concurrent lookups and insertions from many threads rarely touch the same
+ * data. Only enforcing the size limits needs a consistent view of all shards.
+ *
+ * Eviction uses a "GreedyDual-Size" policy: every value has a priority that is refreshed whenever
+ * it is used. The priority is the current base priority plus the time it took to compute the value
+ * divided by its size. Values with the lowest priority are freed first, and the base priority is
+ * raised to the priority of the last freed value. That way, values that are cheap to recompute
+ * relative to their size are freed earlier, while values that have not been used for a long time
+ * eventually fall behind the rising base priority and are freed as well.
+ *
+ * Data that is implicitly shared between multiple cached values (e.g. the same volume tree used by
+ * different grids) is counted only once for the entire cache. It is tracked by its
+ * #ImplicitSharingInfo, and its memory is only considered freed once the last cached value using
+ * it is removed.
  */
 
+#include <array>
 #include <atomic>
-#include <optional>
+#include <mutex>
 
+#include "BLI_array.hh"
 #include "BLI_concurrent_map.hh"
+#include "BLI_implicit_sharing_ptr.hh"
+#include "BLI_map.hh"
 #include "BLI_memory_cache.hh"
 #include "BLI_memory_counter.hh"
 #include "BLI_mutex.hh"
+#include "BLI_time.hh"
 
 namespace blender::memory_cache {
 
@@ -28,29 +49,83 @@ struct StoredValue {
   std::shared_ptr<CachedValue> value;
   /** A logical time that indicates when the value was last used. Lower values are older. */
   int64_t last_use_time = 0;
+  /** Values with a lower priority are freed first. It's refreshed whenever the value is used. */
+  double priority = 0.0;
+  /** Time in seconds it took to compute the value. */
+  double compute_time = 0.0;
+  /**
+   * Memory used by the value including all the shared data it references, counted when it was
+   * added to the cache.
+   */
+  int64_t size_in_bytes = 0;
+  /** Part of #size_in_bytes that is not shared. */
+  int64_t owned_size_in_bytes = 0;
+  /** Shared data used by the value. Its memory is counted in #Cache::shared_data. */
+  Vector<const ImplicitSharingInfo *> shared_data;
+  Category category = Category::Generic;
 };
 
 using CacheMap = ConcurrentMap<std::reference_wrapper<const GenericKey>, StoredValue>;
 
-struct Cache {
-  CacheMap map;
+struct CategoryCounters {
+  std::atomic<int64_t> hits = 0;
+  std::atomic<int64_t> misses = 0;
+  std::atomic<int64_t> evictions = 0;
+  std::atomic<int64_t> compute_time_ns = 0;
+  /** These are only modified while the mutex of the shard is locked. */
+  std::atomic<int64_t> values_num = 0;
+  /** Memory of the values that is not shared, see #Cache::shared_data_sizes for the rest. */
+  std::atomic<int64_t> size_in_bytes = 0;
+};
+
+/** Data that is shared between one or more cached values. */
+struct SharedData {
+  int64_t size_in_bytes = 0;
+  /** Number of cached values using the data. */
+  int users = 0;
+  /** Category of the value that added the data first. */
+  Category category = Category::Generic;
+};
 
+struct CacheShard {
+  CacheMap map;
   std::atomic<int64_t> logical_time = 0;
+
+  Mutex mutex;
+  /**
+   * Keys currently cached in this shard. This is stored separately from the map, because the map
+   * does not allow thread-safe iteration.
+   */
+  Vector<const GenericKey *> keys;
+  std::array<CategoryCounters, CATEGORIES_NUM> counters;
+};
+
+/** Should be large enough to make contention between threads unlikely. */
+static constexpr int SHARDS_NUM = 16;
+
+struct Cache {
+  std::array<CacheShard, SHARDS_NUM> shards;
+
   std::atomic<int64_t> approximate_limit = 1024 * 1024 * 1024;
+  /** Zero means that the category is only limited by the limit of the entire cache. */
+  std::array<std::atomic<int64_t>, CATEGORIES_NUM> category_limits = {};
   /**
-   * This is derived from `memory` below, but is atomic for safe access when the global mutex is
-   * not locked.
+   * Priority of the most recently freed value. New and used values get a priority that is larger,
+   * which makes values that have not been used for a while more likely to be freed.
    */
-  std::atomic<int64_t> size_in_bytes = 0;
+  std::atomic<double> base_priority = 0.0;
+  /** Makes sure that only one thread at a time frees values to stay within the limits. */
+  Mutex enforce_limits_mutex;
 
-  Mutex global_mutex;
-  /** Amount of memory currently used in the cache. */
-  MemoryCount memory;
   /**
-   * Keys currently cached. This is stored separately from the map, because the map does not allow
-   * thread-safe iteration.
+   * All data shared by the cached values. The weak users make sure that the #ImplicitSharingInfo
+   * is not reused for different data while it is in the map.
    */
-  Vector<const GenericKey *> keys;
+  Map<WeakImplicitSharingPtr, SharedData> shared_data;
+  /** Total memory of the shared data per category. */
+  std::array<std::atomic<int64_t>, CATEGORIES_NUM> shared_data_sizes = {};
+  /** Protects #shared_data. It may be locked while a shard is locked, but not the other way. */
+  Mutex shared_data_mutex;
 };
 
 static Cache &get_cache()
@@ -59,73 +134,176 @@ static Cache &get_cache()
   return cache;
 }
 
-static void try_enforce_limit();
+static void try_enforce_limits();
 
-static void set_new_logical_time(const StoredValue &stored_value, const int64_t new_time)
+StringRefNull category_name(const Category category)
+{
+  switch (category) {
+    case Category::Generic:
+      return "GENERIC";
+    case Category::VolumeGrids:
+      return "VOLUME_GRIDS";
+    case Category::FileLoads:
+      return "FILE_LOADS";
+  }
+  BLI_assert_unreachable();
+  return "";
+}
+
+static CacheShard &get_shard(Cache &cache, const GenericKey &key)
+{
+  /* Use the high bits, because the low bits are used to find the bucket within the map. */
+  const uint64_t hash = key.hash();
+  return cache.shards[(hash ^ (hash >> 32)) % SHARDS_NUM];
+}
+
+static double compute_priority(const Cache &cache,
+                               const double compute_time,
+                               const int64_t size_in_bytes)
+{
+  /* Use the cost per megabyte to avoid very small numbers. */
+  const double size_in_mb = std::max<int64_t>(size_in_bytes, 1) / (1024.0 * 1024.0);
+  return cache.base_priority.load(std::memory_order_relaxed) + compute_time / size_in_mb;
+}
+
+static void add_shared_data_users(Cache &cache,
+                                  const MemoryCount &memory,
+                                  const Category category)
+{
+  std::lock_guard lock{cache.shared_data_mutex};
+  for (const auto item : memory.shared_data_bytes.items()) {
+    SharedData &shared_data = cache.shared_data.lookup_or_add_cb_as(item.key, [&]() {
+      item.key->add_weak_user();
+      cache.shared_data_sizes[int(category)].fetch_add(item.value, std::memory_order_relaxed);
+      return SharedData{item.value, 0, category};
+    });
+    shared_data.users++;
+  }
+}
+
+/**
+ * Remove the shared data users of a value that is removed from the cache.
+ * \return Amount of shared memory that is not used by any cached value anymore.
+ */
+static int64_t remove_shared_data_users(Cache &cache, const StoredValue &stored_value)
+{
+  if (stored_value.shared_data.is_empty()) {
+    return 0;
+  }
+  int64_t freed_size = 0;
+  std::lock_guard lock{cache.shared_data_mutex};
+  for (const ImplicitSharingInfo *sharing_info : stored_value.shared_data) {
+    SharedData &shared_data = cache.shared_data.lookup_as(sharing_info);
+    shared_data.users--;
+    if (shared_data.users > 0) {
+      continue;
+    }
+    cache.shared_data_sizes[int(shared_data.category)].fetch_sub(shared_data.size_in_bytes,
+                                                                  std::memory_order_relaxed);
+    freed_size += shared_data.size_in_bytes;
+    cache.shared_data.remove_as(sharing_info);
+  }
+  return freed_size;
+}
+
+static void touch_stored_value(const Cache &cache,
+                               const StoredValue &stored_value,
+                               const int64_t new_time)
 {
   /* Don't want to use `std::atomic` directly in the struct, because that makes it
    * non-movable. Could also use a non-const accessor, but that may degrade performance more.
-   * It's not necessary for correctness that the time is exactly the right value. */
+   * It's not necessary for correctness that the time and priority are exactly the right values. */
   reinterpret_cast<std::atomic<int64_t> *>(const_cast<int64_t *>(&stored_value.last_use_time))
       ->store(new_time, std::memory_order_relaxed);
   static_assert(sizeof(int64_t) == sizeof(std::atomic<int64_t>));
+  const double new_priority = compute_priority(
+      cache, stored_value.compute_time, stored_value.size_in_bytes);
+  reinterpret_cast<std::atomic<double> *>(const_cast<double *>(&stored_value.priority))
+      ->store(new_priority, std::memory_order_relaxed);
+  static_assert(sizeof(double) == sizeof(std::atomic<double>));
 }
 
 std::shared_ptr<CachedValue> get_base(const GenericKey &key,
-                                      const FunctionRef<std::unique_ptr<CachedValue>()> compute_fn)
+                                      const FunctionRef<std::unique_ptr<CachedValue>()> compute_fn,
+                                      const Category category)
 {
   Cache &cache = get_cache();
+  CacheShard &shard = get_shard(cache, key);
   /* "Touch" the cached value so that we know that it is still used. This makes it less likely that
    * it is removed. */
-  const int64_t new_time = cache.logical_time.fetch_add(1, std::memory_order_relaxed);
+  const int64_t new_time = shard.logical_time.fetch_add(1, std::memory_order_relaxed);
   {
     /* Fast path when the value is already cached. */
     CacheMap::ConstAccessor accessor;
-    if (cache.map.lookup(accessor, std::ref(key))) {
-      set_new_logical_time(accessor->second, new_time);
-      return accessor->second.value;
+    if (shard.map.lookup(accessor, std::ref(key))) {
+      const StoredValue &stored_value = accessor->second;
+      touch_stored_value(cache, stored_value, new_time);
+      shard.counters[int(stored_value.category)].hits.fetch_add(1, std::memory_order_relaxed);
+      return stored_value.value;
     }
   }
+  CategoryCounters &counters = shard.counters[int(category)];
+  counters.misses.fetch_add(1, std::memory_order_relaxed);
 
   /* Compute value while no locks are held to avoid potential for dead-locks. Not using a lock also
    * means that the value may be computed more than once, but that's still better than locking all
    * the time. It may be possible to implement something smarter in the future. */
+  const double start_time = BLI_time_now_seconds();
   std::shared_ptr<CachedValue> result = compute_fn();
+  const double compute_time = BLI_time_now_seconds() - start_time;
+  counters.compute_time_ns.fetch_add(int64_t(compute_time * 1e9), std::memory_order_relaxed);
   /* Result should be valid. Use exception to propagate error if necessary. */
   BLI_assert(result);
 
+  /* The value is not shared with other threads yet, so its memory can be counted without locks.
+   * Shared data is only added to the size of the cache if no other cached value uses it already,
+   * see #add_shared_data_users. */
+  MemoryCount memory;
+  {
+    MemoryCounter memory_counter{memory};
+    result->count_memory(memory_counter);
+  }
+
   {
     CacheMap::MutableAccessor accessor;
-    const bool newly_inserted = cache.map.add(accessor, std::ref(key));
+    const bool newly_inserted = shard.map.add(accessor, std::ref(key));
     if (!newly_inserted) {
       /* The value is available already. It was computed unnecessarily. Use the value created by
        * the other thread instead. */
       return accessor->second.value;
     }
+    StoredValue &stored_value = accessor->second;
     /* We want to store the key in the map, but the reference we got passed in may go out of scope.
      * So make a storable copy of it that we use in the map. */
-    accessor->second.key = key.to_storable();
+    stored_value.key = key.to_storable();
     /* Modifying the key should be fine because the new key is equal to the original key. */
     const_cast<std::reference_wrapper<const GenericKey> &>(accessor->first) = std::ref(
-        *accessor->second.key);
+        *stored_value.key);
 
     /* Store the value. Don't move, because we still want to return the value from the function. */
-    accessor->second.value = result;
-    /* Set initial logical time for the new cached entry. */
-    set_new_logical_time(accessor->second, new_time);
+    stored_value.value = result;
+    stored_value.category = category;
+    stored_value.compute_time = compute_time;
+    stored_value.size_in_bytes = memory.total_bytes;
+    stored_value.owned_size_in_bytes = memory.total_bytes - memory.shared_bytes;
+    for (const ImplicitSharingInfo *sharing_info : memory.shared_data_bytes.keys()) {
+      stored_value.shared_data.append(sharing_info);
+    }
+    touch_stored_value(cache, stored_value, new_time);
 
     {
-      /* Update global data of the cache. */
-      std::lock_guard lock{cache.global_mutex};
-      memory_counter::MemoryCounter memory_counter{cache.memory};
-      accessor->second.value->count_memory(memory_counter);
-      cache.keys.append(&accessor->first.get());
-      cache.size_in_bytes = cache.memory.total_bytes;
+      /* Update data of the shard. */
+      std::lock_guard lock{shard.mutex};
+      shard.keys.append(&accessor->first.get());
+      counters.values_num.fetch_add(1, std::memory_order_relaxed);
+      counters.size_in_bytes.fetch_add(stored_value.owned_size_in_bytes,
+                                       std::memory_order_relaxed);
+      add_shared_data_users(cache, memory, category);
     }
   }
   /* Potentially free elements from the cache. Note, even if this would free the value we just
    * added, it would still work correctly, because we already have a shared_ptr to it. */
-  try_enforce_limit();
+  try_enforce_limits();
   return result;
 }
 
@@ -133,7 +311,35 @@ void set_approximate_size_limit(const int64_t limit_in_bytes)
 {
   Cache &cache = get_cache();
   cache.approximate_limit = limit_in_bytes;
-  try_enforce_limit();
+  try_enforce_limits();
+}
+
+void set_approximate_size_limit(const Category category, const int64_t limit_in_bytes)
+{
+  Cache &cache = get_cache();
+  cache.category_limits[int(category)] = limit_in_bytes;
+  try_enforce_limits();
+}
+
+CategoryStatistics get_statistics(const Category category)
+{
+  Cache &cache = get_cache();
+  CategoryStatistics statistics;
+  int64_t compute_time_ns = 0;
+  for (const CacheShard &shard : cache.shards) {
+    const CategoryCounters &counters = shard.counters[int(category)];
+    statistics.hits += counters.hits.load(std::memory_order_relaxed);
+    statistics.misses += counters.misses.load(std::memory_order_relaxed);
+    statistics.evictions += counters.evictions.load(std::memory_order_relaxed);
+    statistics.values_num += counters.values_num.load(std::memory_order_relaxed);
+    statistics.size_in_bytes += counters.size_in_bytes.load(std::memory_order_relaxed);
+    compute_time_ns += counters.compute_time_ns.load(std::memory_order_relaxed);
+  }
+  statistics.size_in_bytes += cache.shared_data_sizes[int(category)].load(
+      std::memory_order_relaxed);
+  statistics.size_limit = cache.category_limits[int(category)].load(std::memory_order_relaxed);
+  statistics.compute_time = double(compute_time_ns) / 1e9;
+  return statistics;
 }
 
 void clear()
@@ -144,136 +350,179 @@ void clear()
 void remove_if(const FunctionRef<bool(const GenericKey &)> predicate)
 {
   Cache &cache = get_cache();
-  std::lock_guard lock{cache.global_mutex};
-
-  /* Store predicate results to avoid assuming that the predicate is cheap and without side effects
-   * that must not happen more than once. */
-  Array<bool> predicate_results(cache.keys.size());
-
-  /* Recount memory of all elements that are not removed. */
-  cache.memory.reset();
-  MemoryCounter memory_counter{cache.memory};
-
-  for (const int64_t i : cache.keys.index_range()) {
-    const GenericKey &key = *cache.keys[i];
-    const bool ok_to_remove = predicate(key);
-    predicate_results[i] = ok_to_remove;
-
-    if (!ok_to_remove) {
-      /* The value is kept, so count its memory. */
-      CacheMap::ConstAccessor accessor;
-      if (cache.map.lookup(accessor, key)) {
-        accessor->second.value->count_memory(memory_counter);
+  for (CacheShard &shard : cache.shards) {
+    std::lock_guard lock{shard.mutex};
+
+    /* Store predicate results to avoid assuming that the predicate is cheap and without side
+     * effects that must not happen more than once. */
+    Array<bool> predicate_results(shard.keys.size());
+
+    for (const int64_t i : shard.keys.index_range()) {
+      const GenericKey &key = *shard.keys[i];
+      const bool ok_to_remove = predicate(key);
+      predicate_results[i] = ok_to_remove;
+      if (!ok_to_remove) {
         continue;
       }
-      BLI_assert_unreachable();
+      /* The value should be removed. */
+      {
+        CacheMap::ConstAccessor accessor;
+        if (!shard.map.lookup(accessor, key)) {
+          BLI_assert_unreachable();
+          continue;
+        }
+        const StoredValue &stored_value = accessor->second;
+        CategoryCounters &counters = shard.counters[int(stored_value.category)];
+        counters.values_num.fetch_sub(1, std::memory_order_relaxed);
+        counters.size_in_bytes.fetch_sub(stored_value.owned_size_in_bytes,
+                                         std::memory_order_relaxed);
+        remove_shared_data_users(cache, stored_value);
+      }
+      const bool success = shard.map.remove(key);
+      BLI_assert(success);
+      UNUSED_VARS_NDEBUG(success);
     }
-    /* The value should be removed. */
-    const bool success = cache.map.remove(key);
-    BLI_assert(success);
-    UNUSED_VARS_NDEBUG(success);
+    /* Remove all removed keys from the vector too. */
+    shard.keys.remove_if([&](const GenericKey *&key) {
+      const int64_t index = &key - shard.keys.data();
+      return predicate_results[index];
+    });
   }
-  /* Remove all removed keys from the vector too. */
-  cache.keys.remove_if([&](const GenericKey *&key) {
-    const int64_t index = &key - cache.keys.data();
-    return predicate_results[index];
-  });
-  cache.size_in_bytes = cache.memory.total_bytes;
 }
 
-static void try_enforce_limit()
+/** Amount of memory that has to be freed to get back below the given limit, if it's exceeded. */
+static int64_t get_size_to_free(const int64_t size, const int64_t limit)
 {
-  Cache &cache = get_cache();
-  const int64_t old_size = cache.size_in_bytes.load(std::memory_order_relaxed);
-  const int64_t approximate_limit = cache.approximate_limit.load(std::memory_order_relaxed);
-  if (old_size < approximate_limit) {
-    /* Nothing to do, the current cache size is still within the right limits. */
-    return;
+  if (size < limit) {
+    return 0;
   }
+  /* Undershoot a little bit. This typically results in more things being freed that have not been
+   * used in a while. The benefit is that we have to do the decision what to free less often than
+   * if we were always just freeing the minimum amount necessary. */
+  return size - int64_t(limit * 0.75);
+}
 
-  std::lock_guard lock{cache.global_mutex};
-
-  /* Gather all the keys with their latest usage times. */
-  Vector<std::pair<int64_t, const GenericKey *>> keys_with_time;
-  for (const GenericKey *key : cache.keys) {
-    CacheMap::ConstAccessor accessor;
-    if (!cache.map.lookup(accessor, *key)) {
-      continue;
+static void try_enforce_limits()
+{
+  Cache &cache = get_cache();
+  std::array<int64_t, CATEGORIES_NUM> category_sizes = {};
+  for (const int i : IndexRange(CATEGORIES_NUM)) {
+    category_sizes[i] = cache.shared_data_sizes[i].load(std::memory_order_relaxed);
+  }
+  for (const CacheShard &shard : cache.shards) {
+    for (const int i : IndexRange(CATEGORIES_NUM)) {
+      category_sizes[i] += shard.counters[i].size_in_bytes.load(std::memory_order_relaxed);
     }
-    keys_with_time.append({accessor->second.last_use_time, key});
   }
-  /* Sort the items so that the newest keys come first. */
-  std::ranges::sort(keys_with_time);
-  std::reverse(keys_with_time.begin(), keys_with_time.end());
-
-  /* Count used memory starting at the most recently touched element. Stop at the element when the
-   * amount became larger than the capacity. */
-  cache.memory.reset();
-  std::optional<int> first_bad_index;
-  {
-    MemoryCounter memory_counter{cache.memory};
-    for (const int i : keys_with_time.index_range()) {
-      const GenericKey &key = *keys_with_time[i].second;
-      CacheMap::ConstAccessor accessor;
-      if (!cache.map.lookup(accessor, key)) {
-        continue;
-      }
-      accessor->second.value->count_memory(memory_counter);
-      /* Undershoot a little bit. This typically results in more things being freed that have not
-       * been used in a while. The benefit is that we have to do the decision what to free less
-       * often than if we were always just freeing the minimum amount necessary. */
-      if (cache.memory.total_bytes <= approximate_limit * 0.75) {
-        continue;
-      }
-      first_bad_index = i;
-      break;
+  int64_t size_to_free = 0;
+  std::array<int64_t, CATEGORIES_NUM> category_sizes_to_free = {};
+  int64_t total_size = 0;
+  bool any_limit_exceeded = false;
+  for (const int i : IndexRange(CATEGORIES_NUM)) {
+    total_size += category_sizes[i];
+    const int64_t category_limit = cache.category_limits[i].load(std::memory_order_relaxed);
+    if (category_limit > 0) {
+      category_sizes_to_free[i] = get_size_to_free(category_sizes[i], category_limit);
+      any_limit_exceeded |= category_sizes_to_free[i] > 0;
     }
   }
-  if (!first_bad_index) {
+  size_to_free = get_size_to_free(total_size,
+                                  cache.approximate_limit.load(std::memory_order_relaxed));
+  any_limit_exceeded |= size_to_free > 0;
+  if (!any_limit_exceeded) {
+    /* Nothing to do, the current cache size is still within the right limits. */
     return;
   }
 
-  /* Avoid recounting memory if the last item is not way too large and the overshoot is still ok.
-   * The alternative would be to subtract the last item from the counted memory again, but removing
-   * from #MemoryCount is not implemented yet. */
-  bool need_memory_recount = false;
-  if (cache.memory.total_bytes < approximate_limit * 1.1) {
-    *first_bad_index += 1;
-    if (*first_bad_index == keys_with_time.size()) {
-      return;
-    }
-  }
-  else {
-    need_memory_recount = true;
+  std::lock_guard enforce_lock{cache.enforce_limits_mutex};
+  /* Lock all shards so that the decision what to free is made on a consistent state. Shards are
+   * always locked in the same order, so this can't dead-lock with other threads doing the same. */
+  std::array<std::unique_lock<Mutex>, SHARDS_NUM> shard_locks;
+  for (const int i : IndexRange(SHARDS_NUM)) {
+    shard_locks[i] = std::unique_lock<Mutex>(cache.shards[i].mutex);
   }
 
-  /* Remove elements that don't fit anymore. */
-  for (const int i : keys_with_time.index_range().drop_front(*first_bad_index)) {
-    const GenericKey &key = *keys_with_time[i].second;
-    cache.map.remove(key);
+  /* Gather all values with their current priorities. */
+  struct Candidate {
+    double priority;
+    int64_t last_use_time;
+    int64_t owned_size_in_bytes;
+    Category category;
+    int shard_index;
+    int64_t key_index;
+  };
+  Vector<Candidate> candidates;
+  for (const int shard_index : IndexRange(SHARDS_NUM)) {
+    CacheShard &shard = cache.shards[shard_index];
+    for (const int64_t key_index : shard.keys.index_range()) {
+      CacheMap::ConstAccessor accessor;
+      if (!shard.map.lookup(accessor, *shard.keys[key_index])) {
+        continue;
+      }
+      const StoredValue &stored_value = accessor->second;
+      candidates.append({stored_value.priority,
+                         stored_value.last_use_time,
+                         stored_value.owned_size_in_bytes,
+                         stored_value.category,
+                         shard_index,
+                         key_index});
+    }
   }
+  /* Sort the values so that the ones that should be freed first come first. */
+  std::ranges::sort(candidates, [](const Candidate &a, const Candidate &b) {
+    if (a.priority != b.priority) {
+      return a.priority < b.priority;
+    }
+    return a.last_use_time < b.last_use_time;
+  });
 
-  /* Update keys vector. */
-  cache.keys.clear();
-  for (const int i : keys_with_time.index_range().take_front(*first_bad_index)) {
-    cache.keys.append(keys_with_time[i].second);
+  /* Free values until all limits are satisfied again. Values of categories that are within their
+   * limit are only freed when the limit of the entire cache is exceeded. */
+  std::array<Vector<bool>, SHARDS_NUM> removed_keys;
+  for (const int i : IndexRange(SHARDS_NUM)) {
+    removed_keys[i].resize(cache.shards[i].keys.size(), false);
   }
-
-  if (need_memory_recount) {
-    /* Recount memory another time, because the last count does not accurately represent the actual
-     * value. */
-    cache.memory.reset();
-    MemoryCounter memory_counter{cache.memory};
-    for (const int i : keys_with_time.index_range().take_front(*first_bad_index)) {
-      const GenericKey &key = *keys_with_time[i].second;
+  double max_removed_priority = cache.base_priority.load(std::memory_order_relaxed);
+  for (const Candidate &candidate : candidates) {
+    int64_t &category_size_to_free = category_sizes_to_free[int(candidate.category)];
+    if (size_to_free <= 0 && category_size_to_free <= 0) {
+      if (std::ranges::all_of(category_sizes_to_free, [](const int64_t s) { return s <= 0; })) {
+        break;
+      }
+      continue;
+    }
+    CacheShard &shard = cache.shards[candidate.shard_index];
+    const GenericKey &key = *shard.keys[candidate.key_index];
+    /* Shared data only frees memory when no other cached value uses it anymore. */
+    int64_t freed_size = candidate.owned_size_in_bytes;
+    {
       CacheMap::ConstAccessor accessor;
-      if (!cache.map.lookup(accessor, key)) {
-        continue;
+      if (shard.map.lookup(accessor, key)) {
+        freed_size += remove_shared_data_users(cache, accessor->second);
       }
-      accessor->second.value->count_memory(memory_counter);
     }
+    shard.map.remove(key);
+    removed_keys[candidate.shard_index][candidate.key_index] = true;
+
+    CategoryCounters &counters = shard.counters[int(candidate.category)];
+    counters.values_num.fetch_sub(1, std::memory_order_relaxed);
+    counters.size_in_bytes.fetch_sub(candidate.owned_size_in_bytes, std::memory_order_relaxed);
+    counters.evictions.fetch_add(1, std::memory_order_relaxed);
+
+    size_to_free -= freed_size;
+    category_size_to_free -= freed_size;
+    max_removed_priority = std::max(max_removed_priority, candidate.priority);
+  }
+  cache.base_priority.store(max_removed_priority, std::memory_order_relaxed);
+
+  /* Update keys vectors. */
+  for (const int i : IndexRange(SHARDS_NUM)) {
+    CacheShard &shard = cache.shards[i];
+    shard.keys.remove_if([&](const GenericKey *&key) {
+      const int64_t index = &key - shard.keys.data();
+      return removed_keys[i][index];
+    });
   }
-  cache.size_in_bytes = cache.memory.total_bytes;
 }
 
 }  // namespace blender::memory_cache
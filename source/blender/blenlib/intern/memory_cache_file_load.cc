@@ -137,7 +137,7 @@ std::shared_ptr<CachedValue> get_loaded_base(const GenericKey &loader_key,
 {
   invalidate_outdated_caches_if_necessary(file_paths);
   const LoadFileKey key{file_paths, loader_key.to_storable()};
-  return memory_cache::get_base(key, load_fn);
+  return memory_cache::get_base(key, load_fn, Category::FileLoads);
 }
 
 }  // namespace blender::memory_cache
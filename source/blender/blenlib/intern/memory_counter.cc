@@ -30,9 +30,15 @@ void MemoryCounter::add_shared(const ImplicitSharingInfo *sharing_info,
     return;
   }
   sharing_info->add_weak_user();
-  /* Count into the `this` for now. In the future we could pass in a separate #MemoryCounter here
-   * if we needed to know the amount of memory used by each shared data. */
+  /* Count into `this`, but remember how much memory the shared data uses itself. Nested shared
+   * data is recorded separately and is not included. */
+  const int64_t old_total_bytes = count_.total_bytes;
+  const int64_t old_shared_bytes = count_.shared_bytes;
   count_fn(*this);
+  const int64_t nested_shared_bytes = count_.shared_bytes - old_shared_bytes;
+  const int64_t bytes = count_.total_bytes - old_total_bytes - nested_shared_bytes;
+  count_.shared_data_bytes.add_new(sharing_info, bytes);
+  count_.shared_bytes += bytes;
 }
 
 void MemoryCounter::add_shared(const ImplicitSharingInfo *sharing_info, const int64_t bytes)
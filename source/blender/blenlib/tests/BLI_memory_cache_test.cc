@@ -3,6 +3,7 @@
  * SPDX-License-Identifier: Apache-2.0 */
 
 #include "BLI_hash.hh"
+#include "BLI_implicit_sharing_ptr.hh"
 #include "BLI_memory_cache.hh"
 #include "BLI_memory_counter.hh"
 
@@ -56,6 +57,24 @@ class CachedInt : public memory_cache::CachedValue {
   }
 };
 
+/** References an array that may be shared with other cached values. */
+class CachedSharedArray : public memory_cache::CachedValue {
+ public:
+  ImplicitSharingPtr<> sharing_info;
+  int64_t size;
+
+  CachedSharedArray(ImplicitSharingPtr<> sharing_info, const int64_t size)
+      : sharing_info(std::move(sharing_info)), size(size)
+  {
+  }
+
+  void count_memory(MemoryCounter &memory) const override
+  {
+    memory.add(sizeof(int));
+    memory.add_shared(sharing_info.get(), size);
+  }
+};
+
 TEST(memory_cache, Simple)
 {
   memory_cache::clear();
@@ -105,4 +124,75 @@ TEST(memory_cache, RemoveIf)
                })->value);
 }
 
+TEST(memory_cache, Statistics)
+{
+  memory_cache::clear();
+  const CategoryStatistics old_statistics = get_statistics(Category::FileLoads);
+
+  memory_cache::get<CachedInt>(
+      GenericIntKey(1), []() { return std::make_unique<CachedInt>(1); }, Category::FileLoads);
+  memory_cache::get<CachedInt>(
+      GenericIntKey(1), []() { return std::make_unique<CachedInt>(1); }, Category::FileLoads);
+
+  const CategoryStatistics statistics = get_statistics(Category::FileLoads);
+  EXPECT_EQ(statistics.misses, old_statistics.misses + 1);
+  EXPECT_EQ(statistics.hits, old_statistics.hits + 1);
+  EXPECT_EQ(statistics.values_num, 1);
+  EXPECT_EQ(statistics.size_in_bytes, int64_t(sizeof(int)));
+
+  memory_cache::clear();
+  EXPECT_EQ(get_statistics(Category::FileLoads).values_num, 0);
+  EXPECT_EQ(get_statistics(Category::FileLoads).size_in_bytes, 0);
+}
+
+TEST(memory_cache, CategoryLimit)
+{
+  memory_cache::clear();
+  const int64_t limit = 10 * int64_t(sizeof(int));
+  set_approximate_size_limit(Category::FileLoads, limit);
+
+  for (int i = 0; i < 100; i++) {
+    memory_cache::get<CachedInt>(
+        GenericIntKey(i), [&]() { return std::make_unique<CachedInt>(i); }, Category::FileLoads);
+    memory_cache::get<CachedInt>(GenericIntKey(-i - 1),
+                                 [&]() { return std::make_unique<CachedInt>(i); });
+  }
+
+  const CategoryStatistics statistics = get_statistics(Category::FileLoads);
+  EXPECT_LE(statistics.size_in_bytes, limit);
+  EXPECT_GT(statistics.evictions, 0);
+  /* Other categories are not affected by the limit. */
+  EXPECT_EQ(get_statistics(Category::Generic).values_num, 100);
+
+  set_approximate_size_limit(Category::FileLoads, 0);
+  memory_cache::clear();
+}
+
+TEST(memory_cache, SharedDataCountedOnce)
+{
+  memory_cache::clear();
+  const int64_t size = 1000;
+  void *data = MEM_new_uninitialized(size_t(size), __func__);
+  const ImplicitSharingPtr<> sharing_info{implicit_sharing::info_for_mem_free(data)};
+
+  for (int i = 0; i < 3; i++) {
+    memory_cache::get<CachedSharedArray>(
+        GenericIntKey(i),
+        [&]() { return std::make_unique<CachedSharedArray>(sharing_info, size); },
+        Category::FileLoads);
+  }
+  EXPECT_EQ(get_statistics(Category::FileLoads).values_num, 3);
+  EXPECT_EQ(get_statistics(Category::FileLoads).size_in_bytes, 3 * int64_t(sizeof(int)) + size);
+
+  /* The shared data stays counted as long as any cached value uses it. */
+  memory_cache::remove_if([](const GenericKey &key) {
+    return dynamic_cast<const GenericIntKey &>(key).value() != 1;
+  });
+  EXPECT_EQ(get_statistics(Category::FileLoads).values_num, 1);
+  EXPECT_EQ(get_statistics(Category::FileLoads).size_in_bytes, int64_t(sizeof(int)) + size);
+
+  memory_cache::clear();
+  EXPECT_EQ(get_statistics(Category::FileLoads).size_in_bytes, 0);
+}
+
 }  // namespace blender::memory_cache::tests
@@ -44,4 +44,30 @@ TEST(memory_counter, Simple)
   EXPECT_EQ(memory_count.total_bytes, 2220);
 }
 
+TEST(memory_counter, SharedDataBytes)
+{
+  MemoryCount memory_count;
+  MemoryCounter memory{memory_count};
+
+  void *data1 = MEM_new_uninitialized(10, __func__);
+  void *data2 = MEM_new_uninitialized(10, __func__);
+  const ImplicitSharingPtr sharing_info1{implicit_sharing::info_for_mem_free(data1)};
+  const ImplicitSharingPtr sharing_info2{implicit_sharing::info_for_mem_free(data2)};
+
+  memory.add(5);
+  memory.add_shared(sharing_info1.get(), [&](MemoryCounter &shared_memory) {
+    shared_memory.add(100);
+    /* Nested shared data is not included in the bytes of the outer shared data. */
+    shared_memory.add_shared(sharing_info2.get(), 20);
+  });
+  memory.add_shared(sharing_info2.get(), 20);
+  memory.add_shared(nullptr, 1000);
+
+  EXPECT_EQ(memory_count.total_bytes, 1125);
+  EXPECT_EQ(memory_count.shared_bytes, 120);
+  EXPECT_EQ(memory_count.shared_data_bytes.size(), 2);
+  EXPECT_EQ(memory_count.shared_data_bytes.lookup(sharing_info1.get()), 100);
+  EXPECT_EQ(memory_count.shared_data_bytes.lookup(sharing_info2.get()), 20);
+}
+
 }  // namespace blender::tests
@@ -544,6 +544,20 @@ const ImplicitSharingInfo *BLO_read_shared(BlendDataReader *reader,
   return shared_data.sharing_info;
 }
 
+/**
+ * Reference data that is stored in the file directly instead of reading it into memory. This is
+ * only possible for large raw data blocks of linked data-blocks in uncompressed library files. The
+ * data is then only loaded from disk when it is accessed.
+ *
+ * Returns the sharing info that keeps the mapped file alive, or null if the data has to be read
+ * normally. The referenced data must never be modified, even if the sharing info is mutable.
+ *
+ * \param size: Expected size of the data in bytes.
+ */
+const ImplicitSharingInfo *BLO_read_mapped(BlendDataReader *reader,
+                                           const void **ptr_p,
+                                           int64_t size);
+
 int BLO_read_fileversion_get(BlendDataReader *reader);
 bool BLO_read_data_is_undo(BlendDataReader *reader);
 void BLO_read_data_globmap_add(BlendDataReader *reader, void *oldaddr, void *newaddr);
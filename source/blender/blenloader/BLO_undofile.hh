@@ -38,6 +38,12 @@ struct MemFileChunk {
   size_t size;
   /** When true, this chunk doesn't own the memory, it's shared with a previous #MemFileChunk */
   bool is_identical;
+  /**
+   * When true, this chunk doesn't own the memory either, it's shared with a chunk that has the
+   * same content but is at a different position in this or the previous #MemFile. Unlike
+   * #is_identical, this does not imply that the data of the ID being written is unchanged.
+   */
+  bool is_deduplicated;
   /** When true, this chunk is also identical to the one in the next step (used by undo code to
    * detect unchanged IDs).
    * Defined when writing the next step (i.e. last undo step has those always false). */
@@ -45,11 +51,18 @@ struct MemFileChunk {
   /** Session UID of the ID being currently written (MAIN_ID_SESSION_UID_UNSET when not writing
    * ID-related data). Used to find matching chunks in previous memundo step. */
   uint id_session_uid;
+  /** Hash of the chunk content, used to find chunks with identical content across steps. */
+  uint32_t content_hash;
 };
 
 struct MemFile {
   ListBaseT<MemFileChunk> chunks;
+  /** Size of the memory owned by this memfile. */
   size_t size;
+  /** Total size of the chunks, i.e. the size of the written data stream. */
+  size_t stream_size;
+  /** Size of the chunks sharing memory through #MemFileChunk::is_deduplicated. */
+  size_t deduplicated_size;
   /**
    * Some data is not serialized into a new buffer because the undo-step can take ownership of it
    * without making a copy. This is faster and requires less memory.
@@ -66,6 +79,15 @@ struct MemFileWriteData {
 
   /** Maps an ID session uid to its first reference MemFileChunk, if existing. */
   Map<uint, MemFileChunk *> id_session_uid_mapping;
+
+  /**
+   * Map the content hash and size of the chunks in the reference memfile, and of the chunks owning
+   * their memory in the written one so far, to these chunks. Allows sharing memory with identical
+   * chunks that are not at the same position in the write stream, e.g. when data has been
+   * inserted before them.
+   */
+  Map<std::pair<uint32_t, size_t>, MemFileChunk *> reference_chunk_by_content;
+  Map<std::pair<uint32_t, size_t>, MemFileChunk *> written_chunk_by_content;
 };
 
 struct MemFileUndoData {
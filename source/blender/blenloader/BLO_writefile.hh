@@ -48,6 +48,11 @@ struct BlendFileWriteParams {
   uint use_userdef : 1 = false;
   /** This is writing a copy/paste buffer, not a regular blendfile. */
   uint is_copypaste_buffer : 1 = false;
+  /**
+   * Serialize all data-blocks one after another on the calling thread. The written file is the
+   * same as with parallel serialization, so this is mainly useful for testing.
+   */
+  uint use_serial_write : 1 = false;
   const BlendThumbnail *thumb = nullptr;
 };
 
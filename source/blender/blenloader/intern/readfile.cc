@@ -57,11 +57,13 @@
 #include "BLI_listbase.hh"
 #include "BLI_map.hh"
 #include "BLI_memarena.hh"
+#include "BLI_mmap.hh"
 #include "BLI_set.hh"
 #include "BLI_string.hh"
 #include "BLI_string_ref.hh"
 #include "BLI_string_utf8.hh"
 #include "BLI_string_utils.hh"
+#include "BLI_task.hh"
 #include "BLI_threads.hh"
 #include "BLI_time.hh"
 #include "BLI_utildefines.hh"
@@ -221,6 +223,72 @@ struct BHeadN {
  */
 #define BHEAD_USE_READ_ON_DEMAND(bhead) ((bhead)->code == BLO_CODE_DATA)
 
+/**
+ * Raw data blocks of linked data-blocks that are at least this large are not read with the
+ * data-block, see #FileData::mapped_file.
+ */
+#define MAPPED_DATA_MIN_SIZE (256 * 1024)
+
+struct MappedBlendFile : NonCopyable, NonMovable {
+  BLI_mmap_file *mmap = nullptr;
+
+  ~MappedBlendFile()
+  {
+    BLI_mmap_free(mmap);
+  }
+};
+
+/** Keeps the mapped file alive while data referencing it is used, see #BLO_read_mapped. */
+class MappedBlendFileSharingInfo : public ImplicitSharingInfo {
+ private:
+  std::shared_ptr<MappedBlendFile> file_;
+
+ public:
+  MappedBlendFileSharingInfo(std::shared_ptr<MappedBlendFile> file) : file_(std::move(file)) {}
+
+ private:
+  void delete_self_with_data() override
+  {
+    MEM_delete(this);
+  }
+};
+
+/**
+ * Map the library file into memory, so that large data of linked data-blocks can be referenced
+ * instead of being read, see #FileData::mapped_file.
+ */
+static void library_filedata_mapped_file_ensure(FileData *fd, const char *filepath)
+{
+#ifdef WIN32
+  /* A mapped file can't be replaced on Windows, so keeping the mapping alive after reading would
+   * prevent saving the library. */
+  UNUSED_VARS(fd, filepath);
+#else
+  if (fd->mapped_file || (fd->flags & FD_FLAGS_IS_MEMFILE)) {
+    return;
+  }
+  const int file = BLI_open(filepath, O_BINARY | O_RDONLY, 0);
+  if (file == -1) {
+    return;
+  }
+  BLI_mmap_file *mmap = BLI_mmap_open(file);
+  /* The mapped memory is still valid when the file is closed. */
+  close(file);
+  if (mmap == nullptr) {
+    return;
+  }
+  /* Compressed files can't be mapped, their data is only available after decompressing. */
+  if (BLI_mmap_get_length(mmap) < SIZEOFBLENDERHEADER_VERSION_0 ||
+      memcmp(BLI_mmap_get_pointer(mmap), "BLENDER", 7) != 0)
+  {
+    BLI_mmap_free(mmap);
+    return;
+  }
+  fd->mapped_file = std::make_shared<MappedBlendFile>();
+  fd->mapped_file->mmap = mmap;
+#endif
+}
+
 /* -------------------------------------------------------------------- */
 /** \name Blend Loader Reporting Wrapper
  * \{ */
@@ -1277,9 +1345,10 @@ static FileData *blo_decode_and_check(FileData *fd, ReportList *reports)
 
 static FileData *blo_filedata_from_file_descriptor(const char *filepath,
                                                    BlendFileReadReport *reports,
-                                                   const int filedes)
+                                                   const int filedes,
+                                                   const bool use_read_ahead)
 {
-  FileReader *file = BLO_file_reader_uncompressed_from_descriptor(filedes);
+  FileReader *file = BLO_file_reader_uncompressed_from_descriptor(filedes, use_read_ahead);
   if (file == nullptr) {
     BKE_reportf(reports->reports, RPT_WARNING, "Unrecognized file format '%s'", filepath);
     return nullptr;
@@ -1296,7 +1365,13 @@ static FileData *blo_filedata_from_file_descriptor(const char *filepath,
   return fd;
 }
 
-static FileData *blo_filedata_from_file_open(const char *filepath, BlendFileReadReport *reports)
+/**
+ * \param use_read_ahead: Decompress file data on worker threads ahead of the read position, for
+ * when the file is going to be read entirely.
+ */
+static FileData *blo_filedata_from_file_open(const char *filepath,
+                                             BlendFileReadReport *reports,
+                                             const bool use_read_ahead)
 {
   errno = 0;
   const int file = BLI_open(filepath, O_BINARY | O_RDONLY, 0);
@@ -1308,12 +1383,12 @@ static FileData *blo_filedata_from_file_open(const char *filepath, BlendFileRead
                 errno ? strerror(errno) : RPT_("unknown error reading file"));
     return nullptr;
   }
-  return blo_filedata_from_file_descriptor(filepath, reports, file);
+  return blo_filedata_from_file_descriptor(filepath, reports, file, use_read_ahead);
 }
 
 FileData *blo_filedata_from_file(const char *filepath, BlendFileReadReport *reports)
 {
-  FileData *fd = blo_filedata_from_file_open(filepath, reports);
+  FileData *fd = blo_filedata_from_file_open(filepath, reports, true);
   if (fd != nullptr) {
     /* needed for library_append and read_libraries */
     STRNCPY(fd->relabase, filepath);
@@ -1330,7 +1405,7 @@ FileData *blo_filedata_from_file(const char *filepath, BlendFileReadReport *repo
 static FileData *blo_filedata_from_file_minimal(const char *filepath)
 {
   BlendFileReadReport read_report{};
-  FileData *fd = blo_filedata_from_file_open(filepath, &read_report);
+  FileData *fd = blo_filedata_from_file_open(filepath, &read_report, false);
   if (fd != nullptr) {
     read_blender_header(fd);
     if (fd->flags & FD_FLAGS_FILE_OK) {
@@ -1379,6 +1454,18 @@ FileData *blo_filedata_from_memfile(MemFile *memfile,
   return blo_decode_and_check(fd, reports->reports);
 }
 
+/**
+ * Free the prefetched data which was not consumed by #read_data_into_datamap, which happens for
+ * the IDs of a batch that were skipped.
+ */
+static void read_libblock_data_prefetch_free(FileData *fd)
+{
+  for (const PrefetchedStruct &prefetched : fd->prefetched_structs.values()) {
+    MEM_delete_void(prefetched.data);
+  }
+  fd->prefetched_structs.clear();
+}
+
 void blo_filedata_free(FileData *fd)
 {
   /* Free all BHeadN data blocks */
@@ -1404,6 +1491,8 @@ void blo_filedata_free(FileData *fd)
     DNA_reconstruct_info_free(fd->reconstruct_info);
   }
 
+  read_libblock_data_prefetch_free(fd);
+
   if (fd->datamap) {
     oldnewmap_free(fd->datamap);
   }
@@ -1477,15 +1566,36 @@ short BLO_version_from_file(const char *filepath)
 /** \name Old/New Pointer Map
  * \{ */
 
+/**
+ * Read a data block that was skipped by #read_data_into_datamap, because it might have been
+ * referenced in the mapped file instead.
+ */
+static void read_mapped_data_block_if_needed(FileData *fd, const void *adr)
+{
+  if (fd->mapped_data_blocks.is_empty()) {
+    return;
+  }
+  const std::optional<BHead *> bhead = fd->mapped_data_blocks.pop_try(adr);
+  if (!bhead) {
+    return;
+  }
+  int64_t alloc_len = 0;
+  if (void *data = read_struct(fd, *bhead, "Data for mapped block", INDEX_ID_NULL, &alloc_len)) {
+    oldnewmap_insert(fd->datamap, (*bhead)->old, data, 0, alloc_len);
+  }
+}
+
 /* Only direct data-blocks. */
 static void *newdataadr(FileData *fd, const void *adr, int64_t *r_alloc_len = nullptr)
 {
+  read_mapped_data_block_if_needed(fd, adr);
   return oldnewmap_lookup_and_inc(fd->datamap, adr, true, r_alloc_len);
 }
 
 /* Only direct data-blocks. */
 static void *newdataadr_no_us(FileData *fd, const void *adr, int64_t *r_alloc_len = nullptr)
 {
+  read_mapped_data_block_if_needed(fd, adr);
   return oldnewmap_lookup_and_inc(fd->datamap, adr, false, r_alloc_len);
 }
 
@@ -2838,6 +2948,35 @@ static bool direct_link_id(FileData *fd,
   return success;
 }
 
+/**
+ * Whether reading the data block is skipped, because it may be referenced in the mapped file
+ * instead, see #FileData::mapped_file.
+ */
+static bool read_data_use_mapping(const FileData *fd, const BHead *bhead)
+{
+  if (!fd->mapped_file) {
+    return false;
+  }
+  if (bhead->SDNAnr != SDNA_RAW_DATA_STRUCT_INDEX || bhead->len < MAPPED_DATA_MIN_SIZE) {
+    return false;
+  }
+#ifdef USE_BHEAD_READ_ON_DEMAND
+  const BHeadN *bheadn = BHEADN_FROM_BHEAD(bhead);
+  return !bheadn->has_data &&
+         bheadn->file_offset + bhead->len <= BLI_mmap_get_length(fd->mapped_file->mmap);
+#else
+  return false;
+#endif
+}
+
+static void read_data_report_duplicate_address(const BHead *bhead)
+{
+  CLOG_ERROR(&LOG,
+             "Blendfile corruption: Invalid, or multiple `bhead` with same old address "
+             "value (%p) for a given ID.",
+             bhead->old);
+}
+
 /* Read all data associated with a datablock into datamap. */
 static BHead *read_data_into_datamap(FileData *fd,
                                      BHead *bhead,
@@ -2847,15 +2986,30 @@ static BHead *read_data_into_datamap(FileData *fd,
   bhead = blo_bhead_next(fd, bhead);
 
   while (bhead && bhead->code == BLO_CODE_DATA) {
+    if (read_data_use_mapping(fd, bhead)) {
+      /* A block with the same address that was read already is kept. */
+      if (fd->datamap->map.contains(bhead->old) ||
+          !fd->mapped_data_blocks.add_overwrite(bhead->old, bhead))
+      {
+        read_data_report_duplicate_address(bhead);
+      }
+      bhead = blo_bhead_next(fd, bhead);
+      continue;
+    }
     int64_t alloc_len = 0;
-    void *data = read_struct(fd, bhead, allocname, id_type_index, &alloc_len);
+    void *data = nullptr;
+    if (std::optional<PrefetchedStruct> prefetched = fd->prefetched_structs.pop_try(bhead)) {
+      data = prefetched->data;
+      alloc_len = prefetched->alloc_len;
+    }
+    else {
+      data = read_struct(fd, bhead, allocname, id_type_index, &alloc_len);
+    }
     if (data) {
+      const bool was_mapped = fd->mapped_data_blocks.remove(bhead->old);
       const bool is_new = oldnewmap_insert(fd->datamap, bhead->old, data, 0, alloc_len);
-      if (!is_new) {
-        CLOG_ERROR(&LOG,
-                   "Blendfile corruption: Invalid, or multiple `bhead` with same old address "
-                   "value (%p) for a given ID.",
-                   bhead->old);
+      if (was_mapped || !is_new) {
+        read_data_report_duplicate_address(bhead);
       }
     }
 
@@ -2865,6 +3019,152 @@ static BHead *read_data_into_datamap(FileData *fd,
   return bhead;
 }
 
+/**
+ * Name used for the allocations of an ID and its data, passed on as `blockname` to
+ * #get_alloc_name.
+ */
+static const char *read_libblock_alloc_name(FileData *fd, BHead *bhead, const int id_type_index)
+{
+#ifndef NDEBUG
+  UNUSED_VARS(fd, bhead, id_type_index);
+  return nullptr;
+#else
+  /* Avoid looking up in the mapping for all read BHead, since this only contains the ID type name
+   * in release builds. */
+  return get_alloc_name(fd, bhead, nullptr, id_type_index);
+#endif
+}
+
+/** Amount of block data that #read_libblock_data_prefetch reads in parallel at once. */
+#define PREFETCH_BATCH_SIZE (64 * 1024 * 1024)
+
+static bool read_libblock_data_prefetch_is_supported(const FileData *fd)
+{
+  /* Undo restores unchanged IDs without reading their data. Endian switching is not thread-safe
+   * and is never needed for files written by current versions anyway. */
+  if (fd->flags & (FD_FLAGS_IS_MEMFILE | FD_FLAGS_SWITCH_ENDIAN)) {
+    return false;
+  }
+  if (fd->skip_flags & BLO_READ_SKIP_DATA) {
+    return false;
+  }
+  return BLI_system_thread_count() > 1;
+}
+
+/**
+ * Whether the block can be read by #read_struct_prefetched. Only structs which need DNA
+ * reconstruction are worth it, other blocks are a single copy which #read_struct does without the
+ * extra allocation. Anything unusual (corrupt blocks, removed structs...) is left to
+ * #read_struct, which handles and reports errors.
+ */
+static bool read_struct_prefetch_is_supported(const FileData *fd, const BHead *bh)
+{
+  if (bh->len == 0 || bh->SDNAnr < 0 || bh->SDNAnr >= fd->filesdna->structs.size()) {
+    return false;
+  }
+  if (fd->compflags[bh->SDNAnr] != SDNA_CMP_NOT_EQUAL) {
+    return false;
+  }
+  const int64_t old_struct_size = DNA_struct_size(fd->filesdna.get(), bh->SDNAnr);
+  return bh->nr >= 0 && (old_struct_size == 0 || bh->nr <= bh->len / old_struct_size);
+}
+
+/**
+ * Thread-safe part of #read_struct, for blocks that passed #read_struct_prefetch_is_supported and
+ * have their data loaded in memory.
+ */
+static void *read_struct_prefetched(const FileData *fd,
+                                    const BHead *bh,
+                                    const char *alloc_name,
+                                    int64_t *r_alloc_len)
+{
+  return DNA_struct_reconstruct(
+      fd->reconstruct_info, bh->SDNAnr, bh->nr, (bh + 1), alloc_name, r_alloc_len);
+}
+
+/**
+ * Read the data blocks of the ID starting at \a bhead and of the IDs following it in parallel,
+ * until about #PREFETCH_BATCH_SIZE bytes have been read. The results are stored in
+ * #FileData::prefetched_structs, where #read_data_into_datamap picks them up.
+ *
+ * Only the DNA reconstruction and copying of the data is done here. Linking the data into its ID
+ * (#direct_link_id) calls into the ID type callbacks, which are not thread-safe, so it remains
+ * serial.
+ *
+ * \return The first #BHead that is not part of the batch.
+ */
+static BHead *read_libblock_data_prefetch(FileData *fd, BHead *bhead)
+{
+  struct PrefetchItem {
+    BHead *bhead;
+    /** Either #bhead, or a temporary copy of it holding its data. */
+    BHead *bhead_data;
+    const char *alloc_name;
+    void *data = nullptr;
+    int64_t alloc_len = 0;
+  };
+  Vector<PrefetchItem> items;
+  int64_t batch_size = 0;
+
+  /* Gather the blocks, and load the data that was not read from the file yet. Accessing the file
+   * and the allocation name storage is not thread-safe, so this is done serially. */
+  while (bhead && blo_bhead_is_id(bhead) && batch_size < PREFETCH_BATCH_SIZE) {
+    /* Link placeholders have no data, other IDs are read through #read_libblock. */
+    const bool is_read = bhead->code != ID_LINK_PLACEHOLDER && blo_bhead_is_id_valid_type(bhead);
+    const int id_type_index = BKE_idtype_idcode_to_index(bhead->code);
+    const char *blockname = is_read ? read_libblock_alloc_name(fd, bhead, id_type_index) : nullptr;
+
+    for (bhead = blo_bhead_next(fd, bhead); bhead && bhead->code == BLO_CODE_DATA;
+         bhead = blo_bhead_next(fd, bhead))
+    {
+      if (!is_read || !read_struct_prefetch_is_supported(fd, bhead) ||
+          read_data_use_mapping(fd, bhead))
+      {
+        continue;
+      }
+      BHead *bhead_data = bhead;
+#ifdef USE_BHEAD_READ_ON_DEMAND
+      if (BHEADN_FROM_BHEAD(bhead)->has_data == false) {
+        bhead_data = blo_bhead_read_full(fd, bhead);
+        if (bhead_data == nullptr) [[unlikely]] {
+          /* Let #read_struct handle the error. */
+          continue;
+        }
+      }
+#endif
+      items.append({bhead,
+                    bhead_data,
+                    get_alloc_name(fd, bhead, blockname, id_type_index)});
+      batch_size += bhead->len;
+    }
+  }
+
+  threading::parallel_for(
+      items.index_range(),
+      256 * 1024,
+      [&](const IndexRange range) {
+        for (PrefetchItem &item : items.as_mutable_span().slice(range)) {
+          item.data = read_struct_prefetched(
+              fd, item.bhead_data, item.alloc_name, &item.alloc_len);
+        }
+      },
+      threading::individual_task_sizes([&](const int64_t i) { return items[i].bhead->len; },
+                                       batch_size));
+
+  for (PrefetchItem &item : items) {
+#ifdef USE_BHEAD_READ_ON_DEMAND
+    if (item.bhead_data != item.bhead) {
+      MEM_delete(BHEADN_FROM_BHEAD(item.bhead_data));
+    }
+#endif
+    if (item.data) {
+      fd->prefetched_structs.add_new(item.bhead, {item.data, item.alloc_len});
+    }
+  }
+
+  return bhead;
+}
+
 /* Verify if the datablock and all associated data is identical. */
 static bool read_libblock_is_identical(FileData *fd, BHead *bhead)
 {
@@ -3529,13 +3829,7 @@ static BHead *read_libblock(FileData *fd,
 
   /* Read libblock struct. */
   const int id_type_index = BKE_idtype_idcode_to_index(bhead->code);
-#ifndef NDEBUG
-  const char *blockname = nullptr;
-#else
-  /* Avoid looking up in the mapping for all read BHead, since this only contains the ID type name
-   * in release builds. */
-  const char *blockname = get_alloc_name(fd, bhead, nullptr, id_type_index);
-#endif
+  const char *blockname = read_libblock_alloc_name(fd, bhead, id_type_index);
   ID *id = read_id_struct(fd, bhead, blockname, id_type_index);
   if (id == nullptr) {
     if (r_id) {
@@ -3603,6 +3897,7 @@ static BHead *read_libblock(FileData *fd,
   bhead = read_data_into_datamap(fd, bhead, blockname, id_type_index);
   const bool success = direct_link_id(fd, main, id_tag, id_read_tags, id, id_old);
   oldnewmap_clear(fd->datamap);
+  fd->mapped_data_blocks.clear();
 
   if (!success) {
     /* XXX This is probably working OK currently given the very limited scope of that flag.
@@ -3651,6 +3946,7 @@ BHead *blo_read_asset_data_block(FileData *fd, BHead *bhead, AssetMetaData **r_a
   BKE_asset_metadata_read(&reader, *r_asset_data);
 
   oldnewmap_clear(fd->datamap);
+  fd->mapped_data_blocks.clear();
 
   return bhead;
 }
@@ -4189,6 +4485,7 @@ static BHead *read_userdef(BlendFileData *bfd, FileData *fd, BHead *bhead)
 
   /* free fd->datamap again */
   oldnewmap_clear(fd->datamap);
+  fd->mapped_data_blocks.clear();
 
   return bhead;
 }
@@ -4329,7 +4626,18 @@ BlendFileData *blo_read_file_internal(FileData *fd, const char *filepath)
     read_undo_reuse_noundo_local_ids(fd);
   }
 
+  /* ID data is read in batches: the data blocks of consecutive IDs are first reconstructed in
+   * parallel, then each ID is read and linked to its data serially. */
+  bool use_prefetch = read_libblock_data_prefetch_is_supported(fd);
+  /* First #BHead after the current batch, null when a new batch can be started. */
+  const BHead *prefetch_end = nullptr;
+
   while (bhead) {
+    if (bhead == prefetch_end) {
+      prefetch_end = nullptr;
+      read_libblock_data_prefetch_free(fd);
+    }
+
     /* If not-null after the `switch`, the BHead is an ID one and needs to be read. */
     Main *bmain_to_read_into = nullptr;
     bool placeholder_set_indirect_extern = false;
@@ -4410,6 +4718,11 @@ BlendFileData *blo_read_file_internal(FileData *fd, const char *filepath)
       }
     }
     if (bmain_to_read_into) {
+      if (use_prefetch && prefetch_end == nullptr) {
+        prefetch_end = read_libblock_data_prefetch(fd, bhead);
+        /* All remaining IDs have been prefetched when reaching the end of the file. */
+        use_prefetch = prefetch_end != nullptr;
+      }
       const eID_Tag id_tag = is_linked_packed_id ? ID_TAG_EXTERN : ID_TAG_LOCAL;
       bhead = read_libblock(
           fd, bmain_to_read_into, bhead, id_tag, {}, placeholder_set_indirect_extern, nullptr);
@@ -4428,6 +4741,7 @@ BlendFileData *blo_read_file_internal(FileData *fd, const char *filepath)
       return bfd;
     }
   }
+  read_libblock_data_prefetch_free(fd);
 
   if (is_undo) {
     /* Move remaining libraries containing 'no undo' IDs from old to new Main. */
@@ -5418,6 +5732,11 @@ static Main *library_link_begin(Main *mainvar,
 
   fd->bmain = mainvar;
 
+  /* Files read from memory don't store their path in #FileData.relabase. */
+  if (BLI_path_cmp(fd->relabase, filepath) == 0) {
+    library_filedata_mapped_file_ensure(fd, filepath);
+  }
+
   /* Add already existing packed data-blocks to map so that they are not loaded again. */
   ID *id;
   FOREACH_MAIN_ID_BEGIN (mainvar, id) {
@@ -5886,6 +6205,9 @@ static FileData *read_library_file_data(FileData *basefd, Main *bmain, Main *lib
                      lib_bmain->curlib->filepath,
                      library_parent_filepath(lib_bmain->curlib));
     fd = blo_filedata_from_file(lib_bmain->curlib->runtime->filepath_abs, basefd->reports);
+    if (fd) {
+      library_filedata_mapped_file_ensure(fd, lib_bmain->curlib->runtime->filepath_abs);
+    }
   }
 
   if (fd) {
@@ -6353,6 +6675,31 @@ bool blo_read_pointer_array_impl(BlendDataReader *reader, const int64_t array_si
   return true;
 }
 
+const ImplicitSharingInfo *BLO_read_mapped(BlendDataReader *reader,
+                                           const void **ptr_p,
+                                           const int64_t size)
+{
+#ifdef USE_BHEAD_READ_ON_DEMAND
+  FileData *fd = reader->fd;
+  BHead *const *bhead_p = fd->mapped_data_blocks.lookup_ptr(*ptr_p);
+  if (bhead_p == nullptr) {
+    return nullptr;
+  }
+  const BHead *bhead = *bhead_p;
+  if (size < 0 || size > bhead->len) {
+    /* Let the regular reading code handle and report invalid data. */
+    return nullptr;
+  }
+  const BHeadN *bheadn = BHEADN_FROM_BHEAD(bhead);
+  *ptr_p = POINTER_OFFSET(BLI_mmap_get_pointer(fd->mapped_file->mmap), bheadn->file_offset);
+  fd->mapped_data_blocks.remove(bhead->old);
+  return MEM_new<MappedBlendFileSharingInfo>(__func__, fd->mapped_file);
+#else
+  UNUSED_VARS(reader, ptr_p, size);
+  return nullptr;
+#endif
+}
+
 ImplicitSharingInfoAndData blo_read_shared_impl(
     BlendDataReader *reader,
     const void **ptr_p,
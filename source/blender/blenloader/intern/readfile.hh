@@ -73,6 +73,14 @@ ENUM_OPERATORS(eFileDataFlag)
 #  pragma GCC poison off_t
 #endif
 
+struct MappedBlendFile;
+
+/** Struct data read ahead of time from a #BHead, see #FileData::prefetched_structs. */
+struct PrefetchedStruct {
+  void *data;
+  int64_t alloc_len;
+};
+
 /**
  * General data used during a blend-file reading.
  *
@@ -168,6 +176,23 @@ struct FileData {
 
   std::optional<Map<StringRefNull, BHead *>> bhead_idname_map;
 
+  /**
+   * Struct data of #BLO_CODE_DATA blocks which need DNA reconstruction, read in parallel ahead of
+   * the ID owning them (see #read_libblock_data_prefetch). Entries are consumed when reading that
+   * ID, the ones of skipped IDs are freed at the end of the batch.
+   */
+  Map<const BHead *, PrefetchedStruct> prefetched_structs;
+
+  /**
+   * Memory mapping of the file, only set for uncompressed library files. Large raw data blocks of
+   * linked data-blocks are not read when the data-block is read. Data that supports it references
+   * the mapped memory instead, so that it is only loaded from disk when it is actually used, see
+   * #BLO_read_mapped. Other data is read when it is looked up.
+   */
+  std::shared_ptr<MappedBlendFile> mapped_file;
+  /** Raw data blocks of the data-block currently being read, that have not been read yet. */
+  Map<const void *, BHead *> mapped_data_blocks;
+
   /**
    * The root (main, local) Main.
    * The Main that will own Library IDs.
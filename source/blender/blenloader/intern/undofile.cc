@@ -6,6 +6,7 @@
  * \ingroup blenloader
  */
 
+#include <array>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
@@ -22,6 +23,7 @@
 
 #include "DNA_listBase.h"
 
+#include "BLI_hash_mm2a.hh"
 #include "BLI_implicit_sharing.hh"
 #include "BLI_listbase.hh"
 
@@ -40,16 +42,66 @@ namespace blender {
 
 /* **************** support for memory-write, for undo buffers *************** */
 
+/**
+ * Content-defined chunking parameters. Written data is split where a rolling hash of the last
+ * bytes matches a pattern, so that after data is inserted or removed, the chunk boundaries of the
+ * following unchanged data are the same as in the previous step and the chunks can be shared.
+ */
+#define MEMFILE_CHUNK_MIN_SIZE (4 * 1024)
+#define MEMFILE_CHUNK_MAX_SIZE (64 * 1024)
+/** Average distance between boundaries (past the minimal size) is `2 ^ bits`. */
+#define MEMFILE_CHUNK_BOUNDARY_MASK 0xFFF80000u
+
+/** Random values for the "gear" rolling hash used to find chunk boundaries. */
+static constexpr std::array<uint32_t, 256> memfile_gear_table = []() {
+  std::array<uint32_t, 256> table{};
+  uint64_t state = 0x9E3779B97F4A7C15ull;
+  for (uint32_t &value : table) {
+    /* SplitMix64. */
+    state += 0x9E3779B97F4A7C15ull;
+    uint64_t z = state;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    value = uint32_t((z ^ (z >> 31)) >> 32);
+  }
+  return table;
+}();
+
+/** \return The size of the first content-defined chunk of the given data. */
+static size_t memfile_chunk_boundary_find(const char *buf, const size_t size)
+{
+  if (size <= MEMFILE_CHUNK_MIN_SIZE * 2) {
+    return size;
+  }
+  const size_t max_size = std::min<size_t>(size, MEMFILE_CHUNK_MAX_SIZE);
+  const uchar *data = reinterpret_cast<const uchar *>(buf);
+  uint32_t hash = 0;
+  for (size_t i = MEMFILE_CHUNK_MIN_SIZE; i < max_size; i++) {
+    hash = (hash << 1) + memfile_gear_table[data[i]];
+    if ((hash & MEMFILE_CHUNK_BOUNDARY_MASK) == 0) {
+      return i + 1;
+    }
+  }
+  return max_size;
+}
+
+static bool memfile_chunk_owns_buffer(const MemFileChunk &chunk)
+{
+  return !chunk.is_identical && !chunk.is_deduplicated;
+}
+
 void BLO_memfile_free(MemFile *memfile)
 {
   while (MemFileChunk *chunk = static_cast<MemFileChunk *>(BLI_pophead(&memfile->chunks))) {
-    if (chunk->is_identical == false) {
+    if (memfile_chunk_owns_buffer(*chunk)) {
       MEM_delete(chunk->buf);
     }
     MEM_delete(chunk);
   }
   MEM_SAFE_DELETE(memfile->shared_storage);
   memfile->size = 0;
+  memfile->stream_size = 0;
+  memfile->deduplicated_size = 0;
 }
 
 MemFileSharedStorage::~MemFileSharedStorage()
@@ -68,7 +120,7 @@ void BLO_memfile_merge(MemFile *first, MemFile *second)
 
   /* First, detect all memchunks in second memfile that are not owned by it. */
   for (MemFileChunk &sc : second->chunks) {
-    if (sc.is_identical) {
+    if (!memfile_chunk_owns_buffer(sc)) {
       buffer_to_second_memchunk.add(sc.buf, &sc);
     }
   }
@@ -76,10 +128,11 @@ void BLO_memfile_merge(MemFile *first, MemFile *second)
   /* Now, check all chunks from first memfile (the one we are removing), and if a memchunk owned by
    * it is also used by the second memfile, transfer the ownership. */
   for (MemFileChunk &fc : first->chunks) {
-    if (!fc.is_identical) {
+    if (memfile_chunk_owns_buffer(fc)) {
       if (MemFileChunk *sc = buffer_to_second_memchunk.lookup_default(fc.buf, nullptr)) {
-        BLI_assert(sc->is_identical);
+        BLI_assert(!memfile_chunk_owns_buffer(*sc));
         sc->is_identical = false;
+        sc->is_deduplicated = false;
         fc.is_identical = true;
       }
       /* Note that if the second memfile does not use that chunk, we assume that the first one
@@ -123,6 +176,11 @@ void BLO_memfile_write_init(WriteData *wd,
         current_session_uid = mem_chunk.id_session_uid;
         mem_data->id_session_uid_mapping.add_new(current_session_uid, &mem_chunk);
       }
+      /* Chunks that do not own their memory are indexed as well, their buffer is owned by an
+       * older step, and will be passed on to the written memfile by #BLO_memfile_merge if that
+       * older step is freed. */
+      mem_data->reference_chunk_by_content.add({mem_chunk.content_hash, mem_chunk.size},
+                                               &mem_chunk);
     }
   }
 }
@@ -130,24 +188,76 @@ void BLO_memfile_write_init(WriteData *wd,
 void BLO_memfile_write_finalize(WriteData * /*wd*/, MemFileWriteData *mem_data)
 {
   mem_data->id_session_uid_mapping.clear();
+  mem_data->reference_chunk_by_content.clear();
+  mem_data->written_chunk_by_content.clear();
 }
 
-void BLO_memfile_chunk_add(MemFileWriteData *mem_data, const char *buf, size_t size)
+static MemFileChunk *memfile_chunk_new(MemFileWriteData *mem_data, const size_t size)
 {
   MemFile *memfile = mem_data->written_memfile;
-  MemFileChunk **compchunk_step = &mem_data->reference_current_chunk;
 
   MemFileChunk *curchunk = MEM_new_uninitialized<MemFileChunk>("MemFileChunk");
   curchunk->size = size;
   curchunk->buf = nullptr;
   curchunk->is_identical = false;
+  curchunk->is_deduplicated = false;
   /* This is unsafe in the sense that an app handler or other code that does not
    * perform an undo push may make changes after the last undo push that
    * will then not be undo. Though it's not entirely clear that is wrong behavior. */
   curchunk->is_identical_future = true;
   curchunk->id_session_uid = mem_data->current_id_session_uid;
+  curchunk->content_hash = 0;
   BLI_addtail(&memfile->chunks, curchunk);
 
+  memfile->stream_size += size;
+  return curchunk;
+}
+
+/**
+ * Share the buffers of the next chunks of the reference memfile if they hold exactly the given
+ * data. This is the common case of unchanged data, it avoids searching for content-defined chunk
+ * boundaries again.
+ */
+static bool memfile_chunks_add_identical(MemFileWriteData *mem_data,
+                                         const char *buf,
+                                         const size_t size)
+{
+  size_t offset = 0;
+  MemFileChunk *compchunk = mem_data->reference_current_chunk;
+  for (; compchunk != nullptr && offset < size;
+       compchunk = static_cast<MemFileChunk *>(compchunk->next))
+  {
+    if (compchunk->id_session_uid != mem_data->current_id_session_uid ||
+        compchunk->size > size - offset || memcmp(compchunk->buf, buf + offset, compchunk->size))
+    {
+      return false;
+    }
+    offset += compchunk->size;
+  }
+  if (offset != size) {
+    return false;
+  }
+
+  for (MemFileChunk *chunk = mem_data->reference_current_chunk; chunk != compchunk;
+       chunk = static_cast<MemFileChunk *>(chunk->next))
+  {
+    MemFileChunk *curchunk = memfile_chunk_new(mem_data, chunk->size);
+    curchunk->buf = chunk->buf;
+    curchunk->is_identical = true;
+    curchunk->content_hash = chunk->content_hash;
+    chunk->is_identical_future = true;
+  }
+  mem_data->reference_current_chunk = compchunk;
+  return true;
+}
+
+static void memfile_chunk_add_single(MemFileWriteData *mem_data, const char *buf, size_t size)
+{
+  MemFile *memfile = mem_data->written_memfile;
+  MemFileChunk **compchunk_step = &mem_data->reference_current_chunk;
+
+  MemFileChunk *curchunk = memfile_chunk_new(mem_data, size);
+
   /* we compare compchunk with buf */
   if (*compchunk_step != nullptr) {
     MemFileChunk *compchunk = *compchunk_step;
@@ -155,18 +265,56 @@ void BLO_memfile_chunk_add(MemFileWriteData *mem_data, const char *buf, size_t s
       if (memcmp(compchunk->buf, buf, size) == 0) {
         curchunk->buf = compchunk->buf;
         curchunk->is_identical = true;
+        curchunk->content_hash = compchunk->content_hash;
         compchunk->is_identical_future = true;
       }
     }
     *compchunk_step = static_cast<MemFileChunk *>(compchunk->next);
   }
+  if (curchunk->buf != nullptr) {
+    return;
+  }
+
+  /* Not equal, look for the same content elsewhere in the reference or written memfile. */
+  curchunk->content_hash = BLI_hash_mm2(reinterpret_cast<const uchar *>(buf), size, 0);
+  const std::pair<uint32_t, size_t> content_key{curchunk->content_hash, size};
+  MemFileChunk *reference_match = mem_data->reference_chunk_by_content.lookup_default(content_key,
+                                                                                      nullptr);
+  MemFileChunk *match = reference_match ? reference_match :
+                                          mem_data->written_chunk_by_content.lookup_default(
+                                              content_key, nullptr);
+  if (match != nullptr && memcmp(match->buf, buf, size) == 0) {
+    curchunk->buf = match->buf;
+    curchunk->is_deduplicated = true;
+    memfile->deduplicated_size += size;
+    if (match == reference_match && match->id_session_uid == curchunk->id_session_uid &&
+        match->id_session_uid != MAIN_ID_SESSION_UID_UNSET)
+    {
+      /* Data of this ID was inserted or removed before this chunk, compare the next chunks with
+       * the ones following the match. */
+      *compchunk_step = static_cast<MemFileChunk *>(match->next);
+    }
+    return;
+  }
 
   /* not equal... */
-  if (curchunk->buf == nullptr) {
-    char *buf_new = MEM_new_array_uninitialized<char>(size, "Chunk buffer");
-    memcpy(buf_new, buf, size);
-    curchunk->buf = buf_new;
-    memfile->size += size;
+  char *buf_new = MEM_new_array_uninitialized<char>(size, "Chunk buffer");
+  memcpy(buf_new, buf, size);
+  curchunk->buf = buf_new;
+  memfile->size += size;
+  mem_data->written_chunk_by_content.add(content_key, curchunk);
+}
+
+void BLO_memfile_chunk_add(MemFileWriteData *mem_data, const char *buf, size_t size)
+{
+  if (memfile_chunks_add_identical(mem_data, buf, size)) {
+    return;
+  }
+  while (size > 0) {
+    const size_t chunk_size = memfile_chunk_boundary_find(buf, size);
+    memfile_chunk_add_single(mem_data, buf, chunk_size);
+    buf += chunk_size;
+    size -= chunk_size;
   }
 }
 
@@ -107,6 +107,7 @@
 #include "BLI_path_utils.hh"
 #include "BLI_set.hh"
 #include "BLI_string.hh"
+#include "BLI_task.hh"
 #include "BLI_task_c.hh"
 #include "BLI_threads.hh"
 #include "BLI_time.hh"
@@ -162,12 +163,23 @@ namespace blender {
 /* Use optimal allocation since blocks of this size are kept in memory for undo. */
 #define MEM_BUFFER_SIZE MEM_SIZE_OPTIMAL(1 << 17) /* 128kb */
 #define MEM_CHUNK_SIZE MEM_SIZE_OPTIMAL(1 << 15)  /* ~32kb */
+/**
+ * Large blocks are passed on to the memfile in bigger pieces, #BLO_memfile_chunk_add splits them
+ * into chunks based on their content.
+ */
+#define MEM_LARGE_CHUNK_SIZE (1 << 30) /* 1gb */
 
 #define ZSTD_BUFFER_SIZE (1 << 21) /* 2mb */
 #define ZSTD_CHUNK_SIZE (1 << 20)  /* 1mb */
 
 #define ZSTD_COMPRESSION_LEVEL 3
 
+/**
+ * Number of data-blocks serialized in parallel per thread before they are appended to the file.
+ * Limits the memory used by serialized data that has not been written yet.
+ */
+constexpr int WRITE_DEFERRED_IDS_PER_THREAD = 2;
+
 static CLG_LogRef LOG = {"blend.writefile"};
 static CLG_LogRef LOG_UNDO = {"undo"};
 
@@ -541,6 +553,11 @@ static void mywrite(WriteData *wd, const void *adr, size_t len)
   wd->write_len += len;
 #endif
 
+  if (wd->deferred) {
+    wd->deferred->stream.extend(Span(static_cast<const uchar *>(adr), int64_t(len)));
+    return;
+  }
+
   if (wd->buffer.buf == nullptr) {
     writedata_do_write(wd, adr, len);
   }
@@ -553,8 +570,9 @@ static void mywrite(WriteData *wd, const void *adr, size_t len)
         wd->buffer.used_len = 0;
       }
 
+      const size_t chunk_size = wd->use_memfile ? MEM_LARGE_CHUNK_SIZE : wd->buffer.chunk_size;
       do {
-        const size_t writelen = std::min(len, wd->buffer.chunk_size);
+        const size_t writelen = std::min(len, chunk_size);
         writedata_do_write(wd, adr, writelen);
         adr = static_cast<const char *>(adr) + writelen;
         len -= writelen;
@@ -608,9 +626,14 @@ static bool mywrite_end(WriteData *wd)
 
   if (wd->use_memfile) {
     BLO_memfile_write_finalize(wd, &wd->mem);
+    const MemFile &memfile = *wd->mem.written_memfile;
     CLOG_INFO(&LOG_UNDO,
-              "Memfile undo step written in %.3f seconds",
-              BLI_time_now_seconds() - wd->timestamp_init);
+              "Memfile undo step written in %.3f seconds, storing %zu of %zu bytes "
+              "(%zu bytes de-duplicated by content)",
+              BLI_time_now_seconds() - wd->timestamp_init,
+              memfile.size,
+              memfile.stream_size,
+              memfile.deduplicated_size);
   }
   else {
     CLOG_INFO(
@@ -855,6 +878,11 @@ static uint64_t get_address_id_int(WriteData &wd, const void *address)
   if (address == nullptr) {
     return 0;
   }
+  /* The actual address id is only generated when the deferred data is written to the file. */
+  if (wd.deferred) {
+    wd.deferred->addresses.append(address);
+    return uint64_t(wd.deferred->addresses.size());
+  }
   /* In undo case, addresses are kept as-is, unless they have been tagged by specific functions
    * like `BLO_write_generated_pointer_tag`, in which case their value will already be in the
    * `pointer_map`. */
@@ -1347,6 +1375,161 @@ static void write_id(WriteData *wd, ID *id)
   mywrite_id_end(wd, id);
 }
 
+/**
+ * Serialize a data-block into a separate buffer, which can be done for multiple data-blocks in
+ * parallel. The result is written to the file with #write_id_deferred_finish.
+ */
+static std::unique_ptr<WriteDataDeferredID> write_id_deferred(const WriteData &wd, ID *id)
+{
+  auto deferred = std::make_unique<WriteDataDeferredID>();
+  WriteData id_wd{};
+  id_wd.sdna = wd.sdna;
+  id_wd.stable_address_ids.sdna_pointers = wd.stable_address_ids.sdna_pointers;
+  id_wd.filepath = wd.filepath;
+  id_wd.timestamp_init = wd.timestamp_init;
+  id_wd.deferred = deferred.get();
+  /* The per-ID validation runs on the separate #WriteData, only failures have to be passed on. */
+  id_wd.validation_data.critical_error = wd.validation_data.critical_error;
+  write_id(&id_wd, id);
+  deferred->critical_error = id_wd.validation_data.critical_error;
+  return deferred;
+}
+
+template<typename BHeadT>
+static void replace_deferred_address_ids(const WriteData &wd,
+                                         WriteDataDeferredID &deferred,
+                                         const Span<uint64_t> address_ids)
+{
+  MutableSpan<uchar> stream = deferred.stream;
+  const auto replace_placeholder = [&](const int64_t offset) {
+    uint64_t value;
+    memcpy(&value, &stream[offset], sizeof(value));
+    if (value != 0) {
+      memcpy(&stream[offset], &address_ids[value - 1], sizeof(value));
+    }
+  };
+
+  Span<int64_t> pointer_array_offsets = deferred.pointer_array_offsets;
+  int64_t offset = 0;
+  while (offset + int64_t(sizeof(BHeadT)) <= stream.size()) {
+    BHeadT bhead;
+    memcpy(&bhead, &stream[offset], sizeof(bhead));
+    const int64_t data_offset = offset + sizeof(BHeadT);
+    if (bhead.len < 0 || data_offset + bhead.len > stream.size()) {
+      /* Only happens when the data could not be written correctly, which is reported already. */
+      BLI_assert_unreachable();
+      break;
+    }
+    replace_placeholder(offset + offsetof(BHeadT, old));
+
+    if (bhead.SDNAnr != SDNA_RAW_DATA_STRUCT_INDEX) {
+      const dna::pointers::StructInfo &struct_info =
+          wd.stable_address_ids.sdna_pointers->get_for_struct(bhead.SDNAnr);
+      for (const int64_t i : IndexRange(bhead.nr)) {
+        for (const dna::pointers::PointerInfo &pointer_info : struct_info.pointers) {
+          replace_placeholder(data_offset + i * struct_info.size_in_bytes + pointer_info.offset);
+        }
+      }
+    }
+    else if (!pointer_array_offsets.is_empty() && pointer_array_offsets.first() == offset) {
+      for (const int64_t i : IndexRange(bhead.len / int64_t(sizeof(uint64_t)))) {
+        replace_placeholder(data_offset + i * int64_t(sizeof(uint64_t)));
+      }
+      pointer_array_offsets = pointer_array_offsets.drop_front(1);
+    }
+    offset = data_offset + bhead.len;
+  }
+}
+
+/**
+ * Generate the address ids in the same order as when the data-block would have been written
+ * directly, and append the serialized data to the file.
+ */
+static void write_id_deferred_finish(WriteData *wd, ID *id, WriteDataDeferredID &deferred)
+{
+  if (deferred.critical_error) {
+    wd->validation_data.critical_error = true;
+    return;
+  }
+  mywrite_id_begin(wd, id);
+
+  Array<uint64_t> address_ids(deferred.addresses.size());
+  for (const int64_t i : deferred.addresses.index_range()) {
+    address_ids[i] = get_address_id_int(*wd, deferred.addresses[i]);
+  }
+  /* See #write_bhead. */
+  if (!USER_DEVELOPER_TOOL_TEST(&U, write_legacy_blend_file_format) &&
+      SYSTEM_SUPPORTS_WRITING_FILE_VERSION_1)
+  {
+    replace_deferred_address_ids<LargeBHead8>(*wd, deferred, address_ids);
+  }
+  else {
+    replace_deferred_address_ids<SmallBHead8>(*wd, deferred, address_ids);
+  }
+  mywrite(wd, deferred.stream.data(), size_t(deferred.stream.size()));
+
+  mywrite_id_end(wd, id);
+}
+
+/**
+ * Data-block types whose write callbacks only read data owned by the data-block, so that they can
+ * be serialized in parallel with other data-blocks.
+ */
+static bool id_can_write_deferred(const ID &id)
+{
+  switch (GS(id.name)) {
+    case ID_ME:
+    case ID_IM:
+    case ID_NT:
+    case ID_CV:
+    case ID_PT:
+      return true;
+    default:
+      return false;
+  }
+}
+
+/**
+ * Write the given data-blocks in order. When writing a file, data-blocks that support it are
+ * serialized in parallel in batches, and then appended to the file one after another.
+ */
+static void write_ids(WriteData *wd, const Span<ID *> ids)
+{
+  /* Undo steps depend on writing each data-block directly into the #MemFile. The debug output
+   * would be written out of order and contain placeholders. */
+  const bool use_deferred = !wd->use_memfile && !wd->use_serial_write &&
+                            wd->debug_dst == nullptr && sizeof(void *) == 8;
+  if (!use_deferred) {
+    for (ID *id : ids) {
+      write_id(wd, id);
+    }
+    return;
+  }
+
+  const int64_t batch_size = int64_t(BLI_system_thread_count()) * WRITE_DEFERRED_IDS_PER_THREAD;
+  for (int64_t batch_start = 0; batch_start < ids.size(); batch_start += batch_size) {
+    const Span<ID *> batch = ids.slice_safe(batch_start, batch_size);
+    Array<std::unique_ptr<WriteDataDeferredID>> deferred_ids(batch.size());
+    threading::parallel_for(batch.index_range(), 1, [&](const IndexRange range) {
+      for (const int64_t i : range) {
+        if (id_can_write_deferred(*batch[i])) {
+          deferred_ids[i] = write_id_deferred(*wd, batch[i]);
+        }
+      }
+    });
+    for (const int64_t i : batch.index_range()) {
+      if (deferred_ids[i]) {
+        write_id_deferred_finish(wd, batch[i], *deferred_ids[i]);
+        /* Free the serialized data early, it can be large. */
+        deferred_ids[i].reset();
+      }
+      else {
+        write_id(wd, batch[i]);
+      }
+    }
+  }
+}
+
 static void write_id_placeholder(WriteData *wd, ID *id)
 {
   mywrite_id_begin(wd, id);
@@ -1811,6 +1994,7 @@ static bool write_file_handle(Main *mainvar,
                               MemFile *current,
                               const int write_flags,
                               const bool use_userdef,
+                              const bool use_serial_write,
                               const BlendThumbnail *thumb,
                               std::ostream *debug_dst)
 {
@@ -1818,6 +2002,7 @@ static bool write_file_handle(Main *mainvar,
 
   wd = mywrite_begin(ww, compare, current);
   wd->debug_dst = debug_dst;
+  wd->use_serial_write = use_serial_write;
   wd->filepath = filepath;
   BlendWriter writer = {wd};
 
@@ -1857,9 +2042,7 @@ static bool write_file_handle(Main *mainvar,
   }
 
   /* Actually write local data-blocks to the file. */
-  for (ID *id : local_ids_to_write) {
-    write_id(wd, id);
-  }
+  write_ids(wd, local_ids_to_write);
 
   /* Write libraries about libraries and linked data-blocks. */
   write_libraries(wd, mainvar);
@@ -2128,8 +2311,16 @@ static bool BLO_write_file_impl(Main *mainvar,
 #endif
 
   /* Actual file writing. */
-  const bool err = write_file_handle(
-      mainvar, &ww, filepath, nullptr, nullptr, write_flags, use_userdef, thumb, debug_dst);
+  const bool err = write_file_handle(mainvar,
+                                     &ww,
+                                     filepath,
+                                     nullptr,
+                                     nullptr,
+                                     write_flags,
+                                     use_userdef,
+                                     params->use_serial_write,
+                                     thumb,
+                                     debug_dst);
 
   const bool close_error = !ww.close();
 
@@ -2200,7 +2391,7 @@ bool BLO_write_file_mem(Main *mainvar, MemFile *compare, MemFile *current, const
   bool use_userdef = false;
 
   const bool err = write_file_handle(
-      mainvar, nullptr, "", compare, current, write_flags, use_userdef, nullptr, nullptr);
+      mainvar, nullptr, "", compare, current, write_flags, use_userdef, false, nullptr, nullptr);
 
   return (err == 0);
 }
@@ -2355,7 +2546,13 @@ void BlendWriter::write_pointer_array(int64_t num, const void *data_ptr)
     data[i] = get_address_id(*this->wd, data[i]);
   }
 
+  WriteDataDeferredID *deferred = this->wd->deferred;
+  const int64_t block_offset = deferred ? deferred->stream.size() : 0;
   writedata(this->wd, BLO_CODE_DATA, data.data(), data.as_span().size_in_bytes(), data_ptr);
+  if (deferred && deferred->stream.size() > block_offset) {
+    /* Remember where the placeholders are, they have to be replaced later on. */
+    deferred->pointer_array_offsets.append(block_offset);
+  }
 }
 
 void BlendWriter::write_string(const char *data)
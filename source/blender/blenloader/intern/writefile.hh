@@ -16,6 +16,7 @@
 
 #include "BLI_map.hh"
 #include "BLI_set.hh"
+#include "BLI_vector.hh"
 
 #include "BLO_undofile.hh"
 
@@ -76,9 +77,33 @@ struct WriteDataStableAddressIDs {
   uint64_t next_id_hint = 0;
 };
 
+/**
+ * Serialized data of a single data-block that was written on a separate thread.
+ *
+ * Stable address ids depend on all the data-blocks written before, so they can't be generated
+ * while serializing data-blocks in parallel. Instead, placeholders are written, which are replaced
+ * with the actual address ids when the data is appended to the file in the original order. This
+ * makes the written file identical to writing all data-blocks serially.
+ */
+struct WriteDataDeferredID {
+  /** The serialized blocks, using placeholders instead of address ids. */
+  Vector<uchar> stream;
+  /**
+   * Runtime addresses in the order their address ids were requested. The placeholder `i + 1`
+   * stands for the address id of `addresses[i]`, zero is still used for null pointers.
+   */
+  Vector<const void *> addresses;
+  /** Start offsets of raw data blocks in #stream that only contain address ids. */
+  Vector<int64_t> pointer_array_offsets;
+  /** Set when serializing failed, see #WriteData::validation_data. */
+  bool critical_error = false;
+};
+
 struct WriteData {
   const SDNA *sdna;
   std::ostream *debug_dst = nullptr;
+  /** Don't serialize data-blocks in parallel, see #BlendFileWriteParams::use_serial_write. */
+  bool use_serial_write = false;
 
   struct {
     /** Use for file and memory writing (size stored in max_size). */
@@ -141,6 +166,12 @@ struct WriteData {
    */
   WriteWrap *ww;
 
+  /**
+   * When not null, all data is written to this buffer instead of the file, and address ids are
+   * replaced by placeholders. Used to serialize data-blocks in parallel.
+   */
+  WriteDataDeferredID *deferred = nullptr;
+
   /** Filepath being written to, may be the empty string. */
   std::string filepath;
 
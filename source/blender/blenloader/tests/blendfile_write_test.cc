@@ -0,0 +1,226 @@
+/* SPDX-FileCopyrightText: 2026 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+#include "blendfile_loading_base_test.h"
+
+#include <fstream>
+#include <sstream>
+
+#include "BKE_appdir.hh"
+#include "BKE_collection.hh"
+#include "BKE_curves.hh"
+#include "BKE_global.hh"
+#include "BKE_image.hh"
+#include "BKE_lib_id.hh"
+#include "BKE_main.hh"
+#include "BKE_mesh.h"
+#include "BKE_mesh.hh"
+#include "BKE_node.hh"
+#include "BKE_node_legacy_types.hh"
+#include "BKE_object.hh"
+#include "BKE_packedFile.hh"
+#include "BKE_pointcloud.hh"
+#include "BKE_report.hh"
+#include "BKE_scene.hh"
+
+#include "BLI_math_vector_types.hh"
+#include "BLI_path_utils.hh"
+#include "BLI_string.hh"
+#include "BLI_threads.hh"
+
+#include "BLO_readfile.hh"
+#include "BLO_writefile.hh"
+
+#include "DNA_curves_types.h"
+#include "DNA_image_types.h"
+#include "DNA_mesh_types.h"
+#include "DNA_node_types.h"
+#include "DNA_object_types.h"
+#include "DNA_packedFile_types.h"
+#include "DNA_pointcloud_types.h"
+#include "DNA_scene_types.h"
+#include "DNA_vfont_types.h"
+
+#include "MEM_guardedalloc.h"
+
+namespace blender {
+
+class BlendfileWritingTest : public BlendfileLoadingBaseTest {
+ protected:
+  Main *bmain_ = nullptr;
+  char filepath_[FILE_MAX];
+
+  void SetUp() override
+  {
+    BKE_tempdir_init(nullptr);
+    BLI_path_join(filepath_, sizeof(filepath_), BKE_tempdir_session(), "write_test.blend");
+    bmain_ = BKE_main_new();
+  }
+
+  void TearDown() override
+  {
+    BKE_main_free(bmain_);
+    BKE_tempdir_session_purge();
+    BlendfileLoadingBaseTest::TearDown();
+  }
+
+  /** Fan of triangles around the origin, with a different size for every mesh. */
+  void add_mesh_object(const int index)
+  {
+    const int verts_num = 3 + index * 7;
+    const int faces_num = verts_num - 2;
+    Mesh *mesh_src = BKE_mesh_new_nomain(verts_num, 0, faces_num, faces_num * 3);
+    MutableSpan<float3> positions = mesh_src->vert_positions_for_write();
+    for (const int i : positions.index_range()) {
+      positions[i] = float3(i, i % 5, index);
+    }
+    MutableSpan<int> face_offsets = mesh_src->face_offsets_for_write();
+    MutableSpan<int> corner_verts = mesh_src->corner_verts_for_write();
+    for (const int i : IndexRange(faces_num)) {
+      face_offsets[i] = i * 3;
+      corner_verts[i * 3 + 0] = 0;
+      corner_verts[i * 3 + 1] = i + 1;
+      corner_verts[i * 3 + 2] = i + 2;
+    }
+    face_offsets.last() = faces_num * 3;
+    mesh_src->tag_topology_changed();
+
+    Object *object = BKE_object_add_only_object(bmain_, OB_MESH, "Object");
+    Mesh *mesh = BKE_mesh_add(bmain_, "Mesh");
+    object->data = &mesh->id;
+    BKE_mesh_nomain_to_mesh(mesh_src, mesh, object);
+    Scene *scene = static_cast<Scene *>(bmain_->scenes.first);
+    BKE_collection_object_add(bmain_, scene->master_collection, object);
+  }
+
+  /**
+   * Data-blocks of the other types which are serialized in parallel, each with a fake user so
+   * that they are written.
+   */
+  void add_non_mesh_ids(const int index)
+  {
+    PointCloud *pointcloud = BKE_id_new<PointCloud>(bmain_, "PointCloud");
+    PointCloud *pointcloud_src = BKE_pointcloud_new_nomain(5 + index * 3);
+    MutableSpan<float3> point_positions = pointcloud_src->positions_for_write();
+    for (const int i : point_positions.index_range()) {
+      point_positions[i] = float3(i, index, 0.5f);
+    }
+    BKE_pointcloud_nomain_to_pointcloud(pointcloud_src, pointcloud);
+    id_fake_user_set(&pointcloud->id);
+
+    Curves *curves_id = BKE_id_new<Curves>(bmain_, "Curves");
+    bke::CurvesGeometry &curves = curves_id->geometry.wrap();
+    curves = bke::CurvesGeometry(4 * (index + 1), index + 1);
+    offset_indices::fill_constant_group_size(4, 0, curves.offsets_for_write());
+    MutableSpan<float3> curve_positions = curves.positions_for_write();
+    for (const int i : curve_positions.index_range()) {
+      curve_positions[i] = float3(index, i, i % 4);
+    }
+    id_fake_user_set(&curves_id->id);
+
+    bNodeTree *ntree = bke::node_tree_add_tree(bmain_, "Nodes", "GeometryNodeTree");
+    bNode *set_position = bke::node_add_static_node(nullptr, *ntree, GEO_NODE_SET_POSITION);
+    bNode *transform = bke::node_add_static_node(nullptr, *ntree, GEO_NODE_TRANSFORM_GEOMETRY);
+    transform->location[0] = float(index);
+    bke::node_add_link(*ntree,
+                       *set_position,
+                       *static_cast<bNodeSocket *>(set_position->outputs.first),
+                       *transform,
+                       *static_cast<bNodeSocket *>(transform->inputs.first));
+    id_fake_user_set(&ntree->id);
+
+    const float color[4] = {0.25f, 0.5f, float(index) / 16.0f, 1.0f};
+    Image *image = BKE_image_add_generated(
+        bmain_, 8, 8, "Image", 24, false, IMA_GENTYPE_BLANK, color, false, false, false);
+    id_fake_user_set(&image->id);
+  }
+
+  std::string write_file(const bool use_serial_write)
+  {
+    BlendFileWriteParams params{};
+    params.use_serial_write = use_serial_write;
+    ReportList reports;
+    BKE_reports_init(&reports, RPT_STORE);
+    EXPECT_TRUE(BLO_write_file(bmain_, filepath_, G_FILE_NO_UI, &params, &reports));
+    BKE_reports_free(&reports);
+
+    std::ifstream file(filepath_, std::ios::binary);
+    std::stringstream stream;
+    stream << file.rdbuf();
+    return stream.str();
+  }
+};
+
+TEST_F(BlendfileWritingTest, parallel_write_matches_serial)
+{
+  BKE_scene_add(bmain_, "Scene");
+  /* More meshes than serialized in parallel at once, so that there are multiple batches. */
+  const int objects_num = BLI_system_thread_count() * 3 + 1;
+  for (const int i : IndexRange(objects_num)) {
+    this->add_mesh_object(i);
+  }
+
+  const std::string serial = this->write_file(true);
+  const std::string parallel = this->write_file(false);
+  EXPECT_FALSE(serial.empty());
+  EXPECT_TRUE(serial == parallel);
+}
+
+TEST_F(BlendfileWritingTest, parallel_write_matches_serial_non_mesh)
+{
+  BKE_scene_add(bmain_, "Scene");
+  const int ids_num = BLI_system_thread_count() + 1;
+  for (const int i : IndexRange(ids_num)) {
+    this->add_non_mesh_ids(i);
+  }
+
+  const std::string serial = this->write_file(true);
+  const std::string parallel = this->write_file(false);
+  EXPECT_FALSE(serial.empty());
+  EXPECT_TRUE(serial == parallel);
+}
+
+TEST_F(BlendfileWritingTest, link_mapped_packed_data)
+{
+  /* Large enough to be referenced from the mapped library file instead of being read. */
+  constexpr int data_size = 4 * 1024 * 1024;
+  uint8_t *data = static_cast<uint8_t *>(
+      MEM_new_array_uninitialized(data_size, sizeof(uint8_t), __func__));
+  for (const int i : IndexRange(data_size)) {
+    data[i] = uint8_t(i * 7 + i / 256);
+  }
+  BKE_scene_add(bmain_, "Scene");
+  VFont *vfont = BKE_id_new<VFont>(bmain_, "Font");
+  vfont->packedfile = BKE_packedfile_new_from_memory(data, data_size);
+  id_fake_user_set(&vfont->id);
+  this->write_file(false);
+
+  Main *bmain = BKE_main_new();
+  const size_t mem_in_use = MEM_get_memory_in_use();
+  BlendHandle *bh = BLO_blendhandle_from_file(filepath_, nullptr);
+  ASSERT_NE(bh, nullptr);
+  LibraryLink_Params params;
+  BLO_library_link_params_init(&params, bmain, 0, 0);
+  Main *mainl = BLO_library_link_begin(&bh, filepath_, &params);
+  VFont *vfont_linked = reinterpret_cast<VFont *>(
+      BLO_library_link_named_part(mainl, &bh, ID_VF, "Font", &params));
+  BLO_library_link_end(mainl, &bh, &params, nullptr);
+  if (bh) {
+    BLO_blendhandle_close(bh);
+  }
+
+  ASSERT_NE(vfont_linked, nullptr);
+  const PackedFile *pf = vfont_linked->packedfile;
+  ASSERT_NE(pf, nullptr);
+  ASSERT_EQ(pf->size, data_size);
+  EXPECT_EQ(memcmp(pf->data, vfont->packedfile->data, data_size), 0);
+#ifndef WIN32
+  /* The packed data references the mapped file, it is not read into memory. */
+  EXPECT_LT(MEM_get_memory_in_use() - mem_in_use, size_t(data_size));
+#endif
+  UNUSED_VARS(mem_in_use);
+
+  BKE_main_free(bmain);
+}
+
+}  // namespace blender
@@ -15,15 +15,19 @@ struct FileReader;
  * Ownership of the rawfile is transferred to the function. The returned reader may be the same or
  * may wrap the provided reader.
  *
+ * \param use_read_ahead: Decompress data ahead of the read position on worker threads, see
+ * #BLI_filereader_new_zstd. Only useful when the whole file is going to be read.
+ *
  * \return null if the file is detected to not be a blend file.
  */
-FileReader *BLO_file_reader_uncompressed(FileReader *rawfile);
+FileReader *BLO_file_reader_uncompressed(FileReader *rawfile, bool use_read_ahead = false);
 
 /**
  * Same as #BLO_file_reader_uncompressed but uses a file descriptor. Ownership of the descriptor
  * is passed to the function. So the file will be closed if it's not a valid blend file.
  */
-FileReader *BLO_file_reader_uncompressed_from_descriptor(int filedes);
+FileReader *BLO_file_reader_uncompressed_from_descriptor(int filedes,
+                                                         bool use_read_ahead = false);
 
 /**
  * Same as #BLO_file_reader_uncompressed but directly reads from an existing buffer. Ownership of
@@ -18,14 +18,14 @@
 
 namespace blender {
 
-FileReader *BLO_file_reader_uncompressed_from_descriptor(int filedes)
+FileReader *BLO_file_reader_uncompressed_from_descriptor(int filedes, const bool use_read_ahead)
 {
   if (FileReader *mmap_reader = BLI_filereader_new_mmap(filedes)) {
     /* The mapped memory is still valid even when the file is closed. */
     close(filedes);
-    return BLO_file_reader_uncompressed(mmap_reader);
+    return BLO_file_reader_uncompressed(mmap_reader, use_read_ahead);
   }
-  return BLO_file_reader_uncompressed(BLI_filereader_new_file(filedes));
+  return BLO_file_reader_uncompressed(BLI_filereader_new_file(filedes), use_read_ahead);
 }
 
 FileReader *BLO_file_reader_uncompressed_from_memory(const void *mem, const int memsize)
@@ -33,7 +33,7 @@ FileReader *BLO_file_reader_uncompressed_from_memory(const void *mem, const int
   return BLO_file_reader_uncompressed(BLI_filereader_new_memory(mem, memsize));
 }
 
-FileReader *BLO_file_reader_uncompressed(FileReader *rawfile)
+FileReader *BLO_file_reader_uncompressed(FileReader *rawfile, const bool use_read_ahead)
 {
   if (!rawfile) {
     return nullptr;
@@ -56,7 +56,7 @@ FileReader *BLO_file_reader_uncompressed(FileReader *rawfile)
   }
   if (BLI_file_magic_is_zstd(first_bytes)) {
     /* The new reader takes ownership of the rawfile. */
-    return BLI_filereader_new_zstd(rawfile);
+    return BLI_filereader_new_zstd(rawfile, use_read_ahead);
   }
   rawfile->close(rawfile);
   return nullptr;
@@ -72,6 +72,15 @@ void DEG_graph_relations_update(Depsgraph *graph);
 /** Tag all relations in the database for update. */
 void DEG_relations_tag_update(Main *bmain);
 
+/**
+ * Tag relations of the given ID for update, after a change which only affects dependencies of
+ * this ID (such as adding or removing a modifier or a constraint).
+ *
+ * Dependency graphs are allowed to only re-build the part of the graph which belongs to the ID,
+ * falling back to a full re-build when the change can not be handled locally.
+ */
+void DEG_id_relations_tag_update(Main *bmain, ID *id);
+
 /* Add Dependencies  ----------------------------- */
 
 /**
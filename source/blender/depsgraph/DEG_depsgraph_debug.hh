@@ -55,6 +55,13 @@ void DEG_debug_stats_gnuplot(const Depsgraph *graph,
                              const char *label,
                              const char *output_filename);
 
+/**
+ * Trace of the operations evaluated during the last evaluation of the graph, in the Chrome trace
+ * event format (which can be opened in Perfetto). Operations are only recorded when timing debug
+ * is enabled (`--debug-depsgraph-time`).
+ */
+std::string DEG_debug_eval_trace_to_json(const Depsgraph &graph);
+
 /* ************************************************ */
 
 /** Compare two dependency graphs. */
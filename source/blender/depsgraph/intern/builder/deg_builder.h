@@ -8,6 +8,8 @@
 
 #pragma once
 
+#include "BLI_set.hh"
+
 namespace blender {
 
 struct Base;
@@ -23,6 +25,7 @@ namespace deg {
 
 struct Depsgraph;
 class DepsgraphBuilderCache;
+struct IDNode;
 
 class DepsgraphBuilder {
  public:
@@ -58,6 +61,9 @@ class DepsgraphBuilder {
 bool deg_check_id_in_depsgraph(const Depsgraph *graph, ID *id_orig);
 bool deg_check_base_in_depsgraph(const Depsgraph *graph, Base *base);
 void deg_graph_build_finalize(Main *bmain, Depsgraph *graph);
+/* Same as above, but only finalizes the given ID nodes. The rest of the ID nodes are expected to
+ * be finalized by a previous build. */
+void deg_graph_build_finalize(Main *bmain, Depsgraph *graph, const Set<IDNode *> &id_nodes);
 
 }  // namespace deg
 }  // namespace blender
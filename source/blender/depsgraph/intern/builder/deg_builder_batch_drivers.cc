@@ -0,0 +1,271 @@
+/* SPDX-FileCopyrightText: 2025 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+
+/** \file
+ * \ingroup depsgraph
+ *
+ * Drivers are evaluated one operation per F-Curve. For rigs with thousands of drivers the cost of
+ * scheduling those operations is much higher than the cost of evaluating simple expressions, so
+ * drivers which do not need Python are merged into batch operations.
+ *
+ * Merging operations must not introduce dependency cycles. Operations which have the same level
+ * in the graph (the length of the longest path from a root operation) can not depend on each
+ * other, so only drivers of the same ID which share the level are merged.
+ */
+
+#include "intern/builder/deg_builder_batch_drivers.h"
+
+#include <algorithm>
+
+#include "DNA_anim_types.h"
+
+#include "BKE_anim_data.hh"
+#include "BKE_animsys.hh"
+#include "BKE_fcurve_driver.h"
+
+#include "intern/node/deg_node.hh"
+#include "intern/node/deg_node_component.hh"
+#include "intern/node/deg_node_id.hh"
+#include "intern/node/deg_node_operation.hh"
+
+#include "intern/debug/deg_debug.h"
+#include "intern/depsgraph.hh"
+#include "intern/depsgraph_relation.hh"
+
+#include "DEG_depsgraph_debug.hh"
+
+namespace blender::deg {
+
+/* Upper limit of the number of drivers in a batch, so that big rigs still benefit from
+ * multi-threaded evaluation of independent drivers. */
+static constexpr int drivers_batch_max_size = 256;
+
+namespace {
+
+struct DriverOperation {
+  OperationNode *op_node;
+  int driver_index;
+  FCurve *fcurve;
+};
+
+}  // namespace
+
+static bool driver_can_be_batched(FCurve *fcurve)
+{
+  ChannelDriver *driver = fcurve->driver;
+  if (driver == nullptr) {
+    return false;
+  }
+  return driver->type != DRIVER_TYPE_PYTHON || BKE_driver_has_simple_expression(driver);
+}
+
+/* Collect driver operations of the given parameters component which can be batched. */
+static void collect_driver_operations(ComponentNode *comp_node, Vector<DriverOperation> &r_drivers)
+{
+  AnimData *adt = BKE_animdata_from_id(comp_node->owner->id_orig);
+  if (adt == nullptr) {
+    return;
+  }
+  /* Drivers with the same RNA path share the operation which evaluates the first of them. */
+  Set<OperationNode *> visited_operations;
+  for (const auto [driver_index, fcu] : adt->drivers.enumerate()) {
+    OperationNode *op_node = comp_node->find_operation(
+        OperationCode::DRIVER, fcu.rna_path(), fcu.array_index);
+    if (op_node == nullptr || !visited_operations.add(op_node)) {
+      continue;
+    }
+    if (driver_can_be_batched(&fcu)) {
+      r_drivers.append({op_node, driver_index, &fcu});
+    }
+  }
+}
+
+static bool is_scheduling_relation(const Relation *rel)
+{
+  return rel->from->type == NodeType::OPERATION && rel->to->type == NodeType::OPERATION &&
+         (rel->flag & RELATION_FLAG_CYCLIC) == 0;
+}
+
+/* Store the level of every operation in its custom flags. Operations which are not reachable by
+ * the scheduling (which should not happen after cycles are solved) get level of -1. */
+static void calculate_operation_levels(Depsgraph *graph)
+{
+  Vector<OperationNode *> queue;
+  queue.reserve(graph->operations.size());
+  for (OperationNode *op_node : graph->operations) {
+    op_node->custom_flags = 0;
+    op_node->num_links_pending = 0;
+    for (Relation *rel : op_node->inlinks) {
+      if (is_scheduling_relation(rel)) {
+        ++op_node->num_links_pending;
+      }
+    }
+    if (op_node->num_links_pending == 0) {
+      queue.append(op_node);
+    }
+  }
+  for (int i = 0; i < queue.size(); i++) {
+    OperationNode *op_node = queue[i];
+    for (Relation *rel : op_node->outlinks) {
+      if (!is_scheduling_relation(rel)) {
+        continue;
+      }
+      OperationNode *to = static_cast<OperationNode *>(rel->to);
+      to->custom_flags = std::max(to->custom_flags, op_node->custom_flags + 1);
+      if (--to->num_links_pending == 0) {
+        queue.append(to);
+      }
+    }
+  }
+  for (OperationNode *op_node : graph->operations) {
+    if (op_node->num_links_pending != 0) {
+      op_node->custom_flags = -1;
+    }
+  }
+}
+
+/* Index of the first new batch of the component. Batches which already exist in the component
+ * keep their index, so that the operation keys stay unique. */
+static int drivers_batch_index_start(const ComponentNode *comp_node)
+{
+  int batch_index = 0;
+  for (const OperationNode *op_node : comp_node->operations_map->values()) {
+    if (op_node->opcode == OperationCode::DRIVERS_BATCH) {
+      batch_index = std::max(batch_index, op_node->name_tag + 1);
+    }
+  }
+  return batch_index;
+}
+
+static void merge_driver_operations(Depsgraph *graph,
+                                    ComponentNode *comp_node,
+                                    const Span<DriverOperation> drivers,
+                                    const int batch_index,
+                                    Set<OperationNode *> &r_removed_operations)
+{
+  Vector<int> driver_indices;
+  Vector<FCurve *> fcurves;
+  for (const DriverOperation &driver : drivers) {
+    driver_indices.append(driver.driver_index);
+    fcurves.append(driver.fcurve);
+  }
+  ID *id_cow = comp_node->owner->id_cow;
+  OperationNode *batch_node = comp_node->add_operation(
+      [id_cow, driver_indices, fcurves](blender::Depsgraph *depsgraph) {
+        BKE_animsys_eval_drivers(depsgraph, id_cow, driver_indices, fcurves);
+      },
+      OperationCode::DRIVERS_BATCH,
+      "",
+      batch_index);
+  graph->operations.append(batch_node);
+
+  for (const DriverOperation &driver : drivers) {
+    r_removed_operations.add_new(driver.op_node);
+  }
+  auto is_removed = [&](const Node *node) {
+    return node->type == NodeType::OPERATION &&
+           r_removed_operations.contains(static_cast<OperationNode *>(const_cast<Node *>(node)));
+  };
+
+  for (const DriverOperation &driver : drivers) {
+    OperationNode *op_node = driver.op_node;
+    batch_node->flag |= op_node->flag;
+    if (graph->entry_tags.remove(op_node)) {
+      graph->entry_tags.add(batch_node);
+    }
+    /* Relations between operations of the batch can only exist when they are cyclic, and are
+     * dropped together with the operations. */
+    for (Relation *rel : op_node->inlinks) {
+      if (!is_removed(rel->from)) {
+        graph->add_new_relation(
+            rel->from, batch_node, rel->name, rel->flag | RELATION_CHECK_BEFORE_ADD);
+      }
+    }
+    for (Relation *rel : op_node->outlinks) {
+      if (!is_removed(rel->to)) {
+        graph->add_new_relation(
+            batch_node, rel->to, rel->name, rel->flag | RELATION_CHECK_BEFORE_ADD);
+      }
+    }
+  }
+
+  for (const DriverOperation &driver : drivers) {
+    OperationNode *op_node = driver.op_node;
+    while (!op_node->inlinks.is_empty()) {
+      op_node->inlinks.last()->unlink();
+    }
+    while (!op_node->outlinks.is_empty()) {
+      op_node->outlinks.last()->unlink();
+    }
+    comp_node->operations_map->remove(ComponentNode::OperationIDKey(
+        op_node->opcode, op_node->name, op_node->name_tag));
+    delete op_node;
+  }
+}
+
+void deg_graph_batch_drivers(Depsgraph *graph)
+{
+  /* Collect drivers of the components which are being built, the ones which were finalized
+   * already do not have the operations map anymore. */
+  Vector<std::pair<ComponentNode *, Vector<DriverOperation>>> drivers_per_component;
+  for (IDNode *id_node : graph->id_nodes) {
+    ComponentNode *comp_node = id_node->find_component(NodeType::PARAMETERS);
+    if (comp_node == nullptr || comp_node->operations_map == nullptr) {
+      continue;
+    }
+    Vector<DriverOperation> drivers;
+    collect_driver_operations(comp_node, drivers);
+    if (drivers.size() > 1) {
+      drivers_per_component.append({comp_node, std::move(drivers)});
+    }
+  }
+  if (drivers_per_component.is_empty()) {
+    return;
+  }
+
+  calculate_operation_levels(graph);
+
+  Set<OperationNode *> removed_operations;
+  int num_batches = 0;
+  for (auto &[comp_node, drivers] : drivers_per_component) {
+    drivers.remove_if([](const DriverOperation &driver) {
+      return driver.op_node->custom_flags == -1;
+    });
+    std::stable_sort(
+        drivers.begin(), drivers.end(), [](const DriverOperation &a, const DriverOperation &b) {
+          return a.op_node->custom_flags < b.op_node->custom_flags;
+        });
+    int batch_index = drivers_batch_index_start(comp_node);
+    int start = 0;
+    while (start < drivers.size()) {
+      const int level = drivers[start].op_node->custom_flags;
+      int end = start + 1;
+      while (end < drivers.size() && end - start < drivers_batch_max_size &&
+             drivers[end].op_node->custom_flags == level)
+      {
+        end++;
+      }
+      if (end - start > 1) {
+        merge_driver_operations(graph,
+                                comp_node,
+                                drivers.as_span().slice(start, end - start),
+                                batch_index++,
+                                removed_operations);
+        num_batches++;
+      }
+      start = end;
+    }
+  }
+
+  graph->operations.remove_if(
+      [&](OperationNode *op_node) { return removed_operations.contains(op_node); });
+
+  DEG_DEBUG_PRINTF(reinterpret_cast<blender::Depsgraph *>(graph),
+                   BUILD,
+                   "Merged %d driver operations into %d batches\n",
+                   int(removed_operations.size()),
+                   num_batches);
+}
+
+}  // namespace blender::deg
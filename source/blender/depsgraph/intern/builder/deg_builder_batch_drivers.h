@@ -0,0 +1,21 @@
+/* SPDX-FileCopyrightText: 2025 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+
+/** \file
+ * \ingroup depsgraph
+ */
+
+#pragma once
+
+namespace blender::deg {
+
+struct Depsgraph;
+
+/* Merge driver operations which do not need Python into batch operations, one per group of
+ * drivers of the same ID which do not depend on each other.
+ * Only components which are still being built (have their operations map) are handled, and new
+ * batches are numbered after the ones which already exist in the component. */
+void deg_graph_batch_drivers(Depsgraph *graph);
+
+}  // namespace blender::deg
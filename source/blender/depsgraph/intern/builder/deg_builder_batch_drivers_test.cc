@@ -0,0 +1,106 @@
+/* SPDX-FileCopyrightText: 2026 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+
+/** \file
+ * \ingroup depsgraph
+ */
+
+#include "MEM_guardedalloc.h"
+
+#include "BKE_anim_data.hh"
+#include "BKE_fcurve.hh"
+#include "BKE_gtest_base.hh"
+#include "BKE_main.hh"
+#include "BKE_object.hh"
+#include "BKE_scene.hh"
+
+#include "DEG_depsgraph.hh"
+#include "DEG_depsgraph_build.hh"
+#include "DEG_depsgraph_query.hh"
+
+#include "BLI_listbase.hh"
+#include "BLI_memory_utils.hh"
+#include "BLI_string.hh"
+
+#include "DNA_anim_types.h"
+#include "DNA_object_types.h"
+#include "DNA_scene_types.h"
+
+#include "intern/builder/deg_builder_test_util.hh"
+#include "intern/depsgraph.hh"
+#include "intern/node/deg_node_operation.hh"
+
+#include "testing/testing.h"
+
+#include <algorithm>
+
+namespace blender::deg::tests {
+
+class DepsgraphBatchDriversTest : public bke::BlenderGTestBase {};
+
+static void add_simple_expression_driver(Object *object,
+                                         const char *rna_path,
+                                         const int array_index,
+                                         const char *expression)
+{
+  AnimData *adt = BKE_animdata_ensure_id(&object->id);
+  FCurve *fcu = BKE_fcurve_create();
+  fcu->rna_path_set(rna_path);
+  fcu->array_index = array_index;
+  fcu->driver = MEM_new<ChannelDriver>("ChannelDriver");
+  fcu->driver->type = DRIVER_TYPE_PYTHON;
+  STRNCPY(fcu->driver->expression, expression);
+  BLI_addtail(&adt->drivers, fcu);
+}
+
+static int drivers_batches_num(const blender::Depsgraph *depsgraph)
+{
+  const deg::Depsgraph *deg_graph = reinterpret_cast<const deg::Depsgraph *>(depsgraph);
+  return std::count_if(
+      deg_graph->operations.begin(), deg_graph->operations.end(), [](const OperationNode *op) {
+        return op->opcode == OperationCode::DRIVERS_BATCH;
+      });
+}
+
+TEST_F(DepsgraphBatchDriversTest, relations_update_twice)
+{
+  Main *bmain = BKE_main_new();
+  BLI_SCOPED_DEFER([&]() { BKE_main_free(bmain); });
+  Scene *scene = BKE_scene_add(bmain, "Scene");
+  ViewLayer *view_layer = static_cast<ViewLayer *>(scene->view_layers.first);
+  Object *object = BKE_object_add(bmain, scene, view_layer, OB_EMPTY, "Rig");
+  BKE_object_add(bmain, scene, view_layer, OB_EMPTY, "Other");
+  for (const char *rna_path : {"location", "rotation_euler", "scale"}) {
+    for (const int i : IndexRange(3)) {
+      add_simple_expression_driver(object, rna_path, i, "0.5");
+    }
+  }
+
+  blender::Depsgraph *depsgraph = DEG_graph_new(bmain, scene, view_layer, DAG_EVAL_VIEWPORT);
+  BLI_SCOPED_DEFER([&]() { DEG_graph_free(depsgraph); });
+  DEG_graph_build_from_view_layer(depsgraph);
+  BKE_scene_graph_update_tagged(depsgraph, bmain);
+
+  const Vector<std::string> full_build = graph_description(depsgraph);
+  EXPECT_GT(drivers_batches_num(depsgraph), 0);
+  EXPECT_EQ(DEG_get_evaluated(depsgraph, object)->loc[0], 0.5f);
+
+  /* The localized update finalizes the re-built object again, batches must not collide with the
+   * ones which are already in the graph. */
+  for ([[maybe_unused]] const int i : IndexRange(2)) {
+    DEG_id_relations_tag_update(bmain, &object->id);
+    DEG_graph_relations_update(depsgraph);
+    BKE_scene_graph_update_tagged(depsgraph, bmain);
+    EXPECT_EQ(graph_description(depsgraph), full_build);
+    EXPECT_EQ(DEG_get_evaluated(depsgraph, object)->loc[2], 0.5f);
+    EXPECT_EQ(DEG_get_evaluated(depsgraph, object)->scale[1], 0.5f);
+  }
+
+  /* Same for the full re-build. */
+  DEG_graph_tag_relations_update(depsgraph);
+  DEG_graph_relations_update(depsgraph);
+  EXPECT_EQ(graph_description(depsgraph), full_build);
+}
+
+}  // namespace blender::deg::tests
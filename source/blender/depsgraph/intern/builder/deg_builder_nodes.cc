@@ -896,6 +896,8 @@ void DepsgraphNodeBuilder::build_object_flags(int base_index,
   if (base_index == -1) {
     return;
   }
+  IDNode *id_node = find_id_node(&object->id);
+  id_node->base_index = base_index;
   Scene *scene_cow = get_cow_datablock(scene_);
   Object *object_cow = get_cow_datablock(object);
   const bool is_from_set = (linked_state == DEG_ID_LINKED_VIA_SET);
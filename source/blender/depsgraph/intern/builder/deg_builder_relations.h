@@ -85,7 +85,7 @@ class DepsgraphRelationBuilder : public DepsgraphBuilder {
  public:
   DepsgraphRelationBuilder(Main *bmain, Depsgraph *graph, DepsgraphBuilderCache *cache);
 
-  void begin_build();
+  virtual void begin_build();
 
   template<typename KeyFrom, typename KeyTo>
   Relation *add_relation(const KeyFrom &key_from,
@@ -345,6 +345,7 @@ class DepsgraphRelationBuilder : public DepsgraphBuilder {
 
   static void constraint_walk(bConstraint *con, ID **idpoin, bool is_reference, void *user_data);
 
+ protected:
   /* State which demotes currently built entities. */
   Scene *scene_;
 
@@ -0,0 +1,56 @@
+/* SPDX-FileCopyrightText: 2026 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+
+/** \file
+ * \ingroup depsgraph
+ *
+ * Utilities for tests which compare dependency graphs built in different ways.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <string>
+
+#include "BLI_set.hh"
+#include "BLI_vector.hh"
+
+#include "intern/depsgraph.hh"
+#include "intern/depsgraph_relation.hh"
+#include "intern/node/deg_node_component.hh"
+#include "intern/node/deg_node_operation.hh"
+
+#include "testing/testing.h"
+
+namespace blender::deg::tests {
+
+inline std::string operation_key(const OperationNode *op_node)
+{
+  return op_node->full_identifier() + "[" + std::to_string(int(op_node->owner->type)) + "#" +
+         std::to_string(op_node->name_tag) + "]";
+}
+
+/* Sorted description of all operations and relations between them, which does not depend on the
+ * order in which the graph was built. */
+inline Vector<std::string> graph_description(const blender::Depsgraph *depsgraph)
+{
+  const deg::Depsgraph *deg_graph = reinterpret_cast<const deg::Depsgraph *>(depsgraph);
+  Vector<std::string> description;
+  Set<std::string> operation_keys;
+  for (const OperationNode *op_node : deg_graph->operations) {
+    const std::string key = operation_key(op_node);
+    EXPECT_TRUE(operation_keys.add(key)) << "Duplicate operation " << key;
+    description.append(key);
+    for (const Relation *rel : op_node->outlinks) {
+      if (rel->to->type == NodeType::OPERATION) {
+        description.append(key + " -> " +
+                           operation_key(static_cast<const OperationNode *>(rel->to)));
+      }
+    }
+  }
+  std::sort(description.begin(), description.end());
+  return description;
+}
+
+}  // namespace blender::deg::tests
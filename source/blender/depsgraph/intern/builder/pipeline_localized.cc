@@ -0,0 +1,373 @@
+/* SPDX-FileCopyrightText: 2025 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+
+#include "pipeline_localized.h"
+
+#include <optional>
+
+#include "BLI_listbase.hh"
+#include "BLI_time.hh"
+
+#include "BKE_global.hh"
+
+#include "DNA_object_force_types.h"
+#include "DNA_object_types.h"
+
+#include "DEG_depsgraph.hh"
+
+#include "intern/builder/deg_builder.h"
+#include "intern/builder/deg_builder_cycle.h"
+#include "intern/builder/deg_builder_key.h"
+#include "intern/builder/deg_builder_nodes.h"
+#include "intern/builder/deg_builder_relations.h"
+#include "intern/depsgraph.hh"
+#include "intern/depsgraph_relation.hh"
+#include "intern/depsgraph_tag.hh"
+#include "intern/node/deg_node_component.hh"
+#include "intern/node/deg_node_id.hh"
+#include "intern/node/deg_node_operation.hh"
+
+namespace blender::deg {
+
+/* Relation between an operation of a re-built ID and a node outside of it.
+ * Operations of the re-built IDs are referenced by key, as the nodes are re-created. */
+struct SavedRelation {
+  Node *from = nullptr;
+  Node *to = nullptr;
+  std::optional<PersistentOperationKey> from_key;
+  std::optional<PersistentOperationKey> to_key;
+  const char *name;
+  int flag;
+};
+
+struct LocalizedBuildState {
+  /* ID nodes whose nodes and relations are re-built. */
+  Set<IDNode *> id_nodes;
+  /* All ID nodes which were in the graph prior to the update. */
+  Set<IDNode *> id_nodes_before_build;
+  /* ID nodes which are to be finalized: the re-built ones and the ones which were added to the
+   * graph by the update. */
+  Set<IDNode *> id_nodes_to_finalize;
+  Vector<SavedRelation> relations;
+  /* Set when an operation of a saved relation was not re-created. Such operations might have been
+   * added to the re-built ID by the node builders of other IDs (e.g. custom properties read by
+   * drivers), so the relation can not be dropped and a full re-build is needed. */
+  bool has_lost_relations = false;
+};
+
+namespace {
+
+IDNode *get_owner_id_node(const Node *node)
+{
+  if (node->type != NodeType::OPERATION) {
+    return nullptr;
+  }
+  return static_cast<const OperationNode *>(node)->owner->owner;
+}
+
+class LocalizedNodeBuilder : public DepsgraphNodeBuilder {
+ public:
+  LocalizedNodeBuilder(Main *bmain,
+                       Depsgraph *graph,
+                       DepsgraphBuilderCache *cache,
+                       LocalizedBuildState &state)
+      : DepsgraphNodeBuilder(bmain, graph, cache), state_(state)
+  {
+  }
+
+  void begin_build() override
+  {
+    for (IDNode *id_node : graph_->id_nodes) {
+      state_.id_nodes_before_build.add_new(id_node);
+      if (state_.id_nodes.contains(id_node)) {
+        begin_build_id_node(id_node);
+      }
+      else {
+        /* Nodes of all other IDs are kept as-is. Remember their evaluation masks, so that the
+         * finalization can detect whether the re-built IDs requested extra data from them. */
+        built_map_.tag_built(id_node->id_orig);
+        id_node->previous_eval_flags = id_node->eval_flags;
+        id_node->previous_customdata_masks = id_node->customdata_masks;
+      }
+    }
+  }
+
+  void end_build() override
+  {
+    /* NOTE: Light linking cache is not updated, objects which use light linking are not
+     * re-built locally. */
+    tag_previously_tagged_nodes();
+    /* The evaluated copies of the re-built IDs might be referencing IDs which are now added to
+     * or removed from the graph, so make sure their pointers are re-mapped. */
+    for (IDNode *id_node : state_.id_nodes) {
+      graph_id_tag_update(
+          bmain_, graph_, id_node->id_orig, ID_RECALC_SYNC_TO_EVAL, DEG_UPDATE_SOURCE_RELATIONS);
+    }
+  }
+
+  void build_id_nodes()
+  {
+    /* NOTE: Pass view layer index of 0 since after scene evaluated copy there is only one view
+     * layer in there, same as #build_view_layer(). */
+    scene_ = graph_->scene;
+    view_layer_ = graph_->view_layer;
+    view_layer_index_ = 0;
+    for (IDNode *id_node : state_.id_nodes) {
+      Object *object = reinterpret_cast<Object *>(id_node->id_orig);
+      build_object(
+          id_node->base_index, object, id_node->linked_state, id_node->is_visible_on_build);
+      if (!graph_->has_animated_visibility) {
+        graph_->has_animated_visibility |= is_object_visibility_animated(object);
+      }
+    }
+  }
+
+ protected:
+  void begin_build_id_node(IDNode *id_node)
+  {
+    /* Keep the evaluated data-block and state accumulated from the rest of the graph, the
+     * #add_id_node() will re-use the existing ID node. */
+    IDInfo id_info{};
+    id_info.previously_visible_components_mask = id_node->visible_components_mask;
+    id_info.previous_eval_flags = id_node->eval_flags;
+    id_info.previous_customdata_masks = id_node->customdata_masks;
+    id_info_hash_.add_new(id_node->id_orig_session_uid, std::move(id_info));
+
+    for (ComponentNode *comp_node : id_node->components.values()) {
+      for (OperationNode *op_node : comp_node->operations) {
+        if (graph_->entry_tags.remove(op_node)) {
+          saved_entry_tags_.append_as(op_node);
+        }
+        if (op_node->flag & DEPSOP_FLAG_NEEDS_UPDATE) {
+          needs_update_operations_.append_as(op_node);
+        }
+        save_relations(op_node);
+        while (!op_node->inlinks.is_empty()) {
+          op_node->inlinks.last()->unlink();
+        }
+        while (!op_node->outlinks.is_empty()) {
+          op_node->outlinks.last()->unlink();
+        }
+      }
+    }
+
+    graph_->operations.remove_if(
+        [id_node](OperationNode *op_node) { return op_node->owner->owner == id_node; });
+    id_node->clear_components();
+  }
+
+  void save_relations(OperationNode *op_node)
+  {
+    IDNode *id_node = op_node->owner->owner;
+    for (Relation *rel : op_node->inlinks) {
+      IDNode *from_id_node = get_owner_id_node(rel->from);
+      if (from_id_node == id_node) {
+        /* Relations within the ID are re-created by the relations builder. */
+        continue;
+      }
+      state_.relations.append_as();
+      SavedRelation &saved_relation = state_.relations.last();
+      if (from_id_node != nullptr && state_.id_nodes.contains(from_id_node)) {
+        saved_relation.from_key.emplace(static_cast<OperationNode *>(rel->from));
+      }
+      else {
+        saved_relation.from = rel->from;
+      }
+      saved_relation.to_key.emplace(op_node);
+      saved_relation.name = rel->name;
+      saved_relation.flag = rel->flag;
+    }
+    for (Relation *rel : op_node->outlinks) {
+      IDNode *to_id_node = get_owner_id_node(rel->to);
+      if (to_id_node != nullptr && state_.id_nodes.contains(to_id_node)) {
+        /* Saved as an incoming relation of the re-built ID. */
+        continue;
+      }
+      state_.relations.append_as();
+      SavedRelation &saved_relation = state_.relations.last();
+      saved_relation.from_key.emplace(op_node);
+      saved_relation.to = rel->to;
+      saved_relation.name = rel->name;
+      saved_relation.flag = rel->flag;
+    }
+  }
+
+  LocalizedBuildState &state_;
+};
+
+class LocalizedRelationBuilder : public DepsgraphRelationBuilder {
+ public:
+  LocalizedRelationBuilder(Main *bmain,
+                           Depsgraph *graph,
+                           DepsgraphBuilderCache *cache,
+                           LocalizedBuildState &state)
+      : DepsgraphRelationBuilder(bmain, graph, cache), state_(state)
+  {
+  }
+
+  void begin_build() override
+  {
+    for (IDNode *id_node : state_.id_nodes_before_build) {
+      if (!state_.id_nodes.contains(id_node)) {
+        built_map_.tag_built(id_node->id_orig);
+      }
+    }
+  }
+
+  void build_id_nodes()
+  {
+    scene_ = graph_->scene;
+    for (IDNode *id_node : state_.id_nodes) {
+      build_object(reinterpret_cast<Object *>(id_node->id_orig));
+    }
+    restore_relations();
+  }
+
+  void build_copy_on_write_relations() override
+  {
+    for (IDNode *id_node : state_.id_nodes_to_finalize) {
+      DepsgraphRelationBuilder::build_copy_on_write_relations(id_node);
+    }
+  }
+
+  void build_driver_relations() override
+  {
+    for (IDNode *id_node : state_.id_nodes_to_finalize) {
+      DepsgraphRelationBuilder::build_driver_relations(id_node);
+    }
+  }
+
+ protected:
+  Node *find_saved_relation_node(Node *node, const std::optional<PersistentOperationKey> &key)
+  {
+    if (key.has_value()) {
+      return find_operation_node(*key);
+    }
+    return node;
+  }
+
+  void restore_relations()
+  {
+    for (const SavedRelation &saved_relation : state_.relations) {
+      Node *from = find_saved_relation_node(saved_relation.from, saved_relation.from_key);
+      Node *to = find_saved_relation_node(saved_relation.to, saved_relation.to_key);
+      if (from == nullptr || to == nullptr) {
+        state_.has_lost_relations = true;
+        return;
+      }
+      graph_->add_new_relation(
+          from, to, saved_relation.name, saved_relation.flag | RELATION_CHECK_BEFORE_ADD);
+    }
+  }
+
+  LocalizedBuildState &state_;
+};
+
+}  // namespace
+
+LocalizedBuilderPipeline::LocalizedBuilderPipeline(blender::Depsgraph *graph)
+    : AbstractBuilderPipeline(graph), state_(std::make_unique<LocalizedBuildState>())
+{
+  state_->id_nodes = deg_graph_->id_nodes_need_update_relations;
+}
+
+LocalizedBuilderPipeline::~LocalizedBuilderPipeline() = default;
+
+bool LocalizedBuilderPipeline::can_build_locally() const
+{
+  if (scene_ == nullptr || view_layer_ == nullptr) {
+    return false;
+  }
+  for (const IDNode *id_node : state_->id_nodes) {
+    if (id_node->id_type != ID_OB) {
+      return false;
+    }
+    if (id_node->linked_state != DEG_ID_LINKED_DIRECTLY || id_node->base_index == -1) {
+      return false;
+    }
+    const Object *object = reinterpret_cast<const Object *>(id_node->id_orig);
+    if (object->instance_collection != nullptr || object->light_linking != nullptr) {
+      return false;
+    }
+    if (!BLI_listbase_is_empty(&object->particlesystem)) {
+      return false;
+    }
+    /* Effectors are collected for the whole scene. */
+    if (object->pd != nullptr && object->pd->forcefield != 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool LocalizedBuilderPipeline::build()
+{
+  if (!can_build_locally()) {
+    return false;
+  }
+
+  double start_time = 0.0;
+  if (G.debug & (G_DEBUG_DEPSGRAPH_BUILD | G_DEBUG_DEPSGRAPH_TIME)) {
+    start_time = BLI_time_now_seconds();
+  }
+
+  build_step_sanity_check();
+  build_step_nodes();
+  build_step_relations();
+  if (state_->has_lost_relations) {
+    if (G.debug & G_DEBUG_DEPSGRAPH_BUILD) {
+      printf("Depsgraph relations can not be updated locally, doing a full re-build.\n");
+    }
+    return false;
+  }
+  build_step_finalize_localized();
+
+  if (G.debug & (G_DEBUG_DEPSGRAPH_BUILD | G_DEBUG_DEPSGRAPH_TIME)) {
+    printf("Depsgraph relations of %d ID(s) updated in %f seconds.\n",
+           int(state_->id_nodes.size()),
+           BLI_time_now_seconds() - start_time);
+  }
+  return true;
+}
+
+std::unique_ptr<DepsgraphNodeBuilder> LocalizedBuilderPipeline::construct_node_builder()
+{
+  return std::make_unique<LocalizedNodeBuilder>(bmain_, deg_graph_, &builder_cache_, *state_);
+}
+
+std::unique_ptr<DepsgraphRelationBuilder> LocalizedBuilderPipeline::construct_relation_builder()
+{
+  return std::make_unique<LocalizedRelationBuilder>(bmain_, deg_graph_, &builder_cache_, *state_);
+}
+
+void LocalizedBuilderPipeline::build_nodes(DepsgraphNodeBuilder &node_builder)
+{
+  static_cast<LocalizedNodeBuilder &>(node_builder).build_id_nodes();
+
+  for (IDNode *id_node : state_->id_nodes) {
+    state_->id_nodes_to_finalize.add(id_node);
+  }
+  for (IDNode *id_node : deg_graph_->id_nodes) {
+    if (!state_->id_nodes_before_build.contains(id_node)) {
+      state_->id_nodes_to_finalize.add(id_node);
+    }
+  }
+}
+
+void LocalizedBuilderPipeline::build_relations(DepsgraphRelationBuilder &relation_builder)
+{
+  static_cast<LocalizedRelationBuilder &>(relation_builder).build_id_nodes();
+}
+
+void LocalizedBuilderPipeline::build_step_finalize_localized()
+{
+  /* Cycles might have been introduced by the new relations anywhere in the graph. */
+  deg_graph_detect_cycles(deg_graph_);
+  deg_graph_build_finalize(bmain_, deg_graph_, state_->id_nodes_to_finalize);
+  DEG_graph_tag_on_visible_update(reinterpret_cast<blender::Depsgraph *>(deg_graph_), false);
+  deg_graph_->need_update_relations = false;
+  deg_graph_->id_nodes_need_update_relations.clear();
+}
+
+}  // namespace blender::deg
@@ -0,0 +1,52 @@
+/* SPDX-FileCopyrightText: 2025 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+
+/** \file
+ * \ingroup depsgraph
+ */
+
+#pragma once
+
+#include "pipeline.h"
+
+namespace blender::deg {
+
+struct LocalizedBuildState;
+
+/* Builder which re-builds nodes and relations of the IDs tagged with
+ * #DEG_id_relations_tag_update(), keeping the rest of the dependency graph intact.
+ *
+ * General notes:
+ *
+ * - Only objects which came to the graph via a base of the view layer are handled. Anything
+ *   else (instanced collections, particle systems, light linking, etc.) requires a full re-build.
+ * - Relations between the re-built IDs and the rest of the graph are restored after re-building.
+ *   Dependencies which went away are only removed on the next full re-build. When an operation
+ *   of such a relation is not re-created (e.g. a custom property operation added by the driver of
+ *   another ID), the update falls back to a full re-build instead of dropping the relation.
+ */
+class LocalizedBuilderPipeline : public AbstractBuilderPipeline {
+ public:
+  LocalizedBuilderPipeline(blender::Depsgraph *graph);
+  ~LocalizedBuilderPipeline() override;
+
+  /* Update relations of the tagged IDs.
+   * Returns false if the update can not be done locally. In this case the caller is expected to
+   * perform a full re-build, the graph might have been partially updated already. */
+  bool build();
+
+ protected:
+  std::unique_ptr<DepsgraphNodeBuilder> construct_node_builder() override;
+  std::unique_ptr<DepsgraphRelationBuilder> construct_relation_builder() override;
+
+  void build_nodes(DepsgraphNodeBuilder &node_builder) override;
+  void build_relations(DepsgraphRelationBuilder &relation_builder) override;
+
+  bool can_build_locally() const;
+  void build_step_finalize_localized();
+
+  std::unique_ptr<LocalizedBuildState> state_;
+};
+
+}  // namespace blender::deg
@@ -0,0 +1,222 @@
+/* SPDX-FileCopyrightText: 2026 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+
+/** \file
+ * \ingroup depsgraph
+ */
+
+#include "MEM_guardedalloc.h"
+
+#include "BKE_anim_data.hh"
+#include "BKE_constraint.h"
+#include "BKE_fcurve.hh"
+#include "BKE_fcurve_driver.h"
+#include "BKE_gtest_base.hh"
+#include "BKE_idprop.hh"
+#include "BKE_main.hh"
+#include "BKE_modifier.hh"
+#include "BKE_object.hh"
+#include "BKE_scene.hh"
+
+#include "DEG_depsgraph.hh"
+#include "DEG_depsgraph_build.hh"
+#include "DEG_depsgraph_query.hh"
+
+#include "BLI_listbase.hh"
+#include "BLI_math_matrix_types.hh"
+#include "BLI_math_vector_c.hh"
+#include "BLI_math_vector_types.hh"
+#include "BLI_memory_utils.hh"
+#include "BLI_string.hh"
+
+#include "DNA_anim_types.h"
+#include "DNA_constraint_types.h"
+#include "DNA_modifier_types.h"
+#include "DNA_object_types.h"
+#include "DNA_scene_types.h"
+
+#include "intern/builder/deg_builder_test_util.hh"
+#include "intern/node/deg_node_id.hh"
+
+#include "testing/testing.h"
+
+#include <algorithm>
+
+namespace blender::deg::tests {
+
+class DepsgraphLocalizedBuildTest : public bke::BlenderGTestBase {
+ protected:
+  Main *bmain_ = nullptr;
+  Scene *scene_ = nullptr;
+  ViewLayer *view_layer_ = nullptr;
+  Object *target_ = nullptr;
+  Object *owner_ = nullptr;
+  blender::Depsgraph *depsgraph_ = nullptr;
+
+  void SetUp() override
+  {
+    bmain_ = BKE_main_new();
+    scene_ = BKE_scene_add(bmain_, "Scene");
+    view_layer_ = static_cast<ViewLayer *>(scene_->view_layers.first);
+    target_ = BKE_object_add(bmain_, scene_, view_layer_, OB_EMPTY, "Target");
+    owner_ = BKE_object_add(bmain_, scene_, view_layer_, OB_MESH, "Owner");
+    BKE_object_add(bmain_, scene_, view_layer_, OB_EMPTY, "Other");
+
+    depsgraph_ = DEG_graph_new(bmain_, scene_, view_layer_, DAG_EVAL_VIEWPORT);
+    DEG_graph_build_from_view_layer(depsgraph_);
+    BKE_scene_graph_update_tagged(depsgraph_, bmain_);
+  }
+
+  void TearDown() override
+  {
+    DEG_graph_free(depsgraph_);
+    BKE_main_free(bmain_);
+  }
+
+  /** Update relations of the owner only, and return the resulting graph. */
+  Vector<std::string> update_owner_relations()
+  {
+    DEG_id_relations_tag_update(bmain_, &owner_->id);
+    DEG_graph_relations_update(depsgraph_);
+    BKE_scene_graph_update_tagged(depsgraph_, bmain_);
+    return graph_description(depsgraph_);
+  }
+
+  Vector<std::string> full_build_relations()
+  {
+    DEG_graph_tag_relations_update(depsgraph_);
+    DEG_graph_relations_update(depsgraph_);
+    BKE_scene_graph_update_tagged(depsgraph_, bmain_);
+    return graph_description(depsgraph_);
+  }
+
+  void move_target(const float3 &location)
+  {
+    copy_v3_v3(target_->loc, location);
+    DEG_id_tag_update(&target_->id, ID_RECALC_TRANSFORM);
+    BKE_scene_graph_update_tagged(depsgraph_, bmain_);
+  }
+};
+
+TEST_F(DepsgraphLocalizedBuildTest, constraint_add_remove)
+{
+  bConstraint *con = BKE_constraint_add_for_object(
+      owner_, "Copy Location", CONSTRAINT_TYPE_LOCLIKE);
+  static_cast<bLocateLikeConstraint *>(con->data)->tar = target_;
+
+  const Vector<std::string> localized = this->update_owner_relations();
+  this->move_target(float3(1.0f, 2.0f, 3.0f));
+  EXPECT_EQ(DEG_get_evaluated(depsgraph_, owner_)->object_to_world().location(),
+            float3(1.0f, 2.0f, 3.0f));
+  EXPECT_EQ(localized, this->full_build_relations());
+
+  /* Relations of the removed constraint may be kept until the next full re-build, but nothing may
+   * be missing. */
+  BKE_constraint_remove_ex(&owner_->constraints, owner_, con);
+  const Vector<std::string> localized_removed = this->update_owner_relations();
+  this->move_target(float3(0.0f));
+  EXPECT_EQ(DEG_get_evaluated(depsgraph_, owner_)->object_to_world().location(),
+            float3(0.0f));
+  const Vector<std::string> full_removed = this->full_build_relations();
+  EXPECT_TRUE(std::ranges::includes(localized_removed, full_removed));
+}
+
+TEST_F(DepsgraphLocalizedBuildTest, modifier_add_remove)
+{
+  ArrayModifierData *amd = reinterpret_cast<ArrayModifierData *>(
+      BKE_modifier_new(eModifierType_Array));
+  amd->offset_type |= MOD_ARR_OFF_OBJ;
+  amd->offset_ob = target_;
+  BLI_addtail(&owner_->modifiers, amd);
+  BKE_modifiers_persistent_uid_init(*owner_, amd->modifier);
+
+  EXPECT_EQ(this->update_owner_relations(), this->full_build_relations());
+
+  BKE_modifier_remove_from_list(owner_, &amd->modifier);
+  BKE_modifier_free(&amd->modifier);
+  const Vector<std::string> localized_removed = this->update_owner_relations();
+  const Vector<std::string> full_removed = this->full_build_relations();
+  EXPECT_TRUE(std::ranges::includes(localized_removed, full_removed));
+}
+
+/* Whether an operation of the given ID has a relation to an operation of another ID. */
+static bool has_relation_between_ids(const blender::Depsgraph *depsgraph,
+                                     const ID *from_id,
+                                     const OperationCode from_opcode,
+                                     const ID *to_id)
+{
+  const deg::Depsgraph *deg_graph = reinterpret_cast<const deg::Depsgraph *>(depsgraph);
+  const IDNode *from_id_node = deg_graph->find_id_node(from_id);
+  const IDNode *to_id_node = deg_graph->find_id_node(to_id);
+  for (const ComponentNode *comp_node : from_id_node->components.values()) {
+    for (const OperationNode *op_node : comp_node->operations) {
+      if (op_node->opcode != from_opcode) {
+        continue;
+      }
+      for (const Relation *rel : op_node->outlinks) {
+        if (rel->to->type == NodeType::OPERATION &&
+            static_cast<const OperationNode *>(rel->to)->owner->owner == to_id_node)
+        {
+          return true;
+        }
+      }
+    }
+  }
+  return false;
+}
+
+/* The operation of a custom property read by the driver of another object is created by the node
+ * builder of that object, so it is not re-created by the localized update of the owner. */
+TEST_F(DepsgraphLocalizedBuildTest, driver_on_custom_property)
+{
+  IDProperty *group = IDP_EnsureProperties(&owner_->id);
+  IDP_AddToGroup(group, bke::idprop::create("prop", 1.0f).release());
+
+  Object *driven = BKE_object_add(bmain_, scene_, view_layer_, OB_EMPTY, "Driven");
+  AnimData *adt = BKE_animdata_ensure_id(&driven->id);
+  FCurve *fcu = BKE_fcurve_create();
+  fcu->rna_path_set("location");
+  fcu->array_index = 0;
+  fcu->driver = MEM_new<ChannelDriver>("ChannelDriver");
+  fcu->driver->type = DRIVER_TYPE_AVERAGE;
+  DriverVar *dvar = driver_add_new_variable(fcu->driver);
+  dvar->targets[0].idtype = ID_OB;
+  dvar->targets[0].id = &owner_->id;
+  dvar->targets[0].rna_path = BLI_strdup("[\"prop\"]");
+  BLI_addtail(&adt->drivers, fcu);
+
+  this->full_build_relations();
+  EXPECT_TRUE(
+      has_relation_between_ids(depsgraph_, &owner_->id, OperationCode::ID_PROPERTY, &driven->id));
+  EXPECT_EQ(DEG_get_evaluated(depsgraph_, driven)->loc[0], 1.0f);
+
+  bConstraint *con = BKE_constraint_add_for_object(
+      owner_, "Copy Location", CONSTRAINT_TYPE_LOCLIKE);
+  static_cast<bLocateLikeConstraint *>(con->data)->tar = target_;
+  const Vector<std::string> localized = this->update_owner_relations();
+  EXPECT_TRUE(
+      has_relation_between_ids(depsgraph_, &owner_->id, OperationCode::ID_PROPERTY, &driven->id));
+  EXPECT_EQ(localized, this->full_build_relations());
+
+  /* The driver still follows the property. */
+  IDP_float_set(IDP_GetPropertyFromGroup(group, "prop"), 3.0f);
+  DEG_id_tag_update(&owner_->id, ID_RECALC_PARAMETERS);
+  BKE_scene_graph_update_tagged(depsgraph_, bmain_);
+  EXPECT_EQ(DEG_get_evaluated(depsgraph_, driven)->loc[0], 3.0f);
+}
+
+/* The update falls back to a full re-build for changes which can't be handled locally. */
+TEST_F(DepsgraphLocalizedBuildTest, scene_relations_update)
+{
+  bConstraint *con = BKE_constraint_add_for_object(
+      owner_, "Copy Location", CONSTRAINT_TYPE_LOCLIKE);
+  static_cast<bLocateLikeConstraint *>(con->data)->tar = target_;
+
+  DEG_id_relations_tag_update(bmain_, &scene_->id);
+  DEG_graph_relations_update(depsgraph_);
+  const Vector<std::string> updated = graph_description(depsgraph_);
+  EXPECT_EQ(updated, this->full_build_relations());
+}
+
+}  // namespace blender::deg::tests
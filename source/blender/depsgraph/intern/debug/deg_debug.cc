@@ -53,6 +53,11 @@ double DepsgraphDebug::total_evaluation_time() const
   return graph_evaluation_total_time_;
 }
 
+double DepsgraphDebug::evaluation_start_time() const
+{
+  return graph_evaluation_start_time_;
+}
+
 bool terminal_do_color()
 {
   return (G.debug & G_DEBUG_DEPSGRAPH_PRETTY) != 0;
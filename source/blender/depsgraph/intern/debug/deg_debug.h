@@ -10,10 +10,25 @@
 
 #include <string>
 
+#include "BLI_vector.hh"
+
 #include "BKE_global.hh"  // IWYU pragma: keep
 
 namespace blender::deg {
 
+/* Evaluation of a single operation, recorded for the evaluation trace. */
+struct EvalTraceEvent {
+  /* Full identifier of the evaluated operation. */
+  std::string name;
+  /* Start time and duration in seconds, relative to the start of the graph evaluation. */
+  double start_time;
+  double duration;
+  /* Estimated time of the critical path that the operation was scheduled with. */
+  double critical_path_time;
+  /* Identifier of the thread which evaluated the operation. */
+  uint64_t thread_id;
+};
+
 class DepsgraphDebug {
  public:
   DepsgraphDebug();
@@ -24,6 +39,7 @@ class DepsgraphDebug {
   void end_graph_evaluation();
 
   double total_evaluation_time() const;
+  double evaluation_start_time() const;
 
   /* NOTE: Corresponds to G_DEBUG_DEPSGRAPH_* flags. */
   int flags;
@@ -32,6 +48,10 @@ class DepsgraphDebug {
    * created for different view layer). */
   std::string name;
 
+  /* Operations evaluated during the last graph evaluation, only gathered when timing debug is
+   * enabled. Can be exported with #DEG_debug_eval_trace_to_json. */
+  Vector<EvalTraceEvent> eval_trace;
+
  protected:
   /* Maximum number of counters used to calculate frame rate of depsgraph update. */
   static const constexpr int MAX_FPS_COUNTERS = 64;
@@ -0,0 +1,56 @@
+/* SPDX-FileCopyrightText: 2026 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+
+/** \file
+ * \ingroup depsgraph
+ *
+ * Export of the evaluation trace in the Chrome trace event format.
+ */
+
+#include <sstream>
+
+#include "DEG_depsgraph_debug.hh"
+
+#include "BLI_map.hh"
+#include "BLI_serialize.hh"
+
+#include "intern/debug/deg_debug.h"
+#include "intern/depsgraph.hh"
+
+namespace blender {
+
+std::string DEG_debug_eval_trace_to_json(const Depsgraph &graph)
+{
+  using namespace io::serialize;
+  const deg::Depsgraph &deg_graph = reinterpret_cast<const deg::Depsgraph &>(graph);
+
+  DictionaryValue io_root;
+  io_root.append_str("displayTimeUnit", "ms");
+  std::shared_ptr<ArrayValue> io_events = io_root.append_array("traceEvents");
+
+  /* Give threads small sequential identifiers, which are easier to read in the trace viewer. */
+  Map<uint64_t, int> trace_thread_ids;
+  for (const deg::EvalTraceEvent &event : deg_graph.debug.eval_trace) {
+    const int tid = trace_thread_ids.lookup_or_add(event.thread_id, trace_thread_ids.size());
+
+    std::shared_ptr<DictionaryValue> io_event = io_events->append_dict();
+    io_event->append_str("name", event.name);
+    io_event->append_str("cat", "depsgraph");
+    io_event->append_str("ph", "X");
+    /* Timestamps in the trace format are in microseconds. */
+    io_event->append_double("ts", event.start_time * 1e6);
+    io_event->append_double("dur", event.duration * 1e6);
+    io_event->append_int("pid", 0);
+    io_event->append_int("tid", tid);
+    std::shared_ptr<DictionaryValue> io_args = io_event->append_dict("args");
+    io_args->append_double("critical_path_ms", event.critical_path_time * 1e3);
+  }
+
+  JsonFormatter formatter;
+  std::stringstream stream;
+  formatter.serialize(stream, io_root);
+  return stream.str();
+}
+
+}  // namespace blender
@@ -107,6 +107,10 @@ struct Depsgraph {
   /* Indicates whether relations needs to be updated. */
   bool need_update_relations;
 
+  /* ID nodes whose relations are to be re-built on the next relations update.
+   * Empty when `need_update_relations` requests a full re-build of the graph. */
+  Set<IDNode *> id_nodes_need_update_relations;
+
   /* Indicates whether indirect effect of nodes on a directly visible ones needs to be updated. */
   bool need_update_nodes_visibility;
 
@@ -34,6 +34,7 @@
 #include "builder/pipeline_compositor.h"
 #include "builder/pipeline_from_collection.h"
 #include "builder/pipeline_from_ids.h"
+#include "builder/pipeline_localized.h"
 #include "builder/pipeline_render.h"
 #include "builder/pipeline_view_layer.h"
 
@@ -321,6 +322,7 @@ void DEG_graph_tag_relations_update(Depsgraph *graph)
   DEG_DEBUG_PRINTF(graph, TAG, "%s: Tagging relations for update.\n", __func__);
   deg::Depsgraph *deg_graph = reinterpret_cast<deg::Depsgraph *>(graph);
   deg_graph->need_update_relations = true;
+  deg_graph->id_nodes_need_update_relations.clear();
 
   /* NOTE: When relations are updated, it's quite possible that we've got new bases in the scene.
    * This means, we need to re-create flat array of bases in view layer. */
@@ -344,6 +346,12 @@ void DEG_graph_relations_update(Depsgraph *graph)
     /* Graph is up to date, nothing to do. */
     return;
   }
+  if (!deg_graph->id_nodes_need_update_relations.is_empty()) {
+    deg::LocalizedBuilderPipeline builder(graph);
+    if (builder.build()) {
+      return;
+    }
+  }
   DEG_graph_build_from_view_layer(graph);
 }
 
@@ -355,4 +363,23 @@ void DEG_relations_tag_update(Main *bmain)
   }
 }
 
+void DEG_id_relations_tag_update(Main *bmain, ID *id)
+{
+  DEG_GLOBAL_DEBUG_PRINTF(TAG, "%s: Tagging relations of %s for update.\n", __func__, id->name);
+  for (deg::Depsgraph *depsgraph : deg::get_all_registered_graphs(bmain)) {
+    deg::IDNode *id_node = depsgraph->find_id_node(id);
+    if (id_node == nullptr) {
+      /* The ID is not part of the graph, so changes to its dependencies do not affect it. */
+      continue;
+    }
+    if (depsgraph->need_update_relations && depsgraph->id_nodes_need_update_relations.is_empty())
+    {
+      /* Full re-build is already requested. */
+      continue;
+    }
+    depsgraph->need_update_relations = true;
+    depsgraph->id_nodes_need_update_relations.add(id_node);
+  }
+}
+
 }  // namespace blender
@@ -8,15 +8,19 @@
  * Evaluation engine entry-points for Depsgraph Engine.
  */
 
+#include <algorithm>
 #include <atomic>
 #include <cstdint>
+#include <thread>
 
 #include "intern/eval/deg_eval.h"
 
+#include "BLI_enumerable_thread_specific.hh"
 #include "BLI_function_ref.hh"
 #include "BLI_gsqueue.hh"
 #include "BLI_task_c.hh"
 #include "BLI_time.hh"
+#include "BLI_vector.hh"
 
 #include "BKE_global.hh"
 
@@ -33,11 +37,13 @@
 
 #include "atomic_ops.h"
 
+#include "intern/debug/deg_debug.h"
 #include "intern/depsgraph.hh"
 #include "intern/depsgraph_relation.hh"
 #include "intern/depsgraph_tag.hh"
 #include "intern/eval/deg_eval_copy_on_write.h"
 #include "intern/eval/deg_eval_flush.h"
+#include "intern/eval/deg_eval_priority.h"
 #include "intern/eval/deg_eval_stats.h"
 #include "intern/eval/deg_eval_visibility.h"
 #include "intern/node/deg_node.hh"
@@ -83,22 +89,49 @@ struct DepsgraphEvalState {
   EvaluationStage stage;
   bool need_update_pending_parents = true;
   bool need_single_thread_pass = false;
+
+  /* Operations which are ready to be evaluated by the threaded stages. */
+  ReadyOperationQueue ready_queue{BLI_task_scheduler_num_threads()};
+
+  /* Evaluated operations per thread, only gathered when statistics are enabled. */
+  threading::EnumerableThreadSpecific<Vector<EvalTraceEvent>> trace_events;
 };
 
-void evaluate_node(const DepsgraphEvalState *state, OperationNode *operation_node)
+void update_eval_time_estimate(OperationNode *operation_node, const double eval_time)
+{
+  if (operation_node->eval_time_estimate < 0.0) {
+    operation_node->eval_time_estimate = eval_time;
+  }
+  else {
+    /* Average with the previous evaluations, so that a single outlier does not change the order
+     * of the scheduling too much. */
+    operation_node->eval_time_estimate = 0.5 * (operation_node->eval_time_estimate + eval_time);
+  }
+}
+
+void evaluate_node(DepsgraphEvalState *state, OperationNode *operation_node)
 {
   blender::Depsgraph *depsgraph = reinterpret_cast<blender::Depsgraph *>(state->graph);
 
   /* Sanity checks. */
   BLI_assert_msg(!operation_node->is_noop(), "NOOP nodes should not actually be scheduled");
-  /* Perform operation. */
+  /* Perform operation. The timing is always measured, it is used to prioritize expensive
+   * operations in the next evaluation. */
+  const double start_time = BLI_time_now_seconds();
+  operation_node->evaluate(depsgraph);
+  const double eval_time = BLI_time_now_seconds() - start_time;
+
+  update_eval_time_estimate(operation_node, eval_time);
   if (state->do_stats) {
-    const double start_time = BLI_time_now_seconds();
-    operation_node->evaluate(depsgraph);
-    operation_node->stats.current_time += BLI_time_now_seconds() - start_time;
-  }
-  else {
-    operation_node->evaluate(depsgraph);
+    operation_node->stats.current_time += eval_time;
+
+    EvalTraceEvent event;
+    event.name = operation_node->full_identifier();
+    event.start_time = start_time - state->graph->debug.evaluation_start_time();
+    event.duration = eval_time;
+    event.critical_path_time = operation_node->critical_path_time;
+    event.thread_id = std::hash<std::thread::id>()(std::this_thread::get_id());
+    state->trace_events.local().append(std::move(event));
   }
 
   /* Clear the flag early on, allowing partial updates without re-evaluating the same node multiple
@@ -108,18 +141,27 @@ void evaluate_node(const DepsgraphEvalState *state, OperationNode *operation_nod
   operation_node->flag &= ~DEPSOP_FLAG_CLEAR_ON_EVAL;
 }
 
-void deg_task_run_func(TaskPool *pool, void *taskdata)
+/* Add an operation which is ready for evaluation. Every task evaluates the most expensive
+ * operation in the ready queue rather than a specific one, so the number of tasks matches the
+ * number of operations which were made ready. */
+void push_ready_node(DepsgraphEvalState *state, TaskPool *pool, OperationNode *node)
+{
+  state->ready_queue.push(node);
+  BLI_task_pool_push(pool, deg_task_run_func, nullptr, false, nullptr);
+}
+
+void deg_task_run_func(TaskPool *pool, void * /*taskdata*/)
 {
   void *userdata_v = BLI_task_pool_user_data(pool);
   DepsgraphEvalState *state = static_cast<DepsgraphEvalState *>(userdata_v);
 
   /* Evaluate node. */
-  OperationNode *operation_node = reinterpret_cast<OperationNode *>(taskdata);
+  OperationNode *operation_node = state->ready_queue.pop();
   evaluate_node(state, operation_node);
 
   /* Schedule children. */
   schedule_children(state, operation_node, [&](OperationNode *node) {
-    BLI_task_pool_push(pool, deg_task_run_func, node, false, nullptr);
+    push_ready_node(state, pool, node);
   });
 }
 
@@ -186,6 +228,11 @@ void calculate_pending_parents_if_needed(DepsgraphEvalState *state)
   state->need_update_pending_parents = false;
 }
 
+bool need_critical_path_time(const DepsgraphEvalState *state, OperationNode *node)
+{
+  return (node->flag & DEPSOP_FLAG_NEEDS_UPDATE) && check_operation_node_visible(state, node);
+}
+
 void initialize_execution(DepsgraphEvalState *state, Depsgraph *graph)
 {
   /* Clear tags and other things which needs to be clear. */
@@ -355,10 +402,16 @@ void evaluate_graph_threaded_stage(DepsgraphEvalState *state,
 
   calculate_pending_parents_if_needed(state);
 
-  schedule_graph(state, [&](OperationNode *node) {
-    BLI_task_pool_push(task_pool, deg_task_run_func, node, false, nullptr);
-  });
+  /* The copy-on-evaluation and visibility stages are cheap, only prioritize the main stage. */
+  if (stage == EvaluationStage::THREADED_EVALUATION) {
+    calculate_critical_path_times(state->graph->operations, [&](OperationNode *node) {
+      return need_critical_path_time(state, node);
+    });
+  }
+
+  schedule_graph(state, [&](OperationNode *node) { push_ready_node(state, task_pool, node); });
   BLI_task_pool_work_and_wait(task_pool);
+  BLI_assert(state->ready_queue.is_empty());
 }
 
 /* Evaluate remaining operations of the dependency graph in a single threaded manner. */
@@ -502,6 +555,16 @@ void deg_evaluate_on_refresh(Depsgraph *graph)
    * synchronization. */
   if (state.do_stats) {
     deg_eval_stats_aggregate(graph);
+
+    graph->debug.eval_trace.clear();
+    for (Vector<EvalTraceEvent> &events : state.trace_events) {
+      graph->debug.eval_trace.extend(std::move(events));
+    }
+    std::sort(graph->debug.eval_trace.begin(),
+              graph->debug.eval_trace.end(),
+              [](const EvalTraceEvent &a, const EvalTraceEvent &b) {
+                return a.start_time < b.start_time;
+              });
   }
 
   /* Clear any uncleared tags. */
@@ -0,0 +1,146 @@
+/* SPDX-FileCopyrightText: 2026 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+
+/** \file
+ * \ingroup depsgraph
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <utility>
+
+#include "intern/eval/deg_eval_priority.h"
+
+#include "BLI_assert.hh"
+
+#include "intern/depsgraph_relation.hh"
+#include "intern/node/deg_node_operation.hh"
+
+namespace blender::deg {
+
+/* Evaluation time used for operations which were never evaluated. */
+constexpr double unknown_operation_eval_time = 1e-6;
+
+static bool need_critical_path_time(const Relation *rel,
+                                    const FunctionRef<bool(OperationNode *node)> need_eval_fn)
+{
+  BLI_assert(rel->to->type == NodeType::OPERATION);
+  return (rel->flag & RELATION_FLAG_CYCLIC) == 0 &&
+         need_eval_fn(static_cast<OperationNode *>(rel->to));
+}
+
+/* The graph is traversed depth first, so that the critical path time of all children is known
+ * when it is calculated for a node. */
+void calculate_critical_path_times(const Span<OperationNode *> operations,
+                                   const FunctionRef<bool(OperationNode *node)> need_evaluation_fn)
+{
+  enum { OP_VISITED = 1 };
+
+  for (OperationNode *node : operations) {
+    node->custom_flags = 0;
+  }
+
+  /* Stack of operations with the index of the next child to visit. */
+  Vector<std::pair<OperationNode *, int>> stack;
+  for (OperationNode *root : operations) {
+    if (root->custom_flags & OP_VISITED || !need_evaluation_fn(root)) {
+      continue;
+    }
+    root->custom_flags |= OP_VISITED;
+    root->critical_path_time = 0.0;
+    stack.append({root, 0});
+
+    while (!stack.is_empty()) {
+      OperationNode *node = stack.last().first;
+      const int child_index = stack.last().second;
+      if (child_index < node->outlinks.size()) {
+        stack.last().second++;
+        const Relation *rel = node->outlinks[child_index];
+        if (!need_critical_path_time(rel, need_evaluation_fn)) {
+          continue;
+        }
+        OperationNode *child = static_cast<OperationNode *>(rel->to);
+        if (child->custom_flags & OP_VISITED) {
+          continue;
+        }
+        child->custom_flags |= OP_VISITED;
+        child->critical_path_time = 0.0;
+        stack.append({child, 0});
+        continue;
+      }
+
+      double children_time = 0.0;
+      for (const Relation *rel : node->outlinks) {
+        if (need_critical_path_time(rel, need_evaluation_fn)) {
+          children_time = std::max(children_time,
+                                   static_cast<OperationNode *>(rel->to)->critical_path_time);
+        }
+      }
+      double node_time = 0.0;
+      if (!node->is_noop()) {
+        node_time = std::max(node->eval_time_estimate, unknown_operation_eval_time);
+      }
+      node->critical_path_time = node_time + children_time;
+      stack.pop_last();
+    }
+  }
+}
+
+static bool critical_path_time_less(const OperationNode *a, const OperationNode *b)
+{
+  return a->critical_path_time < b->critical_path_time;
+}
+
+ReadyOperationQueue::ReadyOperationQueue(const int threads_num)
+    : thread_heaps_(std::max(threads_num, 1))
+{
+}
+
+ReadyOperationQueue::ThreadHeap &ReadyOperationQueue::current_thread_heap()
+{
+  /* Threads of the task scheduler live for the whole session, so they keep their heap index
+   * across evaluations. Other threads, like the one waiting for the task pool, share a heap. */
+  static std::atomic<int> threads_num = 0;
+  thread_local const int thread_index = threads_num.fetch_add(1, std::memory_order_relaxed);
+  return thread_heaps_[thread_index % thread_heaps_.size()];
+}
+
+void ReadyOperationQueue::push(OperationNode *node)
+{
+  ThreadHeap &thread_heap = this->current_thread_heap();
+  std::lock_guard lock{thread_heap.mutex};
+  thread_heap.heap.append(node);
+  std::push_heap(thread_heap.heap.begin(), thread_heap.heap.end(), critical_path_time_less);
+}
+
+OperationNode *ReadyOperationQueue::pop()
+{
+  const int64_t start_index = &this->current_thread_heap() - thread_heaps_.data();
+  /* Another thread might take the last operation of a heap while iterating over them. Its own
+   * operation is still in one of the heaps then, so search again. */
+  while (true) {
+    for (const int64_t i : thread_heaps_.index_range()) {
+      ThreadHeap &thread_heap = thread_heaps_[(start_index + i) % thread_heaps_.size()];
+      std::lock_guard lock{thread_heap.mutex};
+      if (thread_heap.heap.is_empty()) {
+        continue;
+      }
+      std::pop_heap(thread_heap.heap.begin(), thread_heap.heap.end(), critical_path_time_less);
+      return thread_heap.heap.pop_last();
+    }
+  }
+}
+
+bool ReadyOperationQueue::is_empty()
+{
+  for (ThreadHeap &thread_heap : thread_heaps_) {
+    std::lock_guard lock{thread_heap.mutex};
+    if (!thread_heap.heap.is_empty()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace blender::deg
@@ -0,0 +1,69 @@
+/* SPDX-FileCopyrightText: 2026 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+
+/** \file
+ * \ingroup depsgraph
+ *
+ * Prioritization of the operations during the threaded evaluation.
+ */
+
+#pragma once
+
+#include "BLI_array.hh"
+#include "BLI_function_ref.hh"
+#include "BLI_mutex.hh"
+#include "BLI_span.hh"
+#include "BLI_vector.hh"
+
+namespace blender::deg {
+
+struct OperationNode;
+
+/**
+ * Calculate the critical path time of all operations for which the given function returns true,
+ * based on the evaluation times measured during previous evaluations. Operations which were never
+ * evaluated count with a small fixed time, so that the number of operations in a chain is still
+ * taken into account. Cyclic relations are ignored.
+ */
+void calculate_critical_path_times(Span<OperationNode *> operations,
+                                   FunctionRef<bool(OperationNode *node)> need_evaluation_fn);
+
+/**
+ * Operations which are ready to be evaluated, ordered by their critical path time.
+ *
+ * Every thread pushes to and pops from its own max-heap, so that threads don't contend on a single
+ * lock when scheduling many cheap operations. A thread with an empty heap takes the operation from
+ * the heap of another thread. This means the order is only strict within a thread, but children
+ * are pushed by the thread which evaluated their parent, so the operations of an expensive chain
+ * stay prioritized.
+ */
+class ReadyOperationQueue {
+ private:
+  struct alignas(64) ThreadHeap {
+    Mutex mutex;
+    Vector<OperationNode *> heap;
+  };
+  Array<ThreadHeap> thread_heaps_;
+
+ public:
+  explicit ReadyOperationQueue(int threads_num);
+
+  void push(OperationNode *node);
+
+  /**
+   * Remove the operation with the longest critical path of the heap of the current thread, or of
+   * another thread when it is empty.
+   *
+   * \note Must only be called when an operation is known to be in the queue, otherwise it keeps
+   * looking until another thread pushes one.
+   */
+  OperationNode *pop();
+
+  bool is_empty();
+
+ private:
+  ThreadHeap &current_thread_heap();
+};
+
+}  // namespace blender::deg
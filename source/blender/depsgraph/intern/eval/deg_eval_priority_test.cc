@@ -0,0 +1,255 @@
+/* SPDX-FileCopyrightText: 2026 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+
+/** \file
+ * \ingroup depsgraph
+ */
+
+#include <algorithm>
+#include <memory>
+#include <sstream>
+
+#include "BKE_global.hh"
+#include "BKE_gtest_base.hh"
+#include "BKE_main.hh"
+#include "BKE_object.hh"
+#include "BKE_scene.hh"
+
+#include "BLI_serialize.hh"
+#include "BLI_task.hh"
+
+#include "DEG_depsgraph.hh"
+#include "DEG_depsgraph_build.hh"
+#include "DEG_depsgraph_debug.hh"
+
+#include "DNA_object_types.h"
+#include "DNA_scene_types.h"
+
+#include "intern/depsgraph.hh"
+#include "intern/depsgraph_relation.hh"
+#include "intern/eval/deg_eval_priority.h"
+#include "intern/node/deg_node_operation.hh"
+
+#include "testing/testing.h"
+
+namespace blender::deg::tests {
+
+/**
+ * Operations which are not owned by a dependency graph, with an evaluation function which does
+ * nothing, connected by relations.
+ */
+class OperationGraph {
+ public:
+  Vector<std::unique_ptr<OperationNode>> operations;
+  Vector<std::unique_ptr<Relation>> relations;
+
+  OperationNode *add_operation(const char *name, const double eval_time_estimate)
+  {
+    operations.append(std::make_unique<OperationNode>());
+    OperationNode *node = operations.last().get();
+    node->type = NodeType::OPERATION;
+    node->name = name;
+    node->evaluate = [](blender::Depsgraph * /*depsgraph*/) {};
+    node->eval_time_estimate = eval_time_estimate;
+    return node;
+  }
+
+  OperationNode *add_noop(const char *name)
+  {
+    OperationNode *node = this->add_operation(name, -1.0);
+    node->evaluate = nullptr;
+    return node;
+  }
+
+  Relation *add_relation(OperationNode *from, OperationNode *to)
+  {
+    relations.append(std::make_unique<Relation>(from, to, "Test"));
+    Relation *rel = relations.last().get();
+    from->outlinks.append(rel);
+    to->inlinks.append(rel);
+    return rel;
+  }
+
+  Vector<OperationNode *> operation_pointers() const
+  {
+    Vector<OperationNode *> pointers;
+    for (const std::unique_ptr<OperationNode> &node : operations) {
+      pointers.append(node.get());
+    }
+    return pointers;
+  }
+};
+
+/**
+ * A no-op root with a chain of three operations and a fan of three leaf operations.
+ * The chain is longer in total, even though the first fan operation is the most expensive one.
+ */
+struct ChainAndFanGraph : public OperationGraph {
+  OperationNode *root;
+  OperationNode *chain[3];
+  OperationNode *fan[3];
+  /* Expensive operation after the chain, which does not need to be evaluated. */
+  OperationNode *skipped;
+
+  ChainAndFanGraph()
+  {
+    root = this->add_noop("Root");
+    chain[0] = this->add_operation("Chain 0", 1.0);
+    chain[1] = this->add_operation("Chain 1", 2.0);
+    chain[2] = this->add_operation("Chain 2", 3.0);
+    fan[0] = this->add_operation("Fan 0", 4.0);
+    fan[1] = this->add_operation("Fan 1", 1.0);
+    /* Never evaluated. */
+    fan[2] = this->add_operation("Fan 2", -1.0);
+    skipped = this->add_operation("Skipped", 100.0);
+
+    this->add_relation(root, chain[0]);
+    this->add_relation(chain[0], chain[1]);
+    this->add_relation(chain[1], chain[2]);
+    this->add_relation(chain[2], skipped);
+    this->add_relation(chain[2], root)->flag |= RELATION_FLAG_CYCLIC;
+    for (OperationNode *node : fan) {
+      this->add_relation(root, node);
+    }
+
+    calculate_critical_path_times(this->operation_pointers(),
+                                  [&](OperationNode *node) { return node != skipped; });
+  }
+};
+
+TEST(depsgraph_eval_priority, critical_path_times)
+{
+  const ChainAndFanGraph graph;
+  EXPECT_DOUBLE_EQ(graph.chain[2]->critical_path_time, 3.0);
+  EXPECT_DOUBLE_EQ(graph.chain[1]->critical_path_time, 5.0);
+  EXPECT_DOUBLE_EQ(graph.chain[0]->critical_path_time, 6.0);
+  EXPECT_DOUBLE_EQ(graph.fan[0]->critical_path_time, 4.0);
+  EXPECT_DOUBLE_EQ(graph.fan[1]->critical_path_time, 1.0);
+  /* Operations which were never evaluated still count a little. */
+  EXPECT_GT(graph.fan[2]->critical_path_time, 0.0);
+  EXPECT_LT(graph.fan[2]->critical_path_time, 1e-3);
+  /* No-op operations take no time themselves. */
+  EXPECT_DOUBLE_EQ(graph.root->critical_path_time, 6.0);
+}
+
+TEST(depsgraph_eval_priority, longest_chain_dequeued_first)
+{
+  const ChainAndFanGraph graph;
+  ReadyOperationQueue queue(4);
+  /* Operations which become ready when the root is evaluated, in the order of its relations. */
+  for (const Relation *rel : graph.root->outlinks) {
+    queue.push(static_cast<OperationNode *>(rel->to));
+  }
+  EXPECT_EQ(queue.pop(), graph.chain[0]);
+  queue.push(graph.chain[1]);
+  EXPECT_EQ(queue.pop(), graph.chain[1]);
+  EXPECT_EQ(queue.pop(), graph.fan[0]);
+  queue.push(graph.chain[2]);
+  EXPECT_EQ(queue.pop(), graph.chain[2]);
+  EXPECT_EQ(queue.pop(), graph.fan[1]);
+  EXPECT_EQ(queue.pop(), graph.fan[2]);
+  EXPECT_TRUE(queue.is_empty());
+}
+
+TEST(depsgraph_eval_priority, queue_threaded)
+{
+  OperationGraph graph;
+  for (const int i : IndexRange(1000)) {
+    graph.add_operation("Operation", double(i));
+  }
+  const Vector<OperationNode *> operations = graph.operation_pointers();
+  calculate_critical_path_times(operations, [](OperationNode * /*node*/) { return true; });
+
+  /* Every operation is popped once, also when pushed and popped on different threads. */
+  ReadyOperationQueue queue(3);
+  Array<std::atomic<int>> pop_counts(operations.size());
+  for (std::atomic<int> &count : pop_counts) {
+    count = 0;
+  }
+  threading::parallel_for(operations.index_range(), 1, [&](const IndexRange range) {
+    for (const int i : range) {
+      queue.push(operations[i]);
+      const OperationNode *node = queue.pop();
+      pop_counts[int(node->eval_time_estimate)]++;
+    }
+  });
+  EXPECT_TRUE(queue.is_empty());
+  for (const std::atomic<int> &count : pop_counts) {
+    EXPECT_EQ(count, 1);
+  }
+}
+
+class DepsgraphEvalTraceTest : public bke::BlenderGTestBase {
+ protected:
+  Main *bmain_ = nullptr;
+  blender::Depsgraph *depsgraph_ = nullptr;
+  int debug_flags_ = 0;
+
+  void SetUp() override
+  {
+    bmain_ = BKE_main_new();
+    Scene *scene = BKE_scene_add(bmain_, "Scene");
+    ViewLayer *view_layer = static_cast<ViewLayer *>(scene->view_layers.first);
+    Object *parent = BKE_object_add(bmain_, scene, view_layer, OB_EMPTY, "Parent");
+    for (const char *name : {"Child 1", "Child 2", "Child 3"}) {
+      BKE_object_add(bmain_, scene, view_layer, OB_EMPTY, name)->parent = parent;
+    }
+
+    depsgraph_ = DEG_graph_new(bmain_, scene, view_layer, DAG_EVAL_VIEWPORT);
+    DEG_graph_build_from_view_layer(depsgraph_);
+
+    debug_flags_ = G.debug;
+    G.debug |= G_DEBUG_DEPSGRAPH_TIME;
+  }
+
+  void TearDown() override
+  {
+    G.debug = debug_flags_;
+    DEG_graph_free(depsgraph_);
+    BKE_main_free(bmain_);
+  }
+};
+
+TEST_F(DepsgraphEvalTraceTest, trace_to_json)
+{
+  BKE_scene_graph_update_tagged(depsgraph_, bmain_);
+
+  /* Operations get an evaluation time estimate when they are evaluated for the first time. */
+  const Depsgraph *deg_graph = reinterpret_cast<const Depsgraph *>(depsgraph_);
+  Vector<std::string> evaluated_names;
+  for (const OperationNode *node : deg_graph->operations) {
+    if (node->eval_time_estimate >= 0.0) {
+      evaluated_names.append(node->full_identifier());
+    }
+  }
+  EXPECT_FALSE(evaluated_names.is_empty());
+
+  std::stringstream stream(DEG_debug_eval_trace_to_json(*depsgraph_));
+  io::serialize::JsonFormatter formatter;
+  const std::unique_ptr<io::serialize::Value> io_root = formatter.deserialize(stream);
+  ASSERT_NE(io_root, nullptr);
+  const io::serialize::DictionaryValue *io_root_dict = io_root->as_dictionary_value();
+  ASSERT_NE(io_root_dict, nullptr);
+  const io::serialize::ArrayValue *io_events = io_root_dict->lookup_array("traceEvents");
+  ASSERT_NE(io_events, nullptr);
+
+  Vector<std::string> trace_names;
+  for (const std::shared_ptr<io::serialize::Value> &io_event : io_events->elements()) {
+    const io::serialize::DictionaryValue *io_event_dict = io_event->as_dictionary_value();
+    ASSERT_NE(io_event_dict, nullptr);
+    const std::optional<StringRefNull> name = io_event_dict->lookup_str("name");
+    ASSERT_TRUE(name.has_value());
+    trace_names.append(*name);
+    EXPECT_EQ(io_event_dict->lookup_str("ph"), "X");
+    EXPECT_NE(io_event_dict->lookup("ts"), nullptr);
+    EXPECT_NE(io_event_dict->lookup("dur"), nullptr);
+    EXPECT_NE(io_event_dict->lookup("tid"), nullptr);
+  }
+
+  std::sort(evaluated_names.begin(), evaluated_names.end());
+  std::sort(trace_names.begin(), trace_names.end());
+  EXPECT_EQ(trace_names, evaluated_names);
+}
+
+}  // namespace blender::deg::tests
@@ -51,6 +51,7 @@ void IDNode::init(const ID *id, const char * /*subdata*/)
   is_enabled_on_eval = true;
   is_collection_fully_expanded = false;
   has_base = false;
+  base_index = -1;
   is_user_modified = false;
   id_cow_recalc_backup = 0;
 
@@ -112,14 +113,20 @@ void IDNode::destroy()
         "Destroy evaluated ID for %s: id_orig=%p id_cow=%p\n", id_orig->name, id_orig, id_cow);
   }
 
-  for (ComponentNode *comp_node : components.values()) {
-    delete comp_node;
-  }
+  clear_components();
 
   /* Tag that the node is freed. */
   id_orig = nullptr;
 }
 
+void IDNode::clear_components()
+{
+  for (ComponentNode *comp_node : components.values()) {
+    delete comp_node;
+  }
+  components.clear();
+}
+
 std::string IDNode::identifier() const
 {
   char orig_ptr[24], cow_ptr[24];
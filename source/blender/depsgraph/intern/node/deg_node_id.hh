@@ -54,6 +54,9 @@ struct IDNode : public Node {
   void init_copy_on_write(ID *id_cow_hint = nullptr);
   ~IDNode() override;
   void destroy();
+  /* Free all components and their operations, keeping the evaluated data-block and the state
+   * accumulated from the previous build. Used when relations of a single ID are re-built. */
+  void clear_components();
 
   std::string identifier() const override;
 
@@ -122,6 +125,9 @@ struct IDNode : public Node {
   /* Is used to figure out whether object came to the dependency graph via a base. */
   bool has_base;
 
+  /* Index of the base the object came to the dependency graph with, -1 if there is no base. */
+  int base_index;
+
   /* Accumulated flag from operation. Is initialized and used during updates flush. */
   bool is_user_modified;
 
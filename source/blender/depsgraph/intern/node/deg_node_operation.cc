@@ -43,6 +43,8 @@ const char *operationCodeAsString(OperationCode opcode)
       return "ANIMATION_EXIT";
     case OperationCode::DRIVER:
       return "DRIVER";
+    case OperationCode::DRIVERS_BATCH:
+      return "DRIVERS_BATCH";
     case OperationCode::DRIVER_UNSHARE:
       return "DRIVER_UNSHARE";
     /* Scene related. */
@@ -213,7 +215,10 @@ const char *operationCodeAsString(OperationCode opcode)
   return "UNKNOWN";
 }
 
-OperationNode::OperationNode() : name_tag(-1), flag(0) {}
+OperationNode::OperationNode()
+    : eval_time_estimate(-1.0), critical_path_time(0.0), name_tag(-1), flag(0)
+{
+}
 
 std::string OperationNode::identifier() const
 {
@@ -51,6 +51,8 @@ enum class OperationCode {
   ANIMATION_EXIT,
   /* Driver */
   DRIVER,
+  /* Drivers which do not need Python, evaluated together as one operation. */
+  DRIVERS_BATCH,
   /* Writes to RNA properties to ensure implicitly-shared data is un-shared. */
   DRIVER_UNSHARE,
 
@@ -294,6 +296,14 @@ struct OperationNode : public Node {
   uint32_t num_links_pending;
   bool scheduled;
 
+  /* Time in seconds the operation took to evaluate, averaged over previous evaluations.
+   * Is negative when the operation was never evaluated. */
+  double eval_time_estimate;
+  /* Estimated time in seconds of the most expensive chain of operations which starts at this one
+   * and needs to be evaluated. Operations with a longer chain are evaluated first, so that the
+   * expensive chains do not end up as a serial tail of the evaluation. */
+  double critical_path_time;
+
   /* Identifier for the operation being performed. */
   OperationCode opcode;
   int name_tag;
@@ -779,17 +779,25 @@ void CurvesEvalCache::ensure_nurbs(const bke::CurvesGeometry &curves)
 
   curves.ensure_can_interpolate_to_evaluated();
 
-  const Span<BasisCache> nurbs_basis_cache = curves.runtime->nurbs_basis_cache.data();
+  const bke::curves::nurbs::BasisCaches &nurbs_basis_cache =
+      curves.runtime->nurbs_basis_cache.data();
 
-  Vector<int> basis_cache_offset;
+  /* Curves sharing a basis cache also share its data on the GPU. */
+  Array<int> offset_by_cache(nurbs_basis_cache.caches.size());
   Vector<uint32_t> basis_cache_packed;
-  for (const BasisCache &cache : nurbs_basis_cache) {
-    basis_cache_offset.append(cache.invalid ? -1 : basis_cache_packed.size());
+  for (const int cache_index : nurbs_basis_cache.caches.index_range()) {
+    const BasisCache &cache = nurbs_basis_cache.caches[cache_index];
+    offset_by_cache[cache_index] = cache.invalid ? -1 : basis_cache_packed.size();
     if (!cache.invalid) {
       basis_cache_packed.extend(cache.start_indices.as_span().cast<uint32_t>());
       basis_cache_packed.extend(cache.weights.as_span().cast<uint32_t>());
     }
   }
+  const Span<int> cache_indices = nurbs_basis_cache.cache_indices;
+  Vector<int> basis_cache_offset(cache_indices.size());
+  for (const int curve_index : cache_indices.index_range()) {
+    basis_cache_offset[curve_index] = offset_by_cache[cache_indices[curve_index]];
+  }
   /* Ensure buffer is not empty. */
   if (basis_cache_packed.is_empty()) {
     basis_cache_packed.append(0);
@@ -927,7 +927,7 @@ static wmOperatorStatus add_driver_button_none(bContext *C, wmOperator *op, shor
   if (success) {
     /* send updates */
     ui::context_update_anim_flag(C);
-    DEG_relations_tag_update(CTX_data_main(C));
+    DEG_id_relations_tag_update(CTX_data_main(C), ptr.owner_id);
     WM_event_add_notifier(C, NC_ANIMATION | ND_FCURVES_ORDER, nullptr); /* XXX */
 
     return OPERATOR_FINISHED;
@@ -1025,7 +1025,7 @@ static wmOperatorStatus add_driver_button_invoke(bContext *C,
       /* send updates */
       ui::context_update_anim_flag(C);
       DEG_id_tag_update(ptr.owner_id, ID_RECALC_SYNC_TO_EVAL);
-      DEG_relations_tag_update(CTX_data_main(C));
+      DEG_id_relations_tag_update(CTX_data_main(C), ptr.owner_id);
       WM_event_add_notifier(C, NC_ANIMATION | ND_FCURVES_ORDER, nullptr);
     }
 
@@ -1078,7 +1078,7 @@ static wmOperatorStatus remove_driver_button_exec(bContext *C, wmOperator *op)
   if (changed) {
     /* send updates */
     ui::context_update_anim_flag(C);
-    DEG_relations_tag_update(CTX_data_main(C));
+    DEG_id_relations_tag_update(CTX_data_main(C), ptr.owner_id);
     DEG_id_tag_update(ptr.owner_id, ID_RECALC_ANIMATION);
     WM_event_add_notifier(C, NC_ANIMATION | ND_FCURVES_ORDER, nullptr); /* XXX */
   }
@@ -1195,7 +1195,7 @@ static wmOperatorStatus paste_driver_button_exec(bContext *C, wmOperator *op)
 
       ui::context_update_anim_flag(C);
 
-      DEG_relations_tag_update(CTX_data_main(C));
+      DEG_id_relations_tag_update(CTX_data_main(C), ptr.owner_id);
 
       DEG_id_tag_update(ptr.owner_id, ID_RECALC_ANIMATION);
 
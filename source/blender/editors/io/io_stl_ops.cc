@@ -232,6 +232,7 @@ static wmOperatorStatus wm_stl_import_exec(bContext *C, wmOperator *op)
   params.use_scene_unit = RNA_boolean_get(op->ptr, "use_scene_unit");
   params.global_scale = RNA_float_get(op->ptr, "global_scale");
   params.use_mesh_validate = RNA_boolean_get(op->ptr, "use_mesh_validate");
+  params.merge_verts = RNA_boolean_get(op->ptr, "merge_verts");
 
   params.reports = op->reports;
 
@@ -288,6 +289,7 @@ static void ui_stl_import_settings(const bContext *C, ui::Layout *layout, Pointe
     col.use_property_split_set(false);  // bfa
     col.prop(ptr, "use_facet_normal", UI_ITEM_NONE, std::nullopt, ICON_NONE);
     col.prop(ptr, "use_mesh_validate", UI_ITEM_NONE, std::nullopt, ICON_NONE);
+    col.prop(ptr, "merge_verts", UI_ITEM_NONE, std::nullopt, ICON_NONE);
   }
 }
 
@@ -341,6 +343,12 @@ void WM_OT_stl_import(wmOperatorType *ot)
       "Validate Mesh",
       "Ensure the data is valid "
       "(when disabled, data may be imported which causes crashes displaying or editing)");
+  RNA_def_boolean(ot->srna,
+                  "merge_verts",
+                  true,
+                  "Merge Vertices",
+                  "Merge vertices at the same location and remove degenerate and duplicate "
+                  "triangles (when disabled, every triangle gets its own vertices)");
 
   /* Only show `.stl` files by default. */
   prop = RNA_def_string(ot->srna, "filter_glob", "*.stl", 0, "Extension Filter", "");
@@ -222,6 +222,8 @@ struct NodeBakeRequest {
   std::optional<bake::BakePath> path;
   int frame_start;
   int frame_end;
+  /** Compress large arrays in the baked data. */
+  bool use_compression = false;
   std::unique_ptr<bake::BlobWriteSharing> blob_sharing;
 };
 
@@ -338,6 +340,7 @@ static void bake_geometry_nodes_startjob(void *customdata, wmJobWorkerStatus *wo
                       (frame_file_name + ".json").c_str());
         BLI_file_ensure_parent_dir_exists(meta_path);
         bake::DiskBlobWriter blob_writer{request.path->blobs_dir, frame_file_name};
+        blob_writer.set_use_compression(request.use_compression);
         fstream meta_file{meta_path, std::ios::out};
         bake::serialize_bake(frame_cache.values, blob_writer, *request.blob_sharing, meta_file);
         written_size += blob_writer.written_size();
@@ -347,6 +350,7 @@ static void bake_geometry_nodes_startjob(void *customdata, wmJobWorkerStatus *wo
         PackedBake &packed_data = packed_data_by_bake.lookup_or_add_default(&request);
 
         bake::MemoryBlobWriter blob_writer{frame_file_name};
+        blob_writer.set_use_compression(request.use_compression);
         std::ostringstream meta_file{std::ios::binary};
         bake::serialize_bake(frame_cache.values, blob_writer, *request.blob_sharing, meta_file);
 
@@ -649,6 +653,9 @@ static Vector<NodeBakeRequest> collect_simulations_to_bake(Main &bmain,
         request.bake_id = id;
         request.node_type = node->type_legacy;
         request.blob_sharing = std::make_unique<bake::BlobWriteSharing>();
+        if (const NodesModifierBake *bake = nmd->find_bake(id)) {
+          request.use_compression = bake->flag & NODES_MODIFIER_BAKE_COMPRESS;
+        }
         if (bake::get_node_bake_target(*object, *nmd, id) == NODES_MODIFIER_BAKE_TARGET_DISK) {
           request.path = bake::get_node_bake_path(bmain, *object, *nmd, id);
         }
@@ -1001,6 +1008,7 @@ static Vector<NodeBakeRequest> bake_single_node_gather_bake_request(bContext *C,
   if (!bake) {
     return {};
   }
+  request.use_compression = bake->flag & NODES_MODIFIER_BAKE_COMPRESS;
   if (bake::get_node_bake_target(*object, nmd, bake_id) == NODES_MODIFIER_BAKE_TARGET_DISK) {
     request.path = bake::get_node_bake_path(*bmain, *object, nmd, bake_id);
     if (!request.path) {
@@ -1330,7 +1330,7 @@ void constraint_dependency_update(Main *bmain, Object *ob)
   if (ob->pose) {
     object_pose_tag_update(bmain, ob);
   }
-  DEG_relations_tag_update(bmain);
+  DEG_id_relations_tag_update(bmain, &ob->id);
 }
 
 void constraint_tag_update(Main *bmain, Object *ob, bConstraint *con)
@@ -1363,7 +1363,7 @@ void constraint_dependency_tag_update(Main *bmain, Object *ob, bConstraint *con)
   if (ob->pose) {
     object_pose_tag_update(bmain, ob);
   }
-  DEG_relations_tag_update(bmain);
+  DEG_id_relations_tag_update(bmain, &ob->id);
 }
 
 bool constraint_move_to_index(Object *ob, bConstraint *con, const int index)
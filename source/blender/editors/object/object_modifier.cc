@@ -158,6 +158,30 @@ static void object_force_modifier_bind_simple_options(Depsgraph *depsgraph,
   md_eval->mode = mode;
 }
 
+/**
+ * Tag relations for update after a modifier of the given type was added to or removed from the
+ * object. Physics related modifiers affect dependencies of other objects, so they require the
+ * full relations update, the rest only changes dependencies of the object itself.
+ */
+static void object_modifier_relations_tag_update(Main *bmain, Object *ob, const int type)
+{
+  if (ELEM(type,
+           eModifierType_ParticleSystem,
+           eModifierType_ParticleInstance,
+           eModifierType_Collision,
+           eModifierType_Surface,
+           eModifierType_Softbody,
+           eModifierType_Cloth,
+           eModifierType_Fluid,
+           eModifierType_DynamicPaint))
+  {
+    DEG_relations_tag_update(bmain);
+  }
+  else {
+    DEG_id_relations_tag_update(bmain, &ob->id);
+  }
+}
+
 ModifierData *modifier_add(
     ReportList *reports, Main *bmain, Scene *scene, Object *ob, const char *name, int type)
 {
@@ -233,7 +257,7 @@ ModifierData *modifier_add(
   BKE_object_modifier_set_active(ob, new_md);
 
   DEG_id_tag_update(&ob->id, ID_RECALC_GEOMETRY);
-  DEG_relations_tag_update(bmain);
+  object_modifier_relations_tag_update(bmain, ob, type);
 
   return new_md;
 }
@@ -381,6 +405,7 @@ static bool object_modifier_remove(
 bool modifier_remove(ReportList *reports, Main *bmain, Scene *scene, Object *ob, ModifierData *md)
 {
   bool sort_depsgraph = false;
+  const int type = md->type;
 
   bool ok = object_modifier_remove(bmain, scene, ob, md, &sort_depsgraph);
 
@@ -390,7 +415,12 @@ bool modifier_remove(ReportList *reports, Main *bmain, Scene *scene, Object *ob,
   }
 
   DEG_id_tag_update(&ob->id, ID_RECALC_GEOMETRY);
-  DEG_relations_tag_update(bmain);
+  if (sort_depsgraph) {
+    DEG_relations_tag_update(bmain);
+  }
+  else {
+    object_modifier_relations_tag_update(bmain, ob, type);
+  }
 
   return true;
 }
@@ -613,7 +643,7 @@ ModifierData *modifier_copy_to_object(Main *bmain,
 
   WM_main_add_notifier(NC_OBJECT | ND_MODIFIER | NA_ADDED, ob_dst);
   DEG_id_tag_update(&ob_dst->id, ID_RECALC_GEOMETRY | ID_RECALC_ANIMATION);
-  DEG_relations_tag_update(bmain);
+  object_modifier_relations_tag_update(bmain, ob_dst, md_dst->type);
   return md_dst;
 }
 
@@ -262,6 +262,13 @@ class Procedure : NonCopyable, NonMovable {
   DummyInstruction &new_dummy_instruction();
   ReturnInstruction &new_return_instruction();
 
+  /**
+   * Remove an instruction that no other instruction points to anymore. Its references to the next
+   * instruction and to variables are removed as well.
+   */
+  void remove_instruction(CallInstruction &instruction);
+  void remove_instruction(DestructInstruction &instruction);
+
   void add_parameter(ParamType::InterfaceType interface_type, Variable &variable);
   Span<ConstParameter> params() const;
 
@@ -46,4 +46,44 @@ namespace blender::fn::multi_function::procedure_optimization {
  */
 void move_destructs_up(Procedure &procedure, Instruction &block_end_instr);
 
+/**
+ * Calls of the same function with the same input variables compute the same values. This pass
+ * removes the later calls and makes their users use the outputs of the first call instead.
+ *
+ * Only functions with single inputs and outputs are handled, because functions with mutable or
+ * vector parameters may not be called fewer times. Like #move_destructs_up, this only works on a
+ * single chain of instructions ending at \a block_end_instr.
+ */
+void eliminate_common_subexpressions(Procedure &procedure, Instruction &block_end_instr);
+
+/**
+ * Evaluates calls whose inputs are all constant once while optimizing, and replaces them with
+ * calls to constant functions. The procedure executor already evaluates such calls only once per
+ * execution, but procedures are often executed many times for smaller chunks of the full mask.
+ *
+ * Only the outputs of #CustomMF_GenericConstant are known to be constant. The inputs that are
+ * not used anymore afterwards are removed by #remove_unused_calls.
+ */
+void fold_constants(Procedure &procedure, Instruction &block_end_instr);
+
+/**
+ * Removes calls whose outputs are not used by anything else than destruct instructions, together
+ * with these destruct instructions.
+ */
+void remove_unused_calls(Procedure &procedure, Instruction &block_end_instr);
+
+/**
+ * Every variable computed by a procedure uses a buffer that is large enough for all indices of
+ * the mask. For long chains of cheap element-wise functions (e.g. many math nodes) most time is
+ * spent writing and reading these buffers.
+ *
+ * This pass replaces runs of consecutive calls with a call to a single function that evaluates
+ * the entire run for small chunks of indices at a time. Intermediate values that are only used
+ * within the run are stored in small buffers that stay in the CPU cache.
+ *
+ * This should run before #move_destructs_up, because destruct instructions between calls end a
+ * run.
+ */
+void fuse_element_wise_calls(Procedure &procedure, Instruction &block_end_instr);
+
 }  // namespace blender::fn::multi_function::procedure_optimization
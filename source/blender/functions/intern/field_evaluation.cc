@@ -285,6 +285,10 @@ static void build_multi_function_procedure_for_fields(mf::Procedure &procedure,
 
   mf::ReturnInstruction &return_instr = builder.add_return();
 
+  mf::procedure_optimization::fold_constants(procedure, return_instr);
+  mf::procedure_optimization::eliminate_common_subexpressions(procedure, return_instr);
+  mf::procedure_optimization::remove_unused_calls(procedure, return_instr);
+  mf::procedure_optimization::fuse_element_wise_calls(procedure, return_instr);
   mf::procedure_optimization::move_destructs_up(procedure, return_instr);
 
   procedure.prepare_for_execution();
@@ -2,6 +2,14 @@
  *
  * SPDX-License-Identifier: GPL-2.0-or-later */
 
+#include <xxhash.h>
+
+#include "BLI_linear_allocator.hh"
+#include "BLI_multi_value_map.hh"
+#include "BLI_resource_scope.hh"
+#include "BLI_set.hh"
+
+#include "FN_multi_function_builder.hh"
 #include "FN_multi_function_procedure_optimization.hh"
 
 namespace blender::fn::multi_function::procedure_optimization {
@@ -74,4 +82,798 @@ void move_destructs_up(Procedure &procedure, Instruction &block_end_instr)
   }
 }
 
+static Instruction *get_next_instruction(Instruction &instr)
+{
+  switch (instr.type()) {
+    case InstructionType::Call:
+      return static_cast<CallInstruction &>(instr).next();
+    case InstructionType::Destruct:
+      return static_cast<DestructInstruction &>(instr).next();
+    case InstructionType::Dummy:
+      return static_cast<DummyInstruction &>(instr).next();
+    default:
+      BLI_assert_unreachable();
+      return nullptr;
+  }
+}
+
+/**
+ * Find the linear chain of instructions that ends at the given instruction, in the order they are
+ * executed. The chain starts after the last branch or join.
+ */
+static Vector<Instruction *> find_linear_chain(Instruction &block_end_instr)
+{
+  Vector<Instruction *> chain;
+  Instruction *current_instr = &block_end_instr;
+  while (current_instr != nullptr) {
+    chain.append(current_instr);
+    const Span<InstructionCursor> prev_cursors = current_instr->prev();
+    if (prev_cursors.size() != 1) {
+      break;
+    }
+    current_instr = prev_cursors[0].instruction();
+  }
+  std::reverse(chain.begin(), chain.end());
+  return chain;
+}
+
+/** Make all instructions that point to the given instruction point to its next instruction. */
+static void unlink_instruction(Procedure &procedure, Instruction &instr)
+{
+  Instruction *next_instr = get_next_instruction(instr);
+  while (!instr.prev().is_empty()) {
+    /* Do a copy of the cursor here, because `instr.prev()` changes when #set_next is called. */
+    const InstructionCursor cursor = instr.prev()[0];
+    cursor.set_next(procedure, next_instr);
+  }
+}
+
+static void insert_before(Procedure &procedure, Instruction &instr, CallInstruction &new_instr)
+{
+  while (!instr.prev().is_empty()) {
+    const InstructionCursor cursor = instr.prev()[0];
+    cursor.set_next(procedure, &new_instr);
+  }
+  new_instr.set_next(&instr);
+}
+
+static void remove_call(Procedure &procedure, CallInstruction &instr)
+{
+  unlink_instruction(procedure, instr);
+  procedure.remove_instruction(instr);
+}
+
+static void remove_destruct(Procedure &procedure, DestructInstruction &instr)
+{
+  unlink_instruction(procedure, instr);
+  procedure.remove_instruction(instr);
+}
+
+/**
+ * Functions that only have single inputs and outputs compute every output element only from the
+ * input elements at the same index. Calling them does not have side effects.
+ */
+static bool is_element_wise_function(const MultiFunction &fn)
+{
+  bool has_output = false;
+  for (const int param_index : fn.param_indices()) {
+    switch (fn.param_type(param_index).category()) {
+      case ParamCategory::SingleInput:
+        break;
+      case ParamCategory::SingleOutput:
+        has_output = true;
+        break;
+      default:
+        return false;
+    }
+  }
+  return has_output;
+}
+
+static bool is_input_param(const MultiFunction &fn, const int param_index)
+{
+  return fn.param_type(param_index).interface_type() == ParamType::Input;
+}
+
+static Set<const Variable *> get_param_variables(const Procedure &procedure)
+{
+  Set<const Variable *> variables;
+  for (const ConstParameter &param : procedure.params()) {
+    variables.add(param.variable);
+  }
+  return variables;
+}
+
+/** Variables that are initialized at most once have the same value in all their users. */
+static bool is_initialized_once(const Procedure &procedure, Variable &variable)
+{
+  int initializations_num = 0;
+  for (const ConstParameter &param : procedure.params()) {
+    if (param.variable == &variable && param.type != ParamType::Output) {
+      initializations_num++;
+    }
+  }
+  for (Instruction *user : variable.users()) {
+    if (user->type() != InstructionType::Call) {
+      continue;
+    }
+    const CallInstruction &call = static_cast<const CallInstruction &>(*user);
+    for (const int param_index : call.fn().param_indices()) {
+      if (call.params()[param_index] == &variable && !is_input_param(call.fn(), param_index)) {
+        initializations_num++;
+      }
+    }
+  }
+  return initializations_num <= 1;
+}
+
+/**
+ * Check if the outputs of the call can be replaced by the outputs of another call. This is only
+ * done when all users of the variables are known to be in the linear chain.
+ */
+static bool call_can_be_deduplicated(const Procedure &procedure,
+                                     CallInstruction &call,
+                                     const Set<const Variable *> &param_variables,
+                                     const Map<const Instruction *, int> &chain_indices)
+{
+  for (const int param_index : call.fn().param_indices()) {
+    Variable *variable = call.params()[param_index];
+    if (variable == nullptr) {
+      continue;
+    }
+    if (!is_initialized_once(procedure, *variable)) {
+      return false;
+    }
+    if (is_input_param(call.fn(), param_index)) {
+      continue;
+    }
+    if (param_variables.contains(variable)) {
+      return false;
+    }
+    int destructs_num = 0;
+    for (const Instruction *user : variable->users()) {
+      if (!chain_indices.contains(user)) {
+        return false;
+      }
+      switch (user->type()) {
+        case InstructionType::Call:
+          break;
+        case InstructionType::Destruct:
+          destructs_num++;
+          break;
+        default:
+          return false;
+      }
+    }
+    if (destructs_num != 1) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static uint64_t hash_call(const CallInstruction &call)
+{
+  UniqueHashBytes hash;
+  call.fn().hash_unique(hash);
+  for (const int param_index : call.fn().param_indices()) {
+    if (is_input_param(call.fn(), param_index)) {
+      hash.add(call.params()[param_index]);
+    }
+  }
+  const Span bytes = hash.data.as_span();
+  return XXH3_64bits(bytes.data(), bytes.size());
+}
+
+static bool calls_compute_same_values(const CallInstruction &a, const CallInstruction &b)
+{
+  if (!a.fn().equals(b.fn())) {
+    return false;
+  }
+  BLI_assert(a.fn().param_amount() == b.fn().param_amount());
+  for (const int param_index : a.fn().param_indices()) {
+    if (is_input_param(a.fn(), param_index) && a.params()[param_index] != b.params()[param_index])
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+static DestructInstruction *find_destruct(Variable &variable)
+{
+  for (Instruction *user : variable.users()) {
+    if (user->type() == InstructionType::Destruct) {
+      return static_cast<DestructInstruction *>(user);
+    }
+  }
+  return nullptr;
+}
+
+/** Make all users of the outputs of the later call use the outputs of the earlier call. */
+static void replace_call_outputs(Procedure &procedure,
+                                 CallInstruction &earlier_call,
+                                 CallInstruction &later_call,
+                                 const Map<const Instruction *, int> &chain_indices,
+                                 Set<const Instruction *> &r_removed_instructions)
+{
+  const MultiFunction &fn = later_call.fn();
+  for (const int param_index : fn.param_indices()) {
+    if (is_input_param(fn, param_index)) {
+      continue;
+    }
+    Variable *later_variable = later_call.params()[param_index];
+    if (later_variable == nullptr) {
+      continue;
+    }
+    later_call.set_param_variable(param_index, nullptr);
+    Variable *earlier_variable = earlier_call.params()[param_index];
+    if (earlier_variable == nullptr) {
+      /* The output was not used before, so the variable can be computed by the earlier call. */
+      earlier_call.set_param_variable(param_index, later_variable);
+      continue;
+    }
+    /* Do a copy, because the users change in the loop. */
+    const Vector<Instruction *> users = later_variable->users();
+    for (Instruction *user : users) {
+      if (user->type() == InstructionType::Call) {
+        CallInstruction &user_call = static_cast<CallInstruction &>(*user);
+        for (const int user_param_index : user_call.fn().param_indices()) {
+          if (user_call.params()[user_param_index] == later_variable) {
+            user_call.set_param_variable(user_param_index, earlier_variable);
+          }
+        }
+        continue;
+      }
+      /* Keep the destruct instruction that comes last, so that the variable stays initialized
+       * for all users. */
+      DestructInstruction &later_destruct = static_cast<DestructInstruction &>(*user);
+      DestructInstruction &earlier_destruct = *find_destruct(*earlier_variable);
+      DestructInstruction *destruct_to_remove = &later_destruct;
+      if (chain_indices.lookup(&later_destruct) > chain_indices.lookup(&earlier_destruct)) {
+        later_destruct.set_variable(earlier_variable);
+        destruct_to_remove = &earlier_destruct;
+      }
+      r_removed_instructions.add_new(destruct_to_remove);
+      remove_destruct(procedure, *destruct_to_remove);
+    }
+  }
+  r_removed_instructions.add_new(&later_call);
+  remove_call(procedure, later_call);
+}
+
+void eliminate_common_subexpressions(Procedure &procedure, Instruction &block_end_instr)
+{
+  const Vector<Instruction *> chain = find_linear_chain(block_end_instr);
+  Map<const Instruction *, int> chain_indices;
+  for (const int i : chain.index_range()) {
+    chain_indices.add_new(chain[i], i);
+  }
+  const Set<const Variable *> param_variables = get_param_variables(procedure);
+
+  /* Instructions that are removed are not accessed anymore when iterating over the chain. */
+  Set<const Instruction *> removed_instructions;
+  /* Calls that have been visited already, grouped by a hash of the function and its inputs. */
+  MultiValueMap<uint64_t, CallInstruction *> calls_by_hash;
+  for (Instruction *instr : chain) {
+    if (removed_instructions.contains(instr) || instr->type() != InstructionType::Call) {
+      continue;
+    }
+    CallInstruction &call = static_cast<CallInstruction &>(*instr);
+    if (!is_element_wise_function(call.fn()) ||
+        !call_can_be_deduplicated(procedure, call, param_variables, chain_indices))
+    {
+      continue;
+    }
+    const uint64_t hash = hash_call(call);
+    CallInstruction *earlier_call = nullptr;
+    for (CallInstruction *other_call : calls_by_hash.lookup(hash)) {
+      if (calls_compute_same_values(*other_call, call)) {
+        earlier_call = other_call;
+        break;
+      }
+    }
+    if (earlier_call == nullptr) {
+      calls_by_hash.add(hash, &call);
+      continue;
+    }
+    replace_call_outputs(procedure, *earlier_call, call, chain_indices, removed_instructions);
+  }
+}
+
+void fold_constants(Procedure &procedure, Instruction &block_end_instr)
+{
+  const Vector<Instruction *> chain = find_linear_chain(block_end_instr);
+  const Set<const Variable *> param_variables = get_param_variables(procedure);
+
+  /* Owns the values computed while folding. The constant functions make a copy. */
+  ResourceScope scope;
+  /* Variables that are known to have the same value for all indices. */
+  Map<const Variable *, GPointer> constant_values;
+  for (Instruction *instr : chain) {
+    if (instr->type() == InstructionType::Destruct) {
+      constant_values.remove(static_cast<DestructInstruction *>(instr)->variable());
+      continue;
+    }
+    if (instr->type() != InstructionType::Call) {
+      continue;
+    }
+    CallInstruction &call = static_cast<CallInstruction &>(*instr);
+    const MultiFunction &fn = call.fn();
+    const bool is_constant_fn = dynamic_cast<const CustomMF_GenericConstant *>(&fn) != nullptr;
+
+    bool can_fold = is_element_wise_function(fn);
+    bool has_input = false;
+    for (const int param_index : fn.param_indices()) {
+      const Variable *variable = call.params()[param_index];
+      if (is_input_param(fn, param_index)) {
+        has_input = true;
+        can_fold &= constant_values.contains(variable);
+      }
+      else if (variable != nullptr && param_variables.contains(variable)) {
+        can_fold = false;
+      }
+    }
+    if (!can_fold || !(has_input || is_constant_fn)) {
+      /* The values of the variables written by this call are unknown. */
+      for (const int param_index : fn.param_indices()) {
+        if (!is_input_param(fn, param_index)) {
+          constant_values.remove(call.params()[param_index]);
+        }
+      }
+      continue;
+    }
+
+    /* Evaluate the function for a single index. */
+    fn.prepare_for_execution();
+    const IndexMask mask(1);
+    ParamsBuilder params(fn, &mask);
+    Vector<std::pair<int, GPointer>> output_values;
+    for (const int param_index : fn.param_indices()) {
+      const Variable *variable = call.params()[param_index];
+      if (is_input_param(fn, param_index)) {
+        params.add_readonly_single_input(constant_values.lookup(variable));
+      }
+      else if (variable == nullptr) {
+        params.add_ignored_single_output();
+      }
+      else {
+        const CPPType &type = fn.param_type(param_index).data_type().single_type();
+        void *buffer = scope.allocate_owned(type);
+        params.add_uninitialized_single_output(GMutableSpan(type, buffer, 1));
+        output_values.append({param_index, GPointer(type, buffer)});
+      }
+    }
+    ContextBuilder context;
+    fn.call(mask, params, context);
+
+    if (is_constant_fn) {
+      for (const auto &[param_index, value] : output_values) {
+        constant_values.add_overwrite(call.params()[param_index], value);
+      }
+      continue;
+    }
+
+    /* Replace the call with one constant function call for every used output. */
+    for (const auto &[param_index, value] : output_values) {
+      Variable *variable = call.params()[param_index];
+      call.set_param_variable(param_index, nullptr);
+      const MultiFunction &constant_fn = procedure.construct_function<CustomMF_GenericConstant>(
+          *value.type(), value.get(), true);
+      CallInstruction &constant_call = procedure.new_call_instruction(constant_fn);
+      constant_call.set_param_variable(0, variable);
+      insert_before(procedure, call, constant_call);
+      constant_values.add_overwrite(variable, value);
+    }
+    remove_call(procedure, call);
+  }
+}
+
+void remove_unused_calls(Procedure &procedure, Instruction &block_end_instr)
+{
+  const Vector<Instruction *> chain = find_linear_chain(block_end_instr);
+  const Set<const Variable *> param_variables = get_param_variables(procedure);
+
+  /* Iterate backwards, so that calls which become unused by removing later calls are removed as
+   * well. Destruct instructions always come after the call, so they are not visited anymore. */
+  for (int i = chain.size() - 1; i >= 0; i--) {
+    if (chain[i]->type() != InstructionType::Call) {
+      continue;
+    }
+    CallInstruction &call = static_cast<CallInstruction &>(*chain[i]);
+    const MultiFunction &fn = call.fn();
+    if (!is_element_wise_function(fn)) {
+      continue;
+    }
+    bool is_used = false;
+    Vector<DestructInstruction *> destructs;
+    for (const int param_index : fn.param_indices()) {
+      Variable *variable = call.params()[param_index];
+      if (variable == nullptr || is_input_param(fn, param_index)) {
+        continue;
+      }
+      if (param_variables.contains(variable)) {
+        is_used = true;
+        break;
+      }
+      for (Instruction *user : variable->users()) {
+        if (user == &call) {
+          continue;
+        }
+        if (user->type() != InstructionType::Destruct) {
+          is_used = true;
+          break;
+        }
+        destructs.append(static_cast<DestructInstruction *>(user));
+      }
+    }
+    if (is_used) {
+      continue;
+    }
+    for (DestructInstruction *destruct : destructs) {
+      remove_destruct(procedure, *destruct);
+    }
+    remove_call(procedure, call);
+  }
+}
+
+namespace {
+
+/** A call of a function within a #FusedElementWiseFunction. */
+struct FusedCall {
+  const MultiFunction *fn;
+  /** The slot used for every parameter of the function, or -1 for unused outputs. */
+  Vector<int> slots;
+};
+
+/**
+ * Evaluates a sequence of element-wise functions for small chunks of the mask at a time. Every
+ * value is stored in a slot. The inputs of this function come first, then its outputs and then
+ * the temporary values that are only used by the fused calls.
+ */
+class FusedElementWiseFunction : public MultiFunction {
+ private:
+  static constexpr int64_t chunk_size = 512;
+
+  Vector<FusedCall> calls_;
+  Vector<const CPPType *> slot_types_;
+  int inputs_num_;
+  int outputs_num_;
+  Signature signature_;
+
+ public:
+  FusedElementWiseFunction(Vector<FusedCall> calls,
+                           Vector<const CPPType *> slot_types,
+                           const int inputs_num,
+                           const int outputs_num)
+      : calls_(std::move(calls)),
+        slot_types_(std::move(slot_types)),
+        inputs_num_(inputs_num),
+        outputs_num_(outputs_num)
+  {
+    SignatureBuilder builder{"Fused", signature_};
+    for (const int slot : IndexRange(inputs_num_)) {
+      builder.single_input("Input", *slot_types_[slot]);
+    }
+    for (const int slot : IndexRange(inputs_num_, outputs_num_)) {
+      builder.single_output("Output", *slot_types_[slot]);
+    }
+    this->set_signature(&signature_);
+  }
+
+  void call(const IndexMask &mask, Params params, Context context) const override
+  {
+    if (mask.is_empty()) {
+      return;
+    }
+    const IndexRange input_slots(inputs_num_);
+    const IndexRange output_slots(inputs_num_, outputs_num_);
+    const int slots_num = slot_types_.size();
+    LinearAllocator<> allocator;
+
+    /* Values of the slots that are the same for all indices, or null. */
+    Array<void *> single_values(slots_num, nullptr);
+    Array<GVArray> inputs(inputs_num_);
+    for (const int slot : input_slots) {
+      inputs[slot] = params.readonly_single_input(slot);
+      if (inputs[slot].is_single()) {
+        single_values[slot] = allocator.allocate(*slot_types_[slot]);
+        inputs[slot].get_internal_single_to_uninitialized(single_values[slot]);
+      }
+    }
+    Array<GMutableSpan> outputs(outputs_num_);
+    for (const int slot : output_slots) {
+      outputs[slot - inputs_num_] = params.uninitialized_single_output(slot);
+    }
+
+    /* Calls that only depend on single values are evaluated only once. */
+    static const IndexMask one_mask(1);
+    Array<bool> call_is_single(calls_.size());
+    for (const int call_i : calls_.index_range()) {
+      const FusedCall &call = calls_[call_i];
+      const MultiFunction &fn = *call.fn;
+      call_is_single[call_i] = std::all_of(
+          fn.param_indices().begin(), fn.param_indices().end(), [&](const int param_index) {
+            return !is_input_param(fn, param_index) || single_values[call.slots[param_index]];
+          });
+      if (!call_is_single[call_i]) {
+        continue;
+      }
+      ParamsBuilder call_params(fn, &one_mask);
+      for (const int param_index : fn.param_indices()) {
+        const int slot = call.slots[param_index];
+        if (is_input_param(fn, param_index)) {
+          call_params.add_readonly_single_input(GPointer(*slot_types_[slot], single_values[slot]));
+        }
+        else if (slot == -1) {
+          call_params.add_ignored_single_output();
+        }
+        else {
+          single_values[slot] = allocator.allocate(*slot_types_[slot]);
+          call_params.add_uninitialized_single_output(
+              GMutableSpan(*slot_types_[slot], single_values[slot], 1));
+        }
+      }
+      fn.call(one_mask, call_params, context);
+    }
+
+    /* Buffers for the values of a chunk of indices. Inputs and outputs only need them when the
+     * indices in a chunk are not contiguous. */
+    const int64_t max_chunk_size = std::min(mask.size(), chunk_size);
+    Array<void *> chunk_buffers(slots_num, nullptr);
+    for (const int slot : IndexRange(slots_num)) {
+      if (single_values[slot] == nullptr) {
+        const CPPType &type = *slot_types_[slot];
+        chunk_buffers[slot] = allocator.allocate(type.size * max_chunk_size, type.alignment);
+      }
+    }
+
+    for (int64_t chunk_start = 0; chunk_start < mask.size(); chunk_start += chunk_size) {
+      const IndexMask chunk = mask.slice(chunk_start,
+                                         std::min(chunk_size, mask.size() - chunk_start));
+      const std::optional<IndexRange> range = chunk.to_range();
+      const IndexMask chunk_mask(chunk.size());
+      auto buffer_span = [&](const int slot) {
+        return GMutableSpan(*slot_types_[slot], chunk_buffers[slot], chunk.size());
+      };
+      auto get_output = [&](const int slot) {
+        if (range && output_slots.contains(slot)) {
+          return outputs[slot - inputs_num_].slice(*range);
+        }
+        return buffer_span(slot);
+      };
+      auto get_input = [&](const int slot) {
+        if (single_values[slot]) {
+          return GVArray::from_single_ref(*slot_types_[slot], chunk.size(), single_values[slot]);
+        }
+        if (range && input_slots.contains(slot)) {
+          return inputs[slot].slice(*range);
+        }
+        return GVArray::from_span(get_output(slot));
+      };
+
+      if (!range) {
+        for (const int slot : input_slots) {
+          if (!single_values[slot]) {
+            inputs[slot].materialize_compressed_to_uninitialized(chunk, chunk_buffers[slot]);
+          }
+        }
+      }
+
+      for (const int call_i : calls_.index_range()) {
+        if (call_is_single[call_i]) {
+          continue;
+        }
+        const FusedCall &call = calls_[call_i];
+        const MultiFunction &fn = *call.fn;
+        ParamsBuilder call_params(fn, &chunk_mask);
+        for (const int param_index : fn.param_indices()) {
+          const int slot = call.slots[param_index];
+          if (is_input_param(fn, param_index)) {
+            call_params.add_readonly_single_input(get_input(slot));
+          }
+          else if (slot == -1) {
+            call_params.add_ignored_single_output();
+          }
+          else {
+            call_params.add_uninitialized_single_output(get_output(slot));
+          }
+        }
+        fn.call(chunk_mask, call_params, context);
+      }
+
+      for (const int slot : IndexRange(slots_num)) {
+        if (single_values[slot]) {
+          continue;
+        }
+        const CPPType &type = *slot_types_[slot];
+        if (output_slots.contains(slot)) {
+          if (!range) {
+            const GMutableSpan src = buffer_span(slot);
+            const GMutableSpan dst = outputs[slot - inputs_num_];
+            chunk.foreach_index([&](const int64_t i, const int64_t pos) {
+              type.relocate_construct(src[pos], dst[i]);
+            });
+          }
+        }
+        else if (!range || !input_slots.contains(slot)) {
+          type.destruct_n(chunk_buffers[slot], chunk.size());
+        }
+      }
+    }
+
+    for (const int slot : output_slots) {
+      if (single_values[slot]) {
+        slot_types_[slot]->fill_construct_indices(
+            single_values[slot], outputs[slot - inputs_num_].data(), mask);
+      }
+    }
+    for (const int slot : IndexRange(slots_num)) {
+      if (single_values[slot]) {
+        slot_types_[slot]->destruct(single_values[slot]);
+      }
+    }
+  }
+
+  void prepare_for_execution() const override
+  {
+    for (const FusedCall &call : calls_) {
+      call.fn->prepare_for_execution();
+    }
+  }
+
+ private:
+  ExecutionHints get_execution_hints() const override
+  {
+    ExecutionHints hints;
+    for (const FusedCall &call : calls_) {
+      const ExecutionHints call_hints = call.fn->execution_hints();
+      hints.min_grain_size = std::min(hints.min_grain_size, call_hints.min_grain_size);
+      hints.uniform_execution_time &= call_hints.uniform_execution_time;
+    }
+    return hints;
+  }
+};
+
+}  // namespace
+
+/**
+ * Only cheap functions are fused. Expensive functions don't spend much time on reading and
+ * writing buffers, and would be called many more times.
+ */
+static bool is_fusable_function(const MultiFunction &fn)
+{
+  if (!is_element_wise_function(fn)) {
+    return false;
+  }
+  const MultiFunction::ExecutionHints hints = fn.execution_hints();
+  return !hints.allocates_array && hints.min_grain_size >= 1000;
+}
+
+static void fuse_calls(Procedure &procedure,
+                       const Span<CallInstruction *> calls,
+                       const Set<const Variable *> &param_variables,
+                       Set<const Instruction *> &r_removed_instructions)
+{
+  Set<const Instruction *> calls_set;
+  for (const CallInstruction *call : calls) {
+    calls_set.add_new(call);
+  }
+  /* Variables that are only used within the fused calls don't have to be outputs. */
+  auto is_temporary_variable = [&](const Variable &variable) {
+    if (param_variables.contains(&variable)) {
+      return false;
+    }
+    for (const Instruction *user : const_cast<Variable &>(variable).users()) {
+      if (user->type() != InstructionType::Destruct && !calls_set.contains(user)) {
+        return false;
+      }
+    }
+    return true;
+  };
+
+  Vector<Variable *> input_variables;
+  Vector<Variable *> output_variables;
+  Vector<Variable *> temporary_variables;
+  Set<const Variable *> computed_variables;
+  for (CallInstruction *call : calls) {
+    for (const int param_index : call->fn().param_indices()) {
+      Variable *variable = call->params()[param_index];
+      if (variable == nullptr) {
+        continue;
+      }
+      if (is_input_param(call->fn(), param_index)) {
+        if (!computed_variables.contains(variable)) {
+          input_variables.append_non_duplicates(variable);
+        }
+        continue;
+      }
+      computed_variables.add(variable);
+      if (is_temporary_variable(*variable)) {
+        temporary_variables.append(variable);
+      }
+      else {
+        output_variables.append(variable);
+      }
+    }
+  }
+
+  Map<const Variable *, int> slot_by_variable;
+  Vector<const CPPType *> slot_types;
+  for (const Span<Variable *> variables : {input_variables.as_span(),
+                                           output_variables.as_span(),
+                                           temporary_variables.as_span()})
+  {
+    for (const Variable *variable : variables) {
+      slot_by_variable.add_new(variable, slot_types.size());
+      slot_types.append(&variable->data_type().single_type());
+    }
+  }
+  Vector<FusedCall> fused_calls;
+  for (const CallInstruction *call : calls) {
+    FusedCall fused_call{&call->fn()};
+    for (const Variable *variable : call->params()) {
+      fused_call.slots.append(variable ? slot_by_variable.lookup(variable) : -1);
+    }
+    fused_calls.append(std::move(fused_call));
+  }
+
+  const MultiFunction &fused_fn = procedure.construct_function<FusedElementWiseFunction>(
+      std::move(fused_calls),
+      std::move(slot_types),
+      input_variables.size(),
+      output_variables.size());
+  CallInstruction &fused_call = procedure.new_call_instruction(fused_fn);
+  int param_index = 0;
+  for (const Span<Variable *> variables : {input_variables.as_span(), output_variables.as_span()})
+  {
+    for (Variable *variable : variables) {
+      fused_call.set_param_variable(param_index++, variable);
+    }
+  }
+  insert_before(procedure, *calls.first(), fused_call);
+
+  for (CallInstruction *call : calls) {
+    r_removed_instructions.add_new(call);
+    remove_call(procedure, *call);
+  }
+  for (Variable *variable : temporary_variables) {
+    const Vector<Instruction *> users = variable->users();
+    for (Instruction *user : users) {
+      r_removed_instructions.add_new(user);
+      remove_destruct(procedure, static_cast<DestructInstruction &>(*user));
+    }
+  }
+}
+
+void fuse_element_wise_calls(Procedure &procedure, Instruction &block_end_instr)
+{
+  const Vector<Instruction *> chain = find_linear_chain(block_end_instr);
+  const Set<const Variable *> param_variables = get_param_variables(procedure);
+
+  /* Destruct instructions of temporary variables are removed while iterating over the chain. */
+  Set<const Instruction *> removed_instructions;
+  Vector<CallInstruction *> run;
+  auto fuse_run = [&]() {
+    if (run.size() >= 2) {
+      fuse_calls(procedure, run, param_variables, removed_instructions);
+    }
+    run.clear();
+  };
+  for (Instruction *instr : chain) {
+    if (removed_instructions.contains(instr)) {
+      continue;
+    }
+    if (instr->type() == InstructionType::Call) {
+      CallInstruction &call = static_cast<CallInstruction &>(*instr);
+      if (is_fusable_function(call.fn())) {
+        run.append(&call);
+        continue;
+      }
+    }
+    fuse_run();
+  }
+  fuse_run();
+}
+
 }  // namespace blender::fn::multi_function::procedure_optimization
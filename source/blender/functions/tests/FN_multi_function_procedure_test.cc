@@ -7,6 +7,7 @@
 #include "FN_multi_function_builder.hh"
 #include "FN_multi_function_procedure_builder.hh"
 #include "FN_multi_function_procedure_executor.hh"
+#include "FN_multi_function_procedure_optimization.hh"
 #include "FN_multi_function_test_common.hh"
 
 #include "BKE_gtest_base.hh"
@@ -427,4 +428,191 @@ TEST_F(MultiFunctionProcedureTest, OutputBufferReplaced)
   EXPECT_EQ(output[2], output_value);
 }
 
+static int count_call_instructions(const Procedure &procedure)
+{
+  int count = 0;
+  const Instruction *instr = procedure.entry();
+  while (instr->type() != InstructionType::Return) {
+    if (instr->type() == InstructionType::Call) {
+      count++;
+      instr = static_cast<const CallInstruction *>(instr)->next();
+    }
+    else {
+      instr = static_cast<const DestructInstruction *>(instr)->next();
+    }
+  }
+  return count;
+}
+
+TEST_F(MultiFunctionProcedureTest, EliminateCommonSubexpressions)
+{
+  /**
+   * procedure(int a, int *out) {
+   *   int b = a + 10;
+   *   int c = a + 10;
+   *   int unused = a + 20;
+   *   out = b + c;
+   * }
+   */
+
+  auto add_10_fn = build::SI1_SO<int, int>("add 10", [](int a) { return a + 10; });
+  auto add_20_fn = build::SI1_SO<int, int>("add 20", [](int a) { return a + 20; });
+  auto add_fn = build::SI2_SO<int, int, int>("add", [](int a, int b) { return a + b; });
+
+  Procedure procedure;
+  ProcedureBuilder builder{procedure};
+
+  Variable *var_a = &builder.add_single_input_parameter<int>();
+  auto [var_b] = builder.add_call<1>(add_10_fn, {var_a});
+  auto [var_c] = builder.add_call<1>(add_10_fn, {var_a});
+  auto [var_unused] = builder.add_call<1>(add_20_fn, {var_a});
+  auto [var_out] = builder.add_call<1>(add_fn, {var_b, var_c});
+  builder.add_destruct({var_a, var_b, var_c, var_unused});
+  ReturnInstruction &return_instr = builder.add_return();
+  builder.add_output_parameter(*var_out);
+
+  procedure_optimization::eliminate_common_subexpressions(procedure, return_instr);
+  procedure_optimization::remove_unused_calls(procedure, return_instr);
+
+  EXPECT_TRUE(procedure.validate());
+  EXPECT_EQ(count_call_instructions(procedure), 2);
+
+  ProcedureExecutor executor{procedure};
+
+  const IndexMask mask(3);
+  ParamsBuilder params{executor, &mask};
+  ContextBuilder context;
+
+  Array<int> input_array = {1, 2, 3};
+  params.add_readonly_single_input(input_array.as_span());
+
+  Array<int> output_array(3);
+  params.add_uninitialized_single_output(output_array.as_mutable_span());
+
+  executor.call(mask, params, context);
+
+  EXPECT_EQ(output_array[0], 22);
+  EXPECT_EQ(output_array[1], 24);
+  EXPECT_EQ(output_array[2], 26);
+}
+
+TEST_F(MultiFunctionProcedureTest, FoldConstants)
+{
+  /**
+   * procedure(int a, int *out) {
+   *   int b = 5;
+   *   int c = 3;
+   *   int d = b * c;
+   *   out = a + d;
+   * }
+   */
+
+  const int value_5 = 5;
+  const int value_3 = 3;
+  CustomMF_GenericConstant constant_5_fn(CPPType::get<int>(), &value_5, false);
+  CustomMF_GenericConstant constant_3_fn(CPPType::get<int>(), &value_3, false);
+  auto mul_fn = build::SI2_SO<int, int, int>("mul", [](int a, int b) { return a * b; });
+  auto add_fn = build::SI2_SO<int, int, int>("add", [](int a, int b) { return a + b; });
+
+  Procedure procedure;
+  ProcedureBuilder builder{procedure};
+
+  Variable *var_a = &builder.add_single_input_parameter<int>();
+  auto [var_b] = builder.add_call<1>(constant_5_fn);
+  auto [var_c] = builder.add_call<1>(constant_3_fn);
+  auto [var_d] = builder.add_call<1>(mul_fn, {var_b, var_c});
+  auto [var_out] = builder.add_call<1>(add_fn, {var_a, var_d});
+  builder.add_destruct({var_a, var_b, var_c, var_d});
+  ReturnInstruction &return_instr = builder.add_return();
+  builder.add_output_parameter(*var_out);
+
+  procedure_optimization::fold_constants(procedure, return_instr);
+  procedure_optimization::remove_unused_calls(procedure, return_instr);
+
+  EXPECT_TRUE(procedure.validate());
+  EXPECT_EQ(count_call_instructions(procedure), 2);
+
+  ProcedureExecutor executor{procedure};
+
+  const IndexMask mask(3);
+  ParamsBuilder params{executor, &mask};
+  ContextBuilder context;
+
+  Array<int> input_array = {1, 2, 3};
+  params.add_readonly_single_input(input_array.as_span());
+
+  Array<int> output_array(3);
+  params.add_uninitialized_single_output(output_array.as_mutable_span());
+
+  executor.call(mask, params, context);
+
+  EXPECT_EQ(output_array[0], 16);
+  EXPECT_EQ(output_array[1], 17);
+  EXPECT_EQ(output_array[2], 18);
+}
+
+TEST_F(MultiFunctionProcedureTest, FuseElementWiseCalls)
+{
+  /**
+   * procedure(int a, int f, int *out) {
+   *   int b = a + f;
+   *   int c = b * 2;
+   *   out = c + a;
+   * }
+   */
+
+  auto add_fn = build::SI2_SO<int, int, int>("add", [](int a, int b) { return a + b; });
+  auto mul_2_fn = build::SI1_SO<int, int>("mul 2", [](int a) { return a * 2; });
+
+  Procedure procedure;
+  ProcedureBuilder builder{procedure};
+
+  Variable *var_a = &builder.add_single_input_parameter<int>();
+  Variable *var_f = &builder.add_single_input_parameter<int>();
+  auto [var_b] = builder.add_call<1>(add_fn, {var_a, var_f});
+  auto [var_c] = builder.add_call<1>(mul_2_fn, {var_b});
+  auto [var_out] = builder.add_call<1>(add_fn, {var_c, var_a});
+  builder.add_destruct({var_a, var_f, var_b, var_c});
+  ReturnInstruction &return_instr = builder.add_return();
+  builder.add_output_parameter(*var_out);
+
+  procedure_optimization::fuse_element_wise_calls(procedure, return_instr);
+  procedure_optimization::move_destructs_up(procedure, return_instr);
+
+  EXPECT_TRUE(procedure.validate());
+  EXPECT_EQ(count_call_instructions(procedure), 1);
+
+  ProcedureExecutor executor{procedure};
+
+  const int size = 2000;
+  Array<int> input_array(size);
+  for (const int i : input_array.index_range()) {
+    input_array[i] = i;
+  }
+
+  auto evaluate = [&](const IndexMask &mask, const int f) {
+    Array<int> output_array(size, -1);
+    ParamsBuilder params{executor, &mask};
+    params.add_readonly_single_input(input_array.as_span());
+    params.add_readonly_single_input_value(f);
+    params.add_uninitialized_single_output(output_array.as_mutable_span());
+    ContextBuilder context;
+    executor.call(mask, params, context);
+    return output_array;
+  };
+
+  const Array<int> dense_result = evaluate(IndexMask(size), 5);
+  for (const int i : IndexRange(size)) {
+    EXPECT_EQ(dense_result[i], (i + 5) * 2 + i);
+  }
+
+  IndexMaskMemory memory;
+  const IndexMask sparse_mask = IndexMask::from_predicate(
+      IndexMask(size), memory, [](const int64_t i) { return i % 3 == 0; });
+  const Array<int> sparse_result = evaluate(sparse_mask, 1);
+  for (const int i : IndexRange(size)) {
+    EXPECT_EQ(sparse_result[i], i % 3 == 0 ? (i + 1) * 2 + i : -1);
+  }
+}
+
 }  // namespace blender::fn::multi_function::tests
@@ -0,0 +1,112 @@
+/* SPDX-FileCopyrightText: 2026 Blender Authors
+ *
+ * SPDX-License-Identifier: Apache-2.0 */
+
+#include <algorithm>
+
+#include "BLI_array.hh"
+#include "BLI_math_vector.hh"
+#include "BLI_rand.hh"
+
+#include "GEO_xpbd_spatial_hash.hh"
+
+#include "testing/testing.h"
+
+namespace blender::xpbd::tests {
+
+static Vector<int2> find_close_pairs_brute_force(const Span<float3> positions,
+                                                 const Span<float> radii,
+                                                 const float margin)
+{
+  Vector<int2> pairs;
+  for (const int i : positions.index_range()) {
+    for (const int j : positions.index_range().drop_front(i + 1)) {
+      const float max_distance = radii[i] + radii[j] + margin;
+      if (math::distance_squared(positions[i], positions[j]) < math::square(max_distance)) {
+        pairs.append({i, j});
+      }
+    }
+  }
+  return pairs;
+}
+
+static bool pair_less(const int2 &a, const int2 &b)
+{
+  return a[0] < b[0] || (a[0] == b[0] && a[1] < b[1]);
+}
+
+static void expect_same_pairs_as_brute_force(const Span<float3> positions,
+                                             const Span<float> radii,
+                                             const float margin,
+                                             const float cell_size)
+{
+  PointSpatialHash hash;
+  hash.build(positions, cell_size);
+  Vector<int2> pairs;
+  hash.find_close_pairs(positions, radii, margin, pairs);
+
+  /* Pairs are grouped by their first point. */
+  for (const int i : pairs.index_range()) {
+    EXPECT_LT(pairs[i][0], pairs[i][1]);
+    if (i > 0) {
+      EXPECT_LE(pairs[i - 1][0], pairs[i][0]);
+    }
+  }
+
+  /* Building again gives the same pairs in the same order. */
+  PointSpatialHash hash_rebuilt;
+  hash_rebuilt.build(positions, cell_size);
+  Vector<int2> pairs_rebuilt;
+  hash_rebuilt.find_close_pairs(positions, radii, margin, pairs_rebuilt);
+  EXPECT_EQ(pairs_rebuilt.as_span(), pairs.as_span());
+
+  Vector<int2> expected = find_close_pairs_brute_force(positions, radii, margin);
+  EXPECT_FALSE(expected.is_empty());
+  std::sort(pairs.begin(), pairs.end(), pair_less);
+  EXPECT_EQ(pairs.as_span(), expected.as_span());
+}
+
+TEST(xpbd_spatial_hash, random_points)
+{
+  constexpr int points_num = 3000;
+  constexpr float margin = 0.05f;
+  RandomNumberGenerator rng(7);
+  Array<float3> positions(points_num);
+  Array<float> radii(points_num);
+  for (const int i : IndexRange(points_num)) {
+    /* Include negative coordinates, which are rounded down to the next cell. */
+    positions[i] = float3(rng.get_float(), rng.get_float(), rng.get_float()) * 8.0f - 4.0f;
+    radii[i] = 0.05f + rng.get_float() * 0.1f;
+  }
+  expect_same_pairs_as_brute_force(positions, radii, margin, 0.15f * 2.0f + margin);
+}
+
+TEST(xpbd_spatial_hash, points_on_cell_boundaries)
+{
+  /* Lattice with half the cell size as spacing, so that every other point is exactly on a cell
+   * boundary and the closest neighbors are in different cells. Points on the diagonal of a cell
+   * are still close enough, points one cell apart are not. */
+  constexpr float cell_size = 1.0f;
+  constexpr float margin = 0.09f;
+  Vector<float3> positions;
+  for (int z = -2; z <= 4; z++) {
+    for (int y = -2; y <= 4; y++) {
+      for (int x = -2; x <= 4; x++) {
+        positions.append(float3(x, y, z) * (cell_size * 0.5f));
+      }
+    }
+  }
+  const Array<float> radii(positions.size(), 0.45f);
+  expect_same_pairs_as_brute_force(positions, radii, margin, cell_size);
+}
+
+TEST(xpbd_spatial_hash, coincident_points)
+{
+  /* Many points in the same cell and on the same boundary. */
+  Array<float3> positions(50, float3(1.0f, 0.0f, -1.0f));
+  positions.as_mutable_span().take_back(10).fill(float3(2.5f));
+  const Array<float> radii(positions.size(), 0.1f);
+  expect_same_pairs_as_brute_force(positions, radii, 0.0f, 0.2f);
+}
+
+}  // namespace blender::xpbd::tests
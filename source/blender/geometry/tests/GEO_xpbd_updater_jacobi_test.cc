@@ -0,0 +1,127 @@
+/* SPDX-FileCopyrightText: 2026 Blender Authors
+ *
+ * SPDX-License-Identifier: Apache-2.0 */
+
+#include "BLI_array.hh"
+#include "BLI_linear_allocator.hh"
+#include "BLI_math_vector.hh"
+
+#include "GEO_xpbd_constraint_distance.hh"
+
+#include "testing/testing.h"
+
+namespace blender::xpbd::tests {
+
+/**
+ * Chain of points along the X axis, connected by distance constraints with a rest length of one.
+ * The first point is pinned, so the constraints are satisfied when point `i` is at `x = i`. The
+ * chain starts out stretched, so that solving the constraints never flips an edge.
+ */
+struct DistanceChain {
+  static constexpr int points_num = 8;
+
+  Array<float3> positions;
+  Array<float3> velocities;
+  Array<float3> prev_positions;
+  Array<float> inv_masses;
+  Array<int2> point_pairs;
+  Array<float> distances;
+  Array<float> compliances;
+  Array<float> lambdas;
+
+  DistanceChain()
+      : positions(points_num),
+        velocities(points_num, float3(0.0f)),
+        inv_masses(points_num, 1.0f),
+        point_pairs(points_num - 1),
+        distances(points_num - 1, 1.0f),
+        compliances(points_num - 1, 0.0f),
+        lambdas(points_num - 1, 0.0f)
+  {
+    for (const int i : positions.index_range()) {
+      positions[i] = float3(1.5f * i, 0.0f, 0.0f);
+    }
+    prev_positions = positions;
+    inv_masses[0] = 0.0f;
+    for (const int i : point_pairs.index_range()) {
+      point_pairs[i] = int2(i, i + 1);
+    }
+  }
+
+  GeometryRef geometry_ref()
+  {
+    GeometryRef ref;
+    ref.positions = positions;
+    ref.velocities = velocities;
+    ref.prev_positions = prev_positions;
+    ref.inv_masses = inv_masses;
+    return ref;
+  }
+
+  DistanceConstraintSet constraint_set()
+  {
+    return DistanceConstraintSet(0, point_pairs, distances, compliances, 1.0f, lambdas);
+  }
+};
+
+static void expect_chain_solved(const Span<float3> positions)
+{
+  for (const int i : positions.index_range()) {
+    EXPECT_NEAR(positions[i].x, float(i), 1e-3f);
+    EXPECT_EQ(positions[i].y, 0.0f);
+    EXPECT_EQ(positions[i].z, 0.0f);
+  }
+}
+
+TEST(xpbd_updater, jacobi_matches_gauss_seidel)
+{
+  constexpr float delta_time = 1.0f / 60.0f;
+
+  DistanceChain chain_gauss_seidel;
+  {
+    const Array<GeometryRef> refs = {chain_gauss_seidel.geometry_ref()};
+    const ConstraintSetParams params(refs, delta_time);
+    DistanceConstraintSet constraints = chain_gauss_seidel.constraint_set();
+    LinearAllocator<> memory;
+    const ConstraintColoring coloring = constraints.color_constraints(memory);
+    /* Neighboring constraints share a point, so they can't be solved at the same time. */
+    EXPECT_GT(coloring.colors.size(), 1);
+    GaussSeidelUpdater updater(refs);
+    for ([[maybe_unused]] const int iteration : IndexRange(500)) {
+      for (const IndexMask &color : coloring.colors) {
+        constraints.solve_sequential(params, updater, color);
+      }
+    }
+  }
+  expect_chain_solved(chain_gauss_seidel.positions);
+
+  DistanceChain chain_jacobi;
+  {
+    const Array<GeometryRef> refs = {chain_jacobi.geometry_ref()};
+    const ConstraintSetParams params(refs, delta_time);
+    DistanceConstraintSet constraints = chain_jacobi.constraint_set();
+    JacobiBuffers buffers;
+    buffers.ensure(refs);
+    /* Averaging the offsets of all constraints converges slower. */
+    for ([[maybe_unused]] const int iteration : IndexRange(5000)) {
+      JacobiUpdater updater(buffers.geometries());
+      constraints.solve_jacobi(params, updater, IndexMask(constraints.size()));
+      EXPECT_EQ(updater.total_error_count(), constraints.size());
+      buffers.apply_and_reset(refs, {0});
+    }
+    /* The buffers are ready to be used for the next solve. */
+    for (const JacobiGeometryBuffer &buffer : buffers.geometries()) {
+      for (const int i : buffer.position_offsets.index_range()) {
+        EXPECT_EQ(buffer.position_offsets[i], float3(0.0f));
+        EXPECT_EQ(buffer.position_counts[i], 0);
+      }
+    }
+  }
+  expect_chain_solved(chain_jacobi.positions);
+
+  for (const int i : IndexRange(DistanceChain::points_num)) {
+    EXPECT_NEAR(chain_jacobi.positions[i].x, chain_gauss_seidel.positions[i].x, 1e-3f);
+  }
+}
+
+}  // namespace blender::xpbd::tests
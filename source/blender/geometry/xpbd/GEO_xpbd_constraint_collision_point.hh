@@ -0,0 +1,116 @@
+/* SPDX-FileCopyrightText: 2026 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+
+#pragma once
+
+#include "GEO_xpbd_constraint_coloring_utils.hh"
+#include "GEO_xpbd_constraint_set_templated.hh"
+
+namespace blender::xpbd {
+
+/**
+ * Contacts between pairs of points of the same geometry, which are treated as spheres. Like the
+ * distance constraint, but only pushes points apart and is only active while the spheres overlap.
+ * Static friction is handled like in #CollisionFaceConstraintSet.
+ */
+class CollisionPointConstraintSet : public TemplatedConstraintSet<CollisionPointConstraintSet> {
+ private:
+  int geo_i_;
+  /** Indexed by constraint index. */
+  Span<int2> point_pairs_;
+  /** Indexed by point index. */
+  Span<float> point_radii_;
+  float margin_;
+  float compliance_term_;
+  float static_friction_;
+  /* Scale factor for residual error. */
+  float error_scale_;
+  MutableSpan<float> lambdas_normal_;
+
+ public:
+  static constexpr StringRefNull debug_name = "Collision Point";
+
+  CollisionPointConstraintSet(const int geo_i,
+                              const Span<int2> point_pairs,
+                              const Span<float> point_radii,
+                              const float margin,
+                              const float compliance_term,
+                              const float static_friction,
+                              const float error_scale,
+                              MutableSpan<float> lambdas_normal)
+      : TemplatedConstraintSet<CollisionPointConstraintSet>(point_pairs.size(), {geo_i}),
+        geo_i_(geo_i),
+        point_pairs_(point_pairs),
+        point_radii_(point_radii),
+        margin_(margin),
+        compliance_term_(compliance_term),
+        static_friction_(static_friction),
+        error_scale_(error_scale),
+        lambdas_normal_(lambdas_normal)
+  {
+  }
+
+  void reset_force(const int constraint_i) const
+  {
+    lambdas_normal_[constraint_i] = 0.0f;
+  }
+
+  template<typename UpdaterT>
+  void solve_single(const ConstraintSetParams &params,
+                    UpdaterT &updater,
+                    const int constraint_i) const
+  {
+    const int2 &point_pair = point_pairs_[constraint_i];
+    const int point_i0 = point_pair[0];
+    const int point_i1 = point_pair[1];
+    const float inv_m0 = params.inv_mass(geo_i_, point_i0);
+    const float inv_m1 = params.inv_mass(geo_i_, point_i1);
+    const float inv_m_sum = inv_m0 + inv_m1;
+    if (inv_m_sum <= 0.0f) {
+      return;
+    }
+
+    const float3 &pos0 = params.position(geo_i_, point_i0);
+    const float3 &pos1 = params.position(geo_i_, point_i1);
+    float length;
+    const float3 normal = math::normalize_and_get_length(pos1 - pos0, length);
+    const float normal_distance = length - point_radii_[point_i0] - point_radii_[point_i1] -
+                                  margin_;
+    if (normal_distance >= 0.0f) {
+      return;
+    }
+
+    /* Positional correction for penetration. */
+    float &lambda_normal = lambdas_normal_[constraint_i];
+    const float error_squared = math::square(normal_distance + compliance_term_ * lambda_normal);
+    const float delta_lambda_normal = -normal_distance / (inv_m_sum + compliance_term_);
+    float3 offset0 = -delta_lambda_normal * inv_m0 * normal;
+    float3 offset1 = delta_lambda_normal * inv_m1 * normal;
+    lambda_normal += delta_lambda_normal;
+
+    /* Apply static friction as a direct positional update of the relative motion. */
+    const float3 motion0 = pos0 - params.prev_position(geo_i_, point_i0);
+    const float3 motion1 = pos1 - params.prev_position(geo_i_, point_i1);
+    const float3 velocity = motion1 - motion0;
+    const float3 velocity_tangent = velocity - math::dot(velocity, normal) * normal;
+    const float3 lambda_tangent = velocity_tangent / (inv_m_sum + compliance_term_);
+    const bool is_static = math::length_squared(lambda_tangent) <
+                           math::square(static_friction_ * lambda_normal);
+    if (is_static) {
+      offset0 += lambda_tangent * inv_m0;
+      offset1 -= lambda_tangent * inv_m1;
+    }
+
+    updater.update_position(geo_i_, point_i0, offset0);
+    updater.update_position(geo_i_, point_i1, offset1);
+    updater.add_residual_error(geo_i_, error_squared * error_scale_);
+  }
+
+  ConstraintColoring color_constraints(LinearAllocator<> &memory) const override
+  {
+    return color_constraints__binary(point_pairs_, memory);
+  }
+};
+
+}  // namespace blender::xpbd
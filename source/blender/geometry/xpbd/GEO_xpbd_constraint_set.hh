@@ -11,10 +11,26 @@
 #include "GEO_xpbd_constraint_coloring.hh"
 #include "GEO_xpbd_constraint_set_params.hh"
 #include "GEO_xpbd_updater_gauss_seidel.hh"
+#include "GEO_xpbd_updater_jacobi.hh"
 #include "GEO_xpbd_updater_velocity.hh"
 
 namespace blender::xpbd {
 
+/** Determines how the constraints of a set are solved in parallel. */
+enum class ConstraintSolveMethod : int8_t {
+  /**
+   * Independent constraints (see #ConstraintColoring) are solved in parallel, one color after
+   * another. Changes are applied immediately, which gives the best convergence.
+   */
+  GaussSeidel,
+  /**
+   * All constraints are solved in parallel with #JacobiUpdater, the changes are averaged
+   * afterwards. Does not require coloring and has no synchronization between colors, which is
+   * faster for constraint sets with many colors, e.g. dense contacts.
+   */
+  Jacobi,
+};
+
 /**
  * Base class for constraint evaluators. It evaluate a batch of constraints and writes back the
  * results using a passed in "updater".
@@ -40,6 +56,9 @@ class ConstraintSet {
   virtual void solve_sequential(const ConstraintSetParams &params,
                                 GaussSeidelUpdater &updater,
                                 const IndexMask &mask) = 0;
+  virtual void solve_jacobi(const ConstraintSetParams &params,
+                            JacobiUpdater &updater,
+                            const IndexMask &mask) = 0;
   virtual void reset_forces() = 0;
   virtual ConstraintColoring color_constraints(LinearAllocator<> &memory) const = 0;
 
@@ -48,6 +67,11 @@ class ConstraintSet {
     this->solve_sequential(params, updater, IndexMask(constraints_num_));
   }
 
+  int size() const
+  {
+    return constraints_num_;
+  }
+
   Span<int> get_affected_geo_indices() const
   {
     return affected_geo_indices_;
@@ -10,7 +10,7 @@ namespace blender::xpbd {
 
 /**
  * Utility to implement a constraint evaluator that automatically works with multiple updaters like
- * #GaussSeidelUpdater.
+ * #GaussSeidelUpdater and #JacobiUpdater.
  *
  * Child classes have to implement the templated #solve_single method.
  */
@@ -38,6 +38,15 @@ template<typename Child> class TemplatedConstraintSet : public ConstraintSet {
         [&](const int64_t constraint_i) { self.solve_single(params, updater, constraint_i); });
   }
 
+  void solve_jacobi(const ConstraintSetParams &params,
+                    JacobiUpdater &updater,
+                    const IndexMask &mask) override
+  {
+    const Child &self = static_cast<const Child &>(*this);
+    mask.foreach_index(
+        [&](const int64_t constraint_i) { self.solve_single(params, updater, constraint_i); });
+  }
+
   StringRefNull debug_name() const final
   {
     return Child::debug_name;
@@ -0,0 +1,49 @@
+/* SPDX-FileCopyrightText: 2026 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+
+#pragma once
+
+#include "BLI_array.hh"
+#include "BLI_math_vector_types.hh"
+#include "BLI_vector.hh"
+
+namespace blender::xpbd {
+
+/**
+ * Uniform grid over points, stored as a hash table so that its memory usage only depends on the
+ * number of points. It is meant to be rebuilt from scratch whenever positions change, e.g. for
+ * every sub-step, so building is done with a counting sort over the hashed grid cells instead of
+ * inserting points one by one.
+ */
+class PointSpatialHash {
+ private:
+  float inv_cell_size_ = 0.0f;
+  int table_mask_ = 0;
+  /** Points sorted by hash table entry, see #entry_offsets_. */
+  Array<int> sorted_points_;
+  /** Offsets into #sorted_points_ for every hash table entry, with one extra value at the end. */
+  Array<int> entry_offsets_;
+
+ public:
+  /**
+   * \param cell_size: Size of the grid cells. Queries only find points within this distance.
+   */
+  void build(Span<float3> positions, float cell_size);
+
+  /**
+   * Find all pairs of points (with the first index being smaller) for which the distance is
+   * smaller than the sum of their radii and the margin. The sum must not be larger than the cell
+   * size given to #build. The order of the pairs is deterministic.
+   */
+  void find_close_pairs(Span<float3> positions,
+                        Span<float> radii,
+                        float margin,
+                        Vector<int2> &r_pairs) const;
+
+ private:
+  int3 cell_of(const float3 &position) const;
+  int entry_of(const int3 &cell) const;
+};
+
+}  // namespace blender::xpbd
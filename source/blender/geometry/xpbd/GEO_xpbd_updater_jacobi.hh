@@ -0,0 +1,104 @@
+/* SPDX-FileCopyrightText: 2026 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+
+#pragma once
+
+#include "BLI_array.hh"
+#include "BLI_math_quaternion.hh"
+
+#include "GEO_xpbd_geometry_ref.hh"
+
+#include "atomic_ops.h"
+
+namespace blender::xpbd {
+
+/**
+ * Offsets of one geometry that have been accumulated by #JacobiUpdater but are not applied yet.
+ */
+struct JacobiGeometryBuffer {
+  Array<float3> position_offsets;
+  Array<int> position_counts;
+  Array<float4> rotation_offsets;
+  Array<int> rotation_counts;
+};
+
+/**
+ * Storage for the offsets of all simulated geometries. It is reused for all Jacobi solves within
+ * a step, because applying the offsets resets the buffers.
+ */
+class JacobiBuffers {
+ private:
+  Array<JacobiGeometryBuffer> geometries_;
+
+ public:
+  /** Allocate zero initialized buffers if they don't exist yet. */
+  void ensure(Span<GeometryRef> geometry_refs);
+
+  MutableSpan<JacobiGeometryBuffer> geometries()
+  {
+    return geometries_;
+  }
+
+  /**
+   * Move every point of the given geometries by the average of the offsets accumulated for it and
+   * reset the buffers of these geometries.
+   */
+  void apply_and_reset(Span<GeometryRef> geometry_refs, Span<int> geo_indices);
+};
+
+/**
+ * Updater that accumulates the changes in #JacobiBuffers instead of writing them to the simulated
+ * points, so that all constraints of a set see the same positions. Constraints don't need to be
+ * colored to be solved in parallel, at the cost of slower convergence because the averaged
+ * offsets of different constraints affecting the same point are not combined immediately.
+ */
+class JacobiUpdater {
+ private:
+  MutableSpan<JacobiGeometryBuffer> buffers_;
+  float total_error_squared_;
+  int total_error_count_;
+
+ public:
+  JacobiUpdater(MutableSpan<JacobiGeometryBuffer> buffers)
+      : buffers_(buffers), total_error_squared_(0.0f), total_error_count_(0)
+  {
+  }
+
+  float total_error_squared() const
+  {
+    return total_error_squared_;
+  }
+  int total_error_count() const
+  {
+    return total_error_count_;
+  }
+
+  void update_position(const int geo_i, const int point_i, const float3 &offset)
+  {
+    JacobiGeometryBuffer &buffer = buffers_[geo_i];
+    float3 &dst = buffer.position_offsets[point_i];
+    atomic_add_and_fetch_fl(&dst.x, offset.x);
+    atomic_add_and_fetch_fl(&dst.y, offset.y);
+    atomic_add_and_fetch_fl(&dst.z, offset.z);
+    atomic_add_and_fetch_int32(&buffer.position_counts[point_i], 1);
+  }
+  void update_rotation(const int geo_i, const int point_i, const math::Quaternion &offset)
+  {
+    JacobiGeometryBuffer &buffer = buffers_[geo_i];
+    float4 &dst = buffer.rotation_offsets[point_i];
+    const float4 offset_vec = float4(offset);
+    atomic_add_and_fetch_fl(&dst.x, offset_vec.x);
+    atomic_add_and_fetch_fl(&dst.y, offset_vec.y);
+    atomic_add_and_fetch_fl(&dst.z, offset_vec.z);
+    atomic_add_and_fetch_fl(&dst.w, offset_vec.w);
+    atomic_add_and_fetch_int32(&buffer.rotation_counts[point_i], 1);
+  }
+  void add_residual_error(const int /*geo_i*/, const float error_squared)
+  {
+    total_error_squared_ += error_squared;
+    ++total_error_count_;
+  }
+};
+
+}  // namespace blender::xpbd
@@ -0,0 +1,134 @@
+/* SPDX-FileCopyrightText: 2026 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+
+#include <algorithm>
+
+#include "BLI_math_base.hh"
+#include "BLI_math_vector.hh"
+#include "BLI_offset_indices.hh"
+#include "BLI_task.hh"
+
+#include "GEO_xpbd_spatial_hash.hh"
+
+#include "atomic_ops.h"
+
+namespace blender::xpbd {
+
+int3 PointSpatialHash::cell_of(const float3 &position) const
+{
+  return int3(math::floor(position * inv_cell_size_));
+}
+
+int PointSpatialHash::entry_of(const int3 &cell) const
+{
+  /* Hash function from "Optimized Spatial Hashing for Collision Detection of Deformable Objects",
+   * Teschner et al., 2003. */
+  const uint32_t hash = (uint32_t(cell.x) * 73856093u) ^ (uint32_t(cell.y) * 19349663u) ^
+                        (uint32_t(cell.z) * 83492791u);
+  return int(hash & uint32_t(table_mask_));
+}
+
+void PointSpatialHash::build(const Span<float3> positions, const float cell_size)
+{
+  BLI_assert(cell_size > 0.0f);
+  const int points_num = positions.size();
+  inv_cell_size_ = 1.0f / cell_size;
+  /* Use about twice as many entries as points to keep the number of collisions between
+   * different cells low. */
+  const int table_size = int(power_of_2_max(std::max(points_num, 1) * 2));
+  table_mask_ = table_size - 1;
+
+  Array<int> point_entries(points_num);
+  entry_offsets_.reinitialize(table_size + 1);
+  entry_offsets_.fill(0);
+  threading::parallel_for(positions.index_range(), 2048, [&](const IndexRange range) {
+    for (const int point_i : range) {
+      const int entry = this->entry_of(this->cell_of(positions[point_i]));
+      point_entries[point_i] = entry;
+      atomic_fetch_and_add_int32(&entry_offsets_[entry], 1);
+    }
+  });
+  const OffsetIndices<int> offsets = offset_indices::accumulate_counts_to_offsets(entry_offsets_);
+
+  Array<int> entry_fill(table_size, 0);
+  sorted_points_.reinitialize(points_num);
+  threading::parallel_for(positions.index_range(), 2048, [&](const IndexRange range) {
+    for (const int point_i : range) {
+      const int entry = point_entries[point_i];
+      const int index_in_entry = atomic_fetch_and_add_int32(&entry_fill[entry], 1);
+      sorted_points_[offsets[entry][index_in_entry]] = point_i;
+    }
+  });
+  /* Scattering in parallel does not preserve the order of points within an entry. Sort them to
+   * make the result independent of scheduling, which keeps the simulation deterministic. */
+  threading::parallel_for(IndexRange(table_size), 4096, [&](const IndexRange range) {
+    for (const int entry : range) {
+      MutableSpan<int> entry_points = sorted_points_.as_mutable_span().slice(offsets[entry]);
+      if (entry_points.size() > 1) {
+        std::sort(entry_points.begin(), entry_points.end());
+      }
+    }
+  });
+}
+
+void PointSpatialHash::find_close_pairs(const Span<float3> positions,
+                                        const Span<float> radii,
+                                        const float margin,
+                                        Vector<int2> &r_pairs) const
+{
+  const OffsetIndices<int> offsets(entry_offsets_);
+  /* Pairs are gathered per fixed size chunk of points and concatenated in order afterwards, so
+   * that the result does not depend on scheduling. */
+  const int chunk_size = 1024;
+  const int chunks_num = (positions.size() + chunk_size - 1) / chunk_size;
+  Array<Vector<int2>> pairs_by_chunk(chunks_num);
+  threading::parallel_for(IndexRange(chunks_num), 1, [&](const IndexRange chunks_range) {
+    for (const int chunk_i : chunks_range) {
+      const IndexRange points_range = IndexRange::from_begin_size(chunk_i * chunk_size,
+                                                                  chunk_size)
+                                          .intersect(positions.index_range());
+      Vector<int2> &pairs = pairs_by_chunk[chunk_i];
+      for (const int point_i : points_range) {
+        const float3 &position = positions[point_i];
+        const int3 cell = this->cell_of(position);
+        /* Different cells can map to the same hash table entry. Visit each entry only once to
+         * avoid duplicate pairs. */
+        Vector<int, 27> entries;
+        for (int z = -1; z <= 1; z++) {
+          for (int y = -1; y <= 1; y++) {
+            for (int x = -1; x <= 1; x++) {
+              entries.append_non_duplicates(this->entry_of(cell + int3(x, y, z)));
+            }
+          }
+        }
+        std::sort(entries.begin(), entries.end());
+        for (const int entry : entries) {
+          for (const int other_i : sorted_points_.as_span().slice(offsets[entry])) {
+            if (other_i <= point_i) {
+              continue;
+            }
+            const float max_distance = radii[point_i] + radii[other_i] + margin;
+            if (math::distance_squared(position, positions[other_i]) <
+                math::square(max_distance))
+            {
+              pairs.append({point_i, other_i});
+            }
+          }
+        }
+      }
+    }
+  });
+
+  int pairs_num = 0;
+  for (const Vector<int2> &pairs : pairs_by_chunk) {
+    pairs_num += pairs.size();
+  }
+  r_pairs.clear();
+  r_pairs.reserve(pairs_num);
+  for (const Vector<int2> &pairs : pairs_by_chunk) {
+    r_pairs.extend(pairs);
+  }
+}
+
+}  // namespace blender::xpbd
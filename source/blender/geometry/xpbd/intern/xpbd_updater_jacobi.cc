@@ -0,0 +1,70 @@
+/* SPDX-FileCopyrightText: 2026 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+
+#include "BLI_task.hh"
+
+#include "GEO_xpbd_updater_gauss_seidel.hh"
+#include "GEO_xpbd_updater_jacobi.hh"
+
+namespace blender::xpbd {
+
+void JacobiBuffers::ensure(const Span<GeometryRef> geometry_refs)
+{
+  if (geometries_.size() == geometry_refs.size()) {
+    return;
+  }
+  geometries_.reinitialize(geometry_refs.size());
+  for (const int geo_i : geometry_refs.index_range()) {
+    const GeometryRef &ref = geometry_refs[geo_i];
+    JacobiGeometryBuffer &buffer = geometries_[geo_i];
+    const int points_num = ref.positions.size();
+    buffer.position_offsets.reinitialize(points_num);
+    buffer.position_offsets.fill(float3(0.0f));
+    buffer.position_counts.reinitialize(points_num);
+    buffer.position_counts.fill(0);
+    if (!ref.rotations.is_empty()) {
+      buffer.rotation_offsets.reinitialize(points_num);
+      buffer.rotation_offsets.fill(float4(0.0f));
+      buffer.rotation_counts.reinitialize(points_num);
+      buffer.rotation_counts.fill(0);
+    }
+  }
+}
+
+void JacobiBuffers::apply_and_reset(const Span<GeometryRef> geometry_refs,
+                                    const Span<int> geo_indices)
+{
+  for (const int geo_i : geo_indices) {
+    const GeometryRef &ref = geometry_refs[geo_i];
+    JacobiGeometryBuffer &buffer = geometries_[geo_i];
+    threading::parallel_for(ref.positions.index_range(), 4096, [&](const IndexRange range) {
+      for (const int point_i : range) {
+        int &count = buffer.position_counts[point_i];
+        if (count == 0) {
+          continue;
+        }
+        float3 &offset = buffer.position_offsets[point_i];
+        ref.positions[point_i] += offset / float(count);
+        offset = float3(0.0f);
+        count = 0;
+      }
+      if (buffer.rotation_counts.is_empty()) {
+        return;
+      }
+      for (const int point_i : range) {
+        int &count = buffer.rotation_counts[point_i];
+        if (count == 0) {
+          continue;
+        }
+        float4 &offset = buffer.rotation_offsets[point_i];
+        math::Quaternion &rotation = ref.rotations[point_i];
+        rotation = apply_rotation_offset(rotation, offset / float(count));
+        offset = float4(0.0f);
+        count = 0;
+      }
+    });
+  }
+}
+
+}  // namespace blender::xpbd
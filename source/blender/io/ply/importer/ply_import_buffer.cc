@@ -65,6 +65,20 @@ Span<char> PlyReadBuffer::read_line()
 
 bool PlyReadBuffer::read_bytes(void *dst, size_t size)
 {
+  /* Large binary reads go directly from the file to the destination, after the already buffered
+   * data. */
+  if (is_binary_ && size > read_buffer_size_ && file_ != nullptr) {
+    const size_t buffered = size_t(buf_used_ - pos_);
+    memcpy(dst, buffer_.data() + pos_, buffered);
+    pos_ = buf_used_;
+    const size_t remaining = size - buffered;
+    if (at_eof_ || fread(static_cast<char *>(dst) + buffered, 1, remaining, file_) != remaining) {
+      at_eof_ = true;
+      return false;
+    }
+    return true;
+  }
+
   while (size > 0) {
     if (pos_ + size > buf_used_) {
       if (!refill_buffer()) {
@@ -10,12 +10,15 @@
 #include "ply_data.hh"
 #include "ply_import_buffer.hh"
 
+#include "BLI_array.hh"
 #include "BLI_endian_switch.hh"
 #include "BLI_string_ref.hh"
+#include "BLI_task.hh"
 
 #include "fast_float.h"
 
 #include <charconv>
+#include <cstring>
 
 #include "CLG_log.h"
 
@@ -196,6 +199,162 @@ template<typename T> static T get_binary_value(PlyDataTypes type, const uint8_t
   return val;
 }
 
+/**
+ * Convert binary values of the given type to the destination type, switching their endianness if
+ * needed. Floating point destinations are divided by the normalizer.
+ */
+template<typename SrcT, typename DstT, bool BigEndian>
+static void decode_binary_values(const uint8_t *src,
+                                 const int64_t src_stride,
+                                 const int64_t num,
+                                 DstT *dst,
+                                 const int64_t dst_stride,
+                                 const float normalizer)
+{
+  for (int64_t i = 0; i < num; i++) {
+    SrcT value;
+    memcpy(&value, src + i * src_stride, sizeof(SrcT));
+    if constexpr (BigEndian) {
+      endian_switch(reinterpret_cast<uint8_t *>(&value), sizeof(SrcT));
+    }
+    if constexpr (std::is_same_v<DstT, float>) {
+      dst[i * dst_stride] = float(value) / normalizer;
+    }
+    else {
+      UNUSED_VARS(normalizer);
+      dst[i * dst_stride] = DstT(value);
+    }
+  }
+}
+
+template<typename DstT, bool BigEndian>
+static void decode_binary_values(const PlyDataTypes type,
+                                 const uint8_t *src,
+                                 const int64_t src_stride,
+                                 const int64_t num,
+                                 DstT *dst,
+                                 const int64_t dst_stride,
+                                 const float normalizer)
+{
+  switch (type) {
+    case NONE:
+      break;
+    case CHAR:
+      decode_binary_values<int8_t, DstT, BigEndian>(
+          src, src_stride, num, dst, dst_stride, normalizer);
+      break;
+    case UCHAR:
+      decode_binary_values<uint8_t, DstT, BigEndian>(
+          src, src_stride, num, dst, dst_stride, normalizer);
+      break;
+    case SHORT:
+      decode_binary_values<int16_t, DstT, BigEndian>(
+          src, src_stride, num, dst, dst_stride, normalizer);
+      break;
+    case USHORT:
+      decode_binary_values<uint16_t, DstT, BigEndian>(
+          src, src_stride, num, dst, dst_stride, normalizer);
+      break;
+    case INT:
+    case UINT:
+      /* Unsigned values are read as signed, like in #get_binary_value. */
+      decode_binary_values<int32_t, DstT, BigEndian>(
+          src, src_stride, num, dst, dst_stride, normalizer);
+      break;
+    case FLOAT:
+      decode_binary_values<float, DstT, BigEndian>(
+          src, src_stride, num, dst, dst_stride, normalizer);
+      break;
+    case DOUBLE:
+      decode_binary_values<double, DstT, BigEndian>(
+          src, src_stride, num, dst, dst_stride, normalizer);
+      break;
+    default:
+      BLI_assert_msg(false, "Unknown property type");
+  }
+}
+
+/**
+ * Convert a column of binary values, i.e. the values of one property in consecutive rows.
+ * The type switch is done once for the whole column instead of once per value.
+ */
+template<typename DstT>
+static void decode_binary_values(const PlyDataTypes type,
+                                 const bool big_endian,
+                                 const uint8_t *src,
+                                 const int64_t src_stride,
+                                 const int64_t num,
+                                 DstT *dst,
+                                 const int64_t dst_stride = 1,
+                                 const float normalizer = 1.0f)
+{
+  if (big_endian) {
+    decode_binary_values<DstT, true>(type, src, src_stride, num, dst, dst_stride, normalizer);
+  }
+  else {
+    decode_binary_values<DstT, false>(type, src, src_stride, num, dst, dst_stride, normalizer);
+  }
+}
+
+/** Destination of the values of one property of a fixed-size binary element. */
+struct BinaryColumn {
+  int property_index;
+  float *dst;
+  int64_t dst_stride;
+  float normalizer = 1.0f;
+};
+
+/** Approximate size of the blocks of fixed-size binary rows that are read and decoded at once. */
+static constexpr int64_t BINARY_ROWS_BLOCK_SIZE = 4 * 1024 * 1024;
+
+/**
+ * Read all rows of an element without list properties, and decode the values of the given
+ * properties into their destination arrays. Rows are read in large blocks, which are decoded in
+ * parallel one column at a time.
+ */
+static const char *load_binary_columns(PlyReadBuffer &file,
+                                       const PlyHeader &header,
+                                       const PlyElement &element,
+                                       const Span<BinaryColumn> columns)
+{
+  if (element.stride == 0) {
+    return "Vertex/Edge element contains list properties, this is not supported";
+  }
+  const bool big_endian = header.type == PlyFormatType::BINARY_BE;
+  const int64_t stride = element.stride;
+
+  Array<int64_t> property_offsets(element.properties.size());
+  int64_t offset = 0;
+  for (const int64_t i : element.properties.index_range()) {
+    property_offsets[i] = offset;
+    offset += data_type_size[element.properties[i].type];
+  }
+
+  const int64_t block_rows = std::max<int64_t>(BINARY_ROWS_BLOCK_SIZE / stride, 1);
+  Array<uint8_t> block(std::min<int64_t>(block_rows, element.count) * stride);
+  for (int64_t block_start = 0; block_start < element.count; block_start += block_rows) {
+    const int64_t rows_num = std::min<int64_t>(block_rows, element.count - block_start);
+    if (!file.read_bytes(block.data(), rows_num * stride)) {
+      return "Could not read row of binary property";
+    }
+    threading::parallel_for(IndexRange(rows_num), 4096, [&](const IndexRange range) {
+      const uint8_t *rows = block.data() + range.start() * stride;
+      for (const BinaryColumn &column : columns) {
+        const PlyProperty &prop = element.properties[column.property_index];
+        decode_binary_values(prop.type,
+                             big_endian,
+                             rows + property_offsets[column.property_index],
+                             stride,
+                             range.size(),
+                             column.dst + (block_start + range.start()) * column.dst_stride,
+                             column.dst_stride,
+                             column.normalizer);
+      }
+    });
+  }
+  return nullptr;
+}
+
 static const char *parse_row_binary(PlyReadBuffer &file,
                                     const PlyHeader &header,
                                     const PlyElement &element,
@@ -235,6 +394,85 @@ static const char *parse_row_binary(PlyReadBuffer &file,
   return nullptr;
 }
 
+static float4 vertex_color_normalizer(const PlyElement &element,
+                                      const int3 &color_index,
+                                      const int alpha_index)
+{
+  float4 color_norm = {1, 1, 1, 1};
+  if (color_index.x >= 0 && color_index.y >= 0 && color_index.z >= 0) {
+    color_norm.x = data_type_normalizer[element.properties[color_index.x].type];
+    color_norm.y = data_type_normalizer[element.properties[color_index.y].type];
+    color_norm.z = data_type_normalizer[element.properties[color_index.z].type];
+    if (alpha_index >= 0) {
+      color_norm.w = data_type_normalizer[element.properties[alpha_index].type];
+    }
+  }
+  return color_norm;
+}
+
+/**
+ * Binary version of #load_vertex_element, the properties are decoded column by column directly
+ * into the #PlyData arrays.
+ */
+static const char *load_vertex_element_binary(PlyReadBuffer &file,
+                                              const PlyHeader &header,
+                                              const PlyElement &element,
+                                              const int3 &vertex_index,
+                                              const int3 &color_index,
+                                              const int3 &normal_index,
+                                              const int2 &uv_index,
+                                              const int alpha_index,
+                                              const Span<int64_t> custom_attr_indices,
+                                              PlyData *data)
+{
+  const bool has_color = color_index.x >= 0 && color_index.y >= 0 && color_index.z >= 0;
+  const bool has_normal = normal_index.x >= 0 && normal_index.y >= 0 && normal_index.z >= 0;
+  const bool has_uv = uv_index.x >= 0 && uv_index.y >= 0;
+  const bool has_alpha = alpha_index >= 0;
+
+  Vector<BinaryColumn> columns;
+
+  data->vertices.resize(element.count);
+  float *vertices = reinterpret_cast<float *>(data->vertices.data());
+  for (const int axis : IndexRange(3)) {
+    columns.append({vertex_index[axis], vertices + axis, 3});
+  }
+
+  if (has_color) {
+    const float4 color_norm = vertex_color_normalizer(element, color_index, alpha_index);
+    data->vertex_colors.resize(element.count, float4(0.0f, 0.0f, 0.0f, 1.0f));
+    float *colors = reinterpret_cast<float *>(data->vertex_colors.data());
+    for (const int axis : IndexRange(3)) {
+      columns.append({color_index[axis], colors + axis, 4, color_norm[axis]});
+    }
+    if (has_alpha) {
+      columns.append({alpha_index, colors + 3, 4, color_norm.w});
+    }
+  }
+
+  if (has_normal) {
+    data->vertex_normals.resize(element.count);
+    float *normals = reinterpret_cast<float *>(data->vertex_normals.data());
+    for (const int axis : IndexRange(3)) {
+      columns.append({normal_index[axis], normals + axis, 3});
+    }
+  }
+
+  if (has_uv) {
+    data->uv_coordinates.resize(element.count);
+    float *uvs = reinterpret_cast<float *>(data->uv_coordinates.data());
+    for (const int axis : IndexRange(2)) {
+      columns.append({uv_index[axis], uvs + axis, 2});
+    }
+  }
+
+  for (const int64_t ci : custom_attr_indices.index_range()) {
+    columns.append({int(custom_attr_indices[ci]), data->vertex_custom_attr[ci].data.data(), 1});
+  }
+
+  return load_binary_columns(file, header, element, columns);
+}
+
 static const char *load_vertex_element(PlyReadBuffer &file,
                                        const PlyHeader &header,
                                        const PlyElement &element,
@@ -273,6 +511,19 @@ static const char *load_vertex_element(PlyReadBuffer &file,
     data->vertex_custom_attr.append(attr);
   }
 
+  if (header.type != PlyFormatType::ASCII) {
+    return load_vertex_element_binary(file,
+                                      header,
+                                      element,
+                                      vertex_index,
+                                      color_index,
+                                      normal_index,
+                                      uv_index,
+                                      alpha_index,
+                                      custom_attr_indices,
+                                      data);
+  }
+
   data->vertices.reserve(element.count);
   if (has_color) {
     data->vertex_colors.reserve(element.count);
@@ -284,31 +535,12 @@ static const char *load_vertex_element(PlyReadBuffer &file,
     data->uv_coordinates.reserve(element.count);
   }
 
-  float4 color_norm = {1, 1, 1, 1};
-  if (has_color) {
-    color_norm.x = data_type_normalizer[element.properties[color_index.x].type];
-    color_norm.y = data_type_normalizer[element.properties[color_index.y].type];
-    color_norm.z = data_type_normalizer[element.properties[color_index.z].type];
-  }
-  if (has_alpha) {
-    color_norm.w = data_type_normalizer[element.properties[alpha_index].type];
-  }
+  const float4 color_norm = vertex_color_normalizer(element, color_index, alpha_index);
 
   Vector<float> value_vec(element.properties.size());
-  Vector<uint8_t> scratch;
-  if (header.type != PlyFormatType::ASCII) {
-    scratch.resize(element.stride);
-  }
 
   for (int i = 0; i < element.count; i++) {
-
-    const char *error = nullptr;
-    if (header.type == PlyFormatType::ASCII) {
-      error = parse_row_ascii(file, value_vec);
-    }
-    else {
-      error = parse_row_binary(file, header, element, scratch, value_vec);
-    }
+    const char *error = parse_row_ascii(file, value_vec);
     if (error != nullptr) {
       return error;
     }
@@ -463,8 +695,6 @@ static const char *load_face_element(PlyReadBuffer &file,
     Vector<uint8_t> scratch(64);
 
     for (int i = 0; i < element.count; i++) {
-      const uint8_t *ptr;
-
       /* Skip any properties before vertex indices. */
       for (int j = 0; j < prop_index; j++) {
         skip_property(
@@ -486,14 +716,14 @@ static const char *load_face_element(PlyReadBuffer &file,
         CLOG_WARN(&LOG, "PLY Importer: ignoring face %i (%u vertices)", i, count);
       }
       else {
-        ptr = scratch.data();
-        if (header.type == PlyFormatType::BINARY_BE) {
-          endian_switch_array(const_cast<uint8_t *>(ptr), data_type_size[prop.type], count);
-        }
-        for (int j = 0; j < count; ++j) {
-          uint32_t index = get_binary_value<uint32_t>(prop.type, ptr);
-          data->face_vertices.append(index);
-        }
+        const int64_t face_start = data->face_vertices.size();
+        data->face_vertices.resize(face_start + count);
+        decode_binary_values(prop.type,
+                             header.type == PlyFormatType::BINARY_BE,
+                             scratch.data(),
+                             data_type_size[prop.type],
+                             count,
+                             data->face_vertices.data() + face_start);
         data->face_sizes.append(count);
       }
 
@@ -64,6 +64,13 @@ TEST(ply_import, BufferRefillTest)
                                      {5, 1}};
   EXPECT_EQ_SPAN<std::pair<int, int>>(Span(exp_edges, 12), data_a->edges);
   EXPECT_EQ_SPAN<std::pair<int, int>>(Span(exp_edges, 12), data_b->edges);
+
+  /* Check whether the binary vertex positions (decoded in blocks bigger than the read buffer)
+   * match the ASCII ones. */
+  ASSERT_EQ(data_a->vertices.size(), data_b->vertices.size());
+  for (const int64_t i : data_a->vertices.index_range()) {
+    EXPECT_V3_NEAR(data_a->vertices[i], data_b->vertices[i], 1e-6f);
+  }
 }
 
 //@TODO: now we put vertex color attribute first, maybe put position first?
@@ -31,6 +31,11 @@ struct STLImportParams {
   bool use_scene_unit = false;
   float global_scale = 1.0f;
   bool use_mesh_validate = true;
+  /**
+   * Merge vertices at the same position, and remove degenerate and duplicate triangles.
+   * Otherwise every triangle gets its own vertices.
+   */
+  bool merge_verts = true;
 
   ReportList *reports = nullptr;
 };
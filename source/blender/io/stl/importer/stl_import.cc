@@ -84,9 +84,12 @@ Mesh *read_stl_file(const STLImportParams &import_params)
   }
   bool is_ascii_stl = (file_size != (BINARY_HEADER_SIZE + 4 + BINARY_STRIDE * num_tri));
 
-  Mesh *mesh = is_ascii_stl ?
-                   read_stl_ascii(import_params.filepath, import_params.use_facet_normal) :
-                   read_stl_binary(file, import_params.use_facet_normal);
+  Mesh *mesh = is_ascii_stl ? read_stl_ascii(import_params.filepath,
+                                             import_params.use_facet_normal,
+                                             import_params.merge_verts) :
+                              read_stl_binary(import_params.filepath,
+                                              import_params.use_facet_normal,
+                                              import_params.merge_verts);
 
   if (mesh == nullptr) {
     CLOG_ERROR(&LOG, "STL Importer: Failed to import mesh '%s'", import_params.filepath);
@@ -11,9 +11,12 @@
 #include "BLI_fileops.hh"
 #include "BLI_math_vector_types.hh"
 #include "BLI_memory_utils.hh"
+#include "BLI_vector.hh"
 
 #include "DNA_mesh_types.h"
 
+#include "IO_validate.hh"
+
 /* NOTE: we could use C++17 <charconv> from_chars to parse
  * floats, but even if some compilers claim full support,
  * their standard libraries are not quite there yet.
@@ -116,7 +119,7 @@ static inline void parse_float3(StringBuffer &buf, float3 &out)
   }
 }
 
-Mesh *read_stl_ascii(const char *filepath, const bool use_custom_normals)
+Mesh *read_stl_ascii(const char *filepath, const bool use_custom_normals, const bool merge_verts)
 {
   size_t buffer_len;
   char *buffer = BLI_file_read_text_as_mem(filepath, 0, &buffer_len);
@@ -129,7 +132,8 @@ Mesh *read_stl_ascii(const char *filepath, const bool use_custom_normals)
   constexpr int num_reserved_tris = 1024;
 
   StringBuffer str_buf(buffer, buffer_len);
-  STLMeshHelper stl_mesh(num_reserved_tris, use_custom_normals);
+  Vector<PackedTriangle> tris;
+  tris.reserve(num_reserved_tris);
 
   PackedTriangle data{};
   str_buf.drop_line(); /* Skip header line */
@@ -143,7 +147,7 @@ Mesh *read_stl_ascii(const char *filepath, const bool use_custom_normals)
         parse_float3(str_buf, data.vertices[2]);
       }
 
-      stl_mesh.add_triangle(data);
+      tris.append(data);
     }
     else if (str_buf.parse_token("facet", 5)) {
       str_buf.drop_token(); /* Expecting "normal" */
@@ -154,7 +158,12 @@ Mesh *read_stl_ascii(const char *filepath, const bool use_custom_normals)
     }
   }
 
-  return stl_mesh.to_mesh();
+  if (!validate::size_fits_in_int(tris.size() * 3)) {
+    CLOG_WARN(&LOG, "STL mesh too large to import, exceeds max int size");
+    return nullptr;
+  }
+
+  return stl_triangles_to_mesh(tris, use_custom_normals, merge_verts);
 }
 
 }  // namespace io::stl
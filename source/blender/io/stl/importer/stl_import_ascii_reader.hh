@@ -30,7 +30,7 @@ struct Mesh;
 
 namespace io::stl {
 
-Mesh *read_stl_ascii(const char *filepath, bool use_custom_normals);
+Mesh *read_stl_ascii(const char *filepath, bool use_custom_normals, bool merge_verts);
 
 }  // namespace io::stl
 }  // namespace blender
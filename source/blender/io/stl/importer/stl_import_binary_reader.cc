@@ -6,12 +6,23 @@
  * \ingroup stl
  */
 
+#include <algorithm>
 #include <cstdint>
-#include <cstdio>
-
+#include <cstring>
+#include <fcntl.h>
+#ifndef WIN32
+#  include <unistd.h>
+#else
+#  include <io.h>
+#endif
+
+#include "BKE_lib_id.hh"
 #include "BKE_mesh.hh"
 
-#include "BLI_array.hh"
+#include "BLI_fileops.hh"
+#include "BLI_memory_utils.hh"
+#include "BLI_mmap.hh"
+#include "BLI_span.hh"
 
 #include "DNA_mesh_types.h"
 
@@ -28,15 +39,30 @@ namespace blender::io::stl {
 
 static CLG_LogRef LOG = {"io.stl"};
 
-Mesh *read_stl_binary(FILE *file, const bool use_custom_normals)
+Mesh *read_stl_binary(const char *filepath, const bool use_custom_normals, const bool merge_verts)
 {
-  const int chunk_size = 1024;
+  const int file = BLI_open(filepath, O_BINARY | O_RDONLY, 0);
+  if (file == -1) {
+    CLOG_ERROR(&LOG, "STL Importer: cannot open binary STL file: '%s'", filepath);
+    return nullptr;
+  }
+  /* The triangles are used directly from the mapped file, without copying them. */
+  BLI_mmap_file *mmap_file = BLI_mmap_open(file);
+  close(file);
+  if (mmap_file == nullptr) {
+    CLOG_ERROR(&LOG, "STL Importer: cannot mmap binary STL file: '%s'", filepath);
+    return nullptr;
+  }
+  BLI_SCOPED_DEFER([&]() { BLI_mmap_free(mmap_file); });
+
+  const char *file_data = static_cast<const char *>(BLI_mmap_get_pointer(mmap_file));
+  const size_t file_size = BLI_mmap_get_length(mmap_file);
   uint32_t num_tris = 0;
-  fseek(file, BINARY_HEADER_SIZE, SEEK_SET);
-  if (fread(&num_tris, sizeof(uint32_t), 1, file) != 1) {
-    stl_import_report_error(file);
+  if (file_size < BINARY_HEADER_SIZE + sizeof(uint32_t)) {
+    CLOG_ERROR(&LOG, "STL Importer: binary STL file is too small: '%s'", filepath);
     return nullptr;
   }
+  memcpy(&num_tris, file_data + BINARY_HEADER_SIZE, sizeof(uint32_t));
 
   if (num_tris == 0) {
     return BKE_mesh_new_nomain(0, 0, 0, 0);
@@ -47,16 +73,21 @@ Mesh *read_stl_binary(FILE *file, const bool use_custom_normals)
     return nullptr;
   }
 
-  Array<PackedTriangle> tris_buf(chunk_size);
-  STLMeshHelper stl_mesh(num_tris, use_custom_normals);
-  size_t num_read_tris;
-  while ((num_read_tris = fread(tris_buf.data(), sizeof(PackedTriangle), chunk_size, file))) {
-    for (size_t i = 0; i < num_read_tris; i++) {
-      stl_mesh.add_triangle(tris_buf[i]);
-    }
+  /* The file size matched the triangle count when detecting the format, but the file could have
+   * changed since then. */
+  const size_t tris_offset = BINARY_HEADER_SIZE + sizeof(uint32_t);
+  const int64_t file_tris_num = int64_t((file_size - tris_offset) / BINARY_STRIDE);
+  const Span<PackedTriangle> tris(
+      reinterpret_cast<const PackedTriangle *>(file_data + tris_offset),
+      std::min<int64_t>(num_tris, file_tris_num));
+
+  Mesh *mesh = stl_triangles_to_mesh(tris, use_custom_normals, merge_verts);
+  if (BLI_mmap_any_io_error(mmap_file)) {
+    CLOG_ERROR(&LOG, "STL Importer: failed to read binary STL file: '%s'", filepath);
+    BKE_id_free(nullptr, mesh);
+    return nullptr;
   }
-
-  return stl_mesh.to_mesh();
+  return mesh;
 }
 
 }  // namespace blender::io::stl
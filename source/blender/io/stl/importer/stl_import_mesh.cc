@@ -6,10 +6,20 @@
  * \ingroup stl
  */
 
+#include <array>
+#include <cinttypes>
+
 #include "BKE_mesh.hh"
 
+#include "BLI_array.hh"
 #include "BLI_array_utils.hh"
+#include "BLI_index_mask.hh"
+#include "BLI_map.hh"
+#include "BLI_math_base_c.hh"
+#include "BLI_offset_indices.hh"
 #include "BLI_span.hh"
+#include "BLI_task.hh"
+#include "BLI_vector.hh"
 
 #include "DNA_mesh_types.h"
 
@@ -24,64 +34,195 @@ static CLG_LogRef LOG = {"io.stl"};
 
 namespace io::stl {
 
-STLMeshHelper::STLMeshHelper(int tris_num, bool use_custom_normals)
-    : use_custom_normals_(use_custom_normals)
+/** Number of hash map shards used to find equal vertices and triangles in parallel. */
+static constexpr int SHARDS_NUM = 64;
+/** Number of items distributed to the shards by a single task. */
+static constexpr int64_t SHARD_CHUNK_SIZE = 1 << 20;
+
+static int shard_of_hash(const uint64_t hash)
 {
-  degenerate_tris_num_ = 0;
-  duplicate_tris_num_ = 0;
-  tris_.reserve(tris_num);
-  /* Upper bound (all vertices are unique). */
-  verts_.reserve(int64_t(tris_num) * 3);
-  if (use_custom_normals) {
-    loop_normals_.reserve(int64_t(tris_num) * 3);
-  }
+  /* Use the high bits of a mixed hash, the low bits are used by the hash maps of the shards. */
+  return int((hash * 0x9E3779B97F4A7C15ULL) >> 58);
 }
+BLI_STATIC_ASSERT(SHARDS_NUM == 64, "Shard index uses the top 6 bits of the hash");
 
-bool STLMeshHelper::add_triangle(const PackedTriangle &data)
+/**
+ * For every item in the mask, find the index of the first item in the mask that is equal to it.
+ * The items are distributed to shards based on their hash, keeping them ordered within a shard,
+ * and the shards are de-duplicated in parallel. The result is the same as adding all items to a
+ * single #VectorSet in order.
+ */
+template<typename T, typename GetItemFn>
+static void find_first_equal_items(const IndexMask &mask,
+                                   const GetItemFn &get_item,
+                                   MutableSpan<int> r_first_equal)
 {
-  int v1_id = verts_.index_of_or_add(data.vertices[0]);
-  int v2_id = verts_.index_of_or_add(data.vertices[1]);
-  int v3_id = verts_.index_of_or_add(data.vertices[2]);
-  if ((v1_id == v2_id) || (v1_id == v3_id) || (v2_id == v3_id)) {
-    degenerate_tris_num_++;
-    return false;
-  }
-  if (!tris_.add({v1_id, v2_id, v3_id})) {
-    duplicate_tris_num_++;
-    return false;
-  }
+  const int64_t chunks_num = divide_ceil_ul(uint64_t(mask.size()), SHARD_CHUNK_SIZE);
+  Array<std::array<Vector<int>, SHARDS_NUM>> items_by_chunk_shard(chunks_num);
+  threading::parallel_for(IndexRange(chunks_num), 1, [&](const IndexRange chunks) {
+    for (const int64_t chunk : chunks) {
+      std::array<Vector<int>, SHARDS_NUM> &items_by_shard = items_by_chunk_shard[chunk];
+      const IndexRange chunk_range = IndexRange(chunk * SHARD_CHUNK_SIZE, SHARD_CHUNK_SIZE)
+                                         .intersect(IndexRange(mask.size()));
+      mask.slice(chunk_range).foreach_index([&](const int i) {
+        items_by_shard[shard_of_hash(DefaultHash<T>{}(get_item(i)))].append(i);
+      });
+    }
+  });
+
+  threading::parallel_for(IndexRange(SHARDS_NUM), 1, [&](const IndexRange shards) {
+    for (const int shard : shards) {
+      int64_t shard_size = 0;
+      for (const std::array<Vector<int>, SHARDS_NUM> &items_by_shard : items_by_chunk_shard) {
+        shard_size += items_by_shard[shard].size();
+      }
+      Map<T, int> first_by_item;
+      first_by_item.reserve(shard_size);
+      for (std::array<Vector<int>, SHARDS_NUM> &items_by_shard : items_by_chunk_shard) {
+        for (const int i : items_by_shard[shard]) {
+          r_first_equal[i] = first_by_item.lookup_or_add(get_item(i), i);
+        }
+        items_by_shard[shard].clear_and_shrink();
+      }
+    }
+  });
+}
 
-  if (use_custom_normals_) {
-    loop_normals_.append_n_times(data.normal, 3);
-  }
-  return true;
+static float3 corner_position(const Span<PackedTriangle> tris, const int corner)
+{
+  return tris[corner / 3].vertices[corner % 3];
 }
 
-Mesh *STLMeshHelper::to_mesh()
+static Mesh *triangles_to_merged_mesh(const Span<PackedTriangle> tris,
+                                      const bool use_custom_normals)
 {
-  if (degenerate_tris_num_ > 0) {
-    CLOG_WARN(&LOG, "Removed %d degenerate triangles during import", degenerate_tris_num_);
+  const int corners_num = int(tris.size() * 3);
+
+  /* Map every corner to the first corner at the same position. */
+  Array<int> corner_verts(corners_num);
+  find_first_equal_items<float3>(
+      IndexMask(corners_num),
+      [&](const int corner) { return corner_position(tris, corner); },
+      corner_verts);
+
+  /* Vertices are ordered by their first corner. Turn the first corner indices into vertex indices
+   * in place: first corners get their vertex index, then the other corners copy it. */
+  IndexMaskMemory memory;
+  const IndexMask first_corners = IndexMask::from_predicate(
+      IndexRange(corners_num), memory, [&](const int corner) {
+        return corner_verts[corner] == corner;
+      });
+  first_corners.foreach_index(
+      [&](const int corner, const int vert) { corner_verts[corner] = vert; },
+      exec_mode::grain_size(4096));
+  const IndexMask other_corners = first_corners.complement(IndexRange(corners_num), memory);
+  other_corners.foreach_index(
+      [&](const int corner) { corner_verts[corner] = corner_verts[corner_verts[corner]]; },
+      exec_mode::grain_size(4096));
+
+  const auto tri_verts = [&](const int tri) {
+    return Triangle{corner_verts[tri * 3], corner_verts[tri * 3 + 1], corner_verts[tri * 3 + 2]};
+  };
+
+  /* Remove degenerate triangles, and triangles using the same vertices as a previous one. */
+  const IndexMask valid_tris = IndexMask::from_predicate(
+      tris.index_range(), memory, [&](const int tri) {
+        const Triangle t = tri_verts(tri);
+        return t.v1 != t.v2 && t.v1 != t.v3 && t.v2 != t.v3;
+      });
+  Array<int> first_equal_tri(tris.size());
+  find_first_equal_items<Triangle>(valid_tris, tri_verts, first_equal_tri);
+  const IndexMask unique_tris = IndexMask::from_predicate(
+      valid_tris, memory, [&](const int tri) {
+        return first_equal_tri[tri] == tri;
+      });
+
+  const int64_t degenerate_tris_num = tris.size() - valid_tris.size();
+  const int64_t duplicate_tris_num = valid_tris.size() - unique_tris.size();
+  if (degenerate_tris_num > 0) {
+    CLOG_WARN(&LOG, "Removed %" PRId64 " degenerate triangles during import", degenerate_tris_num);
   }
-  if (duplicate_tris_num_ > 0) {
-    CLOG_WARN(&LOG, "Removed %d duplicate triangles during import", duplicate_tris_num_);
+  if (duplicate_tris_num > 0) {
+    CLOG_WARN(&LOG, "Removed %" PRId64 " duplicate triangles during import", duplicate_tris_num);
   }
 
-  Mesh *mesh = BKE_mesh_new_nomain(verts_.size(), 0, tris_.size(), tris_.size() * 3);
-  mesh->vert_positions_for_write().copy_from(verts_);
-  offset_indices::fill_constant_group_size(3, 0, mesh->face_offsets_for_write());
-  array_utils::copy(tris_.as_span().cast<int>(), mesh->corner_verts_for_write());
+  Mesh *mesh = BKE_mesh_new_nomain(
+      first_corners.size(), 0, unique_tris.size(), unique_tris.size() * 3);
+  MutableSpan<float3> positions = mesh->vert_positions_for_write();
+  first_corners.foreach_index(
+      [&](const int corner, const int vert) { positions[vert] = corner_position(tris, corner); },
+      exec_mode::grain_size(4096));
+
+  MutableSpan<int> mesh_corner_verts = mesh->corner_verts_for_write();
+  unique_tris.foreach_index(
+      [&](const int tri, const int face) {
+        for (const int i : IndexRange(3)) {
+          mesh_corner_verts[face * 3 + i] = corner_verts[tri * 3 + i];
+        }
+      },
+      exec_mode::grain_size(4096));
 
+  offset_indices::fill_constant_group_size(3, 0, mesh->face_offsets_for_write());
   bke::mesh_smooth_set(*mesh, false);
 
   /* NOTE: edges must be calculated first before setting custom normals. */
   bke::mesh_calc_edges(*mesh, false, false);
 
-  if (use_custom_normals_ && loop_normals_.size() == mesh->corners_num) {
-    bke::mesh_set_custom_normals(*mesh, loop_normals_);
+  if (use_custom_normals) {
+    Array<float3> corner_normals(mesh->corners_num);
+    unique_tris.foreach_index(
+        [&](const int tri, const int face) {
+          corner_normals.as_mutable_span().slice(face * 3, 3).fill(tris[tri].normal);
+        },
+        exec_mode::grain_size(4096));
+    bke::mesh_set_custom_normals(*mesh, corner_normals);
+  }
+
+  return mesh;
+}
+
+static Mesh *triangles_to_soup_mesh(const Span<PackedTriangle> tris, const bool use_custom_normals)
+{
+  const int corners_num = int(tris.size() * 3);
+  Mesh *mesh = BKE_mesh_new_nomain(corners_num, 0, tris.size(), corners_num);
+  MutableSpan<float3> positions = mesh->vert_positions_for_write();
+  threading::parallel_for(tris.index_range(), 4096, [&](const IndexRange range) {
+    for (const int tri : range) {
+      for (const int i : IndexRange(3)) {
+        positions[tri * 3 + i] = tris[tri].vertices[i];
+      }
+    }
+  });
+  offset_indices::fill_constant_group_size(3, 0, mesh->face_offsets_for_write());
+  array_utils::fill_index_range(mesh->corner_verts_for_write());
+
+  bke::mesh_smooth_set(*mesh, false);
+  bke::mesh_calc_edges(*mesh, false, false);
+
+  if (use_custom_normals) {
+    Array<float3> corner_normals(corners_num);
+    threading::parallel_for(tris.index_range(), 4096, [&](const IndexRange range) {
+      for (const int tri : range) {
+        corner_normals.as_mutable_span().slice(tri * 3, 3).fill(tris[tri].normal);
+      }
+    });
+    bke::mesh_set_custom_normals(*mesh, corner_normals);
   }
 
   return mesh;
 }
 
+Mesh *stl_triangles_to_mesh(const Span<PackedTriangle> tris,
+                            const bool use_custom_normals,
+                            const bool merge_verts)
+{
+  if (tris.is_empty()) {
+    return BKE_mesh_new_nomain(0, 0, 0, 0);
+  }
+  Mesh *mesh = merge_verts ? triangles_to_merged_mesh(tris, use_custom_normals) :
+                             triangles_to_soup_mesh(tris, use_custom_normals);
+  return mesh;
+}
+
 }  // namespace io::stl
 }  // namespace blender
@@ -11,8 +11,7 @@
 #include <cstdint>
 
 #include "BLI_math_vector_types.hh"
-#include "BLI_vector.hh"
-#include "BLI_vector_set.hh"
+#include "BLI_span.hh"
 #include "stl_data.hh"
 
 namespace blender {
@@ -49,25 +48,14 @@ class Triangle {
   }
 };
 
-class STLMeshHelper {
- private:
-  VectorSet<float3> verts_;
-  VectorSet<Triangle> tris_;
-  Vector<float3> loop_normals_;
-  int degenerate_tris_num_;
-  int duplicate_tris_num_;
-  const bool use_custom_normals_;
-
- public:
-  STLMeshHelper(int tris_num, bool use_custom_normals);
-
-  /* Creates a new triangle from specified vertex locations,
-   * duplicate vertices and triangles are merged.
-   */
-  bool add_triangle(const PackedTriangle &data);
-
-  Mesh *to_mesh();
-};
+/**
+ * Create a mesh from the triangles of an STL file.
+ *
+ * When merging vertices, vertices at the same position are merged (in parallel, keeping the order
+ * in which they first appear), and degenerate and duplicate triangles are removed. Otherwise the
+ * mesh is a triangle soup where every triangle has its own vertices.
+ */
+Mesh *stl_triangles_to_mesh(Span<PackedTriangle> tris, bool use_custom_normals, bool merge_verts);
 
 }  // namespace io::stl
 }  // namespace blender
@@ -0,0 +1,118 @@
+/* SPDX-FileCopyrightText: 2026 Blender Authors
+ *
+ * SPDX-License-Identifier: Apache-2.0 */
+
+#include <fstream>
+
+#include "BKE_appdir.hh"
+#include "BKE_gtest_base.hh"
+#include "BKE_lib_id.hh"
+
+#include "BLI_fileops.hh"
+#include "BLI_path_utils.hh"
+#include "BLI_vector.hh"
+
+#include "DNA_mesh_types.h"
+
+#include "stl_data.hh"
+#include "stl_import_binary_reader.hh"
+
+namespace blender::io::stl {
+
+class STLImportBinaryTest : public bke::BlenderGTestBase {
+ protected:
+  void SetUp() override
+  {
+    BKE_tempdir_init(nullptr);
+  }
+
+  void TearDown() override
+  {
+    BKE_tempdir_session_purge();
+  }
+
+  static std::string get_temp_filename(const std::string &filename)
+  {
+    return std::string(BKE_tempdir_base()) + SEP_STR + filename;
+  }
+
+  /** Write a binary STL file, using the given triangle count in the header. */
+  static void write_binary_stl(const std::string &filepath,
+                               const Span<PackedTriangle> tris,
+                               const uint32_t header_tris_num)
+  {
+    std::ofstream file(filepath, std::ios::binary);
+    const char header[BINARY_HEADER_SIZE] = {};
+    file.write(header, sizeof(header));
+    file.write(reinterpret_cast<const char *>(&header_tris_num), sizeof(header_tris_num));
+    file.write(reinterpret_cast<const char *>(tris.data()), tris.size_in_bytes());
+  }
+
+  static Vector<PackedTriangle> get_test_triangles()
+  {
+    const float3 normal(0.0f, 0.0f, 1.0f);
+    return {
+        {normal, {{0, 0, 0}, {1, 0, 0}, {1, 1, 0}}, 0},
+        {normal, {{0, 0, 0}, {1, 1, 0}, {0, 1, 0}}, 0},
+        /* Same vertices as the first triangle. */
+        {normal, {{1, 0, 0}, {1, 1, 0}, {0, 0, 0}}, 0},
+        /* Degenerate triangle. */
+        {normal, {{0, 0, 0}, {0, 0, 0}, {1, 0, 0}}, 0},
+    };
+  }
+};
+
+TEST_F(STLImportBinaryTest, MergeVertices)
+{
+  const Vector<PackedTriangle> tris = get_test_triangles();
+  const std::string filepath = get_temp_filename("merge_vertices.stl");
+  write_binary_stl(filepath, tris, tris.size());
+
+  Mesh *mesh = read_stl_binary(filepath.c_str(), false, true);
+  ASSERT_NE(mesh, nullptr);
+  EXPECT_EQ(mesh->verts_num, 4);
+  EXPECT_EQ(mesh->faces_num, 2);
+  /* Vertices are in the order of their first use. */
+  const Span<float3> positions = mesh->vert_positions();
+  EXPECT_EQ(positions[0], float3(0, 0, 0));
+  EXPECT_EQ(positions[1], float3(1, 0, 0));
+  EXPECT_EQ(positions[2], float3(1, 1, 0));
+  EXPECT_EQ(positions[3], float3(0, 1, 0));
+  EXPECT_EQ_SPAN<int>(mesh->corner_verts(), Span<int>({0, 1, 2, 0, 2, 3}));
+  BKE_id_free(nullptr, mesh);
+}
+
+TEST_F(STLImportBinaryTest, TriangleSoup)
+{
+  const Vector<PackedTriangle> tris = get_test_triangles();
+  const std::string filepath = get_temp_filename("triangle_soup.stl");
+  write_binary_stl(filepath, tris, tris.size());
+
+  Mesh *mesh = read_stl_binary(filepath.c_str(), false, false);
+  ASSERT_NE(mesh, nullptr);
+  EXPECT_EQ(mesh->verts_num, 12);
+  EXPECT_EQ(mesh->faces_num, 4);
+  const Span<float3> positions = mesh->vert_positions();
+  for (const int tri_i : tris.index_range()) {
+    for (const int i : IndexRange(3)) {
+      EXPECT_EQ(positions[tri_i * 3 + i], tris[tri_i].vertices[i]);
+    }
+  }
+  BKE_id_free(nullptr, mesh);
+}
+
+TEST_F(STLImportBinaryTest, TruncatedFile)
+{
+  const Vector<PackedTriangle> tris = get_test_triangles();
+  const std::string filepath = get_temp_filename("truncated.stl");
+  /* The header claims more triangles than the file contains. */
+  write_binary_stl(filepath, tris.as_span().take_front(2), 10);
+
+  Mesh *mesh = read_stl_binary(filepath.c_str(), false, true);
+  ASSERT_NE(mesh, nullptr);
+  EXPECT_EQ(mesh->verts_num, 4);
+  EXPECT_EQ(mesh->faces_num, 2);
+  BKE_id_free(nullptr, mesh);
+}
+
+}  // namespace blender::io::stl
@@ -16,6 +16,7 @@
 #include "BLI_mmap.hh"
 #include "BLI_string.hh"
 #include "BLI_string_ref.hh"
+#include "BLI_task.hh"
 #include "BLI_vector.hh"
 
 #include "IO_string_utils.hh"
@@ -44,6 +45,9 @@ namespace io::obj {
 
 using std::string;
 
+/** Number of chunks parsed at once, before their elements are added to the geometries. */
+static constexpr int64_t PARSE_CHUNK_BATCH = 64;
+
 /**
  * Based on the properties of the given Geometry instance, create a new Geometry instance
  * or return the previous one.
@@ -83,12 +87,91 @@ static Geometry *create_geometry(Geometry *const prev_geometry,
   return new_geometry();
 }
 
-static void geom_add_vertex(const char *p, const char *end, GlobalVertices &r_global_vertices)
+/** Number of vertex positions, UVs and normals in (a part of) the OBJ file. */
+struct VertexCounts {
+  int64_t vertices = 0;
+  int64_t uv_vertices = 0;
+  int64_t vert_normals = 0;
+};
+
+/**
+ * Vertex color or weight found while parsing a chunk. They are applied to #GlobalVertices in file
+ * order when the chunk is added, since `#MRGB` color blocks apply to previously read vertices.
+ */
+struct ChunkVertexAttribute {
+  enum class Type : int8_t {
+    Color,
+    Weight,
+    /** Color of a `#MRGB` block, the vertex index is the number of vertices read before it. */
+    MRGBColor,
+  };
+  Type type;
+  int64_t vertex_index;
+  /** Linear color, or the weight in the first component. */
+  float3 value;
+};
+
+/** Face read from a chunk, its corners are stored in #ObjFileChunk::face_corners. */
+struct ChunkFace {
+  int64_t corners_start;
+  int64_t corners_num;
+  bool is_valid;
+};
+
+/**
+ * Line of a chunk that depends on or changes the parser state (objects, groups, materials,
+ * curves...). These are processed in file order once the chunk has been parsed.
+ */
+struct ChunkLine {
+  /** Text of the line in the file buffer, including line continuations. */
+  StringRef text;
+  /** Number of faces of the chunk before this line. */
+  int64_t faces_before;
+  /** Number of vertices in the file before this line. */
+  int64_t vertices_before;
+};
+
+/**
+ * Part of the OBJ file ending at a line boundary, which is parsed independently of the others.
+ * Vertex positions, UVs and normals are written to #GlobalVertices directly, everything else is
+ * stored in the chunk until it is added to the geometries in file order.
+ */
+struct ObjFileChunk {
+  StringRef buffer;
+  /** Number of elements in the file before this chunk. */
+  VertexCounts counts_start;
+  /** Number of elements in this chunk. */
+  VertexCounts counts;
+
+  Vector<ChunkVertexAttribute> vertex_attributes;
+  Vector<FaceCorner> face_corners;
+  Vector<ChunkFace> faces;
+  Vector<ChunkLine> lines;
+};
+
+/**
+ * State variables of the sequential part of the parsing: once set, they remain the same for the
+ * remaining elements in the object.
+ */
+struct ObjParseState {
+  Geometry *curr_geom = nullptr;
+  bool shaded_smooth = false;
+  string group_name;
+  int group_index = -1;
+  string material_name;
+  int material_index = -1;
+  /** Number of vertices read before the pending `#MRGB` block. */
+  int64_t mrgb_block_vertices_num = 0;
+};
+
+static void geom_add_vertex(const char *p,
+                            const char *end,
+                            const int64_t vertex_index,
+                            MutableSpan<float3> vertices,
+                            Vector<ChunkVertexAttribute> &r_attributes)
 {
-  r_global_vertices.flush_mrgb_block();
-  float3 vert;
+  float3 &vert = vertices[vertex_index];
   p = parse_floats(p, end, 0.0f, vert, 3);
-  r_global_vertices.vertices.append(vert);
   /* OBJ extension: `xyzrgb` vertex colors, when the vertex position
    * is followed by 3 more RGB color components. See
    * http://paulbourke.net/dataformats/obj/colour.html */
@@ -98,17 +181,21 @@ static void geom_add_vertex(const char *p, const char *end, GlobalVertices &r_gl
     if (srgb.x >= 0 && srgb.y >= 0 && srgb.z >= 0) {
       float3 linear;
       srgb_to_linearrgb_v3_v3(linear, srgb);
-      r_global_vertices.set_vertex_color(r_global_vertices.vertices.size() - 1, linear);
+      r_attributes.append({ChunkVertexAttribute::Type::Color, vertex_index, linear});
     }
     else if (srgb.x > 0) {
       /* Treats value in srgb.x as weight. */
-      r_global_vertices.set_vertex_weight(r_global_vertices.vertices.size() - 1, srgb.x);
+      r_attributes.append(
+          {ChunkVertexAttribute::Type::Weight, vertex_index, float3(srgb.x, 0.0f, 0.0f)});
     }
   }
   UNUSED_VARS(p);
 }
 
-static void geom_add_mrgb_colors(const char *p, const char *end, GlobalVertices &r_global_vertices)
+static void geom_add_mrgb_colors(const char *p,
+                                 const char *end,
+                                 const int64_t vertices_before,
+                                 Vector<ChunkVertexAttribute> &r_attributes)
 {
   /* MRGB color extension, in the form of
    * "#MRGB MMRRGGBBMMRRGGBB ..."
@@ -129,30 +216,54 @@ static void geom_add_mrgb_colors(const char *p, const char *end, GlobalVertices
     float linear[4];
     srgb_to_linearrgb_uchar4(linear, srgb);
 
-    r_global_vertices.mrgb_block.append(float3(linear[0], linear[1], linear[2]));
+    r_attributes.append({ChunkVertexAttribute::Type::MRGBColor,
+                         vertices_before,
+                         float3(linear[0], linear[1], linear[2])});
 
     p += mrgb_length;
   }
 }
 
-static void geom_add_vertex_normal(const char *p,
-                                   const char *end,
-                                   GlobalVertices &r_global_vertices)
+static void geom_add_vertex_normal(const char *p, const char *end, float3 &r_normal)
 {
-  float3 normal;
-  parse_floats(p, end, 0.0f, normal, 3);
+  parse_floats(p, end, 0.0f, r_normal, 3);
   /* Normals can be printed with only several digits in the file,
    * making them ever-so-slightly non unit length. Make sure they are
    * normalized. */
-  normalize_v3(normal);
-  r_global_vertices.vert_normals.append(normal);
+  normalize_v3(r_normal);
 }
 
-static void geom_add_uv_vertex(const char *p, const char *end, GlobalVertices &r_global_vertices)
+static void geom_add_uv_vertex(const char *p, const char *end, float2 &r_uv)
 {
-  float2 uv;
-  parse_floats(p, end, 0.0f, uv, 2);
-  r_global_vertices.uv_vertices.append(uv);
+  parse_floats(p, end, 0.0f, r_uv, 2);
+}
+
+/**
+ * Apply the vertex colors and weights of a chunk, in file order.
+ */
+static void add_vertex_attributes(const Span<ChunkVertexAttribute> attributes,
+                                  ObjParseState &state,
+                                  GlobalVertices &r_global_vertices)
+{
+  for (const ChunkVertexAttribute &attribute : attributes) {
+    if (attribute.type == ChunkVertexAttribute::Type::MRGBColor) {
+      /* Vertices read in between the blocks flush the previous one. */
+      if (attribute.vertex_index != state.mrgb_block_vertices_num) {
+        r_global_vertices.flush_mrgb_block(state.mrgb_block_vertices_num);
+      }
+      state.mrgb_block_vertices_num = attribute.vertex_index;
+      r_global_vertices.mrgb_block.append(attribute.value);
+      continue;
+    }
+    /* The vertex with this attribute was read after the pending block. */
+    r_global_vertices.flush_mrgb_block(state.mrgb_block_vertices_num);
+    if (attribute.type == ChunkVertexAttribute::Type::Color) {
+      r_global_vertices.set_vertex_color(attribute.vertex_index, attribute.value);
+    }
+    else {
+      r_global_vertices.set_vertex_weight(attribute.vertex_index, attribute.value.x);
+    }
+  }
 }
 
 /**
@@ -187,11 +298,11 @@ static const char *parse_vertex_index(const char *p, const char *end, size_t n_e
 static void geom_add_polyline(Geometry *geom,
                               const char *p,
                               const char *end,
-                              GlobalVertices &r_global_vertices)
+                              const int64_t vertices_num)
 {
   int last_vertex_index;
   p = drop_whitespace(p, end);
-  p = parse_vertex_index(p, end, r_global_vertices.vertices.size(), last_vertex_index);
+  p = parse_vertex_index(p, end, vertices_num, last_vertex_index);
 
   if (last_vertex_index == INT32_MAX) {
     CLOG_WARN(&LOG, "Skipping invalid OBJ polyline.");
@@ -207,7 +318,7 @@ static void geom_add_polyline(Geometry *geom,
     /* Skip whitespace to get to the next vertex. */
     p = drop_whitespace(p, end);
 
-    p = parse_vertex_index(p, end, r_global_vertices.vertices.size(), vertex_index);
+    p = parse_vertex_index(p, end, vertices_num, vertex_index);
     if (vertex_index == INT32_MAX) {
       break;
     }
@@ -218,24 +329,18 @@ static void geom_add_polyline(Geometry *geom,
   }
 }
 
-static void geom_add_polygon(Geometry *geom,
-                             const char *p,
-                             const char *end,
-                             const GlobalVertices &global_vertices,
-                             const int material_index,
-                             const int group_index,
-                             const bool shaded_smooth)
+/**
+ * Parse the corners of a face into the chunk. Indices are made non-negative and zero-based using
+ * the number of elements read before the face. Corners with an invalid vertex index get -1.
+ */
+static void chunk_add_polygon(ObjFileChunk &chunk,
+                              const char *p,
+                              const char *end,
+                              const VertexCounts &counts)
 {
-  FaceElem curr_face;
-  curr_face.shaded_smooth = shaded_smooth;
-  curr_face.material_index = material_index;
-  if (group_index >= 0) {
-    curr_face.vertex_group_index = group_index;
-    geom->has_vertex_groups_ = true;
-  }
-
-  const int orig_corners_size = geom->face_corners_.size();
-  curr_face.start_index_ = orig_corners_size;
+  ChunkFace curr_face;
+  curr_face.corners_start = chunk.face_corners.size();
+  curr_face.corners_num = 0;
 
   bool face_valid = true;
   p = drop_whitespace(p, end);
@@ -266,47 +371,41 @@ static void geom_add_polygon(Geometry *geom,
       }
     }
     /* Always keep stored indices non-negative and zero-based. */
-    corner.vert_index += corner.vert_index < 0 ? global_vertices.vertices.size() : -1;
-    if (corner.vert_index < 0 || corner.vert_index >= global_vertices.vertices.size()) {
+    corner.vert_index += corner.vert_index < 0 ? counts.vertices : -1;
+    if (corner.vert_index < 0 || corner.vert_index >= counts.vertices) {
       CLOG_WARN(&LOG,
                 "Invalid vertex index %i (valid range [0, %zu)), ignoring face",
                 corner.vert_index,
-                size_t(global_vertices.vertices.size()));
+                size_t(counts.vertices));
       face_valid = false;
-    }
-    else {
-      geom->track_vertex_index(corner.vert_index);
+      corner.vert_index = -1;
     }
     /* Ignore UV index, if the geometry does not have any UVs (#103212). */
-    if (got_uv && !global_vertices.uv_vertices.is_empty()) {
-      corner.uv_vert_index += corner.uv_vert_index < 0 ? global_vertices.uv_vertices.size() : -1;
-      if (corner.uv_vert_index < 0 || corner.uv_vert_index >= global_vertices.uv_vertices.size()) {
+    if (got_uv && counts.uv_vertices != 0) {
+      corner.uv_vert_index += corner.uv_vert_index < 0 ? counts.uv_vertices : -1;
+      if (corner.uv_vert_index < 0 || corner.uv_vert_index >= counts.uv_vertices) {
         CLOG_WARN(&LOG,
                   "Invalid UV index %i (valid range [0, %zu)), ignoring face",
                   corner.uv_vert_index,
-                  size_t(global_vertices.uv_vertices.size()));
+                  size_t(counts.uv_vertices));
         face_valid = false;
       }
     }
     /* Ignore corner normal index, if the geometry does not have any normals.
      * Some obj files out there do have face definitions that refer to normal indices,
      * without any normals being present (#98782). */
-    if (got_normal && !global_vertices.vert_normals.is_empty()) {
-      corner.vertex_normal_index += corner.vertex_normal_index < 0 ?
-                                        global_vertices.vert_normals.size() :
-                                        -1;
-      if (corner.vertex_normal_index < 0 ||
-          corner.vertex_normal_index >= global_vertices.vert_normals.size())
-      {
+    if (got_normal && counts.vert_normals != 0) {
+      corner.vertex_normal_index += corner.vertex_normal_index < 0 ? counts.vert_normals : -1;
+      if (corner.vertex_normal_index < 0 || corner.vertex_normal_index >= counts.vert_normals) {
         CLOG_WARN(&LOG,
                   "Invalid normal index %i (valid range [0, %zu)), ignoring face",
                   corner.vertex_normal_index,
-                  size_t(global_vertices.vert_normals.size()));
+                  size_t(counts.vert_normals));
         face_valid = false;
       }
     }
-    geom->face_corners_.append(corner);
-    curr_face.corner_count_++;
+    chunk.face_corners.append(corner);
+    curr_face.corners_num++;
 
     /* Some files contain extra stuff per face (e.g. 4 indices); skip any remainder (#103441). */
     p = drop_non_whitespace(p, end);
@@ -314,15 +413,42 @@ static void geom_add_polygon(Geometry *geom,
     p = drop_whitespace(p, end);
   }
 
-  if (face_valid) {
-    geom->face_elements_.append(curr_face);
-    geom->total_corner_ += curr_face.corner_count_;
+  curr_face.is_valid = face_valid;
+  chunk.faces.append(curr_face);
+}
+
+static void geom_add_polygon(Geometry *geom,
+                             const Span<FaceCorner> corners,
+                             const bool face_valid,
+                             const int material_index,
+                             const int group_index,
+                             const bool shaded_smooth)
+{
+  FaceElem curr_face;
+  curr_face.shaded_smooth = shaded_smooth;
+  curr_face.material_index = material_index;
+  if (group_index >= 0) {
+    curr_face.vertex_group_index = group_index;
+    geom->has_vertex_groups_ = true;
+  }
+
+  /* Vertices of invalid faces are still added to the geometry. */
+  for (const FaceCorner &corner : corners) {
+    if (corner.vert_index >= 0) {
+      geom->track_vertex_index(corner.vert_index);
+    }
   }
-  else {
-    /* Remove just-added corners for the invalid face. */
-    geom->face_corners_.resize(orig_corners_size);
+
+  if (!face_valid) {
     geom->has_invalid_faces_ = true;
+    return;
   }
+
+  curr_face.start_index_ = geom->face_corners_.size();
+  curr_face.corner_count_ = corners.size();
+  geom->face_corners_.extend(corners);
+  geom->face_elements_.append(curr_face);
+  geom->total_corner_ += curr_face.corner_count_;
 }
 
 static Geometry *geom_set_curve_type(Geometry *geom,
@@ -349,7 +475,7 @@ static void geom_set_curve_degree(Geometry *geom, const char *p, const char *end
 static void geom_add_curve_vertex_indices(Geometry *geom,
                                           const char *p,
                                           const char *end,
-                                          const GlobalVertices &global_vertices)
+                                          const int64_t vertices_num)
 {
   /* Parse curve parameter range. */
   p = parse_floats(p, end, 0, geom->nurbs_element_.range, 2);
@@ -361,8 +487,8 @@ static void geom_add_curve_vertex_indices(Geometry *geom,
       return;
     }
     /* Always keep stored indices non-negative and zero-based. */
-    index += index < 0 ? global_vertices.vertices.size() : -1;
-    if (!validate::index_in_range(index, global_vertices.vertices.size())) {
+    index += index < 0 ? vertices_num : -1;
+    if (!validate::index_in_range(index, vertices_num)) {
       index = 0;
     }
     geom->nurbs_element_.curv_indices.append(index);
@@ -440,7 +566,8 @@ static void geom_new_object(const char *p,
       r_curr_geom, GEOM_MESH, StringRef(p, end).trim(), r_all_geometries);
 }
 
-OBJParser::OBJParser(const OBJImportParams &import_params) : import_params_(import_params)
+OBJParser::OBJParser(const OBJImportParams &import_params, const int64_t parse_chunk_size)
+    : import_params_(import_params), parse_chunk_size_(parse_chunk_size)
 {
   const int obj_file = BLI_open(import_params_.filepath, O_BINARY | O_RDONLY, 0);
   if (obj_file == -1) {
@@ -508,7 +635,7 @@ static void use_all_vertices_if_no_faces(Geometry *geom,
 /* OBJ file format supports "line continuations", which
  * are back-slashes, optionally followed by whitespace.
  * The line virtually extends to the next line in that case. */
-StringRef OBJParser::read_next_obj_line(StringRef &buffer)
+static StringRef read_next_obj_line(StringRef &buffer, string &line_buffer)
 {
   const char *start = buffer.begin();
   const char *end = buffer.end();
@@ -529,7 +656,7 @@ StringRef OBJParser::read_next_obj_line(StringRef &buffer)
   /* We have backslash. Copy into line buffer, replace
    * line continuation with space, return result. */
 
-  line_buffer_.assign(start, ptr);
+  line_buffer.assign(start, ptr);
 
   while (ptr < end) {
     char c = *ptr++;
@@ -541,41 +668,109 @@ StringRef OBJParser::read_next_obj_line(StringRef &buffer)
       }
       if (ahead < end && *ahead == '\n') {
         /* Line continuation: replace backslash & newline with space. */
-        line_buffer_ += ' ';
+        line_buffer += ' ';
         ptr = ahead + 1; /* Continue after the newline. */
       }
       else {
         /* Not a continuation: keep the backslash. */
-        line_buffer_ += c;
+        line_buffer += c;
       }
     }
     else if (c == '\n') {
       break;
     }
     else {
-      line_buffer_ += c;
+      line_buffer += c;
     }
   }
 
   buffer = StringRef(ptr, end);
-  return line_buffer_;
+  return line_buffer;
 }
 
-void OBJParser::parse_string_buffer(StringRef &buffer_str,
-                                    Vector<std::unique_ptr<Geometry>> &r_all_geometries,
-                                    GlobalVertices &r_global_vertices,
-                                    Geometry *&curr_geom)
+/**
+ * Whether the newline ends a line continuation, i.e. it follows a back-slash and optional
+ * whitespace (see #read_next_obj_line).
+ */
+static bool is_line_continuation(const char *line_start, const char *newline)
 {
-  /* State variables: once set, they remain the same for the remaining
-   * elements in the object. */
-  bool state_shaded_smooth = false;
-  string state_group_name;
-  int state_group_index = -1;
-  string state_material_name;
-  int state_material_index = -1;
+  const char *p = newline;
+  while (p > line_start && p[-1] <= ' ' && p[-1] != '\n') {
+    --p;
+  }
+  return p > line_start && p[-1] == '\\';
+}
 
-  while (!buffer_str.is_empty()) {
-    StringRef line = read_next_obj_line(buffer_str);
+/**
+ * Split the file into chunks of approximately the given size that end at a line boundary, so that
+ * they can be parsed independently. Lines with line continuations are never split.
+ */
+static Vector<ObjFileChunk> split_into_line_chunks(const StringRef buffer,
+                                                   const int64_t approximate_chunk_size)
+{
+  Vector<ObjFileChunk> chunks;
+  const char *start = buffer.begin();
+  while (start < buffer.end()) {
+    const char *end = start + std::min(approximate_chunk_size, int64_t(buffer.end() - start));
+    while (end < buffer.end()) {
+      const char *newline = std::find(end, buffer.end(), '\n');
+      end = newline < buffer.end() ? newline + 1 : buffer.end();
+      if (!is_line_continuation(start, newline)) {
+        break;
+      }
+    }
+    chunks.append_as();
+    chunks.last().buffer = StringRef(start, end);
+    start = end;
+  }
+  return chunks;
+}
+
+/**
+ * Count the vertex positions, UVs and normals of a chunk, recognizing them the same way as
+ * #parse_chunk.
+ */
+static VertexCounts count_chunk_vertices(StringRef buffer)
+{
+  VertexCounts counts;
+  string line_buffer;
+  while (!buffer.is_empty()) {
+    StringRef line = read_next_obj_line(buffer, line_buffer);
+    const char *p = line.begin(), *end = line.end();
+    p = drop_whitespace(p, end);
+    if (p == end || *p != 'v') {
+      continue;
+    }
+    if (parse_keyword(p, end, "v")) {
+      counts.vertices++;
+    }
+    else if (parse_keyword(p, end, "vn")) {
+      counts.vert_normals++;
+    }
+    else if (parse_keyword(p, end, "vt")) {
+      counts.uv_vertices++;
+    }
+  }
+  return counts;
+}
+
+/**
+ * Parse the elements of a chunk that do not depend on the parser state: vertex positions, UVs and
+ * normals are written to their place in the global arrays, vertex colors and faces are stored in
+ * the chunk. Other lines are kept to be processed in file order by #OBJParser::add_chunk.
+ */
+static void parse_chunk(ObjFileChunk &chunk, GlobalVertices &r_global_vertices)
+{
+  MutableSpan<float3> vertices = r_global_vertices.vertices;
+  MutableSpan<float2> uv_vertices = r_global_vertices.uv_vertices;
+  MutableSpan<float3> vert_normals = r_global_vertices.vert_normals;
+
+  VertexCounts counts = chunk.counts_start;
+  string line_buffer;
+  StringRef buffer = chunk.buffer;
+  while (!buffer.is_empty()) {
+    const char *line_start = buffer.begin();
+    StringRef line = read_next_obj_line(buffer, line_buffer);
     const char *p = line.begin(), *end = line.end();
     p = drop_whitespace(p, end);
     if (p == end) {
@@ -584,47 +779,87 @@ void OBJParser::parse_string_buffer(StringRef &buffer_str,
     /* Most common things that start with 'v': vertices, normals, UVs. */
     if (*p == 'v') {
       if (parse_keyword(p, end, "v")) {
-        geom_add_vertex(p, end, r_global_vertices);
+        geom_add_vertex(p, end, counts.vertices, vertices, chunk.vertex_attributes);
+        counts.vertices++;
       }
       else if (parse_keyword(p, end, "vn")) {
-        geom_add_vertex_normal(p, end, r_global_vertices);
+        geom_add_vertex_normal(p, end, vert_normals[counts.vert_normals]);
+        counts.vert_normals++;
       }
       else if (parse_keyword(p, end, "vt")) {
-        geom_add_uv_vertex(p, end, r_global_vertices);
+        geom_add_uv_vertex(p, end, uv_vertices[counts.uv_vertices]);
+        counts.uv_vertices++;
       }
     }
     /* Faces. */
     else if (parse_keyword(p, end, "f")) {
+      chunk_add_polygon(chunk, p, end, counts);
+    }
+    else if (parse_keyword(p, end, "#MRGB")) {
+      geom_add_mrgb_colors(p, end, counts.vertices, chunk.vertex_attributes);
+    }
+    /* Comments. */
+    else if (*p == '#') {
+      /* Nothing to do. */
+    }
+    else {
+      chunk.lines.append(
+          {StringRef(line_start, buffer.begin()), chunk.faces.size(), counts.vertices});
+    }
+  }
+}
+
+void OBJParser::add_chunk(ObjFileChunk &chunk,
+                          Vector<std::unique_ptr<Geometry>> &r_all_geometries,
+                          GlobalVertices &r_global_vertices,
+                          ObjParseState &state)
+{
+  add_vertex_attributes(chunk.vertex_attributes, state, r_global_vertices);
+
+  int64_t face_index = 0;
+  const auto add_faces = [&](const int64_t faces_end) {
+    for (; face_index < faces_end; face_index++) {
+      const ChunkFace &face = chunk.faces[face_index];
+      Geometry *curr_geom = state.curr_geom;
       /* If we don't have a material index assigned yet, get one.
        * It means "usemtl" state came from the previous object. */
-      if (state_material_index == -1 && !state_material_name.empty() &&
+      if (state.material_index == -1 && !state.material_name.empty() &&
           curr_geom->material_indices_.is_empty())
       {
-        curr_geom->material_indices_.add_new(state_material_name, 0);
-        curr_geom->material_order_.append(state_material_name);
-        state_material_index = 0;
+        curr_geom->material_indices_.add_new(state.material_name, 0);
+        curr_geom->material_order_.append(state.material_name);
+        state.material_index = 0;
       }
 
       geom_add_polygon(curr_geom,
-                       p,
-                       end,
-                       r_global_vertices,
-                       state_material_index,
-                       state_group_index,
-                       state_shaded_smooth);
+                       chunk.face_corners.as_span().slice(face.corners_start, face.corners_num),
+                       face.is_valid,
+                       state.material_index,
+                       state.group_index,
+                       state.shaded_smooth);
     }
-    /* Faces. */
-    else if (parse_keyword(p, end, "l")) {
-      geom_add_polyline(curr_geom, p, end, r_global_vertices);
+  };
+
+  for (const ChunkLine &chunk_line : chunk.lines) {
+    add_faces(chunk_line.faces_before);
+
+    StringRef text = chunk_line.text;
+    StringRef line = read_next_obj_line(text, line_buffer_);
+    const char *p = line.begin(), *end = line.end();
+    p = drop_whitespace(p, end);
+    Geometry *&curr_geom = state.curr_geom;
+
+    if (parse_keyword(p, end, "l")) {
+      geom_add_polyline(curr_geom, p, end, chunk_line.vertices_before);
     }
     /* Objects. */
     else if (parse_keyword(p, end, "o")) {
       if (import_params_.use_split_objects) {
         geom_new_object(p,
                         end,
-                        state_shaded_smooth,
-                        state_group_name,
-                        state_material_index,
+                        state.shaded_smooth,
+                        state.group_name,
+                        state.material_index,
                         curr_geom,
                         r_all_geometries);
       }
@@ -634,54 +869,47 @@ void OBJParser::parse_string_buffer(StringRef &buffer_str,
       if (import_params_.use_split_groups) {
         geom_new_object(p,
                         end,
-                        state_shaded_smooth,
-                        state_group_name,
-                        state_material_index,
+                        state.shaded_smooth,
+                        state.group_name,
+                        state.material_index,
                         curr_geom,
                         r_all_geometries);
       }
       else {
-        geom_update_group(StringRef(p, end).trim(), state_group_name);
+        geom_update_group(StringRef(p, end).trim(), state.group_name);
         int new_index = curr_geom->group_indices_.size();
-        state_group_index = curr_geom->group_indices_.lookup_or_add(state_group_name, new_index);
-        if (new_index == state_group_index) {
-          curr_geom->group_order_.append(state_group_name);
+        state.group_index = curr_geom->group_indices_.lookup_or_add(state.group_name, new_index);
+        if (new_index == state.group_index) {
+          curr_geom->group_order_.append(state.group_name);
         }
       }
     }
     /* Smoothing groups. */
     else if (parse_keyword(p, end, "s")) {
-      geom_update_smooth_group(p, end, state_shaded_smooth);
+      geom_update_smooth_group(p, end, state.shaded_smooth);
     }
     /* Materials and their libraries. */
     else if (parse_keyword(p, end, "usemtl")) {
-      state_material_name = StringRef(p, end).trim();
+      state.material_name = StringRef(p, end).trim();
       int new_mat_index = curr_geom->material_indices_.size();
-      state_material_index = curr_geom->material_indices_.lookup_or_add(state_material_name,
+      state.material_index = curr_geom->material_indices_.lookup_or_add(state.material_name,
                                                                         new_mat_index);
-      if (new_mat_index == state_material_index) {
-        curr_geom->material_order_.append(state_material_name);
+      if (new_mat_index == state.material_index) {
+        curr_geom->material_order_.append(state.material_name);
       }
     }
     else if (parse_keyword(p, end, "mtllib")) {
       add_mtl_library(StringRef(p, end).trim());
     }
-    else if (parse_keyword(p, end, "#MRGB")) {
-      geom_add_mrgb_colors(p, end, r_global_vertices);
-    }
-    /* Comments. */
-    else if (*p == '#') {
-      /* Nothing to do. */
-    }
     /* Curve related things. */
     else if (parse_keyword(p, end, "cstype")) {
-      curr_geom = geom_set_curve_type(curr_geom, p, end, state_group_name, r_all_geometries);
+      curr_geom = geom_set_curve_type(curr_geom, p, end, state.group_name, r_all_geometries);
     }
     else if (parse_keyword(p, end, "deg")) {
       geom_set_curve_degree(curr_geom, p, end);
     }
     else if (parse_keyword(p, end, "curv")) {
-      geom_add_curve_vertex_indices(curr_geom, p, end, r_global_vertices);
+      geom_add_curve_vertex_indices(curr_geom, p, end, chunk_line.vertices_before);
     }
     else if (parse_keyword(p, end, "parm")) {
       geom_add_curve_parameters(curr_geom, p, end);
@@ -693,6 +921,7 @@ void OBJParser::parse_string_buffer(StringRef &buffer_str,
       CLOG_WARN(&LOG, "OBJ element not recognized: '%s'", string(p, end).c_str());
     }
   }
+  add_faces(chunk.faces.size());
 }
 
 void OBJParser::parse(Vector<std::unique_ptr<Geometry>> &r_all_geometries,
@@ -707,15 +936,51 @@ void OBJParser::parse(Vector<std::unique_ptr<Geometry>> &r_all_geometries,
   STRNCPY(ob_name, BLI_path_basename(import_params_.filepath));
   BLI_path_extension_strip(ob_name);
 
-  Geometry *curr_geom = create_geometry(nullptr, GEOM_MESH, ob_name, r_all_geometries);
+  ObjParseState state;
+  state.curr_geom = create_geometry(nullptr, GEOM_MESH, ob_name, r_all_geometries);
 
   const char *file_data = static_cast<const char *>(BLI_mmap_get_pointer(mmap_file_));
   size_t file_size = BLI_mmap_get_length(mmap_file_);
-  StringRef buffer_str{file_data, int64_t(file_size)};
-  OBJParser::parse_string_buffer(buffer_str, r_all_geometries, r_global_vertices, curr_geom);
+  Vector<ObjFileChunk> chunks = split_into_line_chunks(StringRef(file_data, int64_t(file_size)),
+                                                       parse_chunk_size_);
+
+  /* Count the elements of each chunk first, so that every chunk knows where its vertices go in
+   * the global arrays and how to resolve the (possibly relative) indices of its faces. */
+  threading::parallel_for(chunks.index_range(), 1, [&](const IndexRange range) {
+    for (const int64_t i : range) {
+      chunks[i].counts = count_chunk_vertices(chunks[i].buffer);
+    }
+  });
+  VertexCounts total_counts;
+  for (ObjFileChunk &chunk : chunks) {
+    chunk.counts_start = total_counts;
+    total_counts.vertices += chunk.counts.vertices;
+    total_counts.uv_vertices += chunk.counts.uv_vertices;
+    total_counts.vert_normals += chunk.counts.vert_normals;
+  }
+  r_global_vertices.vertices.resize(total_counts.vertices);
+  r_global_vertices.uv_vertices.resize(total_counts.uv_vertices);
+  r_global_vertices.vert_normals.resize(total_counts.vert_normals);
+
+  /* Parse the chunks in parallel, and add their faces and other elements to the geometries in
+   * file order. This is done in batches to limit the memory used by the parsed chunks. */
+  for (int64_t batch_start = 0; batch_start < chunks.size(); batch_start += PARSE_CHUNK_BATCH) {
+    const IndexRange batch = chunks.index_range().drop_front(batch_start).take_front(
+        PARSE_CHUNK_BATCH);
+    threading::parallel_for(batch, 1, [&](const IndexRange range) {
+      for (const int64_t i : range) {
+        parse_chunk(chunks[i], r_global_vertices);
+      }
+    });
+    for (const int64_t i : batch) {
+      add_chunk(chunks[i], r_all_geometries, r_global_vertices, state);
+      /* Free the parsed data. */
+      chunks[i] = {};
+    }
+  }
 
-  r_global_vertices.flush_mrgb_block();
-  use_all_vertices_if_no_faces(curr_geom, r_all_geometries, r_global_vertices);
+  r_global_vertices.flush_mrgb_block(state.mrgb_block_vertices_num);
+  use_all_vertices_if_no_faces(state.curr_geom, r_all_geometries, r_global_vertices);
   add_default_mtl_library();
 }
 
@@ -22,10 +22,16 @@ struct BLI_mmap_file;
 namespace blender::io::obj {
 
 struct MTLMaterial;
+struct ObjFileChunk;
+struct ObjParseState;
+
+/** Approximate size of the parts of the file that are parsed in parallel. */
+constexpr int64_t PARSE_CHUNK_SIZE = 1024 * 1024;
 
 class OBJParser {
  private:
   const OBJImportParams &import_params_;
+  int64_t parse_chunk_size_;
   Vector<std::string> mtl_libraries_;
   BLI_mmap_file *mmap_file_ = nullptr;
   std::string line_buffer_;
@@ -33,8 +39,10 @@ class OBJParser {
  public:
   /**
    * Open OBJ file at the path given in import parameters.
+   * \param parse_chunk_size: Approximate size of the parts of the file that are parsed in
+   * parallel. Only meant to be changed for testing.
    */
-  OBJParser(const OBJImportParams &import_params);
+  OBJParser(const OBJImportParams &import_params, int64_t parse_chunk_size = PARSE_CHUNK_SIZE);
   ~OBJParser();
 
   /**
@@ -51,11 +59,13 @@ class OBJParser {
  private:
   void add_mtl_library(StringRef path);
   void add_default_mtl_library();
-  StringRef read_next_obj_line(StringRef &buffer);
-  void parse_string_buffer(StringRef &buffer_str,
-                           Vector<std::unique_ptr<Geometry>> &r_all_geometries,
-                           GlobalVertices &r_global_vertices,
-                           Geometry *&curr_geom);
+  /**
+   * Add the faces and other elements of a parsed chunk to the geometries, in file order.
+   */
+  void add_chunk(ObjFileChunk &chunk,
+                 Vector<std::unique_ptr<Geometry>> &r_all_geometries,
+                 GlobalVertices &r_global_vertices,
+                 ObjParseState &state);
 };
 
 class MTLParser {
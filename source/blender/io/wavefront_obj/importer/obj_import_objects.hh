@@ -65,13 +65,16 @@ struct GlobalVertices {
     return index < vertex_colors.size() && vertex_colors[index].x >= 0.0;
   }
 
-  void flush_mrgb_block()
+  /**
+   * \param vertices_num: Number of vertices read before the block.
+   */
+  void flush_mrgb_block(const int64_t vertices_num)
   {
     if (!mrgb_block.is_empty()) {
       /* Set color of the last mrgb_block.size() verts. */
       int64_t start_of_block = 0;
-      if (mrgb_block.size() <= vertices.size()) {
-        start_of_block = vertices.size() - mrgb_block.size();
+      if (mrgb_block.size() <= vertices_num) {
+        start_of_block = vertices_num - mrgb_block.size();
       }
       if (start_of_block == 0) {
         vertex_colors = std::move(mrgb_block);
@@ -0,0 +1,191 @@
+/* SPDX-FileCopyrightText: 2026 Blender Authors
+ *
+ * SPDX-License-Identifier: Apache-2.0 */
+
+#include <gtest/gtest.h>
+
+#include <fmt/format.h>
+
+#include "BLI_fileops.hh"
+#include "BLI_string.hh"
+
+#include "BKE_appdir.hh"
+#include "BKE_gtest_base.hh"
+
+#include "testing/testing.h"
+
+#include "obj_import_file_reader.hh"
+
+namespace blender::io::obj {
+
+struct OBJParseResult {
+  Vector<std::unique_ptr<Geometry>> geometries;
+  GlobalVertices global_vertices;
+};
+
+class OBJParserTest : public bke::BlenderGTestBase {
+ protected:
+  std::string filepath_;
+
+  void SetUp() override
+  {
+    BKE_tempdir_init(nullptr);
+    filepath_ = std::string(BKE_tempdir_base()) + SEP_STR + "obj_parser_test.obj";
+  }
+
+  void TearDown() override
+  {
+    BLI_delete(filepath_.c_str(), false, false);
+  }
+
+  void write_file(const StringRef text)
+  {
+    FILE *file = BLI_fopen(filepath_.c_str(), "wb");
+    fwrite(text.data(), 1, text.size(), file);
+    fclose(file);
+  }
+
+  OBJParseResult parse(const int64_t parse_chunk_size)
+  {
+    OBJImportParams params;
+    STRNCPY(params.filepath, filepath_.c_str());
+    OBJParser parser(params, parse_chunk_size);
+    OBJParseResult result;
+    parser.parse(result.geometries, result.global_vertices);
+    return result;
+  }
+};
+
+/**
+ * Blocks of elements of all kinds, using relative indices, line continuations, vertex colors and
+ * a curve, so that chunk boundaries end up at many different places.
+ */
+static std::string create_test_obj(const int blocks_num)
+{
+  std::string text = "mtllib parser_test.mtl\n";
+  for (const int i : IndexRange(blocks_num)) {
+    text += fmt::format("o Object_{}\n", i);
+    text += fmt::format("v {} 0.5 -1.25\n", i);
+    text += fmt::format("v {} 1.5 2.0 0.1 0.2 0.3\n", i + 1);
+    text += "v 0.0 0.0 1.0\nv 1.0 1.0 1.0\n";
+    text += "#MRGB ff102030ff405060\n";
+    text += fmt::format("vt {} 0.25\nvt 0.5 0.5\nvt 1 1\nvt 0 1\n", i * 0.125f);
+    text += "vn 0 0 1\nvn 0 1 0\n# A comment line\n";
+    text += fmt::format("g group_{}\nusemtl material_{}\n", i % 2, i % 3);
+    text += (i % 2) ? "s 1\n" : "s off\n";
+    text += "f -4/-4/-2 -3/-3/-2 -2/-2/-1\n";
+    text += "f -4/-4/-2 \\\n  -3/-3/-2 \\  \n  -2/-2/-1 -1/-1/-1\n";
+    text += "l -1 -2 -3\n";
+    if (i % 4 == 3) {
+      text += "cstype bspline\ndeg 3\ncurv 0.0 1.0 -4 -3 -2 -1\nparm u 0 0 0 0 1 1 1 1\nend\n";
+    }
+  }
+  return text;
+}
+
+static void expect_same_geometry(const Geometry &a, const Geometry &b)
+{
+  EXPECT_EQ(a.geom_type_, b.geom_type_);
+  EXPECT_EQ(a.geometry_name_, b.geometry_name_);
+  EXPECT_EQ(a.group_order_, b.group_order_);
+  EXPECT_EQ(a.material_order_, b.material_order_);
+  EXPECT_EQ(a.vertex_index_min_, b.vertex_index_min_);
+  EXPECT_EQ(a.vertex_index_max_, b.vertex_index_max_);
+  EXPECT_TRUE(a.vertices_ == b.vertices_);
+  EXPECT_EQ(a.edges_, b.edges_);
+  EXPECT_EQ(a.has_invalid_faces_, b.has_invalid_faces_);
+  EXPECT_EQ(a.total_corner_, b.total_corner_);
+
+  ASSERT_EQ(a.face_corners_.size(), b.face_corners_.size());
+  for (const int i : a.face_corners_.index_range()) {
+    EXPECT_EQ(a.face_corners_[i].vert_index, b.face_corners_[i].vert_index);
+    EXPECT_EQ(a.face_corners_[i].uv_vert_index, b.face_corners_[i].uv_vert_index);
+    EXPECT_EQ(a.face_corners_[i].vertex_normal_index, b.face_corners_[i].vertex_normal_index);
+  }
+  ASSERT_EQ(a.face_elements_.size(), b.face_elements_.size());
+  for (const int i : a.face_elements_.index_range()) {
+    EXPECT_EQ(a.face_elements_[i].vertex_group_index, b.face_elements_[i].vertex_group_index);
+    EXPECT_EQ(a.face_elements_[i].material_index, b.face_elements_[i].material_index);
+    EXPECT_EQ(a.face_elements_[i].shaded_smooth, b.face_elements_[i].shaded_smooth);
+    EXPECT_EQ(a.face_elements_[i].start_index_, b.face_elements_[i].start_index_);
+    EXPECT_EQ(a.face_elements_[i].corner_count_, b.face_elements_[i].corner_count_);
+  }
+
+  EXPECT_EQ(a.nurbs_element_.group_, b.nurbs_element_.group_);
+  EXPECT_EQ(a.nurbs_element_.degree, b.nurbs_element_.degree);
+  EXPECT_EQ(a.nurbs_element_.range, b.nurbs_element_.range);
+  EXPECT_EQ(a.nurbs_element_.curv_indices, b.nurbs_element_.curv_indices);
+  EXPECT_EQ(a.nurbs_element_.parm, b.nurbs_element_.parm);
+}
+
+static void expect_same_parse_result(const OBJParseResult &a, const OBJParseResult &b)
+{
+  EXPECT_EQ(a.global_vertices.vertices, b.global_vertices.vertices);
+  EXPECT_EQ(a.global_vertices.uv_vertices, b.global_vertices.uv_vertices);
+  EXPECT_EQ(a.global_vertices.vert_normals, b.global_vertices.vert_normals);
+  EXPECT_EQ(a.global_vertices.vertex_colors, b.global_vertices.vertex_colors);
+  EXPECT_EQ(a.global_vertices.vertex_weights, b.global_vertices.vertex_weights);
+  ASSERT_EQ(a.geometries.size(), b.geometries.size());
+  for (const int i : a.geometries.index_range()) {
+    expect_same_geometry(*a.geometries[i], *b.geometries[i]);
+  }
+}
+
+TEST_F(OBJParserTest, small_chunks_match_single_chunk)
+{
+  const std::string text = create_test_obj(8);
+  this->write_file(text);
+  ASSERT_LT(int64_t(text.size()), PARSE_CHUNK_SIZE);
+  const OBJParseResult expected = this->parse(PARSE_CHUNK_SIZE);
+  EXPECT_EQ(expected.global_vertices.vertices.size(), 8 * 4);
+  EXPECT_EQ(expected.geometries.size(), 8 + 2);
+
+  /* Tiny chunks split the file after almost every line, including lines with continuations. */
+  for (const int64_t chunk_size : {1, 2, 3, 7, 16, 61, 256}) {
+    SCOPED_TRACE(chunk_size);
+    expect_same_parse_result(this->parse(chunk_size), expected);
+  }
+}
+
+TEST_F(OBJParserTest, lines_across_chunk_boundary)
+{
+  /* Fill the file with vertices and a comment up to just before the end of the first chunk, so
+   * that the end of the chunk is in the second line of the continued face. */
+  std::string text = "o Boundary\n";
+  int vertices_num = 0;
+  while (int64_t(text.size()) < PARSE_CHUNK_SIZE - 64) {
+    text += fmt::format("v {} 0.0 1.0\n", vertices_num++);
+  }
+  text += "#" + std::string(PARSE_CHUNK_SIZE - 10 - text.size() - 2, ' ') + "\n";
+  ASSERT_EQ(int64_t(text.size()), PARSE_CHUNK_SIZE - 10);
+  const int vertices_before_face = vertices_num;
+  text += "f 1 2 \\\n 3 \\\n -3 -2 -1\n";
+  text += "vt 0.25 0.75\nvn 0 0 1\n";
+  for ([[maybe_unused]] const int i : IndexRange(3)) {
+    text += "f -3//-1 -2//-1 -1//-1\n";
+    text += std::string(30, ' ') + "v 1.0 2.0 3.0\n";
+    vertices_num++;
+  }
+  text += create_test_obj(4);
+  vertices_num += 4 * 4;
+  this->write_file(text);
+  ASSERT_GT(int64_t(text.size()), PARSE_CHUNK_SIZE);
+
+  const OBJParseResult result = this->parse(PARSE_CHUNK_SIZE);
+  const OBJParseResult expected = this->parse(int64_t(text.size()) * 2);
+  EXPECT_EQ(result.global_vertices.vertices.size(), vertices_num);
+  expect_same_parse_result(result, expected);
+
+  /* The continued face spanning the chunk boundary. */
+  const Geometry &geometry = *result.geometries.first();
+  ASSERT_FALSE(geometry.face_elements_.is_empty());
+  const FaceElem &face = geometry.face_elements_.first();
+  ASSERT_EQ(face.corner_count_, 6);
+  const int expected_vert_indices[6] = {
+      0, 1, 2, vertices_before_face - 3, vertices_before_face - 2, vertices_before_face - 1};
+  for (const int i : IndexRange(6)) {
+    EXPECT_EQ(geometry.face_corners_[face.start_index_ + i].vert_index, expected_vert_indices[i]);
+  }
+}
+
+}  // namespace blender::io::obj
@@ -23,6 +23,9 @@ namespace bke {
 struct FCurveRuntime;
 struct NlaStripRuntime;
 }  // namespace bke
+namespace animrig {
+class AnimDataEvalCache;
+}  // namespace animrig
 using FCurveRuntime = bke::FCurveRuntime;
 using NlaStripRuntime = bke::NlaStripRuntime;
 template<typename T> class Span;
@@ -765,6 +768,11 @@ struct AnimData {
 
   /** Runtime data, for depsgraph evaluation. */
   FCurve **driver_array = nullptr;
+  /**
+   * Runtime data, for depsgraph evaluation: cached evaluation plans of the animation. Only used
+   * on evaluated copies. Set to nullptr when reading or copying.
+   */
+  animrig::AnimDataEvalCache *eval_cache = nullptr;
 
   /* settings for animation evaluation */
   /** User-defined settings. */
@@ -19,6 +19,9 @@
 namespace blender {
 
 struct AnimData;
+namespace bke {
+struct KeyRuntime;
+}  // namespace bke
 
 /* Key::type: KeyBlocks are interpreted as... */
 enum ShapekeyContainerType : char {
@@ -152,6 +155,9 @@ struct Key {
    * current free UID for key-blocks.
    */
   int uidgen = 0;
+
+  /** Only allocated for evaluated copies, see #bke::KeyRuntime. */
+  bke::KeyRuntime *runtime = nullptr;
 };
 
 }  // namespace blender
@@ -50,6 +50,7 @@ struct Ipo;
 struct Key;
 struct Material;
 struct MCol;
+struct MDeformWeight;
 struct MEdge;
 struct MFace;
 
@@ -424,6 +425,12 @@ struct Mesh {
   Span<MDeformVert> deform_verts() const;
   /** Write access to vertex group data. */
   MutableSpan<MDeformVert> deform_verts_for_write();
+  /**
+   * Cached copy of the vertex group data, with the weights of all vertices stored contiguously.
+   * Faster to traverse than #deform_verts, where every vertex has a separate allocation.
+   * \warning: May be empty.
+   */
+  GroupedSpan<MDeformWeight> deform_weights() const;
 
   /**
    * Cached triangulation of mesh faces, depending on the face topology and the vertex positions.
@@ -556,6 +563,12 @@ struct Mesh {
 
   /** Call after changing vertex positions to tag lazily calculated caches for recomputation. */
   void tag_positions_changed();
+  /**
+   * Like #tag_positions_changed, when only the positions of the vertices in the mask changed.
+   * Already calculated normals are updated in place for the affected faces and their vertices,
+   * instead of being recalculated for the entire mesh.
+   */
+  void tag_positions_changed(const IndexMask &changed_verts);
   /** Call after moving every mesh vertex by the same translation. */
   void tag_positions_changed_uniformly();
   /** Like #tag_positions_changed but doesn't tag normals; they must be updated separately. */
@@ -69,9 +69,15 @@ enum ePointCache_Flag : int {
   PTCACHE_IGNORE_CLEAR = 1 << 13,
 
   PTCACHE_FLAG_INFO_DIRTY = 1 << 14,
+  /**
+   * Store the frames of a baked disk cache in a single indexed file instead of one file per
+   * frame, see #BKE_ptcache_disk_pack.
+   */
+  PTCACHE_DISK_PACK = 1 << 15,
 
   PTCACHE_REDO_NEEDED = PTCACHE_OUTDATED | PTCACHE_FRAMES_SKIPPED,
-  PTCACHE_FLAGS_COPY = PTCACHE_DISK_CACHE | PTCACHE_EXTERNAL | PTCACHE_IGNORE_LIBPATH,
+  PTCACHE_FLAGS_COPY = PTCACHE_DISK_CACHE | PTCACHE_EXTERNAL | PTCACHE_IGNORE_LIBPATH |
+                       PTCACHE_DISK_PACK,
 };
 ENUM_OPERATORS(ePointCache_Flag)
 
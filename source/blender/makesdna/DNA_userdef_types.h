@@ -1143,6 +1143,12 @@ struct UserDef {
   short vbotimeout = 120, vbocollectrate = 60;
   short textimeout = 120, texcollectrate = 60;
   int memcachelimit = 4096;
+  /**
+   * Limits of the memory cache for specific kinds of data in megabytes. Zero means that they are
+   * only limited by #memcachelimit.
+   */
+  int memcachelimit_volume_grids = 0;
+  int memcachelimit_file_loads = 0;
   /**
    * Maximum evaluation depth of node trees (e.g. number of nested node groups, not how many nodes
    * are in a chain).
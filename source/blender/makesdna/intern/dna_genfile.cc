@@ -18,6 +18,7 @@
 #include <cstdlib>
 #include <cstring>
 #include <iostream>
+#include <type_traits>
 
 #include <fmt/format.h>
 
@@ -26,7 +27,9 @@
 #include "BLI_index_range.hh"
 #include "BLI_math_matrix_types.hh"
 #include "BLI_set.hh"
+#include "BLI_task.hh"
 #include "BLI_utildefines.hh"
+#include "BLI_vector.hh"
 
 #include "DNA_genfile.h"
 #include "DNA_print.hh"
@@ -847,169 +850,230 @@ const char *DNA_struct_get_compareflags(const SDNA *oldsdna, const SDNA *newsdna
 }
 
 /**
- * Converts a value of one primitive type to another.
+ * Converts a single value of one primitive type to another. This matches the conversion rules
+ * that have always been used when reading files: integer types go through a 64 bit integer
+ * (intentionally overflowing signed values into an unsigned type, casting back to a signed value
+ * preserves the sign), floating point types go through a double and `char`/`uchar` values are
+ * normalized to the 0..1 range when converted to a floating point type.
+ */
+template<typename OldT, typename NewT> inline NewT cast_primitive_value(const OldT old_value)
+{
+  if constexpr (std::is_floating_point_v<NewT>) {
+    double value = double(old_value);
+    if constexpr (std::is_same_v<OldT, char> || std::is_same_v<OldT, uchar>) {
+      value /= 255.0;
+    }
+    return NewT(value);
+  }
+  else if constexpr (std::is_floating_point_v<OldT>) {
+    /* `int64_t` range stored in a `uint64_t`. */
+    return NewT(uint64_t(int64_t(old_value)));
+  }
+  else {
+    return NewT(uint64_t(old_value));
+  }
+}
+
+/**
+ * Converts the same primitive array in a number of consecutive blocks. The loops are typed so
+ * that the compiler can vectorize them, which matters when reading large arrays of structs.
+ */
+template<typename OldT, typename NewT>
+static void cast_primitive_array(int64_t blocks,
+                                 int64_t array_len,
+                                 const char *old_data,
+                                 const int64_t old_stride,
+                                 char *new_data,
+                                 const int64_t new_stride)
+{
+  if (old_stride == array_len * int64_t(sizeof(OldT)) &&
+      new_stride == array_len * int64_t(sizeof(NewT)))
+  {
+    /* The arrays of all blocks are contiguous in memory, convert them in a single loop. */
+    array_len *= blocks;
+    blocks = 1;
+  }
+  for (int64_t block = 0; block < blocks; block++) {
+    const char *old_array = old_data + block * old_stride;
+    char *new_array = new_data + block * new_stride;
+    for (int64_t a = 0; a < array_len; a++) {
+      /* Use #memcpy because the data of old files is not guaranteed to be aligned. */
+      OldT old_value;
+      memcpy(&old_value, old_array + a * int64_t(sizeof(OldT)), sizeof(OldT));
+      const NewT new_value = cast_primitive_value<OldT, NewT>(old_value);
+      memcpy(new_array + a * int64_t(sizeof(NewT)), &new_value, sizeof(NewT));
+    }
+  }
+}
+
+template<typename OldT>
+static void cast_primitive_type_from(const eSDNA_Type new_type,
+                                     const int64_t blocks,
+                                     const int64_t array_len,
+                                     const char *old_data,
+                                     const int64_t old_stride,
+                                     char *new_data,
+                                     const int64_t new_stride)
+{
+  switch (new_type) {
+    case SDNA_TYPE_CHAR:
+      cast_primitive_array<OldT, char>(
+          blocks, array_len, old_data, old_stride, new_data, new_stride);
+      break;
+    case SDNA_TYPE_UCHAR:
+      cast_primitive_array<OldT, uchar>(
+          blocks, array_len, old_data, old_stride, new_data, new_stride);
+      break;
+    case SDNA_TYPE_SHORT:
+      cast_primitive_array<OldT, short>(
+          blocks, array_len, old_data, old_stride, new_data, new_stride);
+      break;
+    case SDNA_TYPE_USHORT:
+      cast_primitive_array<OldT, ushort>(
+          blocks, array_len, old_data, old_stride, new_data, new_stride);
+      break;
+    case SDNA_TYPE_INT:
+      cast_primitive_array<OldT, int>(
+          blocks, array_len, old_data, old_stride, new_data, new_stride);
+      break;
+    case SDNA_TYPE_FLOAT:
+      cast_primitive_array<OldT, float>(
+          blocks, array_len, old_data, old_stride, new_data, new_stride);
+      break;
+    case SDNA_TYPE_DOUBLE:
+      cast_primitive_array<OldT, double>(
+          blocks, array_len, old_data, old_stride, new_data, new_stride);
+      break;
+    case SDNA_TYPE_INT64:
+      cast_primitive_array<OldT, int64_t>(
+          blocks, array_len, old_data, old_stride, new_data, new_stride);
+      break;
+    case SDNA_TYPE_UINT64:
+      cast_primitive_array<OldT, uint64_t>(
+          blocks, array_len, old_data, old_stride, new_data, new_stride);
+      break;
+    case SDNA_TYPE_INT8:
+      cast_primitive_array<OldT, int8_t>(
+          blocks, array_len, old_data, old_stride, new_data, new_stride);
+      break;
+    case SDNA_TYPE_VOID:
+    case SDNA_TYPE_RAW_DATA:
+      BLI_assert_msg(false, "Conversion to SDNA_TYPE_VOID/SDNA_TYPE_RAW_DATA is not supported");
+      break;
+  }
+}
+
+/**
+ * Converts values of one primitive type to another.
  *
  * \note there is no optimization for the case where \a otype and \a ctype are the same:
  * assumption is that caller will handle this case.
  *
  * \param old_type: Type to convert from.
  * \param new_type: Type to convert to.
- * \param array_len: Number of elements to convert.
- * \param old_data: Buffer containing the old values.
- * \param new_data: Buffer the converted values will be written to.
+ * \param blocks: Number of blocks that contain an array to convert.
+ * \param array_len: Number of elements to convert in every block.
+ * \param old_data: Buffer containing the old values of the first block.
+ * \param old_stride: Distance in bytes between the old arrays of consecutive blocks.
+ * \param new_data: Buffer the converted values of the first block will be written to.
+ * \param new_stride: Distance in bytes between the new arrays of consecutive blocks.
  */
 static void cast_primitive_type(const eSDNA_Type old_type,
                                 const eSDNA_Type new_type,
-                                const int array_len,
+                                const int64_t blocks,
+                                const int64_t array_len,
                                 const char *old_data,
-                                char *new_data)
-{
-  /* define lengths */
-  const int oldlen = DNA_elem_type_size(old_type);
-  const int curlen = DNA_elem_type_size(new_type);
-
-  double old_value_f = 0.0;
-  /* Intentionally overflow signed values into an unsigned type.
-   * Casting back to a signed value preserves the sign (when the new value is signed). */
-  uint64_t old_value_i = 0;
-
-  for (int a = 0; a < array_len; a++) {
-    switch (old_type) {
-      case SDNA_TYPE_CHAR: {
-        const char value = *old_data;
-        old_value_i = value;
-        old_value_f = double(value);
-        break;
-      }
-      case SDNA_TYPE_UCHAR: {
-        const uchar value = *reinterpret_cast<const uchar *>(old_data);
-        old_value_i = value;
-        old_value_f = double(value);
-        break;
-      }
-      case SDNA_TYPE_SHORT: {
-        const short value = *reinterpret_cast<const short *>(old_data);
-        old_value_i = value;
-        old_value_f = double(value);
-        break;
-      }
-      case SDNA_TYPE_USHORT: {
-        const ushort value = *reinterpret_cast<const ushort *>(old_data);
-        old_value_i = value;
-        old_value_f = double(value);
-        break;
-      }
-      case SDNA_TYPE_INT: {
-        const int value = *reinterpret_cast<const int *>(old_data);
-        old_value_i = value;
-        old_value_f = double(value);
-        break;
-      }
-      case SDNA_TYPE_FLOAT: {
-        const float value = *reinterpret_cast<const float *>(old_data);
-        /* `int64_t` range stored in a `uint64_t`. */
-        old_value_i = uint64_t(int64_t(value));
-        old_value_f = value;
-        break;
-      }
-      case SDNA_TYPE_DOUBLE: {
-        const double value = *reinterpret_cast<const double *>(old_data);
-        /* `int64_t` range stored in a `uint64_t`. */
-        old_value_i = uint64_t(int64_t(value));
-        old_value_f = value;
-        break;
-      }
-      case SDNA_TYPE_INT64: {
-        const int64_t value = *reinterpret_cast<const int64_t *>(old_data);
-        old_value_i = uint64_t(value);
-        old_value_f = double(value);
-        break;
-      }
-      case SDNA_TYPE_UINT64: {
-        const uint64_t value = *reinterpret_cast<const uint64_t *>(old_data);
-        old_value_i = value;
-        old_value_f = double(value);
-        break;
-      }
-      case SDNA_TYPE_INT8: {
-        const int8_t value = *reinterpret_cast<const int8_t *>(old_data);
-        old_value_i = uint64_t(value);
-        old_value_f = double(value);
-        break;
-      }
-      case SDNA_TYPE_VOID:
-      case SDNA_TYPE_RAW_DATA:
-        BLI_assert_msg(false,
-                       "Conversion from SDNA_TYPE_VOID/SDNA_TYPE_RAW_DATA is not supported");
-        break;
-    }
-
-    switch (new_type) {
-      case SDNA_TYPE_CHAR:
-        *new_data = char(old_value_i);
-        break;
-      case SDNA_TYPE_UCHAR:
-        *reinterpret_cast<uchar *>(new_data) = uchar(old_value_i);
-        break;
-      case SDNA_TYPE_SHORT:
-        *reinterpret_cast<short *>(new_data) = short(old_value_i);
-        break;
-      case SDNA_TYPE_USHORT:
-        *reinterpret_cast<ushort *>(new_data) = ushort(old_value_i);
-        break;
-      case SDNA_TYPE_INT:
-        *reinterpret_cast<int *>(new_data) = int(old_value_i);
-        break;
-      case SDNA_TYPE_FLOAT:
-        if (old_type < 2) {
-          old_value_f /= 255.0;
-        }
-        *reinterpret_cast<float *>(new_data) = old_value_f;
-        break;
-      case SDNA_TYPE_DOUBLE:
-        if (old_type < 2) {
-          old_value_f /= 255.0;
-        }
-        *reinterpret_cast<double *>(new_data) = old_value_f;
-        break;
-      case SDNA_TYPE_INT64:
-        *reinterpret_cast<int64_t *>(new_data) = int64_t(old_value_i);
-        break;
-      case SDNA_TYPE_UINT64:
-        *reinterpret_cast<uint64_t *>(new_data) = old_value_i;
-        break;
-      case SDNA_TYPE_INT8:
-        *reinterpret_cast<int8_t *>(new_data) = int8_t(old_value_i);
-        break;
-      case SDNA_TYPE_VOID:
-      case SDNA_TYPE_RAW_DATA:
-        BLI_assert_msg(false, "Conversion to SDNA_TYPE_VOID/SDNA_TYPE_RAW_DATA is not supported");
-        break;
-    }
-
-    old_data += oldlen;
-    new_data += curlen;
+                                const int64_t old_stride,
+                                char *new_data,
+                                const int64_t new_stride)
+{
+  /* Dispatch on the types once for all values, instead of once per value. */
+  switch (old_type) {
+    case SDNA_TYPE_CHAR:
+      cast_primitive_type_from<char>(
+          new_type, blocks, array_len, old_data, old_stride, new_data, new_stride);
+      break;
+    case SDNA_TYPE_UCHAR:
+      cast_primitive_type_from<uchar>(
+          new_type, blocks, array_len, old_data, old_stride, new_data, new_stride);
+      break;
+    case SDNA_TYPE_SHORT:
+      cast_primitive_type_from<short>(
+          new_type, blocks, array_len, old_data, old_stride, new_data, new_stride);
+      break;
+    case SDNA_TYPE_USHORT:
+      cast_primitive_type_from<ushort>(
+          new_type, blocks, array_len, old_data, old_stride, new_data, new_stride);
+      break;
+    case SDNA_TYPE_INT:
+      cast_primitive_type_from<int>(
+          new_type, blocks, array_len, old_data, old_stride, new_data, new_stride);
+      break;
+    case SDNA_TYPE_FLOAT:
+      cast_primitive_type_from<float>(
+          new_type, blocks, array_len, old_data, old_stride, new_data, new_stride);
+      break;
+    case SDNA_TYPE_DOUBLE:
+      cast_primitive_type_from<double>(
+          new_type, blocks, array_len, old_data, old_stride, new_data, new_stride);
+      break;
+    case SDNA_TYPE_INT64:
+      cast_primitive_type_from<int64_t>(
+          new_type, blocks, array_len, old_data, old_stride, new_data, new_stride);
+      break;
+    case SDNA_TYPE_UINT64:
+      cast_primitive_type_from<uint64_t>(
+          new_type, blocks, array_len, old_data, old_stride, new_data, new_stride);
+      break;
+    case SDNA_TYPE_INT8:
+      cast_primitive_type_from<int8_t>(
+          new_type, blocks, array_len, old_data, old_stride, new_data, new_stride);
+      break;
+    case SDNA_TYPE_VOID:
+    case SDNA_TYPE_RAW_DATA:
+      BLI_assert_msg(false, "Conversion from SDNA_TYPE_VOID/SDNA_TYPE_RAW_DATA is not supported");
+      break;
   }
 }
 
-static void cast_pointer_32_to_64(const int array_len,
-                                  const uint32_t *old_data,
-                                  uint64_t *new_data)
+static void cast_pointer_32_to_64(const int64_t blocks,
+                                  const int64_t array_len,
+                                  const char *old_data,
+                                  const int64_t old_stride,
+                                  char *new_data,
+                                  const int64_t new_stride)
 {
-  for (int a = 0; a < array_len; a++) {
-    new_data[a] = old_data[a];
+  for (int64_t block = 0; block < blocks; block++) {
+    const char *old_array = old_data + block * old_stride;
+    char *new_array = new_data + block * new_stride;
+    for (int64_t a = 0; a < array_len; a++) {
+      uint32_t old_value;
+      memcpy(&old_value, old_array + a * 4, 4);
+      const uint64_t new_value = old_value;
+      memcpy(new_array + a * 8, &new_value, 8);
+    }
   }
 }
 
-static void cast_pointer_64_to_32(const int array_len,
-                                  const uint64_t *old_data,
-                                  uint32_t *new_data)
+static void cast_pointer_64_to_32(const int64_t blocks,
+                                  const int64_t array_len,
+                                  const char *old_data,
+                                  const int64_t old_stride,
+                                  char *new_data,
+                                  const int64_t new_stride)
 {
   /* WARNING: 32-bit Blender trying to load file saved by 64-bit Blender,
    * pointers may lose uniqueness on truncation! (Hopefully this won't
    * happen unless/until we ever get to multi-gigabyte .blend files...) */
-  for (int a = 0; a < array_len; a++) {
-    new_data[a] = old_data[a] >> 3;
+  for (int64_t block = 0; block < blocks; block++) {
+    const char *old_array = old_data + block * old_stride;
+    char *new_array = new_data + block * new_stride;
+    for (int64_t a = 0; a < array_len; a++) {
+      uint64_t old_value;
+      memcpy(&old_value, old_array + a * 8, 8);
+      const uint32_t new_value = uint32_t(old_value >> 3);
+      memcpy(new_array + a * 4, &new_value, 4);
+    }
   }
 }
 
@@ -1233,79 +1297,113 @@ struct DNA_ReconstructInfo {
   ReconstructStep **steps;
 };
 
+/**
+ * Amount of old struct data that is converted with a single pass over the reconstruct steps.
+ * Executing every step for many blocks at once reduces the per-step overhead, while the chunk
+ * is still small enough to stay in the CPU cache.
+ */
+static constexpr int64_t RECONSTRUCT_CHUNK_SIZE = 16 * 1024;
+
+/** Minimum amount of old struct data converted by a single thread. */
+static constexpr int64_t RECONSTRUCT_PARALLEL_GRAIN_SIZE = 256 * 1024;
+
 static void reconstruct_structs(const DNA_ReconstructInfo *reconstruct_info,
-                                const int blocks,
+                                const int64_t blocks,
                                 const int old_struct_index,
                                 const int new_struct_index,
                                 const char *old_blocks,
                                 char *new_blocks);
 
 /**
- * Converts the contents of an entire struct from oldsdna to newsdna format.
+ * Executes a single preprocessed reconstruct step for a number of consecutive structs.
  *
- * \param reconstruct_info: Preprocessed reconstruct information generated by
- * #DNA_reconstruct_info_create.
- * \param new_struct_index: Index in `newsdna->structs` of the struct that is being reconstructed.
- * \param old_block: Memory buffer containing the old struct.
- * \param new_block: Where to put converted struct contents.
+ * \param old_blocks: Memory buffer containing the old structs.
+ * \param old_block_size: Size of a single struct in the old format.
+ * \param new_blocks: Where to put converted struct contents.
+ * \param new_block_size: Size of a single struct in the new format.
  */
-static void reconstruct_struct(const DNA_ReconstructInfo *reconstruct_info,
-                               const int new_struct_index,
-                               const char *old_block,
-                               char *new_block)
-{
-  const ReconstructStep *steps = reconstruct_info->steps[new_struct_index];
-  const int step_count = reconstruct_info->step_counts[new_struct_index];
-
-  /* Execute all preprocessed steps. */
-  for (int a = 0; a < step_count; a++) {
-    const ReconstructStep *step = &steps[a];
-    switch (step->type) {
-      case RECONSTRUCT_STEP_MEMCPY:
-        memcpy(new_block + step->data.memcpy.new_offset,
-               old_block + step->data.memcpy.old_offset,
-               step->data.memcpy.size);
-        break;
-      case RECONSTRUCT_STEP_CAST_PRIMITIVE:
-        cast_primitive_type(step->data.cast_primitive.old_type,
-                            step->data.cast_primitive.new_type,
-                            step->data.cast_primitive.array_len,
-                            old_block + step->data.cast_primitive.old_offset,
-                            new_block + step->data.cast_primitive.new_offset);
-        break;
-      case RECONSTRUCT_STEP_CAST_POINTER_TO_32:
-        cast_pointer_64_to_32(
-            step->data.cast_pointer.array_len,
-            reinterpret_cast<const uint64_t *>(old_block + step->data.cast_pointer.old_offset),
-            reinterpret_cast<uint32_t *>(new_block + step->data.cast_pointer.new_offset));
-        break;
-      case RECONSTRUCT_STEP_CAST_POINTER_TO_64:
-        cast_pointer_32_to_64(
-            step->data.cast_pointer.array_len,
-            reinterpret_cast<const uint32_t *>(old_block + step->data.cast_pointer.old_offset),
-            reinterpret_cast<uint64_t *>(new_block + step->data.cast_pointer.new_offset));
-        break;
-      case RECONSTRUCT_STEP_SUBSTRUCT:
-        reconstruct_structs(reconstruct_info,
-                            step->data.substruct.array_len,
-                            step->data.substruct.old_struct_index,
-                            step->data.substruct.new_struct_index,
-                            old_block + step->data.substruct.old_offset,
-                            new_block + step->data.substruct.new_offset);
-        break;
-      case RECONSTRUCT_STEP_INIT_ZERO:
-        /* Do nothing, because the memory block are zeroed (from #MEM_new_zeroed).
-         *
-         * Note that the struct could be initialized with the default struct,
-         * however this complicates versioning, especially with flags, see: D4500. */
+static void reconstruct_step_execute(const DNA_ReconstructInfo *reconstruct_info,
+                                     const ReconstructStep &step,
+                                     const int64_t blocks,
+                                     const char *old_blocks,
+                                     const int64_t old_block_size,
+                                     char *new_blocks,
+                                     const int64_t new_block_size)
+{
+  switch (step.type) {
+    case RECONSTRUCT_STEP_MEMCPY: {
+      const char *old_data = old_blocks + step.data.memcpy.old_offset;
+      char *new_data = new_blocks + step.data.memcpy.new_offset;
+      if (step.data.memcpy.size == old_block_size && step.data.memcpy.size == new_block_size) {
+        /* The step covers the entire struct, copy all blocks at once. */
+        memcpy(new_data, old_data, size_t(blocks * new_block_size));
         break;
+      }
+      for (int64_t block = 0; block < blocks; block++) {
+        memcpy(new_data + block * new_block_size,
+               old_data + block * old_block_size,
+               step.data.memcpy.size);
+      }
+      break;
     }
+    case RECONSTRUCT_STEP_CAST_PRIMITIVE:
+      cast_primitive_type(step.data.cast_primitive.old_type,
+                          step.data.cast_primitive.new_type,
+                          blocks,
+                          step.data.cast_primitive.array_len,
+                          old_blocks + step.data.cast_primitive.old_offset,
+                          old_block_size,
+                          new_blocks + step.data.cast_primitive.new_offset,
+                          new_block_size);
+      break;
+    case RECONSTRUCT_STEP_CAST_POINTER_TO_32:
+      cast_pointer_64_to_32(blocks,
+                            step.data.cast_pointer.array_len,
+                            old_blocks + step.data.cast_pointer.old_offset,
+                            old_block_size,
+                            new_blocks + step.data.cast_pointer.new_offset,
+                            new_block_size);
+      break;
+    case RECONSTRUCT_STEP_CAST_POINTER_TO_64:
+      cast_pointer_32_to_64(blocks,
+                            step.data.cast_pointer.array_len,
+                            old_blocks + step.data.cast_pointer.old_offset,
+                            old_block_size,
+                            new_blocks + step.data.cast_pointer.new_offset,
+                            new_block_size);
+      break;
+    case RECONSTRUCT_STEP_SUBSTRUCT:
+      for (int64_t block = 0; block < blocks; block++) {
+        reconstruct_structs(reconstruct_info,
+                            step.data.substruct.array_len,
+                            step.data.substruct.old_struct_index,
+                            step.data.substruct.new_struct_index,
+                            old_blocks + block * old_block_size + step.data.substruct.old_offset,
+                            new_blocks + block * new_block_size + step.data.substruct.new_offset);
+      }
+      break;
+    case RECONSTRUCT_STEP_INIT_ZERO:
+      /* Do nothing, because the memory block are zeroed (from #MEM_new_zeroed).
+       *
+       * Note that the struct could be initialized with the default struct,
+       * however this complicates versioning, especially with flags, see: D4500. */
+      break;
   }
 }
 
-/** Reconstructs an array of structs. */
+/**
+ * Converts the contents of an array of structs from oldsdna to newsdna format.
+ *
+ * \param reconstruct_info: Preprocessed reconstruct information generated by
+ * #DNA_reconstruct_info_create.
+ * \param blocks: Number of structs in the array.
+ * \param old_struct_index: Index in `oldsdna->structs` of the struct that is being reconstructed.
+ * \param new_struct_index: Index in `newsdna->structs` of the struct that is being reconstructed.
+ * \param old_blocks: Memory buffer containing the old structs.
+ * \param new_blocks: Where to put converted struct contents.
+ */
 static void reconstruct_structs(const DNA_ReconstructInfo *reconstruct_info,
-                                const int blocks,
+                                const int64_t blocks,
                                 const int old_struct_index,
                                 const int new_struct_index,
                                 const char *old_blocks,
@@ -1314,13 +1412,28 @@ static void reconstruct_structs(const DNA_ReconstructInfo *reconstruct_info,
   const SDNA_Struct *old_struct = reconstruct_info->oldsdna->structs[old_struct_index];
   const SDNA_Struct *new_struct = reconstruct_info->newsdna->structs[new_struct_index];
 
-  const int old_block_size = reconstruct_info->oldsdna->types_size[old_struct->type_index];
-  const int new_block_size = reconstruct_info->newsdna->types_size[new_struct->type_index];
+  const int64_t old_block_size = reconstruct_info->oldsdna->types_size[old_struct->type_index];
+  const int64_t new_block_size = reconstruct_info->newsdna->types_size[new_struct->type_index];
 
-  for (int a = 0; a < blocks; a++) {
-    const char *old_block = old_blocks + a * old_block_size;
-    char *new_block = new_blocks + a * new_block_size;
-    reconstruct_struct(reconstruct_info, new_struct_index, old_block, new_block);
+  const ReconstructStep *steps = reconstruct_info->steps[new_struct_index];
+  const int step_count = reconstruct_info->step_counts[new_struct_index];
+
+  const int64_t chunk_size = std::max<int64_t>(
+      1, RECONSTRUCT_CHUNK_SIZE / std::max<int64_t>(old_block_size, 1));
+  for (int64_t chunk_start = 0; chunk_start < blocks; chunk_start += chunk_size) {
+    const int64_t chunk_blocks = std::min(chunk_size, blocks - chunk_start);
+    const char *old_chunk = old_blocks + chunk_start * old_block_size;
+    char *new_chunk = new_blocks + chunk_start * new_block_size;
+    /* Execute all preprocessed steps. */
+    for (int a = 0; a < step_count; a++) {
+      reconstruct_step_execute(reconstruct_info,
+                               steps[a],
+                               chunk_blocks,
+                               old_chunk,
+                               old_block_size,
+                               new_chunk,
+                               new_block_size);
+    }
   }
 }
 
@@ -1343,19 +1456,27 @@ void *DNA_struct_reconstruct(const DNA_ReconstructInfo *reconstruct_info,
   }
 
   const SDNA_Struct *new_struct = newsdna->structs[new_struct_index];
-  const int new_block_size = newsdna->types_size[new_struct->type_index];
+  const int64_t old_block_size = oldsdna->types_size[old_struct->type_index];
+  const int64_t new_block_size = newsdna->types_size[new_struct->type_index];
 
   const int alignment = DNA_struct_alignment(newsdna, new_struct_index);
   char *new_blocks = static_cast<char *>(
       MEM_new_array_zeroed_aligned(new_block_size, blocks, alignment, alloc_name));
-  reconstruct_structs(reconstruct_info,
-                      blocks,
-                      old_struct_index,
-                      new_struct_index,
-                      static_cast<const char *>(old_blocks),
-                      new_blocks);
+
+  /* Large arrays of structs (e.g. mesh data from files written before it was stored in generic
+   * attributes) are converted in parallel. Every block is independent of the others. */
+  const int64_t grain_size = std::max<int64_t>(
+      1, RECONSTRUCT_PARALLEL_GRAIN_SIZE / std::max<int64_t>(old_block_size, 1));
+  threading::parallel_for(IndexRange(blocks), grain_size, [&](const IndexRange range) {
+    reconstruct_structs(reconstruct_info,
+                        range.size(),
+                        old_struct_index,
+                        new_struct_index,
+                        static_cast<const char *>(old_blocks) + range.start() * old_block_size,
+                        new_blocks + range.start() * new_block_size);
+  });
   if (r_alloc_size) {
-    *r_alloc_size = int64_t(new_block_size) * blocks;
+    *r_alloc_size = new_block_size * blocks;
   }
   return new_blocks;
 }
@@ -1597,41 +1718,91 @@ static ReconstructStep *create_reconstruct_steps_for_struct(const SDNA *oldsdna,
   return steps;
 }
 
+/**
+ * Check if the cast steps operate on consecutive arrays, so that they can be merged into a single
+ * step by extending the array length of the first step.
+ */
+static bool cast_steps_are_consecutive(const int prev_old_offset,
+                                       const int prev_new_offset,
+                                       const int prev_array_len,
+                                       const int old_offset,
+                                       const int new_offset,
+                                       const int old_type_size,
+                                       const int new_type_size)
+{
+  return prev_old_offset + prev_array_len * old_type_size == old_offset &&
+         prev_new_offset + prev_array_len * new_type_size == new_offset;
+}
+
 /** Compresses an array of reconstruct steps in-place and returns the new step count. */
 static int compress_reconstruct_steps(ReconstructStep *steps, const int old_step_count)
 {
   int new_step_count = 0;
   for (int a = 0; a < old_step_count; a++) {
     ReconstructStep *step = &steps[a];
+    ReconstructStep *prev_step = new_step_count > 0 ? &steps[new_step_count - 1] : nullptr;
     switch (step->type) {
       case RECONSTRUCT_STEP_INIT_ZERO:
         /* These steps are simply removed. */
         break;
       case RECONSTRUCT_STEP_MEMCPY:
-        if (new_step_count > 0) {
-          /* Try to merge this memcpy step with the previous one. */
-          ReconstructStep *prev_step = &steps[new_step_count - 1];
-          if (prev_step->type == RECONSTRUCT_STEP_MEMCPY) {
-            /* Check if there are no bytes between the blocks to copy. */
-            if (prev_step->data.memcpy.old_offset + prev_step->data.memcpy.size ==
-                    step->data.memcpy.old_offset &&
-                prev_step->data.memcpy.new_offset + prev_step->data.memcpy.size ==
-                    step->data.memcpy.new_offset)
-            {
-              prev_step->data.memcpy.size += step->data.memcpy.size;
-              break;
-            }
+        /* Try to merge this memcpy step with the previous one. */
+        if (prev_step && prev_step->type == RECONSTRUCT_STEP_MEMCPY) {
+          /* Check if there are no bytes between the blocks to copy. */
+          if (prev_step->data.memcpy.old_offset + prev_step->data.memcpy.size ==
+                  step->data.memcpy.old_offset &&
+              prev_step->data.memcpy.new_offset + prev_step->data.memcpy.size ==
+                  step->data.memcpy.new_offset)
+          {
+            prev_step->data.memcpy.size += step->data.memcpy.size;
+            break;
           }
         }
         steps[new_step_count] = *step;
         new_step_count++;
         break;
       case RECONSTRUCT_STEP_CAST_PRIMITIVE:
+        /* Merge consecutive arrays with the same types (e.g. `x`, `y` and `z` members), so that
+         * they are converted in a single loop. */
+        if (prev_step && prev_step->type == RECONSTRUCT_STEP_CAST_PRIMITIVE &&
+            prev_step->data.cast_primitive.old_type == step->data.cast_primitive.old_type &&
+            prev_step->data.cast_primitive.new_type == step->data.cast_primitive.new_type &&
+            cast_steps_are_consecutive(prev_step->data.cast_primitive.old_offset,
+                                       prev_step->data.cast_primitive.new_offset,
+                                       prev_step->data.cast_primitive.array_len,
+                                       step->data.cast_primitive.old_offset,
+                                       step->data.cast_primitive.new_offset,
+                                       DNA_elem_type_size(step->data.cast_primitive.old_type),
+                                       DNA_elem_type_size(step->data.cast_primitive.new_type)))
+        {
+          prev_step->data.cast_primitive.array_len += step->data.cast_primitive.array_len;
+          break;
+        }
+        steps[new_step_count] = *step;
+        new_step_count++;
+        break;
       case RECONSTRUCT_STEP_CAST_POINTER_TO_32:
-      case RECONSTRUCT_STEP_CAST_POINTER_TO_64:
+      case RECONSTRUCT_STEP_CAST_POINTER_TO_64: {
+        const bool to_32 = step->type == RECONSTRUCT_STEP_CAST_POINTER_TO_32;
+        if (prev_step && prev_step->type == step->type &&
+            cast_steps_are_consecutive(prev_step->data.cast_pointer.old_offset,
+                                       prev_step->data.cast_pointer.new_offset,
+                                       prev_step->data.cast_pointer.array_len,
+                                       step->data.cast_pointer.old_offset,
+                                       step->data.cast_pointer.new_offset,
+                                       to_32 ? 8 : 4,
+                                       to_32 ? 4 : 8))
+        {
+          prev_step->data.cast_pointer.array_len += step->data.cast_pointer.array_len;
+          break;
+        }
+        steps[new_step_count] = *step;
+        new_step_count++;
+        break;
+      }
       case RECONSTRUCT_STEP_SUBSTRUCT:
-        /* These steps are not changed at all for now. It should be possible to merge consecutive
-         * steps of the same type, but it is not really worth it. */
+        /* These steps are not changed here, small nested structs are inlined by
+         * #flatten_reconstruct_steps instead. */
         steps[new_step_count] = *step;
         new_step_count++;
         break;
@@ -1640,6 +1811,78 @@ static int compress_reconstruct_steps(ReconstructStep *steps, const int old_step
   return new_step_count;
 }
 
+/**
+ * Maximum number of steps that a #RECONSTRUCT_STEP_SUBSTRUCT step may be replaced with, when the
+ * steps of the nested struct are inlined into the parent struct.
+ */
+static constexpr int RECONSTRUCT_INLINE_STEPS_MAX = 32;
+
+/**
+ * Appends the reconstruct steps of a struct to \a r_steps, with offsets relative to the parent
+ * struct. Nested structs are inlined unless they are in large arrays. That avoids recursion when
+ * executing the steps and allows merging them with the steps of the parent struct, so that e.g.
+ * a `float[3]` nested in a struct that is converted to `double` becomes part of a larger run.
+ */
+static void flatten_reconstruct_steps(const DNA_ReconstructInfo *reconstruct_info,
+                                      const int new_struct_index,
+                                      const int old_offset,
+                                      const int new_offset,
+                                      Vector<ReconstructStep> &r_steps)
+{
+  const ReconstructStep *steps = reconstruct_info->steps[new_struct_index];
+  const int step_count = reconstruct_info->step_counts[new_struct_index];
+
+  for (int a = 0; a < step_count; a++) {
+    ReconstructStep step = steps[a];
+    switch (step.type) {
+      case RECONSTRUCT_STEP_INIT_ZERO:
+        break;
+      case RECONSTRUCT_STEP_MEMCPY:
+        step.data.memcpy.old_offset += old_offset;
+        step.data.memcpy.new_offset += new_offset;
+        r_steps.append(step);
+        break;
+      case RECONSTRUCT_STEP_CAST_PRIMITIVE:
+        step.data.cast_primitive.old_offset += old_offset;
+        step.data.cast_primitive.new_offset += new_offset;
+        r_steps.append(step);
+        break;
+      case RECONSTRUCT_STEP_CAST_POINTER_TO_32:
+      case RECONSTRUCT_STEP_CAST_POINTER_TO_64:
+        step.data.cast_pointer.old_offset += old_offset;
+        step.data.cast_pointer.new_offset += new_offset;
+        r_steps.append(step);
+        break;
+      case RECONSTRUCT_STEP_SUBSTRUCT: {
+        step.data.substruct.old_offset += old_offset;
+        step.data.substruct.new_offset += new_offset;
+        const int sub_old_struct_index = step.data.substruct.old_struct_index;
+        const int sub_new_struct_index = step.data.substruct.new_struct_index;
+        const int64_t inline_steps_num = int64_t(step.data.substruct.array_len) *
+                                         reconstruct_info->step_counts[sub_new_struct_index];
+        if (inline_steps_num > RECONSTRUCT_INLINE_STEPS_MAX) {
+          r_steps.append(step);
+          break;
+        }
+        const SDNA *oldsdna = reconstruct_info->oldsdna;
+        const SDNA *newsdna = reconstruct_info->newsdna;
+        const int sub_old_size =
+            oldsdna->types_size[oldsdna->structs[sub_old_struct_index]->type_index];
+        const int sub_new_size =
+            newsdna->types_size[newsdna->structs[sub_new_struct_index]->type_index];
+        for (int i = 0; i < step.data.substruct.array_len; i++) {
+          flatten_reconstruct_steps(reconstruct_info,
+                                    sub_new_struct_index,
+                                    step.data.substruct.old_offset + i * sub_old_size,
+                                    step.data.substruct.new_offset + i * sub_new_size,
+                                    r_steps);
+        }
+        break;
+      }
+    }
+  }
+}
+
 DNA_ReconstructInfo *DNA_reconstruct_info_create(const SDNA *oldsdna,
                                                  const SDNA *newsdna,
                                                  const char *compare_flags)
@@ -1672,17 +1915,44 @@ DNA_ReconstructInfo *DNA_reconstruct_info_create(const SDNA *oldsdna,
 
     reconstruct_info->steps[new_struct_index] = steps;
     reconstruct_info->step_counts[new_struct_index] = steps_len;
+  }
+
+  /* Inline the steps of nested structs. This requires the steps of all structs to exist already.
+   * Nested structs that have been flattened before are inlined with their flattened steps. */
+  for (const int new_struct_index : newsdna->structs.index_range()) {
+    ReconstructStep *steps = reconstruct_info->steps[new_struct_index];
+    const int steps_len = reconstruct_info->step_counts[new_struct_index];
+    if (std::none_of(steps, steps + steps_len, [](const ReconstructStep &step) {
+          return step.type == RECONSTRUCT_STEP_SUBSTRUCT;
+        }))
+    {
+      continue;
+    }
+    Vector<ReconstructStep> flattened_steps;
+    flatten_reconstruct_steps(reconstruct_info, new_struct_index, 0, 0, flattened_steps);
+    const int flattened_steps_len = compress_reconstruct_steps(flattened_steps.data(),
+                                                               int(flattened_steps.size()));
+    if (flattened_steps_len > steps_len) {
+      MEM_delete(steps);
+      steps = MEM_new_array_uninitialized<ReconstructStep>(size_t(flattened_steps_len), __func__);
+      reconstruct_info->steps[new_struct_index] = steps;
+    }
+    std::copy_n(flattened_steps.data(), flattened_steps_len, steps);
+    reconstruct_info->step_counts[new_struct_index] = flattened_steps_len;
+  }
 
 /* This is useful when debugging the reconstruct steps. */
 #if 0
-    printf("%s: \n", new_struct_name);
-    for (int a = 0; a < steps_len; a++) {
+  for (const int new_struct_index : newsdna->structs.index_range()) {
+    printf("%s: \n",
+           std::string(newsdna->types[newsdna->structs[new_struct_index]->type_index]).c_str());
+    for (int a = 0; a < reconstruct_info->step_counts[new_struct_index]; a++) {
       printf("  ");
-      print_reconstruct_step(&steps[a], oldsdna, newsdna);
+      print_reconstruct_step(&reconstruct_info->steps[new_struct_index][a], oldsdna, newsdna);
       printf("\n");
     }
-#endif
   }
+#endif
 
   return reconstruct_info;
 }
@@ -7,7 +7,12 @@
 #include "DNA_genfile.h"
 #include "DNA_sdna_types.h"
 
+#include "BLI_string.hh"
 #include "BLI_string_ref.hh"
+#include "BLI_vector.hh"
+#include "BLI_vector_set.hh"
+
+#include "MEM_guardedalloc.h"
 
 #include "dna/dna_test.h"
 
@@ -178,4 +183,236 @@ TEST_F(SDNATest, struct_member_offset_by_name_without_alias)
             offsetof(StructWithEnumMembers, my_enum32));
 }
 
+namespace {
+
+struct TestStructDefinition {
+  const char *type_name;
+  int size;
+  /** Pairs of type and member names. */
+  Vector<std::pair<const char *, const char *>> members;
+};
+
+/**
+ * Encode SDNA data for the given structs, in the same format that is written by `makesdna`. This
+ * allows creating two versions of a struct to test reconstruction.
+ */
+Vector<char> encode_test_sdna(const Span<TestStructDefinition> structs)
+{
+  Vector<std::pair<const char *, int>> types = {{"char", 1},
+                                                {"uchar", 1},
+                                                {"short", 2},
+                                                {"ushort", 2},
+                                                {"int", 4},
+                                                {"long", 4},
+                                                {"ulong", 4},
+                                                {"float", 4},
+                                                {"double", 8},
+                                                {"int64_t", 8},
+                                                {"uint64_t", 8},
+                                                {"void", 0},
+                                                {"int8_t", 1},
+                                                {"raw_data", 0},
+                                                {"ListBase", int(sizeof(ListBase))}};
+  const int builtin_types_num = 13;
+  for (const TestStructDefinition &struct_def : structs) {
+    types.append({struct_def.type_name, struct_def.size});
+  }
+  auto type_index = [&](const StringRef name) {
+    for (const int i : types.index_range()) {
+      if (name == types[i].first) {
+        return short(i);
+      }
+    }
+    BLI_assert_unreachable();
+    return short(-1);
+  };
+  VectorSet<std::string> member_names = {"*first", "*last"};
+  for (const TestStructDefinition &struct_def : structs) {
+    for (const auto &member : struct_def.members) {
+      member_names.add(member.second);
+    }
+  }
+
+  Vector<char> data;
+  auto write = [&](const void *value, const int size) {
+    data.extend(Span(static_cast<const char *>(value), size));
+  };
+  auto write_int = [&](const int value) { write(&value, sizeof(int)); };
+  auto write_short = [&](const short value) { write(&value, sizeof(short)); };
+  auto write_string = [&](const StringRef str) {
+    data.extend(Span(str.data(), str.size()));
+    data.append('\0');
+  };
+  auto align_4 = [&]() {
+    while (data.size() % 4 != 0) {
+      data.append('\0');
+    }
+  };
+
+  write("SDNANAME", 8);
+  write_int(member_names.size());
+  for (const std::string &name : member_names) {
+    write_string(name);
+  }
+  align_4();
+  write("TYPE", 4);
+  write_int(types.size());
+  for (const auto &type : types) {
+    write_string(type.first);
+  }
+  align_4();
+  write("TLEN", 4);
+  for (const auto &type : types) {
+    write_short(type.second);
+  }
+  align_4();
+  write("STRC", 4);
+  write_int(2 + structs.size());
+  /* The raw data struct always comes first. */
+  write_short(builtin_types_num);
+  write_short(0);
+  write_short(type_index("ListBase"));
+  write_short(2);
+  for (const char *name : {"*first", "*last"}) {
+    write_short(type_index("void"));
+    write_short(member_names.index_of(name));
+  }
+  for (const TestStructDefinition &struct_def : structs) {
+    write_short(type_index(struct_def.type_name));
+    write_short(struct_def.members.size());
+    for (const auto &member : struct_def.members) {
+      write_short(type_index(member.first));
+      write_short(member_names.index_of(member.second));
+    }
+  }
+  return data;
+}
+
+struct OldPoint {
+  float co[3];
+  int flag;
+  short type;
+  short pad;
+  char name[8];
+};
+
+struct NewPoint {
+  float co[3];
+  int flag;
+  short type;
+  short pad;
+  char name[8];
+  float extra;
+};
+
+struct OldContainer {
+  OldPoint points[4];
+  int value;
+  int count;
+};
+
+struct NewContainer {
+  NewPoint points[4];
+  float value;
+  int count;
+};
+
+}  // namespace
+
+TEST(SDNAReconstruct, struct_array)
+{
+  const TestStructDefinition old_point{"Point",
+                                       sizeof(OldPoint),
+                                       {{"float", "co[3]"},
+                                        {"int", "flag"},
+                                        {"short", "type"},
+                                        {"short", "pad"},
+                                        {"char", "name[8]"}}};
+  const TestStructDefinition new_point{"Point",
+                                       sizeof(NewPoint),
+                                       {{"float", "co[3]"},
+                                        {"int", "flag"},
+                                        {"short", "type"},
+                                        {"short", "pad"},
+                                        {"char", "name[8]"},
+                                        {"float", "extra"}}};
+  const TestStructDefinition old_container{"Container",
+                                           sizeof(OldContainer),
+                                           {{"Point", "points[4]"},
+                                            {"int", "value"},
+                                            {"int", "count"}}};
+  const TestStructDefinition new_container{"Container",
+                                           sizeof(NewContainer),
+                                           {{"Point", "points[4]"},
+                                            {"float", "value"},
+                                            {"int", "count"}}};
+  const Vector<char> old_data = encode_test_sdna({old_point, old_container});
+  const Vector<char> new_data = encode_test_sdna({new_point, new_container});
+  const char *error_message = nullptr;
+  std::unique_ptr<SDNA> old_sdna = DNA_sdna_from_data(
+      old_data.data(), old_data.size(), true, false, &error_message);
+  std::unique_ptr<SDNA> new_sdna = DNA_sdna_from_data(
+      new_data.data(), new_data.size(), true, false, &error_message);
+  ASSERT_NE(old_sdna, nullptr);
+  ASSERT_NE(new_sdna, nullptr);
+
+  const char *compare_flags = DNA_struct_get_compareflags(old_sdna.get(), new_sdna.get());
+  const int old_container_index = DNA_struct_find_index_without_alias(old_sdna.get(),
+                                                                      "Container");
+  EXPECT_EQ(compare_flags[old_container_index], SDNA_CMP_NOT_EQUAL);
+  DNA_ReconstructInfo *reconstruct_info = DNA_reconstruct_info_create(
+      old_sdna.get(), new_sdna.get(), compare_flags);
+
+  /* Use enough elements to test the conversion of large arrays as well. */
+  for (const int containers_num : {1, 5000}) {
+    Vector<OldContainer> old_containers(containers_num);
+    for (const int i : old_containers.index_range()) {
+      OldContainer &container = old_containers[i];
+      for (const int j : IndexRange(4)) {
+        OldPoint &point = container.points[j];
+        point.co[0] = float(i);
+        point.co[1] = float(j);
+        point.co[2] = float(i + j);
+        point.flag = i * 4 + j;
+        point.type = short(j);
+        point.pad = 0;
+        STRNCPY(point.name, "point");
+      }
+      container.value = i - 100;
+      container.count = i * 2;
+    }
+
+    int64_t alloc_size = 0;
+    NewContainer *new_containers = static_cast<NewContainer *>(
+        DNA_struct_reconstruct(reconstruct_info,
+                               old_container_index,
+                               containers_num,
+                               old_containers.data(),
+                               __func__,
+                               &alloc_size));
+    ASSERT_NE(new_containers, nullptr);
+    EXPECT_EQ(alloc_size, sizeof(NewContainer) * containers_num);
+    for (const int i : old_containers.index_range()) {
+      const NewContainer &container = new_containers[i];
+      for (const int j : IndexRange(4)) {
+        const NewPoint &point = container.points[j];
+        EXPECT_EQ(point.co[0], float(i));
+        EXPECT_EQ(point.co[1], float(j));
+        EXPECT_EQ(point.co[2], float(i + j));
+        EXPECT_EQ(point.flag, i * 4 + j);
+        EXPECT_EQ(point.type, short(j));
+        EXPECT_STREQ(point.name, "point");
+        /* New members are zero initialized. */
+        EXPECT_EQ(point.extra, 0.0f);
+      }
+      EXPECT_EQ(container.value, float(i - 100));
+      EXPECT_EQ(container.count, i * 2);
+    }
+    MEM_delete(new_containers);
+  }
+
+  DNA_reconstruct_info_free(reconstruct_info);
+  MEM_delete(compare_flags);
+}
+
 }  // namespace blender::dna
@@ -282,6 +282,30 @@ static void rna_Cache_toggle_disk_cache(Main * /*bmain*/, Scene * /*scene*/, Poi
   }
 }
 
+static void rna_Cache_toggle_disk_pack(Main * /*bmain*/, Scene * /*scene*/, PointerRNA *ptr)
+{
+  Object *ob = nullptr;
+  Scene *scene = nullptr;
+
+  if (!rna_Cache_get_valid_owner_ID(ptr, &ob, &scene)) {
+    return;
+  }
+
+  PointCache *cache = static_cast<PointCache *>(ptr->data);
+
+  PTCacheID pid = BKE_ptcache_id_find(ob, scene, cache);
+
+  /* Convert an existing baked disk cache, new bakes are packed when they finish. */
+  if (pid.cache && (cache->flag & PTCACHE_BAKED) && (cache->flag & PTCACHE_DISK_CACHE)) {
+    if (cache->flag & PTCACHE_DISK_PACK) {
+      BKE_ptcache_disk_pack(&pid);
+    }
+    else {
+      BKE_ptcache_disk_unpack(&pid);
+    }
+  }
+}
+
 bool rna_Cache_use_disk_cache_override_apply(Main * /*bmain*/,
                                              RNAPropertyOverrideApplyContext &rnaapply_ctx)
 {
@@ -1041,6 +1065,14 @@ static void rna_def_pointcache_common(StructRNA *srna)
   RNA_def_property_override_funcs(
       prop, nullptr, nullptr, "rna_Cache_use_disk_cache_override_apply");
 
+  prop = RNA_def_property(srna, "use_disk_cache_pack", PROP_BOOLEAN, PROP_NONE);
+  RNA_def_property_boolean_sdna(prop, nullptr, "flag", PTCACHE_DISK_PACK);
+  RNA_def_property_ui_text(prop,
+                           "Pack Disk Cache",
+                           "Store all frames of a baked disk cache in a single indexed file, "
+                           "which is faster to play back than one file per frame");
+  RNA_def_property_update(prop, NC_OBJECT, "rna_Cache_toggle_disk_pack");
+
   prop = RNA_def_property(srna, "is_outdated", PROP_BOOLEAN, PROP_NONE);
   RNA_def_property_boolean_sdna(prop, nullptr, "flag", PTCACHE_OUTDATED);
   RNA_def_property_clear_flag(prop, PROP_EDITABLE);
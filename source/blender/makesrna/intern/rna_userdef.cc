@@ -1185,6 +1185,10 @@ static void rna_Userdef_memcache_update(Main * /*bmain*/, Scene * /*scene*/, Poi
   const int64_t new_limit = int64_t(U.memcachelimit) * 1024 * 1024;
   MEM_CacheLimiter_set_maximum(new_limit);
   memory_cache::set_approximate_size_limit(new_limit);
+  memory_cache::set_approximate_size_limit(memory_cache::Category::VolumeGrids,
+                                           int64_t(U.memcachelimit_volume_grids) * 1024 * 1024);
+  memory_cache::set_approximate_size_limit(memory_cache::Category::FileLoads,
+                                           int64_t(U.memcachelimit_file_loads) * 1024 * 1024);
   USERDEF_TAG_DIRTY;
 }
 
@@ -6400,6 +6404,24 @@ static void rna_def_userdef_system(BlenderRNA *brna)
   RNA_def_property_ui_text(prop, "Memory Cache Limit", "Memory cache limit (in megabytes)");
   RNA_def_property_update(prop, 0, "rna_Userdef_memcache_update");
 
+  prop = RNA_def_property(srna, "memory_cache_limit_volume_grids", PROP_INT, PROP_NONE);
+  RNA_def_property_int_sdna(prop, nullptr, "memcachelimit_volume_grids");
+  RNA_def_property_range(prop, 0, max_memory_in_megabytes_int());
+  RNA_def_property_ui_text(prop,
+                           "Volume Grids Cache Limit",
+                           "Memory cache limit for volume grids loaded from files (in megabytes). "
+                           "Zero means they are only limited by the memory cache limit");
+  RNA_def_property_update(prop, 0, "rna_Userdef_memcache_update");
+
+  prop = RNA_def_property(srna, "memory_cache_limit_file_loads", PROP_INT, PROP_NONE);
+  RNA_def_property_int_sdna(prop, nullptr, "memcachelimit_file_loads");
+  RNA_def_property_range(prop, 0, max_memory_in_megabytes_int());
+  RNA_def_property_ui_text(prop,
+                           "File Loads Cache Limit",
+                           "Memory cache limit for files loaded by geometry nodes (in megabytes). "
+                           "Zero means they are only limited by the memory cache limit");
+  RNA_def_property_update(prop, 0, "rna_Userdef_memcache_update");
+
   /* Nodes. */
 
   prop = RNA_def_property(srna, "nodes_stack_limit", PROP_INT, PROP_NONE);
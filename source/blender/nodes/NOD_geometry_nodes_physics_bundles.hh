@@ -16,6 +16,12 @@ class MeshColliderBundle {
   static const FlatBundleTypePtr &get_bundle_type();
 };
 
+class PointCollisionBundle {
+ public:
+  static constexpr StringRefNull name = "Blender.Collision.Points";
+  static const FlatBundleTypePtr &get_bundle_type();
+};
+
 class CollisionContactsBundle {
  public:
   static constexpr StringRefNull name = "Blender.CollisionContacts";
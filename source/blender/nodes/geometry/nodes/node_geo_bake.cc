@@ -729,6 +729,11 @@ void draw_common_bake_settings(bContext *C, BakeDrawContext &ctx, ui::Layout &la
                     ICON_NONE,
                     placeholder_path);
   }
+  {
+    ui::Layout *col = &settings_col.column(true);
+    col->use_property_split_set(false); /* bfa - use_property_split = False */
+    col->prop(&ctx.bake_rna, "use_compression", UI_ITEM_NONE, IFACE_("Compress"), ICON_NONE);
+  }
   {
     ui::Layout *col = &settings_col.column(true);
     col->use_property_split_set(false); /* bfa - use_property_split = False */
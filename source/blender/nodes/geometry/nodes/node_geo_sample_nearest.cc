@@ -146,19 +146,30 @@ static void get_closest_mesh_tris(const Mesh &mesh,
 {
   BLI_assert(mesh.faces_num > 0);
   const bke::bvh::Tree &tree = mesh.bvh_tris();
-  mask.foreach_index([&](const int i) {
-    const float3 position = positions[i];
-    const bke::bvh::ClosestPointResult nearest = *tree.closest_point(position);
-    if (!r_tri_indices.is_empty()) {
-      r_tri_indices[i] = nearest.index;
-    }
-    if (!r_distances_sq.is_empty()) {
-      r_distances_sq[i] = math::distance_squared(position, nearest.position);
-    }
-    if (!r_positions.is_empty()) {
-      r_positions[i] = nearest.position;
-    }
-  });
+
+  /* Query the closest points in chunks to limit the size of the temporary buffers. */
+  constexpr int64_t chunk_size = 4096;
+  Array<float3> chunk_positions(std::min(chunk_size, mask.size()));
+  Array<std::optional<bke::bvh::ClosestPointResult>> chunk_results(chunk_positions.size());
+  for (int64_t start = 0; start < mask.size(); start += chunk_size) {
+    const IndexMask chunk = mask.slice(start, std::min(chunk_size, mask.size() - start));
+    chunk.foreach_index([&](const int i, const int pos) { chunk_positions[pos] = positions[i]; });
+    tree.closest_point(IndexRange(chunk.size()), chunk_positions, chunk_results);
+
+    chunk.foreach_index([&](const int i, const int pos) {
+      const float3 &position = chunk_positions[pos];
+      const bke::bvh::ClosestPointResult &nearest = *chunk_results[pos];
+      if (!r_tri_indices.is_empty()) {
+        r_tri_indices[i] = nearest.index;
+      }
+      if (!r_distances_sq.is_empty()) {
+        r_distances_sq[i] = math::distance_squared(position, nearest.position);
+      }
+      if (!r_positions.is_empty()) {
+        r_positions[i] = nearest.position;
+      }
+    });
+  }
 }
 
 static void get_closest_mesh_faces(const Mesh &mesh,
@@ -164,34 +164,54 @@ class SampleNearestSurfaceFunction : public mf::MultiFunction {
     MutableSpan<bool> is_valid_span = params.uninitialized_single_output_if_required<bool>(
         4, "Is Valid");
 
-    mask.foreach_index([&](const int i) {
-      const float3 position = positions[i];
-      const int sample_id = sample_ids[i];
-      const int group_index = group_indices_.index_of_try(sample_id);
-      if (group_index == -1) {
-        triangle_index[i] = -1;
-        bary_weights[i] = float3(0, 0, 0);
-        if (!is_valid_span.is_empty()) {
-          is_valid_span[i] = false;
+    /* Query the closest points in chunks to limit the size of the temporary buffers. */
+    constexpr int64_t chunk_size = 4096;
+    Array<float3> chunk_positions(std::min(chunk_size, mask.size()));
+    Array<int> chunk_group_indices(chunk_positions.size());
+    Array<std::optional<bke::bvh::ClosestPointResult>> chunk_results(chunk_positions.size());
+    for (int64_t start = 0; start < mask.size(); start += chunk_size) {
+      const IndexMask chunk = mask.slice(start, std::min(chunk_size, mask.size() - start));
+      chunk.foreach_index([&](const int i, const int pos) {
+        chunk_positions[pos] = positions[i];
+        chunk_group_indices[pos] = group_indices_.index_of_try(sample_ids[i]);
+        chunk_results[pos] = std::nullopt;
+      });
+
+      IndexMaskMemory memory;
+      const IndexMask valid_mask = IndexMask::from_predicate(
+          IndexRange(chunk.size()), memory, [&](const int pos) {
+            return chunk_group_indices[pos] != -1;
+          });
+      if (single_tree_) {
+        single_tree_->closest_point(valid_mask, chunk_positions, chunk_results);
+      }
+      else {
+        /* Process the queries of each group together, so that they use the same tree. */
+        VectorSet<int> groups;
+        const Vector<IndexMask, 4> group_masks = IndexMask::from_group_ids(
+            valid_mask, VArray<int>::from_span(chunk_group_indices), memory, groups);
+        for (const int i : group_masks.index_range()) {
+          bvh_trees_[groups[i]].closest_point(group_masks[i], chunk_positions, chunk_results);
         }
-        return;
       }
-      const bke::bvh::Tree &bvh = single_tree_ ? *single_tree_ : bvh_trees_[group_index];
-      const std::optional<bke::bvh::ClosestPointResult> result = bvh.closest_point(position);
-      if (!result) {
-        triangle_index[i] = -1;
-        bary_weights[i] = float3(0, 0, 0);
+
+      chunk.foreach_index([&](const int i, const int pos) {
+        const std::optional<bke::bvh::ClosestPointResult> &result = chunk_results[pos];
+        if (!result) {
+          triangle_index[i] = -1;
+          bary_weights[i] = float3(0, 0, 0);
+          if (!is_valid_span.is_empty()) {
+            is_valid_span[i] = false;
+          }
+          return;
+        }
+        triangle_index[i] = result->index;
+        bary_weights[i] = result->bary_coord;
         if (!is_valid_span.is_empty()) {
-          is_valid_span[i] = false;
+          is_valid_span[i] = true;
         }
-        return;
-      }
-      triangle_index[i] = result->index;
-      bary_weights[i] = result->bary_coord;
-      if (!is_valid_span.is_empty()) {
-        is_valid_span[i] = true;
-      }
-    });
+      });
+    }
   }
 
   ExecutionHints get_execution_hints() const override
@@ -56,6 +56,32 @@ static void set_points_position(bke::MutableAttributeAccessor attributes,
                                      position_field);
 }
 
+static void set_mesh_position(Mesh &mesh,
+                              const Field<bool> &selection_field,
+                              const Field<float3> &position_field)
+{
+  const bke::MeshFieldContext field_context(mesh, bke::AttrDomain::Point);
+  if (!selection_field.depends_on_input()) {
+    set_points_position(
+        mesh.attributes_for_write(), field_context, selection_field, position_field);
+    return;
+  }
+
+  fn::FieldEvaluator evaluator(field_context, mesh.verts_num);
+  evaluator.set_selection(selection_field);
+  evaluator.add(position_field);
+  evaluator.evaluate();
+  const IndexMask selection = evaluator.get_evaluated_selection_as_mask();
+  if (selection.is_empty()) {
+    return;
+  }
+  const VArray<float3> positions = evaluator.get_evaluated<float3>(0);
+  positions.materialize(selection, mesh.vert_positions_for_write());
+  /* Only the selected vertices moved, so normals that were calculated already can be updated
+   * locally. */
+  mesh.tag_positions_changed(selection);
+}
+
 static void set_curves_position(bke::CurvesGeometry &curves,
                                 const fn::FieldContext &field_context,
                                 const Field<bool> &selection_field,
@@ -135,10 +161,7 @@ static void node_geo_exec(GeoNodeExecParams params)
                                 params.extract_input<Field<float3>>("Offset"_ustr)}));
 
   if (Mesh *mesh = geometry.get_mesh_for_write()) {
-    set_points_position(mesh->attributes_for_write(),
-                        bke::MeshFieldContext(*mesh, bke::AttrDomain::Point),
-                        selection_field,
-                        position_field);
+    set_mesh_position(*mesh, selection_field, position_field);
   }
   if (PointCloud *pointcloud = geometry.get_pointcloud_for_write()) {
     set_points_position(pointcloud->attributes_for_write(),
@@ -14,6 +14,7 @@
 #include "BKE_mesh_sample.hh"
 #include "BKE_pointcloud.hh"
 
+#include "BLI_bounds.hh"
 #include "BLI_math_geom_c.hh"
 #include "BLI_stack.hh"
 #include "BLI_string_utf8.hh"
@@ -24,6 +25,7 @@
 
 #include "GEO_xpbd_constraint_collision_edge.hh"
 #include "GEO_xpbd_constraint_collision_face.hh"
+#include "GEO_xpbd_constraint_collision_point.hh"
 #include "GEO_xpbd_constraint_damping_angular.hh"
 #include "GEO_xpbd_constraint_damping_linear.hh"
 #include "GEO_xpbd_constraint_distance.hh"
@@ -33,6 +35,7 @@
 #include "GEO_xpbd_constraint_pin_rotation.hh"
 #include "GEO_xpbd_constraint_rod_bend_twist.hh"
 #include "GEO_xpbd_constraint_rod_stretch_shear.hh"
+#include "GEO_xpbd_spatial_hash.hh"
 
 #include "NOD_geo_tag_filter.hh"
 #include "NOD_geometry_nodes_bundle.hh"
@@ -89,6 +92,7 @@ static NestedBundleTypePtr make_world_type()
   types.append(XPBDSolverDataBundle::get_bundle_type());
   types.append(DampingBundle::get_bundle_type());
   types.append(MeshColliderBundle::get_bundle_type());
+  types.append(PointCollisionBundle::get_bundle_type());
   types.append(CollisionContactsBundle::get_bundle_type());
   types.append(RodStretchShearBundle::get_bundle_type());
   types.append(RodBendTwistBundle::get_bundle_type());
@@ -254,6 +258,7 @@ struct PinRotationConstraintChunkUsage {
 struct EdgeLengthConstraint {
   std::string path;
   float error_threshold;
+  xpbd::ConstraintSolveMethod solve_method;
 };
 struct EdgeLengthConstraintUsage {
   /** Index of corresponding #EdgeLengthConstraint. */
@@ -269,6 +274,7 @@ struct EdgeLengthConstraintUsage {
 struct CrossEdgeLengthConstraint {
   std::string path;
   float error_threshold;
+  xpbd::ConstraintSolveMethod solve_method;
 };
 struct CrossEdgeLengthConstraintUsage {
   /** Index of the corresponding #CrossEdgeLengthConstraint. */
@@ -292,8 +298,9 @@ struct DeformingMeshInfo {
   /** This is one longer than the number of substeps because it also contains the initial mesh. */
   Vector<const Mesh *> substep_meshes;
   /**
-   * This contains one bvh tree per substep. A future optimization could be to not build
-   * independent BVH trees for each mesh because the are usually very similar.
+   * This contains one bvh tree per substep. The substep meshes share their topology, so the trees
+   * of the meshes from the previous evaluation are refit instead of being built from scratch (see
+   * #bke::bvh::ReusableTree).
    */
   Vector<const bke::bvh::Tree *> substep_corner_tris_bvh_trees;
   Vector<bke::BVHTreeFromMesh> substep_edges_bvh_trees;
@@ -322,9 +329,36 @@ struct CollisionContacts {
   std::string path;
 };
 
+struct PointCollision {
+  std::string path;
+  float margin;
+  float friction;
+  float compliance;
+  float error_threshold;
+  xpbd::ConstraintSolveMethod solve_method;
+};
+struct PointCollisionUsage {
+  /** Index of the corresponding #PointCollision. */
+  int constraint_i;
+  VArraySpan<float> radii;
+  float max_radius = 0.0f;
+  /** Points of the same curve don't collide with each other. Empty for other geometry types. */
+  Array<int> point_to_curve;
+
+  /* Contacts are found again for every sub-step, using the predicted positions. */
+  xpbd::PointSpatialHash spatial_hash;
+  Vector<int2> point_pairs;
+  Array<float> lambdas_normal;
+  std::unique_ptr<xpbd::CollisionPointConstraintSet> constraint;
+  std::unique_ptr<LinearAllocator<>> coloring_memory;
+  xpbd::ConstraintColoring coloring;
+};
+
 struct ConstraintWithColoring {
   xpbd::ConstraintSet *constraint;
+  /** Only computed when the constraint is solved with the Gauss-Seidel method. */
   xpbd::ConstraintColoring coloring;
+  xpbd::ConstraintSolveMethod solve_method;
 };
 
 struct GeometryData {
@@ -380,6 +414,7 @@ struct GeometryData {
   Vector<EdgeLengthConstraintUsage> edge_length_constraints;
   Vector<CrossEdgeLengthConstraintUsage> cross_edge_length_constraints;
   Vector<MeshColliderUsage> mesh_colliders;
+  Vector<PointCollisionUsage> point_collisions;
   Vector<RodStretchShearConstraintUsage> rod_stretch_shear_constraints;
   Vector<RodBendTwistConstraintUsage> rod_bend_twist_constraints;
 
@@ -543,6 +578,7 @@ struct ChunkData {
 struct ConstraintsInfo {
   Vector<MeshCollider> mesh_colliders;
   Vector<CollisionContacts> collision_contacts;
+  Vector<PointCollision> point_collisions;
   Vector<DampingConstraint> damping_constraints;
   Vector<RodStretchShearConstraint> rod_stretch_shear_constraints;
   Vector<RodBendTwistConstraint> rod_bend_twist_constraints;
@@ -591,6 +627,8 @@ class XpbdSolverStep {
   Geometries geometries_;
   ConstraintsInfo constraints_;
   Array<ChunkData> chunks_data_;
+  /** Accumulated offsets of constraints which are solved with the Jacobi method. */
+  xpbd::JacobiBuffers jacobi_buffers_;
 
   Mutex field_evaluators_mutex_;
 
@@ -630,6 +668,7 @@ class XpbdSolverStep {
     this->prepare_inverse_moments_of_inertia();
 
     this->gather_from_world__mesh_colliders();
+    this->gather_from_world__point_collisions();
     this->gather_from_world__stretch_shear_constraints();
     this->gather_from_world__bend_twist_constraints();
     this->gather_from_world__edge_length_constraints();
@@ -675,6 +714,13 @@ class XpbdSolverStep {
     return 1.0f / std::max(math::square(error_threshold), 1e-12f);
   }
 
+  static xpbd::ConstraintSolveMethod solve_method_from_bundle(const Bundle &bundle)
+  {
+    return bundle.lookup<bool>(*BundleKey::from_str("use_jacobi")).value_or(false) ?
+               xpbd::ConstraintSolveMethod::Jacobi :
+               xpbd::ConstraintSolveMethod::GaussSeidel;
+  }
+
   void gather_nested_bundle_paths()
   {
     foreach_nested_bundle_item(world_,
@@ -882,6 +928,51 @@ class XpbdSolverStep {
     }
   }
 
+  void gather_from_world__point_collisions()
+  {
+    const Span<std::string> paths = nested_bundle_paths_.lookup_as(PointCollisionBundle::name);
+    for (const StringRef path : paths) {
+      const BundlePtr *bundle_ptr = world_.lookup_path_ptr<BundlePtr>(path);
+      if (!bundle_ptr || !*bundle_ptr) {
+        continue;
+      }
+      const Bundle &bundle = **bundle_ptr;
+      const float margin = bundle.lookup<float>(*BundleKey::from_str("margin")).value_or(0.0f);
+      const float friction = bundle.lookup<float>(*BundleKey::from_str("friction")).value_or(0.0f);
+      const float compliance =
+          bundle.lookup<float>(*BundleKey::from_str("compliance")).value_or(0.0f);
+      const float error_threshold =
+          bundle.lookup<float>(*BundleKey::from_str("error_threshold")).value_or(1e-3f);
+      const int constraint_i = constraints_.point_collisions.append_and_get_index(
+          {path,
+           std::max(margin, 0.0f),
+           std::max(friction, 0.0f),
+           compliance,
+           error_threshold,
+           solve_method_from_bundle(bundle)});
+
+      for (const int data_key_i : geometries_.data_keys.index_range()) {
+        if (!this->effector_applies_to_geometry(path, bundle, data_key_i)) {
+          continue;
+        }
+        this->ensure_radius_loaded(data_key_i);
+        GeometryData &geo_data = *geometries_.data[data_key_i];
+        PointCollisionUsage usage;
+        usage.constraint_i = constraint_i;
+        usage.radii = geo_data.radii;
+        if (const std::optional<Bounds<float>> radius_bounds = bounds::min_max(
+                Span<float>(usage.radii)))
+        {
+          usage.max_radius = std::max(radius_bounds->max, 0.0f);
+        }
+        if (geo_data.curves) {
+          usage.point_to_curve = geo_data.curves->point_to_curve_map();
+        }
+        geo_data.point_collisions.append(std::move(usage));
+      }
+    }
+  }
+
   void gather_contacts__mesh_colliders(const int chunk_i,
                                        const float max_distance,
                                        const int solver_refs_i,
@@ -1821,7 +1912,7 @@ class XpbdSolverStep {
       const float error_threshold =
           bundle.lookup<float>(*BundleKey::from_str("error_threshold")).value_or(1e-3f);
       const int constraint_i = constraints_.edge_length_constraints.append_and_get_index(
-          {path, error_threshold});
+          {path, error_threshold, solve_method_from_bundle(bundle)});
 
       for (const int data_key_i : geometries_.data.index_range()) {
         const DataKey &data_key = geometries_.data_keys[data_key_i];
@@ -1869,8 +1960,12 @@ class XpbdSolverStep {
             constraint_usage.compliances,
             error_scale_from_threshold(constraint.error_threshold),
             constraint_usage.lambdas);
-        xpbd::ConstraintColoring coloring = constraint_set.color_constraints(tls.allocator);
-        geo_data.static_constraints.append({&constraint_set, std::move(coloring)});
+        xpbd::ConstraintColoring coloring;
+        if (constraint.solve_method == xpbd::ConstraintSolveMethod::GaussSeidel) {
+          coloring = constraint_set.color_constraints(tls.allocator);
+        }
+        geo_data.static_constraints.append(
+            {&constraint_set, std::move(coloring), constraint.solve_method});
       }
     }
   }
@@ -1885,7 +1980,7 @@ class XpbdSolverStep {
       const float error_threshold =
           bundle.lookup<float>(*BundleKey::from_str("error_threshold")).value_or(1e-3f);
       const int constraint_i = constraints_.cross_edge_length_constraints.append_and_get_index(
-          {path, error_threshold});
+          {path, error_threshold, solve_method_from_bundle(bundle)});
       for (const int data_key_i : geometries_.data.index_range()) {
         const DataKey &data_key = geometries_.data_keys[data_key_i];
         GeometryData &geo_data = *geometries_.data[data_key_i];
@@ -1943,8 +2038,12 @@ class XpbdSolverStep {
             cross_edge_compliances,
             error_scale_from_threshold(constraint.error_threshold),
             constraint_usage.lambdas);
-        xpbd::ConstraintColoring coloring = constraint_set.color_constraints(tls.allocator);
-        geo_data.static_constraints.append({&constraint_set, std::move(coloring)});
+        xpbd::ConstraintColoring coloring;
+        if (constraint.solve_method == xpbd::ConstraintSolveMethod::GaussSeidel) {
+          coloring = constraint_set.color_constraints(tls.allocator);
+        }
+        geo_data.static_constraints.append(
+            {&constraint_set, std::move(coloring), constraint.solve_method});
       }
     }
   }
@@ -2448,6 +2547,9 @@ class XpbdSolverStep {
       }
     }
     else {
+      if (this->uses_jacobi_solve()) {
+        jacobi_buffers_.ensure(geometries_.solver_refs[0]);
+      }
       int solver_refs_i = 0;
       for (const int substep_i : IndexRange(substeps_)) {
         const SubstepInterval substep(
@@ -2457,6 +2559,7 @@ class XpbdSolverStep {
           this->simulate__inertial_update__chunk(chunk_i, solver_refs_i);
         });
         this->simulate__gather_dynamic_constraints(substep, solver_refs_i);
+        this->simulate__gather_point_collisions(solver_refs_i);
         this->simulate__reset_forces();
         for ([[maybe_unused]] const int iter_i : IndexRange(constraint_iterations_)) {
           this->simulate__position_solve__single_iteration(solver_refs_i, average_error_squared);
@@ -2479,13 +2582,31 @@ class XpbdSolverStep {
   {
     for (const int data_key_i : geometries_.data_keys.index_range()) {
       const GeometryData &geo_data = *geometries_.data[data_key_i];
-      if (!geo_data.static_constraints.is_empty()) {
+      if (!geo_data.static_constraints.is_empty() || !geo_data.point_collisions.is_empty()) {
         return false;
       }
     }
     return true;
   }
 
+  bool uses_jacobi_solve() const
+  {
+    for (const int data_key_i : geometries_.data_keys.index_range()) {
+      const GeometryData &geo_data = *geometries_.data[data_key_i];
+      for (const ConstraintWithColoring &constraint : geo_data.static_constraints) {
+        if (constraint.solve_method == xpbd::ConstraintSolveMethod::Jacobi) {
+          return true;
+        }
+      }
+    }
+    for (const PointCollision &collision : constraints_.point_collisions) {
+      if (collision.solve_method == xpbd::ConstraintSolveMethod::Jacobi) {
+        return true;
+      }
+    }
+    return false;
+  }
+
   void prepare_solver_geometry_refs()
   {
     for (const int direction : IndexRange(2)) {
@@ -2623,6 +2744,56 @@ class XpbdSolverStep {
     chunk_data.external_edge_contacts = std::move(new_edge_contacts);
   }
 
+  void simulate__gather_point_collisions(const int solver_refs_i)
+  {
+    threading::parallel_for(geometries_.data_keys.index_range(), 1, [&](const IndexRange range) {
+      for (const int data_key_i : range) {
+        GeometryData &geo_data = *geometries_.data[data_key_i];
+        const xpbd::GeometryRef &ref = geometries_.solver_refs[solver_refs_i][data_key_i];
+        for (PointCollisionUsage &usage : geo_data.point_collisions) {
+          this->gather_point_collisions(data_key_i, ref.positions, usage);
+        }
+      }
+    });
+  }
+
+  void gather_point_collisions(const int data_key_i,
+                               const Span<float3> positions,
+                               PointCollisionUsage &usage)
+  {
+    const PointCollision &collision = constraints_.point_collisions[usage.constraint_i];
+    /* Also find pairs that are not in contact yet but may get into contact during the constraint
+     * iterations. The constraints are only active while the points overlap. */
+    const float search_margin = collision.margin + usage.max_radius;
+    const float cell_size = 2.0f * usage.max_radius + search_margin;
+    usage.point_pairs.clear();
+    if (cell_size > 0.0f) {
+      usage.spatial_hash.build(positions, cell_size);
+      usage.spatial_hash.find_close_pairs(
+          positions, usage.radii, search_margin, usage.point_pairs);
+    }
+    if (!usage.point_to_curve.is_empty()) {
+      usage.point_pairs.remove_if([&](const int2 &pair) {
+        return usage.point_to_curve[pair[0]] == usage.point_to_curve[pair[1]];
+      });
+    }
+
+    usage.lambdas_normal.reinitialize(usage.point_pairs.size());
+    usage.constraint = std::make_unique<xpbd::CollisionPointConstraintSet>(
+        data_key_i,
+        usage.point_pairs,
+        usage.radii,
+        collision.margin,
+        std::max(0.0f, substep_compliance_factor_ * collision.compliance),
+        collision.friction,
+        error_scale_from_threshold(collision.error_threshold),
+        usage.lambdas_normal);
+    if (collision.solve_method == xpbd::ConstraintSolveMethod::GaussSeidel) {
+      usage.coloring_memory = std::make_unique<LinearAllocator<>>();
+      usage.coloring = usage.constraint->color_constraints(*usage.coloring_memory);
+    }
+  }
+
   void simulate__reset_forces()
   {
     this->parallel_for_each_chunk(
@@ -2632,6 +2803,9 @@ class XpbdSolverStep {
       for (ConstraintWithColoring &constraint : geo_data.static_constraints) {
         constraint.constraint->reset_forces();
       }
+      for (PointCollisionUsage &usage : geo_data.point_collisions) {
+        usage.constraint->reset_forces();
+      }
     }
   }
 
@@ -2662,19 +2836,38 @@ class XpbdSolverStep {
       error_tls.local().total_error_count += updater.total_error_count();
     });
 
+    auto solve_constraint = [&](xpbd::ConstraintSet &constraint,
+                                const xpbd::ConstraintColoring &coloring,
+                                const xpbd::ConstraintSolveMethod solve_method) {
+      if (solve_method == xpbd::ConstraintSolveMethod::Jacobi) {
+        threading::parallel_for(IndexRange(constraint.size()), 512, [&](const IndexRange range) {
+          xpbd::JacobiUpdater updater{jacobi_buffers_.geometries()};
+          constraint.solve_jacobi(solve_params, updater, IndexMask(range));
+          error_tls.local().total_error_squared += updater.total_error_squared();
+          error_tls.local().total_error_count += updater.total_error_count();
+        });
+        jacobi_buffers_.apply_and_reset(solver_refs, constraint.get_affected_geo_indices());
+        return;
+      }
+      for (const int color_i : coloring.colors.index_range()) {
+        const IndexMask &mask = coloring.colors[color_i];
+        threading::parallel_for(mask.index_range(), 512, [&](const IndexRange range) {
+          const IndexMask sliced_mask = mask.slice(range);
+          xpbd::GaussSeidelUpdater updater{solver_refs};
+          constraint.solve_sequential(solve_params, updater, sliced_mask);
+          error_tls.local().total_error_squared += updater.total_error_squared();
+          error_tls.local().total_error_count += updater.total_error_count();
+        });
+      }
+    };
     for (const int data_key_i : geometries_.data_keys.index_range()) {
       const GeometryData &geo_data = *geometries_.data[data_key_i];
       for (const ConstraintWithColoring &constraint : geo_data.static_constraints) {
-        for (const int color_i : constraint.coloring.colors.index_range()) {
-          const IndexMask &mask = constraint.coloring.colors[color_i];
-          threading::parallel_for(mask.index_range(), 512, [&](const IndexRange range) {
-            const IndexMask sliced_mask = mask.slice(range);
-            xpbd::GaussSeidelUpdater updater{solver_refs};
-            constraint.constraint->solve_sequential(solve_params, updater, sliced_mask);
-            error_tls.local().total_error_squared += updater.total_error_squared();
-            error_tls.local().total_error_count += updater.total_error_count();
-          });
-        }
+        solve_constraint(*constraint.constraint, constraint.coloring, constraint.solve_method);
+      }
+      for (const PointCollisionUsage &usage : geo_data.point_collisions) {
+        const PointCollision &collision = constraints_.point_collisions[usage.constraint_i];
+        solve_constraint(*usage.constraint, usage.coloring, collision.solve_method);
       }
     }
 
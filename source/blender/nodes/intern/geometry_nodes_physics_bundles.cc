@@ -14,6 +14,16 @@ static void add_filter(FlatBundleTypeBuilder &b)
   b.add<decl::String>("filter"_ustr);
 }
 
+static void add_use_jacobi(FlatBundleTypeBuilder &b)
+{
+  b.add<decl::Bool>("use_jacobi"_ustr)
+      .default_value(false)
+      .description(
+          "Solve all constraints at once and average their changes, instead of solving groups of "
+          "independent constraints one after another. Converges slower but scales better with "
+          "many threads when many constraints affect the same points");
+}
+
 const FlatBundleTypePtr &MeshColliderBundle::get_bundle_type()
 {
   static const FlatBundleTypePtr bundle_type = []() {
@@ -37,6 +47,26 @@ const FlatBundleTypePtr &MeshColliderBundle::get_bundle_type()
   return bundle_type;
 }
 
+const FlatBundleTypePtr &PointCollisionBundle::get_bundle_type()
+{
+  static const FlatBundleTypePtr bundle_type = []() {
+    FlatBundleTypeBuilder b(PointCollisionBundle::name);
+    add_filter(b);
+    b.add<decl::Float>("margin"_ustr).min(0.0f).subtype(PROP_DISTANCE);
+    b.add<decl::Float>("friction"_ustr).min(0.0f);
+    b.add<decl::Float>("compliance"_ustr).min(0.0f);
+    b.add<decl::Float>("error_threshold"_ustr)
+        .default_value(1e-3f)
+        .min(1e-5f)
+        .subtype(PROP_DISTANCE);
+    add_use_jacobi(b);
+    const FlatBundleTypePtr bundle_type = b.build();
+    BundleTypeRegistry::register_type(bundle_type);
+    return bundle_type;
+  }();
+  return bundle_type;
+}
+
 const FlatBundleTypePtr &DampingBundle::get_bundle_type()
 {
   static const FlatBundleTypePtr bundle_type = []() {
@@ -145,6 +175,7 @@ const FlatBundleTypePtr &EdgeLengthConstraintBundle::get_bundle_type()
         .default_value(1e-3f)
         .min(1e-5f)
         .subtype(PROP_DISTANCE);
+    add_use_jacobi(b);
     const FlatBundleTypePtr bundle_type = b.build();
     BundleTypeRegistry::register_type(bundle_type);
     return bundle_type;
@@ -163,6 +194,7 @@ const FlatBundleTypePtr &CrossEdgeLengthConstraintBundle::get_bundle_type()
         .default_value(1e-3f)
         .min(1e-5f)
         .subtype(PROP_DISTANCE);
+    add_use_jacobi(b);
     const FlatBundleTypePtr bundle_type = b.build();
     BundleTypeRegistry::register_type(bundle_type);
     return bundle_type;
@@ -37,6 +37,7 @@
 #include "bpy_app_icons.hh"
 #include "bpy_app_timers.hh"
 
+#include "BLI_memory_cache.hh"
 #include "BLI_utildefines.hh"
 
 #include "BKE_appdir.hh"
@@ -817,6 +818,46 @@ static PyObject *bpy_app_memory_usage_undo(PyObject * /*self*/, PyObject * /*arg
   return PyLong_FromSize_t(total_memory);
 }
 
+PyDoc_STRVAR(
+    /* Wrap. */
+    bpy_app_memory_cache_statistics_doc,
+    ".. function:: memory_cache_statistics()\n"
+    "\n"
+    "   Get usage statistics of the cache that is used e.g. for volume grids and files loaded by\n"
+    "   geometry nodes.\n"
+    "\n"
+    "   :return: Dictionary with an entry for every category of cached data "
+    "('GENERIC', 'VOLUME_GRIDS', 'FILE_LOADS'). "
+    "Each entry is a dictionary with the number of ``hits``, ``misses`` and ``evictions``, "
+    "the number of cached ``values``, their ``size`` and the ``size_limit`` of the category "
+    "in bytes, and the ``compute_time`` spent on cache misses in seconds.\n"
+    "   :rtype: dict[str, dict[str, int | float]]\n");
+
+static PyObject *bpy_app_memory_cache_statistics(PyObject * /*self*/, PyObject * /*args*/)
+{
+  using namespace blender;
+  PyObject *result = PyDict_New();
+  for (int i = 0; i < memory_cache::CATEGORIES_NUM; i++) {
+    const memory_cache::Category category = memory_cache::Category(i);
+    const memory_cache::CategoryStatistics statistics = memory_cache::get_statistics(category);
+    PyObject *item = PyDict_New();
+    auto add_value = [&](const char *name, PyObject *value) {
+      PyDict_SetItemString(item, name, value);
+      Py_DECREF(value);
+    };
+    add_value("hits", PyLong_FromLongLong(statistics.hits));
+    add_value("misses", PyLong_FromLongLong(statistics.misses));
+    add_value("evictions", PyLong_FromLongLong(statistics.evictions));
+    add_value("values", PyLong_FromLongLong(statistics.values_num));
+    add_value("size", PyLong_FromLongLong(statistics.size_in_bytes));
+    add_value("size_limit", PyLong_FromLongLong(statistics.size_limit));
+    add_value("compute_time", PyFloat_FromDouble(statistics.compute_time));
+    PyDict_SetItemString(result, memory_cache::category_name(category).c_str(), item);
+    Py_DECREF(item);
+  }
+  return result;
+}
+
 static PyMethodDef bpy_app_methods[] = {
     {"is_job_running",
      reinterpret_cast<PyCFunction>(bpy_app_is_job_running),
@@ -830,6 +871,10 @@ static PyMethodDef bpy_app_methods[] = {
      static_cast<PyCFunction>(bpy_app_memory_usage_undo),
      METH_NOARGS | METH_STATIC,
      bpy_app_memory_usage_undo_doc},
+    {"memory_cache_statistics",
+     static_cast<PyCFunction>(bpy_app_memory_cache_statistics),
+     METH_NOARGS | METH_STATIC,
+     bpy_app_memory_cache_statistics_doc},
     {nullptr, nullptr, 0, nullptr},
 };
 
@@ -545,6 +545,10 @@ static void wm_init_userdef(Main *bmain)
   const int64_t cache_limit = int64_t(U.memcachelimit) * 1024 * 1024;
   MEM_CacheLimiter_set_maximum(cache_limit);
   memory_cache::set_approximate_size_limit(cache_limit);
+  memory_cache::set_approximate_size_limit(memory_cache::Category::VolumeGrids,
+                                           int64_t(U.memcachelimit_volume_grids) * 1024 * 1024);
+  memory_cache::set_approximate_size_limit(memory_cache::Category::FileLoads,
+                                           int64_t(U.memcachelimit_file_loads) * 1024 * 1024);
 
   BKE_sound_init(bmain);
 